@@ -0,0 +1,138 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Alkenso (Vladimir Vashurkin)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <asenum/asenum.h>
+
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace
+{
+    constexpr size_t ResultCount = 1000;
+    
+    enum class Result
+    {
+        Record,
+        Missing
+    };
+    
+    struct Record
+    {
+        std::array<uint64_t, 8> fields;
+    };
+    
+    using ResultAsEnum = asenum::AsEnum<
+    asenum::Case11<Result, Result::Record, Record>,
+    asenum::Case11<Result, Result::Missing, void>
+    >;
+    
+    static_assert(!ResultAsEnum::storesInline<Result::Record>(), "Record should be allocated on the heap");
+    
+    /// Per-request bump arena: memory is released all at once.
+    class Arena
+    {
+    public:
+        explicit Arena(const size_t size) : m_buffer(size), m_offset(0) {}
+        
+        void* allocate(const size_t size, const size_t align)
+        {
+            m_offset = (m_offset + align - 1) / align * align;
+            void* ptr = &m_buffer[m_offset];
+            m_offset += size;
+            
+            return ptr;
+        }
+        
+        void reset() { m_offset = 0; }
+        
+    private:
+        std::vector<uint8_t> m_buffer;
+        size_t m_offset;
+    };
+    
+    template <typename T>
+    struct ArenaAllocator
+    {
+        using value_type = T;
+        
+        explicit ArenaAllocator(Arena* arena) : arena(arena) {}
+        
+        template <typename U>
+        ArenaAllocator(const ArenaAllocator<U>& other) : arena(other.arena) {}
+        
+        T* allocate(const size_t count) { return static_cast<T*>(arena->allocate(count * sizeof(T), alignof(T))); }
+        void deallocate(T*, size_t) {}
+        
+        template <typename U>
+        bool operator==(const ArenaAllocator<U>& other) const { return arena == other.arena; }
+        
+        template <typename U>
+        bool operator!=(const ArenaAllocator<U>& other) const { return arena != other.arena; }
+        
+        Arena* arena;
+    };
+    
+    void BM_Request_DefaultAllocation(benchmark::State& state)
+    {
+        std::vector<ResultAsEnum> results;
+        results.reserve(ResultCount);
+        
+        for (auto _ : state)
+        {
+            for (size_t i = 0; i < ResultCount; i++)
+            {
+                results.push_back(ResultAsEnum::create<Result::Record>(Record { { { i } } }));
+            }
+            benchmark::DoNotOptimize(results.data());
+            results.clear();
+        }
+        state.SetItemsProcessed(state.iterations() * ResultCount);
+    }
+    
+    void BM_Request_ArenaAllocation(benchmark::State& state)
+    {
+        std::vector<ResultAsEnum> results;
+        results.reserve(ResultCount);
+        Arena arena(ResultCount * 256);
+        
+        for (auto _ : state)
+        {
+            const ArenaAllocator<char> allocator(&arena);
+            for (size_t i = 0; i < ResultCount; i++)
+            {
+                results.push_back(ResultAsEnum::create<Result::Record>(std::allocator_arg, allocator, Record { { { i } } }));
+            }
+            benchmark::DoNotOptimize(results.data());
+            results.clear();
+            arena.reset();
+        }
+        state.SetItemsProcessed(state.iterations() * ResultCount);
+    }
+}
+
+BENCHMARK(BM_Request_DefaultAllocation);
+BENCHMARK(BM_Request_ArenaAllocation);
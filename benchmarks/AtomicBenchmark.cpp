@@ -0,0 +1,193 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Alkenso (Vladimir Vashurkin)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <asenum/atomic.h>
+
+#include <benchmark/benchmark.h>
+
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+
+namespace
+{
+    enum class Health
+    {
+        Ok,
+        Degraded,
+        Down
+    };
+    
+    using SmallState = asenum::AsEnum<
+    asenum::Case11<Health, Health::Ok, void>,
+    asenum::Case11<Health, Health::Degraded, int>,
+    asenum::Case11<Health, Health::Down, void>
+    >;
+    
+    using State = asenum::AsEnum<
+    asenum::Case11<Health, Health::Ok, void>,
+    asenum::Case11<Health, Health::Degraded, int>,
+    asenum::Case11<Health, Health::Down, std::string>
+    >;
+    
+    /// Heap payload: copying the value increments shared reference counter.
+    State MakeDown()
+    {
+        return State::create<Health::Down>("upstream connection refused by remote host");
+    }
+    
+    size_t MessageSize(const State& state)
+    {
+        size_t size = 0;
+        state.ifCase<Health::Down>([&size] (const std::string& message) {
+            size = message.size();
+        });
+        return size;
+    }
+    
+    /// Mutex-guarded value: the way shared state is published without AtomicAsEnum.
+    struct LockedState
+    {
+        std::mutex mutex;
+        State value = MakeDown();
+    };
+    
+    struct SharedLockedState
+    {
+        std::shared_timed_mutex mutex;
+        State value = MakeDown();
+    };
+    
+    void BM_Read_Mutex(benchmark::State& state)
+    {
+        static LockedState s_state;
+        size_t sum = 0;
+        for (auto _ : state)
+        {
+            std::lock_guard<std::mutex> lock(s_state.mutex);
+            sum += MessageSize(s_state.value);
+        }
+        benchmark::DoNotOptimize(sum);
+        state.SetItemsProcessed(state.iterations());
+    }
+    
+    /// Shared lock doesn't exclude readers, but each of them still writes the lock word.
+    void BM_Read_SharedMutex(benchmark::State& state)
+    {
+        static SharedLockedState s_state;
+        size_t sum = 0;
+        for (auto _ : state)
+        {
+            std::shared_lock<std::shared_timed_mutex> lock(s_state.mutex);
+            sum += MessageSize(s_state.value);
+        }
+        benchmark::DoNotOptimize(sum);
+        state.SetItemsProcessed(state.iterations());
+    }
+    
+    void BM_Read_Atomic(benchmark::State& state)
+    {
+        static asenum::AtomicAsEnum<State> s_state(MakeDown());
+        size_t sum = 0;
+        for (auto _ : state)
+        {
+            sum += s_state.read(&MessageSize);
+        }
+        benchmark::DoNotOptimize(sum);
+        state.SetItemsProcessed(state.iterations());
+    }
+    
+    /// Copy of heap payload increments and decrements its reference counter shared by all readers.
+    void BM_Load_Atomic(benchmark::State& state)
+    {
+        static asenum::AtomicAsEnum<State> s_state(MakeDown());
+        size_t sum = 0;
+        for (auto _ : state)
+        {
+            sum += MessageSize(s_state.load());
+        }
+        benchmark::DoNotOptimize(sum);
+        state.SetItemsProcessed(state.iterations());
+    }
+    
+    void BM_Load_AtomicSingleWord(benchmark::State& state)
+    {
+        static asenum::AtomicAsEnum<SmallState> s_state(SmallState::create<Health::Degraded>(2));
+        size_t sum = 0;
+        for (auto _ : state)
+        {
+            sum += s_state.load().caseIndex();
+        }
+        benchmark::DoNotOptimize(sum);
+        state.SetItemsProcessed(state.iterations());
+    }
+    
+    /// Thread 0 keeps publishing new values, other threads read.
+    void BM_ReadWithWriter_Mutex(benchmark::State& state)
+    {
+        static LockedState s_state;
+        size_t sum = 0;
+        for (auto _ : state)
+        {
+            std::lock_guard<std::mutex> lock(s_state.mutex);
+            if (state.thread_index() == 0)
+            {
+                s_state.value = MakeDown();
+            }
+            else
+            {
+                sum += MessageSize(s_state.value);
+            }
+        }
+        benchmark::DoNotOptimize(sum);
+        state.SetItemsProcessed(state.iterations());
+    }
+    
+    void BM_ReadWithWriter_Atomic(benchmark::State& state)
+    {
+        static asenum::AtomicAsEnum<State> s_state(MakeDown());
+        size_t sum = 0;
+        for (auto _ : state)
+        {
+            if (state.thread_index() == 0)
+            {
+                s_state.store(MakeDown());
+            }
+            else
+            {
+                sum += s_state.read(&MessageSize);
+            }
+        }
+        benchmark::DoNotOptimize(sum);
+        state.SetItemsProcessed(state.iterations());
+    }
+}
+
+BENCHMARK(BM_Read_Mutex)->ThreadRange(1, 64)->UseRealTime();
+BENCHMARK(BM_Read_SharedMutex)->ThreadRange(1, 64)->UseRealTime();
+BENCHMARK(BM_Read_Atomic)->ThreadRange(1, 64)->UseRealTime();
+BENCHMARK(BM_Load_Atomic)->ThreadRange(1, 64)->UseRealTime();
+BENCHMARK(BM_Load_AtomicSingleWord)->ThreadRange(1, 64)->UseRealTime();
+BENCHMARK(BM_ReadWithWriter_Mutex)->ThreadRange(2, 64)->UseRealTime();
+BENCHMARK(BM_ReadWithWriter_Atomic)->ThreadRange(2, 64)->UseRealTime();
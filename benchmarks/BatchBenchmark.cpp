@@ -0,0 +1,190 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Alkenso (Vladimir Vashurkin)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "BenchmarkUtils.h"
+
+#include <asenum/batch.h>
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace
+{
+    constexpr size_t ValueCount = 1 << 16;
+    
+    int64_t g_sum = 0;
+    
+    /// Distinct non-inlined function per case: prevents compiler from merging handlers into branchless code.
+    template <size_t I>
+    __attribute__((noinline)) void Consume(const int value)
+    {
+        g_sum += value + static_cast<int64_t>(I);
+    }
+    
+    template <size_t I>
+    __attribute__((noinline)) int64_t Measure(const int value)
+    {
+        return value * static_cast<int64_t>(I + 1);
+    }
+    
+    struct Handler
+    {
+        template <size_t I>
+        void operator()(std::integral_constant<size_t, I>, const int value) const
+        {
+            Consume<I>(value);
+        }
+    };
+    
+    struct MapHandler
+    {
+        template <size_t I>
+        int64_t operator()(std::integral_constant<size_t, I>, const int value) const
+        {
+            return Measure<I>(value);
+        }
+    };
+    
+    /**
+     Argument of benchmarks: 0 - uniformly distributed random cases,
+     1 - skewed: each next case is twice less frequent than previous one, so about half of values have case 0.
+     */
+    template <size_t N>
+    std::vector<bench::WideAsEnum<N>> MakeValues(const bool skewed)
+    {
+        if (!skewed)
+        {
+            return bench::MakeWideValues<N>(ValueCount);
+        }
+        
+        std::mt19937 generator(42);
+        std::geometric_distribution<size_t> distribution(0.5);
+        
+        std::vector<bench::WideAsEnum<N>> values;
+        values.reserve(ValueCount);
+        for (size_t i = 0; i < ValueCount; i++)
+        {
+            values.push_back(bench::WideFactory<N>::create(std::min(distribution(generator), N - 1), static_cast<int>(i)));
+        }
+        
+        return values;
+    }
+    
+    template <size_t N>
+    void BM_ForEach_DoSwitch(benchmark::State& state)
+    {
+        const auto values = MakeValues<N>(state.range(0));
+        const Handler handler;
+        for (auto _ : state)
+        {
+            for (const auto& value : values)
+            {
+                bench::WideChain<N>::apply(value.doSwitch(), handler);
+            }
+            benchmark::DoNotOptimize(g_sum);
+        }
+        state.SetItemsProcessed(state.iterations() * values.size());
+    }
+    
+    /// Includes grouping of the batch on each iteration.
+    template <size_t N>
+    void BM_ForEach_Grouped(benchmark::State& state)
+    {
+        const auto values = MakeValues<N>(state.range(0));
+        const auto matcher = bench::WideMatcher<N>::make(bench::WideAsEnum<N>::template matcher<void>(), Handler());
+        asenum::CaseGroups groups;
+        for (auto _ : state)
+        {
+            groups.assign(values.data(), values.size());
+            asenum::groupedForEachCase(groups, values.data(), matcher);
+            benchmark::DoNotOptimize(g_sum);
+        }
+        state.SetItemsProcessed(state.iterations() * values.size());
+    }
+    
+    template <size_t N>
+    void BM_Map_DoMap(benchmark::State& state)
+    {
+        const auto values = MakeValues<N>(state.range(0));
+        const MapHandler handler;
+        std::vector<int64_t> output(values.size());
+        for (auto _ : state)
+        {
+            for (size_t i = 0; i < values.size(); i++)
+            {
+                output[i] = bench::WideMapChain<N>::template apply<int64_t>(values[i].template doMap<int64_t>(), handler);
+            }
+            benchmark::ClobberMemory();
+        }
+        state.SetItemsProcessed(state.iterations() * values.size());
+    }
+    
+    /// Results in original order.
+    template <size_t N>
+    void BM_Map_Grouped(benchmark::State& state)
+    {
+        const auto values = MakeValues<N>(state.range(0));
+        const auto matcher = bench::WideMatcher<N>::make(bench::WideAsEnum<N>::template matcher<int64_t>(), MapHandler());
+        std::vector<int64_t> output(values.size());
+        asenum::CaseGroups groups;
+        for (auto _ : state)
+        {
+            groups.assign(values.data(), values.size());
+            asenum::groupedMap(groups, values.data(), matcher, output.data());
+            benchmark::ClobberMemory();
+        }
+        state.SetItemsProcessed(state.iterations() * values.size());
+    }
+    
+    /// Results in grouped order: written sequentially.
+    template <size_t N>
+    void BM_Map_GroupedOrder(benchmark::State& state)
+    {
+        const auto values = MakeValues<N>(state.range(0));
+        const auto matcher = bench::WideMatcher<N>::make(bench::WideAsEnum<N>::template matcher<int64_t>(), MapHandler());
+        std::vector<int64_t> output(values.size());
+        asenum::CaseGroups groups;
+        for (auto _ : state)
+        {
+            groups.assign(values.data(), values.size());
+            asenum::groupedMap(groups, values.data(), matcher, output.data(), asenum::BatchOrder::Grouped);
+            benchmark::ClobberMemory();
+        }
+        state.SetItemsProcessed(state.iterations() * values.size());
+    }
+}
+
+BENCHMARK_TEMPLATE(BM_ForEach_DoSwitch, 4)->Arg(0)->Arg(1);
+BENCHMARK_TEMPLATE(BM_ForEach_Grouped, 4)->Arg(0)->Arg(1);
+BENCHMARK_TEMPLATE(BM_ForEach_DoSwitch, 16)->Arg(0)->Arg(1);
+BENCHMARK_TEMPLATE(BM_ForEach_Grouped, 16)->Arg(0)->Arg(1);
+BENCHMARK_TEMPLATE(BM_Map_DoMap, 4)->Arg(0)->Arg(1);
+BENCHMARK_TEMPLATE(BM_Map_Grouped, 4)->Arg(0)->Arg(1);
+BENCHMARK_TEMPLATE(BM_Map_GroupedOrder, 4)->Arg(0)->Arg(1);
+BENCHMARK_TEMPLATE(BM_Map_DoMap, 16)->Arg(0)->Arg(1);
+BENCHMARK_TEMPLATE(BM_Map_Grouped, 16)->Arg(0)->Arg(1);
+BENCHMARK_TEMPLATE(BM_Map_GroupedOrder, 16)->Arg(0)->Arg(1);
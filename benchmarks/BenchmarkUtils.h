@@ -0,0 +1,281 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Alkenso (Vladimir Vashurkin)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <asenum/asenum.h>
+#include <asenum/vector.h>
+
+#include <cstdint>
+#include <random>
+#include <utility>
+#include <vector>
+
+#if __cplusplus > 201402L
+#include <variant>
+#endif
+
+namespace bench
+{
+    /// Enum without named values: benchmarks use 'static_cast<WideEnum>(i)' as i-th case.
+    enum class WideEnum : uint16_t {};
+    
+    template <size_t I>
+    using WideCase = asenum::Case11<WideEnum, static_cast<WideEnum>(I), int>;
+    
+    template <typename Indices>
+    struct WideAsEnumMaker;
+    
+    template <size_t... I>
+    struct WideAsEnumMaker<asenum::details::IndexSequence<I...>>
+    {
+        using type = asenum::AsEnum<WideCase<I>...>;
+        using vector = asenum::AsEnumVector<WideCase<I>...>;
+    };
+    
+    /// AsEnum with 'N' cases, each of them holds 'int'.
+    template <size_t N>
+    using WideAsEnum = typename WideAsEnumMaker<typename asenum::details::MakeIndexSequence<N>::type>::type;
+    
+    /// Columnar vector of values with 'N' cases, each of them holds 'int'.
+    template <size_t N>
+    using WideAsEnumVector = typename WideAsEnumMaker<typename asenum::details::MakeIndexSequence<N>::type>::vector;
+    
+    template <size_t N, size_t I = 0>
+    struct WideFactory
+    {
+        static WideAsEnum<N> create(const size_t index, const int value)
+        {
+            return index == I ? WideAsEnum<N>::template create<static_cast<WideEnum>(I)>(value) : WideFactory<N, I + 1>::create(index, value);
+        }
+    };
+    
+    template <size_t N>
+    struct WideFactory<N, N>
+    {
+        static WideAsEnum<N> create(size_t, const int value)
+        {
+            return WideAsEnum<N>::template create<static_cast<WideEnum>(0)>(value);
+        }
+    };
+    
+    /// Random case indices in range [0, N) shared by AsEnum and std::variant values: both get the same sequence of cases.
+    template <size_t N>
+    std::vector<size_t> MakeWideCases(const size_t count)
+    {
+        std::mt19937 generator(42);
+        std::uniform_int_distribution<size_t> distribution(0, N - 1);
+        
+        std::vector<size_t> cases;
+        cases.reserve(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            cases.push_back(distribution(generator));
+        }
+        
+        return cases;
+    }
+    
+    /// Values with uniformly distributed random cases.
+    template <size_t N>
+    std::vector<WideAsEnum<N>> MakeWideValues(const size_t count)
+    {
+        const std::vector<size_t> cases = MakeWideCases<N>(count);
+        
+        std::vector<WideAsEnum<N>> values;
+        values.reserve(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            values.push_back(WideFactory<N>::create(cases[i], static_cast<int>(i)));
+        }
+        
+        return values;
+    }
+    
+    /// Values with uniformly distributed random cases and payloads in range [0, payloadCount): contain duplicates.
+    template <size_t N>
+    std::vector<WideAsEnum<N>> MakeWideKeys(const size_t count, const int payloadCount)
+    {
+        std::mt19937 generator(42);
+        std::uniform_int_distribution<size_t> caseDistribution(0, N - 1);
+        std::uniform_int_distribution<int> payloadDistribution(0, payloadCount - 1);
+        
+        std::vector<WideAsEnum<N>> values;
+        values.reserve(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            values.push_back(WideFactory<N>::create(caseDistribution(generator), payloadDistribution(generator)));
+        }
+        
+        return values;
+    }
+    
+    /// Passes index of the case to the handler as 'std::integral_constant', so each case may do distinct work.
+    template <size_t I, typename Handler>
+    struct IndexedHandler
+    {
+        auto operator()(const int value) const -> decltype(std::declval<const Handler&>()(std::integral_constant<size_t, I>(), value))
+        {
+            return handler(std::integral_constant<size_t, I>(), value);
+        }
+        
+        Handler handler;
+    };
+    
+    /// Appends 'ifCase' for every case starting from 'I' to switch/match chain. Handler is called as 'handler(std::integral_constant<size_t, caseIndex>(), value)'.
+    template <size_t N, size_t I = 0, bool IsLast = I + 1 == N>
+    struct WideChain
+    {
+        template <typename Chain, typename Handler>
+        static void apply(Chain&& chain, const Handler& handler)
+        {
+            const IndexedHandler<I, const Handler&> caseHandler = { handler };
+            WideChain<N, I + 1>::apply(std::forward<Chain>(chain).template ifCase<static_cast<WideEnum>(I)>(caseHandler), handler);
+        }
+    };
+    
+    template <size_t N, size_t I>
+    struct WideChain<N, I, true>
+    {
+        template <typename Chain, typename Handler>
+        static void apply(Chain&& chain, const Handler& handler)
+        {
+            const IndexedHandler<I, const Handler&> caseHandler = { handler };
+            std::forward<Chain>(chain).template ifCase<static_cast<WideEnum>(I)>(caseHandler);
+        }
+    };
+    
+    /// Same as 'WideChain' for 'doMap' chains: the last 'ifCase' returns mapped value.
+    template <size_t N, size_t I = 0, bool IsLast = I + 1 == N>
+    struct WideMapChain
+    {
+        template <typename T, typename Chain, typename Handler>
+        static T apply(Chain chain, const Handler& handler)
+        {
+            const IndexedHandler<I, const Handler&> caseHandler = { handler };
+            return WideMapChain<N, I + 1>::template apply<T>(chain.template ifCase<static_cast<WideEnum>(I)>(caseHandler), handler);
+        }
+    };
+    
+    template <size_t N, size_t I>
+    struct WideMapChain<N, I, true>
+    {
+        template <typename T, typename Chain, typename Handler>
+        static T apply(Chain chain, const Handler& handler)
+        {
+            const IndexedHandler<I, const Handler&> caseHandler = { handler };
+            return chain.template ifCase<static_cast<WideEnum>(I)>(caseHandler);
+        }
+    };
+    
+    /// Builds reusable matcher with handlers for every case starting from 'I'. Handler is called as 'handler(std::integral_constant<size_t, caseIndex>(), value)'.
+    template <size_t N, size_t I = 0, bool IsLast = I + 1 == N>
+    struct WideMatcher
+    {
+        template <typename Matcher, typename Handler>
+        static auto make(const Matcher& matcher, const Handler& handler)
+        -> decltype(WideMatcher<N, I + 1>::make(matcher.template ifCase<static_cast<WideEnum>(I)>(IndexedHandler<I, Handler> { handler }), handler))
+        {
+            return WideMatcher<N, I + 1>::make(matcher.template ifCase<static_cast<WideEnum>(I)>(IndexedHandler<I, Handler> { handler }), handler);
+        }
+    };
+    
+    template <size_t N, size_t I>
+    struct WideMatcher<N, I, true>
+    {
+        template <typename Matcher, typename Handler>
+        static auto make(const Matcher& matcher, const Handler& handler)
+        -> decltype(matcher.template ifCase<static_cast<WideEnum>(I)>(IndexedHandler<I, Handler> { handler }))
+        {
+            return matcher.template ifCase<static_cast<WideEnum>(I)>(IndexedHandler<I, Handler> { handler });
+        }
+    };
+    
+#if __cplusplus > 201402L
+    /// Distinct type for each alternative of 'WideVariant', so 'std::visit' handlers know the case.
+    template <size_t I>
+    struct VariantCase
+    {
+        int value;
+        
+        bool operator==(const VariantCase& other) const { return value == other.value; }
+        bool operator!=(const VariantCase& other) const { return value != other.value; }
+        bool operator<(const VariantCase& other) const { return value < other.value; }
+        bool operator<=(const VariantCase& other) const { return value <= other.value; }
+        bool operator>(const VariantCase& other) const { return value > other.value; }
+        bool operator>=(const VariantCase& other) const { return value >= other.value; }
+    };
+    
+    template <typename Indices>
+    struct WideVariantMaker;
+    
+    template <size_t... I>
+    struct WideVariantMaker<asenum::details::IndexSequence<I...>>
+    {
+        using type = std::variant<VariantCase<I>...>;
+        
+        static type create(const size_t index, const int value)
+        {
+            using Factory = type (*)(int);
+            static constexpr Factory s_factories[] = { [] (const int caseValue) { return type(std::in_place_index<I>, VariantCase<I> { caseValue }); }... };
+            
+            return s_factories[index](value);
+        }
+    };
+    
+    /// std::variant with 'N' alternatives: baseline for 'WideAsEnum<N>'.
+    template <size_t N>
+    using WideVariant = typename WideVariantMaker<typename asenum::details::MakeIndexSequence<N>::type>::type;
+    
+    /// Same values as 'MakeWideValues' stored in std::variant.
+    template <size_t N>
+    std::vector<WideVariant<N>> MakeWideVariants(const size_t count)
+    {
+        using Maker = WideVariantMaker<typename asenum::details::MakeIndexSequence<N>::type>;
+        const std::vector<size_t> cases = MakeWideCases<N>(count);
+        
+        std::vector<WideVariant<N>> values;
+        values.reserve(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            values.push_back(Maker::create(cases[i], static_cast<int>(i)));
+        }
+        
+        return values;
+    }
+    
+    /// Visitor of 'WideVariant' that calls handler the same way as 'IndexedHandler'.
+    template <typename Handler>
+    struct VariantHandler
+    {
+        template <size_t I>
+        auto operator()(const VariantCase<I>& value) const
+        {
+            return handler(std::integral_constant<size_t, I>(), value.value);
+        }
+        
+        Handler handler;
+    };
+#endif
+}
@@ -0,0 +1,151 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Alkenso (Vladimir Vashurkin)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <asenum/flat_hash.h>
+#include "BenchmarkUtils.h"
+
+#include <asenum/codec.h>
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <vector>
+
+namespace
+{
+    constexpr size_t ValueCount = 4096;
+    
+    enum class RecordType
+    {
+        Id,
+        Point,
+        Text,
+        Empty
+    };
+    
+    struct Point3
+    {
+        double x;
+        double y;
+        double z;
+    };
+    
+    using Record = asenum::AsEnum<
+    asenum::Case11<RecordType, RecordType::Id, uint64_t>,
+    asenum::Case11<RecordType, RecordType::Point, Point3>,
+    asenum::Case11<RecordType, RecordType::Text, std::string>,
+    asenum::Case11<RecordType, RecordType::Empty, void>
+    >;
+    
+    std::vector<Record> MakeRecords()
+    {
+        std::vector<Record> records;
+        records.reserve(ValueCount);
+        for (size_t i = 0; i < ValueCount; i++)
+        {
+            switch (i % 4)
+            {
+                case 0: records.push_back(Record::create<RecordType::Id>(i)); break;
+                case 1: records.push_back(Record::create<RecordType::Point>(Point3 { 1.0 * i, 2.0 * i, 3.0 * i })); break;
+                case 2: records.push_back(Record::create<RecordType::Text>(std::string(8 + i % 32, 'x'))); break;
+                default: records.push_back(Record::create<RecordType::Empty>()); break;
+            }
+        }
+        
+        return records;
+    }
+    
+    template <typename ConcreteAsEnum>
+    std::vector<uint8_t> Encode(const std::vector<ConcreteAsEnum>& values)
+    {
+        std::vector<uint8_t> buffer;
+        asenum::BinaryWriter writer(buffer);
+        for (const auto& value : values)
+        {
+            writer.write(value);
+        }
+        
+        return buffer;
+    }
+    
+    template <typename ConcreteAsEnum>
+    void EncodeBenchmark(benchmark::State& state, const std::vector<ConcreteAsEnum>& values)
+    {
+        std::vector<uint8_t> buffer;
+        buffer.reserve(Encode(values).size());
+        for (auto _ : state)
+        {
+            buffer.clear();
+            asenum::BinaryWriter writer(buffer);
+            for (const auto& value : values)
+            {
+                writer.write(value);
+            }
+            benchmark::DoNotOptimize(buffer.data());
+        }
+        state.SetBytesProcessed(state.iterations() * buffer.size());
+    }
+    
+    template <typename ConcreteAsEnum>
+    void DecodeBenchmark(benchmark::State& state, const std::vector<ConcreteAsEnum>& values)
+    {
+        const std::vector<uint8_t> buffer = Encode(values);
+        for (auto _ : state)
+        {
+            asenum::BinaryReader reader(buffer.data(), buffer.size());
+            while (!reader.atEnd())
+            {
+                const auto value = reader.read<ConcreteAsEnum>();
+                benchmark::DoNotOptimize(value);
+            }
+        }
+        state.SetBytesProcessed(state.iterations() * buffer.size());
+    }
+    
+    /// Trivially copyable payloads only.
+    void BM_Encode_Int(benchmark::State& state)
+    {
+        EncodeBenchmark(state, bench::MakeWideValues<8>(ValueCount));
+    }
+    
+    void BM_Decode_Int(benchmark::State& state)
+    {
+        DecodeBenchmark(state, bench::MakeWideValues<8>(ValueCount));
+    }
+    
+    /// Integer, 24-byte struct (heap-allocated by AsEnum), string and 'void' cases.
+    void BM_Encode_Mixed(benchmark::State& state)
+    {
+        EncodeBenchmark(state, MakeRecords());
+    }
+    
+    void BM_Decode_Mixed(benchmark::State& state)
+    {
+        DecodeBenchmark(state, MakeRecords());
+    }
+}
+
+BENCHMARK(BM_Encode_Int);
+BENCHMARK(BM_Decode_Int);
+BENCHMARK(BM_Encode_Mixed);
+BENCHMARK(BM_Decode_Mixed);
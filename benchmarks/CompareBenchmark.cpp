@@ -0,0 +1,123 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Alkenso (Vladimir Vashurkin)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "BenchmarkUtils.h"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <functional>
+
+#if __cplusplus > 201402L
+#include <variant>
+#endif
+
+namespace
+{
+    constexpr size_t ValueCount = 4096;
+    
+    template <typename Values>
+    void Sort(benchmark::State& state, const Values& values)
+    {
+        for (auto _ : state)
+        {
+            auto sorted = values;
+            std::sort(sorted.begin(), sorted.end());
+            benchmark::DoNotOptimize(sorted.data());
+        }
+        state.SetItemsProcessed(state.iterations() * values.size());
+    }
+    
+    /// Applies comparison to neighbouring values.
+    template <template <typename> class Operator, typename Values>
+    void Compare(benchmark::State& state, const Values& values)
+    {
+        const Operator<typename Values::value_type> compare;
+        
+        for (auto _ : state)
+        {
+            size_t matches = 0;
+            for (size_t i = 1; i < values.size(); i++)
+            {
+                matches += compare(values[i - 1], values[i]);
+            }
+            benchmark::DoNotOptimize(matches);
+        }
+        state.SetItemsProcessed(state.iterations() * values.size());
+    }
+    
+    template <size_t N>
+    void BM_Sort(benchmark::State& state)
+    {
+        Sort(state, bench::MakeWideValues<N>(ValueCount));
+    }
+    
+    template <size_t N, template <typename> class Operator>
+    void BM_Compare(benchmark::State& state)
+    {
+        Compare<Operator>(state, bench::MakeWideValues<N>(ValueCount));
+    }
+    
+#if __cplusplus > 201402L
+    template <size_t N>
+    void BM_Sort_Variant(benchmark::State& state)
+    {
+        Sort(state, bench::MakeWideVariants<N>(ValueCount));
+    }
+    
+    template <size_t N, template <typename> class Operator>
+    void BM_Compare_Variant(benchmark::State& state)
+    {
+        Compare<Operator>(state, bench::MakeWideVariants<N>(ValueCount));
+    }
+#endif
+}
+
+#define ASENUM_COMPARE_BENCHMARKS(N) \
+BENCHMARK_TEMPLATE(BM_Sort, N); \
+BENCHMARK_TEMPLATE2(BM_Compare, N, std::equal_to); \
+BENCHMARK_TEMPLATE2(BM_Compare, N, std::not_equal_to); \
+BENCHMARK_TEMPLATE2(BM_Compare, N, std::less); \
+BENCHMARK_TEMPLATE2(BM_Compare, N, std::less_equal); \
+BENCHMARK_TEMPLATE2(BM_Compare, N, std::greater); \
+BENCHMARK_TEMPLATE2(BM_Compare, N, std::greater_equal)
+
+ASENUM_COMPARE_BENCHMARKS(3);
+ASENUM_COMPARE_BENCHMARKS(16);
+ASENUM_COMPARE_BENCHMARKS(64);
+
+#if __cplusplus > 201402L
+#define ASENUM_COMPARE_VARIANT_BENCHMARKS(N) \
+BENCHMARK_TEMPLATE(BM_Sort_Variant, N); \
+BENCHMARK_TEMPLATE2(BM_Compare_Variant, N, std::equal_to); \
+BENCHMARK_TEMPLATE2(BM_Compare_Variant, N, std::not_equal_to); \
+BENCHMARK_TEMPLATE2(BM_Compare_Variant, N, std::less); \
+BENCHMARK_TEMPLATE2(BM_Compare_Variant, N, std::less_equal); \
+BENCHMARK_TEMPLATE2(BM_Compare_Variant, N, std::greater); \
+BENCHMARK_TEMPLATE2(BM_Compare_Variant, N, std::greater_equal)
+
+ASENUM_COMPARE_VARIANT_BENCHMARKS(3);
+ASENUM_COMPARE_VARIANT_BENCHMARKS(16);
+ASENUM_COMPARE_VARIANT_BENCHMARKS(64);
+#endif
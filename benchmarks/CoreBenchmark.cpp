@@ -0,0 +1,274 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Alkenso (Vladimir Vashurkin)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "BenchmarkUtils.h"
+
+#include <benchmark/benchmark.h>
+
+#if __cplusplus > 201402L
+#include <variant>
+#endif
+
+namespace
+{
+    constexpr size_t ValueCount = 4096;
+    
+    enum class ShapeType
+    {
+        Id,
+        Box
+    };
+    
+    /// Bigger than default inline storage: allocated on the heap by AsEnum.
+    struct Box
+    {
+        double bounds[4];
+    };
+    
+    using Shape = asenum::AsEnum<
+    asenum::Case11<ShapeType, ShapeType::Id, int>,
+    asenum::Case11<ShapeType, ShapeType::Box, Box>
+    >;
+    
+    constexpr bench::WideEnum FirstCase = static_cast<bench::WideEnum>(0);
+    
+    void BM_CreateDestroy_Inline(benchmark::State& state)
+    {
+        int value = 0;
+        for (auto _ : state)
+        {
+            const Shape shape = Shape::create<ShapeType::Id>(value++);
+            benchmark::DoNotOptimize(shape);
+        }
+    }
+    
+    void BM_CreateDestroy_Heap(benchmark::State& state)
+    {
+        double value = 0;
+        for (auto _ : state)
+        {
+            const Shape shape = Shape::create<ShapeType::Box>(Box { { value++, 0, 1, 1 } });
+            benchmark::DoNotOptimize(shape);
+        }
+    }
+    
+    /// Copies and destroys all values.
+    template <size_t N>
+    void BM_Copy(benchmark::State& state)
+    {
+        const auto values = bench::MakeWideValues<N>(ValueCount);
+        for (auto _ : state)
+        {
+            auto copy = values;
+            benchmark::DoNotOptimize(copy.data());
+        }
+        state.SetItemsProcessed(state.iterations() * values.size());
+    }
+    
+    void BM_Copy_Heap(benchmark::State& state)
+    {
+        const std::vector<Shape> values(ValueCount, Shape::create<ShapeType::Box>(Box { { 0, 0, 1, 1 } }));
+        for (auto _ : state)
+        {
+            auto copy = values;
+            benchmark::DoNotOptimize(copy.data());
+        }
+        state.SetItemsProcessed(state.iterations() * values.size());
+    }
+    
+    template <size_t N>
+    void BM_IsCase(benchmark::State& state)
+    {
+        const auto values = bench::MakeWideValues<N>(ValueCount);
+        for (auto _ : state)
+        {
+            size_t count = 0;
+            for (const auto& value : values)
+            {
+                count += value.template isCase<FirstCase>();
+            }
+            benchmark::DoNotOptimize(count);
+        }
+        state.SetItemsProcessed(state.iterations() * values.size());
+    }
+    
+    template <size_t N>
+    void BM_IfCase(benchmark::State& state)
+    {
+        const auto values = bench::MakeWideValues<N>(ValueCount);
+        for (auto _ : state)
+        {
+            int64_t sum = 0;
+            for (const auto& value : values)
+            {
+                value.template ifCase<FirstCase>([&sum] (const int payload) {
+                    sum += payload;
+                });
+            }
+            benchmark::DoNotOptimize(sum);
+        }
+        state.SetItemsProcessed(state.iterations() * values.size());
+    }
+    
+    /// Threads copy values sharing the same heap payloads: measures contention on shared reference counters.
+    void BM_CopyShared_Threads(benchmark::State& state)
+    {
+        static const std::vector<Shape> s_values(ValueCount, Shape::create<ShapeType::Box>(Box { { 0, 0, 1, 1 } }));
+        for (auto _ : state)
+        {
+            for (const Shape& value : s_values)
+            {
+                const Shape copy = value;
+                benchmark::DoNotOptimize(copy);
+            }
+        }
+        state.SetItemsProcessed(state.iterations() * s_values.size());
+    }
+    
+#if __cplusplus > 201402L
+    using ShapeVariant = std::variant<int, Box>;
+    
+    void BM_CreateDestroy_Inline_Variant(benchmark::State& state)
+    {
+        int value = 0;
+        for (auto _ : state)
+        {
+            const ShapeVariant shape(std::in_place_index<0>, value++);
+            benchmark::DoNotOptimize(shape);
+        }
+    }
+    
+    void BM_CreateDestroy_Heap_Variant(benchmark::State& state)
+    {
+        double value = 0;
+        for (auto _ : state)
+        {
+            const ShapeVariant shape(std::in_place_index<1>, Box { { value++, 0, 1, 1 } });
+            benchmark::DoNotOptimize(shape);
+        }
+    }
+    
+    template <size_t N>
+    void BM_Copy_Variant(benchmark::State& state)
+    {
+        const auto values = bench::MakeWideVariants<N>(ValueCount);
+        for (auto _ : state)
+        {
+            auto copy = values;
+            benchmark::DoNotOptimize(copy.data());
+        }
+        state.SetItemsProcessed(state.iterations() * values.size());
+    }
+    
+    void BM_Copy_Heap_Variant(benchmark::State& state)
+    {
+        const std::vector<ShapeVariant> values(ValueCount, ShapeVariant(std::in_place_index<1>, Box { { 0, 0, 1, 1 } }));
+        for (auto _ : state)
+        {
+            auto copy = values;
+            benchmark::DoNotOptimize(copy.data());
+        }
+        state.SetItemsProcessed(state.iterations() * values.size());
+    }
+    
+    template <size_t N>
+    void BM_IsCase_Variant(benchmark::State& state)
+    {
+        const auto values = bench::MakeWideVariants<N>(ValueCount);
+        for (auto _ : state)
+        {
+            size_t count = 0;
+            for (const auto& value : values)
+            {
+                count += value.index() == 0;
+            }
+            benchmark::DoNotOptimize(count);
+        }
+        state.SetItemsProcessed(state.iterations() * values.size());
+    }
+    
+    template <size_t N>
+    void BM_IfCase_Variant(benchmark::State& state)
+    {
+        const auto values = bench::MakeWideVariants<N>(ValueCount);
+        for (auto _ : state)
+        {
+            int64_t sum = 0;
+            for (const auto& value : values)
+            {
+                if (const auto* payload = std::get_if<0>(&value))
+                {
+                    sum += payload->value;
+                }
+            }
+            benchmark::DoNotOptimize(sum);
+        }
+        state.SetItemsProcessed(state.iterations() * values.size());
+    }
+    
+    void BM_CopyShared_Threads_Variant(benchmark::State& state)
+    {
+        static const std::vector<ShapeVariant> s_values(ValueCount, ShapeVariant(std::in_place_index<1>, Box { { 0, 0, 1, 1 } }));
+        for (auto _ : state)
+        {
+            for (const ShapeVariant& value : s_values)
+            {
+                const ShapeVariant copy = value;
+                benchmark::DoNotOptimize(copy);
+            }
+        }
+        state.SetItemsProcessed(state.iterations() * s_values.size());
+    }
+#endif
+}
+
+BENCHMARK(BM_CreateDestroy_Inline);
+BENCHMARK(BM_CreateDestroy_Heap);
+BENCHMARK(BM_Copy_Heap);
+BENCHMARK(BM_CopyShared_Threads)->Threads(1)->Threads(2)->Threads(4)->Threads(8)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_Copy, 3);
+BENCHMARK_TEMPLATE(BM_Copy, 16);
+BENCHMARK_TEMPLATE(BM_Copy, 64);
+BENCHMARK_TEMPLATE(BM_IsCase, 3);
+BENCHMARK_TEMPLATE(BM_IsCase, 16);
+BENCHMARK_TEMPLATE(BM_IsCase, 64);
+BENCHMARK_TEMPLATE(BM_IfCase, 3);
+BENCHMARK_TEMPLATE(BM_IfCase, 16);
+BENCHMARK_TEMPLATE(BM_IfCase, 64);
+
+#if __cplusplus > 201402L
+BENCHMARK(BM_CreateDestroy_Inline_Variant);
+BENCHMARK(BM_CreateDestroy_Heap_Variant);
+BENCHMARK(BM_Copy_Heap_Variant);
+BENCHMARK(BM_CopyShared_Threads_Variant)->Threads(1)->Threads(2)->Threads(4)->Threads(8)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_Copy_Variant, 3);
+BENCHMARK_TEMPLATE(BM_Copy_Variant, 16);
+BENCHMARK_TEMPLATE(BM_Copy_Variant, 64);
+BENCHMARK_TEMPLATE(BM_IsCase_Variant, 3);
+BENCHMARK_TEMPLATE(BM_IsCase_Variant, 16);
+BENCHMARK_TEMPLATE(BM_IsCase_Variant, 64);
+BENCHMARK_TEMPLATE(BM_IfCase_Variant, 3);
+BENCHMARK_TEMPLATE(BM_IfCase_Variant, 16);
+BENCHMARK_TEMPLATE(BM_IfCase_Variant, 64);
+#endif
@@ -0,0 +1,142 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Alkenso (Vladimir Vashurkin)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "BenchmarkUtils.h"
+
+#include <benchmark/benchmark.h>
+
+#if __cplusplus > 201402L
+#include <variant>
+#endif
+
+namespace
+{
+    constexpr size_t ValueCount = 4096;
+    
+    int64_t g_sum = 0;
+    
+    /// Distinct non-inlined function per case: prevents compiler from merging handlers into branchless code.
+    template <size_t I>
+    __attribute__((noinline)) void Consume(const int value)
+    {
+        g_sum += value + static_cast<int64_t>(I);
+    }
+    
+    struct Handler
+    {
+        template <size_t I>
+        void operator()(std::integral_constant<size_t, I>, const int value) const
+        {
+            Consume<I>(value);
+        }
+    };
+    
+    template <size_t N>
+    void BM_DoSwitch(benchmark::State& state)
+    {
+        const auto values = bench::MakeWideValues<N>(ValueCount);
+        const Handler handler;
+        
+        for (auto _ : state)
+        {
+            for (const auto& value : values)
+            {
+                bench::WideChain<N>::apply(value.doSwitch(), handler);
+            }
+            benchmark::DoNotOptimize(g_sum);
+        }
+        state.SetItemsProcessed(state.iterations() * values.size());
+    }
+    
+    template <size_t N>
+    void BM_Match(benchmark::State& state)
+    {
+        const auto values = bench::MakeWideValues<N>(ValueCount);
+        const Handler handler;
+        
+        for (auto _ : state)
+        {
+            for (const auto& value : values)
+            {
+                bench::WideChain<N>::apply(value.match(), handler);
+            }
+            benchmark::DoNotOptimize(g_sum);
+        }
+        state.SetItemsProcessed(state.iterations() * values.size());
+    }
+    
+    template <size_t N>
+    void BM_Matcher(benchmark::State& state)
+    {
+        const auto values = bench::MakeWideValues<N>(ValueCount);
+        const Handler handler;
+        const auto matcher = bench::WideMatcher<N>::make(bench::WideAsEnum<N>::matcher(), handler);
+        
+        for (auto _ : state)
+        {
+            for (const auto& value : values)
+            {
+                matcher(value);
+            }
+            benchmark::DoNotOptimize(g_sum);
+        }
+        state.SetItemsProcessed(state.iterations() * values.size());
+    }
+    
+#if __cplusplus > 201402L
+    /// Baseline: std::visit over std::variant with the same cases and handlers.
+    template <size_t N>
+    void BM_Visit_Variant(benchmark::State& state)
+    {
+        const auto values = bench::MakeWideVariants<N>(ValueCount);
+        const bench::VariantHandler<Handler> handler = { Handler() };
+        
+        for (auto _ : state)
+        {
+            for (const auto& value : values)
+            {
+                std::visit(handler, value);
+            }
+            benchmark::DoNotOptimize(g_sum);
+        }
+        state.SetItemsProcessed(state.iterations() * values.size());
+    }
+#endif
+}
+
+BENCHMARK_TEMPLATE(BM_DoSwitch, 3);
+BENCHMARK_TEMPLATE(BM_Match, 3);
+BENCHMARK_TEMPLATE(BM_Matcher, 3);
+BENCHMARK_TEMPLATE(BM_DoSwitch, 16);
+BENCHMARK_TEMPLATE(BM_Match, 16);
+BENCHMARK_TEMPLATE(BM_Matcher, 16);
+BENCHMARK_TEMPLATE(BM_DoSwitch, 64);
+BENCHMARK_TEMPLATE(BM_Match, 64);
+BENCHMARK_TEMPLATE(BM_Matcher, 64);
+
+#if __cplusplus > 201402L
+BENCHMARK_TEMPLATE(BM_Visit_Variant, 3);
+BENCHMARK_TEMPLATE(BM_Visit_Variant, 16);
+BENCHMARK_TEMPLATE(BM_Visit_Variant, 64);
+#endif
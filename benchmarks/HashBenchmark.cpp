@@ -0,0 +1,139 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Alkenso (Vladimir Vashurkin)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "BenchmarkUtils.h"
+
+#include <asenum/flat_hash.h>
+
+#include <benchmark/benchmark.h>
+
+#include <unordered_map>
+#include <unordered_set>
+
+namespace
+{
+    constexpr size_t KeyCount = 4096;
+    constexpr int PayloadCount = 256;
+    
+    struct CaseValueHash
+    {
+        template <size_t I>
+        size_t operator()(std::integral_constant<size_t, I>, const int value) const
+        {
+            return I * 31 + std::hash<int>()(value);
+        }
+    };
+    
+    /// Hasher the way it is written by hand without built-in support: visit the value and combine case with payload hash.
+    template <size_t N>
+    struct UserHasher
+    {
+        size_t operator()(const bench::WideAsEnum<N>& value) const
+        {
+            static const auto s_matcher = bench::WideMatcher<N>::make(bench::WideAsEnum<N>::template matcher<size_t>(), CaseValueHash());
+            return s_matcher(value);
+        }
+    };
+    
+    template <typename Set>
+    void Dedup(benchmark::State& state, const std::vector<typename Set::key_type>& keys)
+    {
+        for (auto _ : state)
+        {
+            Set set;
+            for (const auto& key : keys)
+            {
+                set.insert(key);
+            }
+            benchmark::DoNotOptimize(set.size());
+        }
+        state.SetItemsProcessed(state.iterations() * keys.size());
+    }
+    
+    template <typename Map, typename Key>
+    void Aggregate(benchmark::State& state, const std::vector<Key>& keys)
+    {
+        for (auto _ : state)
+        {
+            Map counters;
+            for (const auto& key : keys)
+            {
+                counters[key]++;
+            }
+            benchmark::DoNotOptimize(counters.size());
+        }
+        state.SetItemsProcessed(state.iterations() * keys.size());
+    }
+    
+    template <size_t N>
+    void BM_Dedup_UnorderedSet_UserHasher(benchmark::State& state)
+    {
+        Dedup<std::unordered_set<bench::WideAsEnum<N>, UserHasher<N>>>(state, bench::MakeWideKeys<N>(KeyCount, PayloadCount));
+    }
+    
+    template <size_t N>
+    void BM_Dedup_UnorderedSet_StdHash(benchmark::State& state)
+    {
+        Dedup<std::unordered_set<bench::WideAsEnum<N>>>(state, bench::MakeWideKeys<N>(KeyCount, PayloadCount));
+    }
+    
+    template <size_t N>
+    void BM_Dedup_FlatHashSet(benchmark::State& state)
+    {
+        const auto keys = bench::MakeWideKeys<N>(KeyCount, PayloadCount);
+        for (auto _ : state)
+        {
+            asenum::FlatHashSet<bench::WideAsEnum<N>> set;
+            for (const auto& key : keys)
+            {
+                set.insert(key);
+            }
+            benchmark::DoNotOptimize(set.size());
+        }
+        state.SetItemsProcessed(state.iterations() * keys.size());
+    }
+    
+    template <size_t N>
+    void BM_Aggregate_UnorderedMap_UserHasher(benchmark::State& state)
+    {
+        Aggregate<std::unordered_map<bench::WideAsEnum<N>, int, UserHasher<N>>>(state, bench::MakeWideKeys<N>(KeyCount, PayloadCount));
+    }
+    
+    template <size_t N>
+    void BM_Aggregate_FlatHashMap(benchmark::State& state)
+    {
+        Aggregate<asenum::FlatHashMap<bench::WideAsEnum<N>, int>>(state, bench::MakeWideKeys<N>(KeyCount, PayloadCount));
+    }
+}
+
+BENCHMARK_TEMPLATE(BM_Dedup_UnorderedSet_UserHasher, 3);
+BENCHMARK_TEMPLATE(BM_Dedup_UnorderedSet_StdHash, 3);
+BENCHMARK_TEMPLATE(BM_Dedup_FlatHashSet, 3);
+BENCHMARK_TEMPLATE(BM_Dedup_UnorderedSet_UserHasher, 40);
+BENCHMARK_TEMPLATE(BM_Dedup_UnorderedSet_StdHash, 40);
+BENCHMARK_TEMPLATE(BM_Dedup_FlatHashSet, 40);
+BENCHMARK_TEMPLATE(BM_Aggregate_UnorderedMap_UserHasher, 3);
+BENCHMARK_TEMPLATE(BM_Aggregate_FlatHashMap, 3);
+BENCHMARK_TEMPLATE(BM_Aggregate_UnorderedMap_UserHasher, 40);
+BENCHMARK_TEMPLATE(BM_Aggregate_FlatHashMap, 40);
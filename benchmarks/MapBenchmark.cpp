@@ -0,0 +1,129 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Alkenso (Vladimir Vashurkin)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "BenchmarkUtils.h"
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+
+#if __cplusplus > 201402L
+#include <variant>
+#endif
+
+namespace
+{
+    constexpr size_t ValueCount = 4096;
+    
+    template <typename T>
+    struct Label
+    {
+        T operator()(const int value) const { return T(value > 0 ? "positive" : "non-positive"); }
+    };
+    
+    template <>
+    struct Label<int>
+    {
+        int operator()(const int value) const { return value; }
+    };
+    
+    template <typename T>
+    void BM_DoMap(benchmark::State& state)
+    {
+        const auto values = bench::MakeWideValues<3>(ValueCount);
+        const Label<T> label;
+        
+        for (auto _ : state)
+        {
+            for (const auto& value : values)
+            {
+                T result = value.template doMap<T>()
+                .template ifCase<static_cast<bench::WideEnum>(0)>(label)
+                .template ifCase<static_cast<bench::WideEnum>(1)>(label)
+                .template ifCase<static_cast<bench::WideEnum>(2)>(label);
+                benchmark::DoNotOptimize(result);
+            }
+        }
+        state.SetItemsProcessed(state.iterations() * values.size());
+    }
+    
+    /// Distinct result for each case.
+    struct CaseLabel
+    {
+        template <size_t I>
+        int operator()(std::integral_constant<size_t, I>, const int value) const
+        {
+            return value * static_cast<int>(I + 1);
+        }
+    };
+    
+    template <size_t N>
+    void BM_DoMap_Cases(benchmark::State& state)
+    {
+        const auto values = bench::MakeWideValues<N>(ValueCount);
+        const CaseLabel label;
+        
+        for (auto _ : state)
+        {
+            for (const auto& value : values)
+            {
+                const int result = bench::WideMapChain<N>::template apply<int>(value.template doMap<int>(), label);
+                benchmark::DoNotOptimize(result);
+            }
+        }
+        state.SetItemsProcessed(state.iterations() * values.size());
+    }
+    
+#if __cplusplus > 201402L
+    /// Baseline: std::visit returning value.
+    template <size_t N>
+    void BM_DoMap_Cases_Variant(benchmark::State& state)
+    {
+        const auto values = bench::MakeWideVariants<N>(ValueCount);
+        const bench::VariantHandler<CaseLabel> label = { CaseLabel() };
+        
+        for (auto _ : state)
+        {
+            for (const auto& value : values)
+            {
+                const int result = std::visit(label, value);
+                benchmark::DoNotOptimize(result);
+            }
+        }
+        state.SetItemsProcessed(state.iterations() * values.size());
+    }
+#endif
+}
+
+BENCHMARK_TEMPLATE(BM_DoMap, int);
+BENCHMARK_TEMPLATE(BM_DoMap, std::string);
+BENCHMARK_TEMPLATE(BM_DoMap_Cases, 3);
+BENCHMARK_TEMPLATE(BM_DoMap_Cases, 16);
+BENCHMARK_TEMPLATE(BM_DoMap_Cases, 64);
+
+#if __cplusplus > 201402L
+BENCHMARK_TEMPLATE(BM_DoMap_Cases_Variant, 3);
+BENCHMARK_TEMPLATE(BM_DoMap_Cases_Variant, 16);
+BENCHMARK_TEMPLATE(BM_DoMap_Cases_Variant, 64);
+#endif
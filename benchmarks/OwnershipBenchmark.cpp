@@ -0,0 +1,132 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Alkenso (Vladimir Vashurkin)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <asenum/asenum.h>
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    constexpr size_t ValueCount = 4096;
+    
+    enum class Message
+    {
+        Text,
+        Code
+    };
+    
+    template <template <typename...> class AsEnumT>
+    using MessageAsEnum = AsEnumT<
+    asenum::Case11<Message, Message::Text, std::string>,
+    asenum::Case11<Message, Message::Code, int>
+    >;
+    
+    using SharedMessage = MessageAsEnum<asenum::AsEnum>;
+    using LocalMessage = MessageAsEnum<asenum::LocalAsEnum>;
+    using DeepCopyMessage = MessageAsEnum<asenum::DeepCopyAsEnum>;
+    
+    /// libstdc++ uses non-atomic reference counting until the process starts its first thread: make it multithreaded as real services are.
+    const bool s_multithreaded = [] {
+        std::thread([] {}).join();
+        return true;
+    }();
+    
+    /// Every value holds heap payload: copies share or copy it depending on ownership policy.
+    template <typename ConcreteAsEnum>
+    std::vector<ConcreteAsEnum> MakeMessages()
+    {
+        std::vector<ConcreteAsEnum> messages;
+        messages.reserve(ValueCount);
+        for (size_t i = 0; i < ValueCount; i++)
+        {
+            messages.push_back(ConcreteAsEnum::template create<Message::Text>("message text that does not fit SSO #" + std::to_string(i)));
+        }
+        
+        return messages;
+    }
+    
+    /// Copies each value into local variable that is destroyed right away: value passed along pipeline stages.
+    template <typename ConcreteAsEnum>
+    void BM_CopyDestroy(benchmark::State& state)
+    {
+        const std::vector<ConcreteAsEnum> messages = MakeMessages<ConcreteAsEnum>();
+        for (auto _ : state)
+        {
+            for (const ConcreteAsEnum& message : messages)
+            {
+                ConcreteAsEnum copy = message;
+                benchmark::DoNotOptimize(copy);
+            }
+        }
+        state.SetItemsProcessed(state.iterations() * messages.size());
+    }
+    
+    template <typename ConcreteAsEnum>
+    void BM_Copy(benchmark::State& state)
+    {
+        const std::vector<ConcreteAsEnum> messages = MakeMessages<ConcreteAsEnum>();
+        for (auto _ : state)
+        {
+            std::vector<ConcreteAsEnum> copies(messages);
+            benchmark::DoNotOptimize(copies.data());
+            
+            state.PauseTiming();
+            copies.clear();
+            state.ResumeTiming();
+        }
+        state.SetItemsProcessed(state.iterations() * messages.size());
+    }
+    
+    template <typename ConcreteAsEnum>
+    void BM_Destroy(benchmark::State& state)
+    {
+        const std::vector<ConcreteAsEnum> messages = MakeMessages<ConcreteAsEnum>();
+        for (auto _ : state)
+        {
+            state.PauseTiming();
+            std::vector<ConcreteAsEnum> copies(messages);
+            state.ResumeTiming();
+            
+            copies.clear();
+            benchmark::DoNotOptimize(copies.data());
+        }
+        state.SetItemsProcessed(state.iterations() * messages.size());
+    }
+}
+
+BENCHMARK_TEMPLATE(BM_CopyDestroy, SharedMessage);
+BENCHMARK_TEMPLATE(BM_CopyDestroy, LocalMessage);
+BENCHMARK_TEMPLATE(BM_CopyDestroy, DeepCopyMessage);
+
+BENCHMARK_TEMPLATE(BM_Copy, SharedMessage);
+BENCHMARK_TEMPLATE(BM_Copy, LocalMessage);
+BENCHMARK_TEMPLATE(BM_Copy, DeepCopyMessage);
+
+BENCHMARK_TEMPLATE(BM_Destroy, SharedMessage);
+BENCHMARK_TEMPLATE(BM_Destroy, LocalMessage);
+BENCHMARK_TEMPLATE(BM_Destroy, DeepCopyMessage);
@@ -0,0 +1,93 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Alkenso (Vladimir Vashurkin)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <asenum/flat_hash.h>
+#include "BenchmarkUtils.h"
+
+#include <asenum/parallel.h>
+
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+namespace
+{
+    constexpr size_t ValueCount = 1 << 20;
+    constexpr size_t CaseCount = 8;
+    
+    /// Few dozens of cycles of work per value, distinct for each case.
+    struct HashPayload
+    {
+        template <size_t I>
+        uint64_t operator()(std::integral_constant<size_t, I>, const int value) const
+        {
+            uint64_t hash = static_cast<uint64_t>(value) + I;
+            for (int round = 0; round < 4; round++)
+            {
+                hash ^= hash >> 33;
+                hash *= 0xff51afd7ed558ccdULL;
+            }
+            return hash;
+        }
+    };
+    
+    const std::vector<bench::WideAsEnum<CaseCount>>& Values()
+    {
+        static const auto s_values = bench::MakeWideValues<CaseCount>(ValueCount);
+        return s_values;
+    }
+    
+    void BM_Map_Serial(benchmark::State& state)
+    {
+        const auto& values = Values();
+        const auto matcher = bench::WideMatcher<CaseCount>::make(bench::WideAsEnum<CaseCount>::matcher<uint64_t>(), HashPayload());
+        std::vector<uint64_t> output(values.size());
+        for (auto _ : state)
+        {
+            for (size_t i = 0; i < values.size(); i++)
+            {
+                output[i] = matcher(values[i]);
+            }
+            benchmark::ClobberMemory();
+        }
+        state.SetItemsProcessed(state.iterations() * values.size());
+    }
+    
+    /// Argument: number of threads.
+    void BM_Map_Parallel(benchmark::State& state)
+    {
+        const auto& values = Values();
+        const auto matcher = bench::WideMatcher<CaseCount>::make(bench::WideAsEnum<CaseCount>::matcher<uint64_t>(), HashPayload());
+        std::vector<uint64_t> output(values.size());
+        asenum::ThreadPool pool(static_cast<size_t>(state.range(0)));
+        for (auto _ : state)
+        {
+            asenum::parallelMap(pool, values.data(), values.size(), matcher, output.data());
+            benchmark::ClobberMemory();
+        }
+        state.SetItemsProcessed(state.iterations() * values.size());
+    }
+}
+
+BENCHMARK(BM_Map_Serial)->UseRealTime();
+BENCHMARK(BM_Map_Parallel)->RangeMultiplier(2)->Range(1, 64)->UseRealTime();
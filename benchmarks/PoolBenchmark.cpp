@@ -0,0 +1,164 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Alkenso (Vladimir Vashurkin)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <asenum/pool.h>
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <vector>
+
+#if defined(__linux__)
+#include <unistd.h>
+#endif
+
+namespace
+{
+    constexpr size_t LiveValues = 1024;
+    constexpr size_t SampleBatch = 64;
+    constexpr size_t HistogramSize = 4096;
+    
+    enum class Event
+    {
+        Small,
+        Large,
+        Empty
+    };
+    
+    template <template <typename...> class Enum>
+    using EventAsEnum = Enum<
+    asenum::Case11<Event, Event::Small, std::array<uint64_t, 4>>,
+    asenum::Case11<Event, Event::Large, std::array<uint64_t, 16>>,
+    asenum::Case11<Event, Event::Empty, void>
+    >;
+    
+#if defined(__linux__)
+    constexpr bool HasResidentSize = true;
+    
+    double ResidentMegabytes()
+    {
+        std::ifstream statm("/proc/self/statm");
+        size_t total = 0;
+        size_t resident = 0;
+        statm >> total >> resident;
+        
+        return static_cast<double>(resident * static_cast<size_t>(sysconf(_SC_PAGESIZE))) / (1024 * 1024);
+    }
+#else
+    /// Resident size is read from procfs, elsewhere it is not reported.
+    constexpr bool HasResidentSize = false;
+    
+    double ResidentMegabytes()
+    {
+        return 0;
+    }
+#endif
+    
+    /// Latency histogram with 1ns buckets: keeps memory footprint of measurement fixed.
+    class Histogram
+    {
+    public:
+        Histogram() : m_buckets(HistogramSize), m_count(0) {}
+        
+        void add(const double nanoseconds)
+        {
+            m_buckets[std::min(static_cast<size_t>(nanoseconds), HistogramSize - 1)]++;
+            m_count++;
+        }
+        
+        double percentile(const double p) const
+        {
+            const size_t rank = static_cast<size_t>(p * m_count);
+            size_t seen = 0;
+            for (size_t i = 0; i < m_buckets.size(); i++)
+            {
+                seen += m_buckets[i];
+                if (seen > rank)
+                {
+                    return static_cast<double>(i);
+                }
+            }
+            
+            return static_cast<double>(HistogramSize);
+        }
+        
+    private:
+        std::vector<size_t> m_buckets;
+        size_t m_count;
+    };
+    
+    /// Each thread keeps window of live values and replaces them one by one: every operation is destruction + creation.
+    template <typename AsEnum>
+    void CreateDestroy(benchmark::State& state)
+    {
+        const double rssBefore = ResidentMegabytes();
+        std::vector<AsEnum> window(LiveValues, AsEnum::template create<Event::Empty>());
+        Histogram histogram;
+        
+        size_t index = 0;
+        for (auto _ : state)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < SampleBatch; i++, index++)
+            {
+                auto& slot = window[index % LiveValues];
+                slot = index % 2 ? AsEnum::template create<Event::Small>({ { index } }) : AsEnum::template create<Event::Large>({ { index } });
+            }
+            const auto finish = std::chrono::steady_clock::now();
+            histogram.add(std::chrono::duration<double, std::nano>(finish - start).count() / SampleBatch);
+        }
+        
+        state.counters["p50_ns"] = benchmark::Counter(histogram.percentile(0.5), benchmark::Counter::kAvgThreads);
+        state.counters["p99_ns"] = benchmark::Counter(histogram.percentile(0.99), benchmark::Counter::kAvgThreads);
+        state.counters["p999_ns"] = benchmark::Counter(histogram.percentile(0.999), benchmark::Counter::kAvgThreads);
+        if (state.thread_index() == 0 && !HasResidentSize)
+        {
+            state.SetLabel("rss n/a");
+        }
+        else if (state.thread_index() == 0)
+        {
+            // Process-wide: run benchmarks separately ('--benchmark_filter') to compare memory footprint.
+            state.counters["rss_mb"] = ResidentMegabytes();
+            state.counters["rss_growth_mb"] = ResidentMegabytes() - rssBefore;
+        }
+        state.SetItemsProcessed(state.iterations() * SampleBatch);
+    }
+    
+    void BM_CreateDestroy_Default(benchmark::State& state)
+    {
+        CreateDestroy<EventAsEnum<asenum::AsEnum>>(state);
+    }
+    
+    void BM_CreateDestroy_Pooled(benchmark::State& state)
+    {
+        CreateDestroy<EventAsEnum<asenum::PooledAsEnum>>(state);
+    }
+}
+
+BENCHMARK(BM_CreateDestroy_Default)->Threads(1)->Threads(4)->Threads(32)->UseRealTime();
+BENCHMARK(BM_CreateDestroy_Pooled)->Threads(1)->Threads(4)->Threads(32)->UseRealTime();
@@ -0,0 +1,188 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Alkenso (Vladimir Vashurkin)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <asenum/queue.h>
+
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    constexpr size_t MessageCount = 1 << 16;
+    constexpr size_t QueueCapacity = 1024;
+    constexpr size_t MaxBatch = 64;
+    
+    enum class Event
+    {
+        Tick,
+        Text
+    };
+    
+    /// Tick holds time of push in nanoseconds: consumers measure queueing latency.
+    using EventAsEnum = asenum::AsEnum<
+    asenum::Case11<Event, Event::Tick, int64_t>,
+    asenum::Case11<Event, Event::Text, std::string>
+    >;
+    
+    int64_t Now()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+    
+    class LockFreeQueue
+    {
+    public:
+        bool tryPush(EventAsEnum&& event)
+        {
+            return m_queue.tryPush(std::move(event));
+        }
+        
+        template <typename Matcher>
+        size_t drain(const Matcher& matcher)
+        {
+            return m_queue.drain(matcher, MaxBatch);
+        }
+        
+    private:
+        asenum::AsEnumQueue<EventAsEnum> m_queue { QueueCapacity };
+    };
+    
+    /// Baseline: bounded 'std::deque' under mutex. Consumers take messages in batches too.
+    class LockedQueue
+    {
+    public:
+        bool tryPush(EventAsEnum&& event)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_queue.size() == QueueCapacity)
+            {
+                return false;
+            }
+            m_queue.push_back(std::move(event));
+            return true;
+        }
+        
+        template <typename Matcher>
+        size_t drain(const Matcher& matcher)
+        {
+            thread_local std::vector<EventAsEnum> t_batch;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                while (!m_queue.empty() && t_batch.size() < MaxBatch)
+                {
+                    t_batch.push_back(std::move(m_queue.front()));
+                    m_queue.pop_front();
+                }
+            }
+            
+            for (const EventAsEnum& event : t_batch)
+            {
+                matcher(event);
+            }
+            
+            const size_t count = t_batch.size();
+            t_batch.clear();
+            return count;
+        }
+        
+    private:
+        std::mutex m_mutex;
+        std::deque<EventAsEnum> m_queue;
+    };
+    
+    /// Arguments: number of producers and consumers. Each iteration passes 'MessageCount' messages through the queue.
+    template <typename Queue>
+    void BM_Pipeline(benchmark::State& state)
+    {
+        const size_t producerCount = static_cast<size_t>(state.range(0));
+        const size_t consumerCount = static_cast<size_t>(state.range(1));
+        
+        int64_t totalLatency = 0;
+        for (auto _ : state)
+        {
+            Queue queue;
+            std::atomic<size_t> received(0);
+            std::atomic<int64_t> latency(0);
+            
+            std::vector<std::thread> threads;
+            for (size_t producer = 0; producer < producerCount; producer++)
+            {
+                threads.emplace_back([&queue, producerCount] {
+                    for (size_t i = 0; i < MessageCount / producerCount; i++)
+                    {
+                        EventAsEnum event = EventAsEnum::create<Event::Tick>(Now());
+                        while (!queue.tryPush(std::move(event)))
+                        {
+                            std::this_thread::yield();
+                        }
+                    }
+                });
+            }
+            
+            for (size_t consumer = 0; consumer < consumerCount; consumer++)
+            {
+                threads.emplace_back([&queue, &received, &latency, producerCount] {
+                    int64_t localLatency = 0;
+                    const auto matcher = EventAsEnum::matcher<void>()
+                    .ifCase<Event::Tick>([&localLatency] (const int64_t pushed) {
+                        localLatency += Now() - pushed;
+                    })
+                    .ifDefault([] {});
+                    
+                    const size_t total = MessageCount / producerCount * producerCount;
+                    while (received.load(std::memory_order_relaxed) < total)
+                    {
+                        const size_t count = queue.drain(matcher);
+                        received.fetch_add(count, std::memory_order_relaxed);
+                        if (!count)
+                        {
+                            std::this_thread::yield();
+                        }
+                    }
+                    latency += localLatency;
+                });
+            }
+            
+            for (std::thread& thread : threads)
+            {
+                thread.join();
+            }
+            totalLatency += latency.load();
+        }
+        
+        const size_t messages = state.iterations() * (MessageCount / producerCount * producerCount);
+        state.SetItemsProcessed(messages);
+        state.counters["latency_ns"] = benchmark::Counter(static_cast<double>(totalLatency) / messages);
+    }
+}
+
+BENCHMARK_TEMPLATE(BM_Pipeline, LockFreeQueue)->Args({ 1, 1 })->Args({ 2, 2 })->Args({ 4, 4 })->Args({ 4, 1 })->Args({ 1, 4 })->UseRealTime();
+BENCHMARK_TEMPLATE(BM_Pipeline, LockedQueue)->Args({ 1, 1 })->Args({ 2, 2 })->Args({ 4, 4 })->Args({ 4, 1 })->Args({ 1, 4 })->UseRealTime();
@@ -0,0 +1,149 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Alkenso (Vladimir Vashurkin)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <asenum/flat_hash.h>
+#include <asenum/simd.h>
+
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <vector>
+
+namespace
+{
+    constexpr size_t TagCount = 1 << 16;
+    constexpr size_t CaseCount = 8;
+    
+    enum class Tag8 : uint8_t {};
+    enum class Tag32 : uint32_t {};
+    
+    const char* LevelName(const asenum::SimdLevel level)
+    {
+        switch (level)
+        {
+            case asenum::SimdLevel::SSE2: return "SSE2";
+            case asenum::SimdLevel::AVX2: return "AVX2";
+            case asenum::SimdLevel::NEON: return "NEON";
+            default: return "Scalar";
+        }
+    }
+    
+    template <typename Enum>
+    std::vector<Enum> MakeTags()
+    {
+        std::mt19937 generator(42);
+        std::uniform_int_distribution<int> distribution(0, CaseCount - 1);
+        
+        std::vector<Enum> tags(TagCount);
+        for (Enum& tag : tags)
+        {
+            tag = static_cast<Enum>(distribution(generator));
+        }
+        
+        return tags;
+    }
+    
+    /// Resolves instruction set from benchmark argument: 0 - scalar, 1 - the best supported one.
+    asenum::SimdLevel ResolveLevel(benchmark::State& state)
+    {
+        const asenum::SimdLevel level = state.range(0) ? asenum::ActiveSimdLevel() : asenum::SimdLevel::Scalar;
+        state.SetLabel(LevelName(level));
+        
+        return level;
+    }
+    
+    /// Baseline: loop over tags the way it is written by hand.
+    template <typename Enum>
+    void BM_CountCase_Loop(benchmark::State& state)
+    {
+        const auto tags = MakeTags<Enum>();
+        for (auto _ : state)
+        {
+            size_t count = 0;
+            for (const Enum tag : tags)
+            {
+                if (tag == static_cast<Enum>(3))
+                {
+                    count++;
+                }
+            }
+            benchmark::DoNotOptimize(count);
+        }
+        state.SetItemsProcessed(state.iterations() * tags.size());
+    }
+    
+    template <typename Enum>
+    void BM_CountCase(benchmark::State& state)
+    {
+        using Word = typename asenum::details::TagWord<sizeof(Enum)>::type;
+        
+        const asenum::SimdLevel level = ResolveLevel(state);
+        const auto tags = MakeTags<Enum>();
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(asenum::details::TagKernels<Word>::count(level, reinterpret_cast<const Word*>(tags.data()), tags.size(), 3));
+        }
+        state.SetItemsProcessed(state.iterations() * tags.size());
+    }
+    
+    template <typename Enum>
+    void BM_SelectCase(benchmark::State& state)
+    {
+        using Word = typename asenum::details::TagWord<sizeof(Enum)>::type;
+        
+        const asenum::SimdLevel level = ResolveLevel(state);
+        const auto tags = MakeTags<Enum>();
+        std::vector<size_t> indices(tags.size());
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(asenum::details::TagKernels<Word>::select(level, reinterpret_cast<const Word*>(tags.data()), tags.size(), 3, indices.data()));
+            benchmark::ClobberMemory();
+        }
+        state.SetItemsProcessed(state.iterations() * tags.size());
+    }
+    
+    template <typename Enum>
+    void BM_CaseHistogram(benchmark::State& state)
+    {
+        using Word = typename asenum::details::TagWord<sizeof(Enum)>::type;
+        
+        const asenum::SimdLevel level = ResolveLevel(state);
+        const auto tags = MakeTags<Enum>();
+        size_t histogram[CaseCount];
+        for (auto _ : state)
+        {
+            asenum::details::TagKernels<Word>::histogram(level, reinterpret_cast<const Word*>(tags.data()), tags.size(), histogram, CaseCount);
+            benchmark::DoNotOptimize(histogram);
+        }
+        state.SetItemsProcessed(state.iterations() * tags.size());
+    }
+}
+
+BENCHMARK_TEMPLATE(BM_CountCase_Loop, Tag8);
+BENCHMARK_TEMPLATE(BM_CountCase, Tag8)->Arg(0)->Arg(1);
+BENCHMARK_TEMPLATE(BM_CountCase_Loop, Tag32);
+BENCHMARK_TEMPLATE(BM_CountCase, Tag32)->Arg(0)->Arg(1);
+BENCHMARK_TEMPLATE(BM_SelectCase, Tag8)->Arg(0)->Arg(1);
+BENCHMARK_TEMPLATE(BM_SelectCase, Tag32)->Arg(0)->Arg(1);
+BENCHMARK_TEMPLATE(BM_CaseHistogram, Tag8)->Arg(0)->Arg(1);
+BENCHMARK_TEMPLATE(BM_CaseHistogram, Tag32)->Arg(0)->Arg(1);
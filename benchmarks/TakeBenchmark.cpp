@@ -0,0 +1,128 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Alkenso (Vladimir Vashurkin)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <asenum/asenum.h>
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace
+{
+    enum class Packet
+    {
+        Data,
+        Ping
+    };
+    
+    using PacketAsEnum = asenum::AsEnum<
+    asenum::Case11<Packet, Packet::Data, std::vector<uint8_t>>,
+    asenum::Case11<Packet, Packet::Ping, void>
+    >;
+    
+    /// Each iteration receives a freshly created packet and extracts its buffer.
+    void BM_Extract_ForceAsCase(benchmark::State& state)
+    {
+        const size_t size = static_cast<size_t>(state.range(0));
+        for (auto _ : state)
+        {
+            const PacketAsEnum packet = PacketAsEnum::create<Packet::Data>(std::vector<uint8_t>(size));
+            std::vector<uint8_t> buffer = packet.forceAsCase<Packet::Data>();
+            benchmark::DoNotOptimize(buffer.data());
+        }
+        state.SetBytesProcessed(state.iterations() * size);
+    }
+    
+    void BM_Extract_Take(benchmark::State& state)
+    {
+        const size_t size = static_cast<size_t>(state.range(0));
+        for (auto _ : state)
+        {
+            PacketAsEnum packet = PacketAsEnum::create<Packet::Data>(std::vector<uint8_t>(size));
+            std::vector<uint8_t> buffer = std::move(packet).take<Packet::Data>();
+            benchmark::DoNotOptimize(buffer.data());
+        }
+        state.SetBytesProcessed(state.iterations() * size);
+    }
+    
+    void BM_Extract_DoMap_Rvalue(benchmark::State& state)
+    {
+        const size_t size = static_cast<size_t>(state.range(0));
+        for (auto _ : state)
+        {
+            std::vector<uint8_t> buffer = PacketAsEnum::create<Packet::Data>(std::vector<uint8_t>(size)).doMap<std::vector<uint8_t>>()
+            .ifCase<Packet::Data>([] (std::vector<uint8_t>&& value) {
+                return std::move(value);
+            })
+            .ifCase<Packet::Ping>([] {
+                return std::vector<uint8_t>();
+            });
+            benchmark::DoNotOptimize(buffer.data());
+        }
+        state.SetBytesProcessed(state.iterations() * size);
+    }
+    
+    /// Appends bytes one by one re-creating the packet: each step copies the whole buffer.
+    void BM_Accumulate_Create(benchmark::State& state)
+    {
+        const size_t size = static_cast<size_t>(state.range(0));
+        for (auto _ : state)
+        {
+            PacketAsEnum packet = PacketAsEnum::create<Packet::Data>(std::vector<uint8_t>());
+            for (size_t i = 0; i < size; i++)
+            {
+                std::vector<uint8_t> buffer = packet.forceAsCase<Packet::Data>();
+                buffer.push_back(static_cast<uint8_t>(i));
+                packet = PacketAsEnum::create<Packet::Data>(std::move(buffer));
+            }
+            benchmark::DoNotOptimize(packet);
+        }
+        state.SetItemsProcessed(state.iterations() * size);
+    }
+    
+    void BM_Accumulate_Modify(benchmark::State& state)
+    {
+        const size_t size = static_cast<size_t>(state.range(0));
+        for (auto _ : state)
+        {
+            PacketAsEnum packet = PacketAsEnum::create<Packet::Data>(std::vector<uint8_t>());
+            for (size_t i = 0; i < size; i++)
+            {
+                packet.modify<Packet::Data>([i] (std::vector<uint8_t>& buffer) {
+                    buffer.push_back(static_cast<uint8_t>(i));
+                });
+            }
+            benchmark::DoNotOptimize(packet);
+        }
+        state.SetItemsProcessed(state.iterations() * size);
+    }
+}
+
+BENCHMARK(BM_Extract_ForceAsCase)->Arg(4 << 10)->Arg(1 << 20);
+BENCHMARK(BM_Extract_Take)->Arg(4 << 10)->Arg(1 << 20);
+BENCHMARK(BM_Extract_DoMap_Rvalue)->Arg(4 << 10)->Arg(1 << 20);
+
+BENCHMARK(BM_Accumulate_Create)->Arg(256)->Arg(4 << 10);
+BENCHMARK(BM_Accumulate_Modify)->Arg(256)->Arg(4 << 10);
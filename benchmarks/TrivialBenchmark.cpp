@@ -0,0 +1,163 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Alkenso (Vladimir Vashurkin)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <asenum/asenum.h>
+
+#include <benchmark/benchmark.h>
+
+#include <chrono>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+#if __cplusplus > 201402L
+#include <variant>
+#endif
+
+namespace
+{
+    constexpr size_t ValueCount = 4096;
+    
+    enum class Event
+    {
+        Tick,
+        Timeout,
+        Error
+    };
+    
+    /// Same payload as 'int', but copy constructor is user-provided: AsEnum falls back to type-erased layout.
+    struct CopyableInt
+    {
+        CopyableInt(const int value) : value(value) {}
+        CopyableInt(const CopyableInt& other) noexcept : value(other.value) {}
+        
+        int value;
+    };
+    
+    using TrivialEvent = asenum::AsEnum<
+    asenum::Case11<Event, Event::Tick, void>,
+    asenum::Case11<Event, Event::Timeout, std::chrono::milliseconds>,
+    asenum::Case11<Event, Event::Error, int>
+    >;
+    
+    using NonTrivialEvent = asenum::AsEnum<
+    asenum::Case11<Event, Event::Tick, void>,
+    asenum::Case11<Event, Event::Timeout, std::chrono::milliseconds>,
+    asenum::Case11<Event, Event::Error, CopyableInt>
+    >;
+    
+    static_assert(std::is_trivially_copyable<TrivialEvent>::value, "Trivial layout is expected");
+    static_assert(!std::is_trivially_copyable<NonTrivialEvent>::value, "Type-erased layout is expected");
+    
+    template <typename EventAsEnum>
+    std::vector<EventAsEnum> MakeEvents()
+    {
+        std::vector<EventAsEnum> events;
+        events.reserve(ValueCount);
+        for (size_t i = 0; i < ValueCount; i++)
+        {
+            switch (i % 3)
+            {
+                case 0: events.push_back(EventAsEnum::template create<Event::Tick>()); break;
+                case 1: events.push_back(EventAsEnum::template create<Event::Timeout>(std::chrono::milliseconds(i))); break;
+                default: events.push_back(EventAsEnum::template create<Event::Error>(static_cast<int>(i))); break;
+            }
+        }
+        
+        return events;
+    }
+    
+    /// Not inlined: argument is passed by value through the calling convention (in registers if trivially copyable).
+    template <typename EventAsEnum>
+    __attribute__((noinline)) size_t CaseIndexOf(const EventAsEnum event)
+    {
+        return event.caseIndex();
+    }
+    
+    template <typename EventAsEnum>
+    void BM_PassByValue(benchmark::State& state)
+    {
+        const std::vector<EventAsEnum> events = MakeEvents<EventAsEnum>();
+        for (auto _ : state)
+        {
+            size_t sum = 0;
+            for (const EventAsEnum& event : events)
+            {
+                sum += CaseIndexOf(event);
+            }
+            benchmark::DoNotOptimize(sum);
+        }
+        state.SetItemsProcessed(state.iterations() * events.size());
+    }
+    
+    /// Copies and destroys all values. Trivially copyable elements are copied by single 'memmove'.
+    template <typename EventAsEnum>
+    void BM_VectorCopy(benchmark::State& state)
+    {
+        const std::vector<EventAsEnum> events = MakeEvents<EventAsEnum>();
+        for (auto _ : state)
+        {
+            std::vector<EventAsEnum> copy = events;
+            benchmark::DoNotOptimize(copy.data());
+        }
+        state.SetBytesProcessed(state.iterations() * events.size() * sizeof(EventAsEnum));
+        state.SetItemsProcessed(state.iterations() * events.size());
+    }
+    
+#if __cplusplus > 201402L
+    using EventVariant = std::variant<std::monostate, std::chrono::milliseconds, int>;
+    
+    void BM_VectorCopy_Variant(benchmark::State& state)
+    {
+        std::vector<EventVariant> events;
+        events.reserve(ValueCount);
+        for (size_t i = 0; i < ValueCount; i++)
+        {
+            switch (i % 3)
+            {
+                case 0: events.emplace_back(std::in_place_index<0>); break;
+                case 1: events.emplace_back(std::in_place_index<1>, std::chrono::milliseconds(i)); break;
+                default: events.emplace_back(std::in_place_index<2>, static_cast<int>(i)); break;
+            }
+        }
+        
+        for (auto _ : state)
+        {
+            std::vector<EventVariant> copy = events;
+            benchmark::DoNotOptimize(copy.data());
+        }
+        state.SetBytesProcessed(state.iterations() * events.size() * sizeof(EventVariant));
+        state.SetItemsProcessed(state.iterations() * events.size());
+    }
+#endif
+}
+
+BENCHMARK_TEMPLATE(BM_PassByValue, TrivialEvent);
+BENCHMARK_TEMPLATE(BM_PassByValue, NonTrivialEvent);
+BENCHMARK_TEMPLATE(BM_VectorCopy, TrivialEvent);
+BENCHMARK_TEMPLATE(BM_VectorCopy, NonTrivialEvent);
+
+#if __cplusplus > 201402L
+BENCHMARK(BM_VectorCopy_Variant);
+#endif
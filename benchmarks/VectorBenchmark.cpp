@@ -0,0 +1,167 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Alkenso (Vladimir Vashurkin)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "BenchmarkUtils.h"
+
+#include <asenum/vector.h>
+
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+namespace
+{
+    constexpr size_t ValueCount = 1 << 16;
+    constexpr bench::WideEnum FirstCase = static_cast<bench::WideEnum>(0);
+    
+    template <size_t N>
+    bench::WideAsEnumVector<N> MakeWideVector(const std::vector<bench::WideAsEnum<N>>& values)
+    {
+        bench::WideAsEnumVector<N> vector;
+        vector.reserve(values.size());
+        for (const auto& value : values)
+        {
+            vector.push_back(value);
+        }
+        
+        return vector;
+    }
+    
+    /// Sums values of single case: 1/N of all elements.
+    template <size_t N>
+    void BM_Filter_VectorOfAsEnum(benchmark::State& state)
+    {
+        const auto values = bench::MakeWideValues<N>(ValueCount);
+        for (auto _ : state)
+        {
+            long long sum = 0;
+            for (const auto& value : values)
+            {
+                value.template ifCase<FirstCase>([&sum] (const int payload) {
+                    sum += payload;
+                });
+            }
+            benchmark::DoNotOptimize(sum);
+        }
+        state.SetItemsProcessed(state.iterations() * values.size());
+    }
+    
+    template <size_t N>
+    void BM_Filter_AsEnumVector(benchmark::State& state)
+    {
+        const auto vector = MakeWideVector<N>(bench::MakeWideValues<N>(ValueCount));
+        for (auto _ : state)
+        {
+            long long sum = 0;
+            vector.template forEach<FirstCase>([&sum] (const int payload) {
+                sum += payload;
+            });
+            benchmark::DoNotOptimize(sum);
+        }
+        state.SetItemsProcessed(state.iterations() * vector.size());
+    }
+    
+    /// Counts cases of all elements in order.
+    template <size_t N>
+    void BM_ScanCases_VectorOfAsEnum(benchmark::State& state)
+    {
+        const auto values = bench::MakeWideValues<N>(ValueCount);
+        for (auto _ : state)
+        {
+            size_t histogram[N] = {};
+            for (const auto& value : values)
+            {
+                histogram[static_cast<size_t>(value.enumCase())]++;
+            }
+            benchmark::DoNotOptimize(histogram);
+        }
+        state.SetItemsProcessed(state.iterations() * values.size());
+    }
+    
+    template <size_t N>
+    void BM_ScanCases_AsEnumVector(benchmark::State& state)
+    {
+        const auto vector = MakeWideVector<N>(bench::MakeWideValues<N>(ValueCount));
+        for (auto _ : state)
+        {
+            size_t histogram[N] = {};
+            for (size_t i = 0; i < vector.size(); i++)
+            {
+                histogram[static_cast<size_t>(vector.enumCase(i))]++;
+            }
+            benchmark::DoNotOptimize(histogram);
+        }
+        state.SetItemsProcessed(state.iterations() * vector.size());
+    }
+    
+    /// Random access through element view.
+    template <size_t N>
+    void BM_RandomAccess_VectorOfAsEnum(benchmark::State& state)
+    {
+        const auto values = bench::MakeWideValues<N>(ValueCount);
+        for (auto _ : state)
+        {
+            long long sum = 0;
+            for (size_t i = 0; i < values.size(); i++)
+            {
+                const size_t index = (i * 7919) % values.size();
+                values[index].template ifCase<FirstCase>([&sum] (const int payload) {
+                    sum += payload;
+                });
+            }
+            benchmark::DoNotOptimize(sum);
+        }
+        state.SetItemsProcessed(state.iterations() * values.size());
+    }
+    
+    template <size_t N>
+    void BM_RandomAccess_AsEnumVector(benchmark::State& state)
+    {
+        const auto vector = MakeWideVector<N>(bench::MakeWideValues<N>(ValueCount));
+        for (auto _ : state)
+        {
+            long long sum = 0;
+            for (size_t i = 0; i < vector.size(); i++)
+            {
+                const size_t index = (i * 7919) % vector.size();
+                vector[index].template ifCase<FirstCase>([&sum] (const int payload) {
+                    sum += payload;
+                });
+            }
+            benchmark::DoNotOptimize(sum);
+        }
+        state.SetItemsProcessed(state.iterations() * vector.size());
+    }
+}
+
+BENCHMARK_TEMPLATE(BM_Filter_VectorOfAsEnum, 3);
+BENCHMARK_TEMPLATE(BM_Filter_AsEnumVector, 3);
+BENCHMARK_TEMPLATE(BM_Filter_VectorOfAsEnum, 40);
+BENCHMARK_TEMPLATE(BM_Filter_AsEnumVector, 40);
+BENCHMARK_TEMPLATE(BM_ScanCases_VectorOfAsEnum, 3);
+BENCHMARK_TEMPLATE(BM_ScanCases_AsEnumVector, 3);
+BENCHMARK_TEMPLATE(BM_ScanCases_VectorOfAsEnum, 40);
+BENCHMARK_TEMPLATE(BM_ScanCases_AsEnumVector, 40);
+BENCHMARK_TEMPLATE(BM_RandomAccess_VectorOfAsEnum, 3);
+BENCHMARK_TEMPLATE(BM_RandomAccess_AsEnumVector, 3);
@@ -0,0 +1,139 @@
+#!/usr/bin/env python3
+#
+# MIT License
+#
+# Copyright (c) 2019 Alkenso (Vladimir Vashurkin)
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+#
+
+"""
+Compile-time benchmark: generates translation units with N-case AsEnum and measures how long they compile.
+Each unit creates and unwraps every case, runs full 'doSwitch', 'doMap' and 'match' chains and compares values.
+With Clang '-ftime-trace' reports are written next to generated sources (open them in chrome://tracing).
+
+    benchmarks/compile_time.py --compiler clang++ --cases 50 100 200 300
+"""
+
+import argparse
+import os
+import subprocess
+import sys
+import time
+
+
+def payload(index):
+    return 'void' if index % 5 == 4 else 'int'
+
+
+def generate(count):
+    cases = range(count)
+    lines = [
+        '#include <asenum/asenum.h>',
+        '',
+        'enum class Wide',
+        '{',
+        ',\n'.join('    C%d' % i for i in cases),
+        '};',
+        '',
+        'using WideAsEnum = asenum::AsEnum<',
+        ',\n'.join('asenum::Case11<Wide, Wide::C%d, %s>' % (i, payload(i)) for i in cases),
+        '>;',
+        '',
+        'int Use(const WideAsEnum& value)',
+        '{',
+        '    int sum = 0;',
+    ]
+    
+    for i in cases:
+        if payload(i) == 'void':
+            lines.append('    sum += WideAsEnum::create<Wide::C%d>().isCase<Wide::C%d>();' % (i, i))
+            lines.append('    value.ifCase<Wide::C%d>([&] { sum++; });' % i)
+        else:
+            lines.append('    sum += WideAsEnum::create<Wide::C%d>(%d).isCase<Wide::C%d>();' % (i, i, i))
+            lines.append('    value.ifCase<Wide::C%d>([&] (int v) { sum += v; });' % i)
+    
+    lines.append('    value.doSwitch()')
+    for i in cases:
+        handler = '[&] { sum++; }' if payload(i) == 'void' else '[&] (int v) { sum += v; }'
+        lines.append('    .ifCase<Wide::C%d>(%s)' % (i, handler))
+    lines.append('    .ifDefault([] {});')
+    
+    lines.append('    sum += value.doMap<int>()')
+    for i in cases:
+        handler = '[] { return 1; }' if payload(i) == 'void' else '[] (int v) { return v; }'
+        lines.append('    .ifCase<Wide::C%d>(%s)%s' % (i, handler, ';' if i == count - 1 else ''))
+    
+    lines.append('    value.match()')
+    for i in cases:
+        handler = '[&] { sum++; }' if payload(i) == 'void' else '[&] (int v) { sum += v; }'
+        lines.append('    .ifCase<Wide::C%d>(%s)%s' % (i, handler, ';' if i == count - 1 else ''))
+    
+    lines += [
+        '    sum += value < value;',
+        '    sum += value == value;',
+        '    return sum;',
+        '}',
+        '',
+    ]
+    
+    return '\n'.join(lines)
+
+
+def main():
+    root = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+    
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('--compiler', default=os.environ.get('CXX', 'c++'))
+    parser.add_argument('--std', default='c++11')
+    parser.add_argument('--cases', type=int, nargs='+', default=[50, 100, 200, 300])
+    parser.add_argument('--output', default='compile_time')
+    parser.add_argument('--flags', default='', help='extra compiler flags, e.g. "-ftemplate-depth=512"')
+    args = parser.parse_args()
+    
+    os.makedirs(args.output, exist_ok=True)
+    version = subprocess.run([args.compiler, '--version'], stdout=subprocess.PIPE, universal_newlines=True).stdout
+    trace = ['-ftime-trace'] if 'clang' in version else []
+    
+    print('%8s %12s' % ('cases', 'seconds'))
+    failed = False
+    for count in args.cases:
+        source = os.path.join(args.output, 'cases_%d.cpp' % count)
+        with open(source, 'w') as file:
+            file.write(generate(count))
+        
+        command = [args.compiler, '-std=' + args.std, '-I', os.path.join(root, 'include'), '-c', source,
+                   '-o', source + '.o'] + trace + args.flags.split()
+        start = time.time()
+        result = subprocess.run(command, stdout=subprocess.PIPE, stderr=subprocess.STDOUT, universal_newlines=True)
+        elapsed = time.time() - start
+        
+        if result.returncode != 0:
+            failed = True
+            print('%8d %12s' % (count, 'failed'))
+            print('\n'.join(result.stdout.splitlines()[:20]), file=sys.stderr)
+        else:
+            print('%8d %12.2f' % (count, elapsed))
+        sys.stdout.flush()
+    
+    return 1 if failed else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
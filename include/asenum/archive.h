@@ -0,0 +1,885 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Alkenso (Vladimir Vashurkin)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <asenum/asenum.h>
+#include <asenum/codec.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace asenum
+{
+    template <typename ConcreteAsEnum>
+    class ArchiveReader;
+    
+    namespace details
+    {
+        /**
+         Archive file layout (all numbers in native byte order):
+         - header;
+         - payloads of all records in order of appending. Trivially copyable payloads are stored as raw bytes
+           aligned to 'alignof' of their type, other payloads are encoded with 'Serializer'. 'void' cases have no payload;
+         - case tags of archived AsEnum ('uint64_t' per case, see 'EncodeCaseTag');
+         - case index of each record ('uint8_t' if there are up to 256 cases, 'uint16_t' otherwise);
+         - payload offset of each record ('uint64_t');
+         - per-case index: 'caseCount + 1' starts followed by indices of records grouped by case ('uint64_t').
+         */
+        struct ArchiveHeader
+        {
+            char magic[8];
+            uint32_t version;
+            uint32_t caseCount;
+            uint64_t recordCount;
+            uint64_t dataEnd;
+            uint64_t caseTagsOffset;
+            uint64_t tagsOffset;
+            uint64_t offsetsOffset;
+            uint64_t caseIndexOffset;
+        };
+        
+        constexpr char ArchiveMagic[8] = { 'A', 'S', 'E', 'N', 'U', 'M', 'A', 'R' };
+        constexpr uint32_t ArchiveVersion = 1;
+        constexpr uint32_t NoArchiveCase = UINT32_MAX;
+        
+        uint64_t AlignOffset(uint64_t offset, size_t alignment);
+        
+        template <typename T>
+        struct ArchivePayload
+        {
+            /// 'bool' is decoded with 'Serializer' that rejects invalid bytes instead of being read in place.
+            static constexpr bool ZeroCopy = std::is_trivially_copyable<T>::value && !std::is_same<T, bool>::value;
+            
+            /// @return true if payload recorded at 'offset' starts within payload section that ends at 'dataEnd'
+            /// and, if it is read in place, is aligned and fits the section entirely.
+            static bool fits(uint64_t offset, uint64_t dataEnd);
+        };
+        
+        template <>
+        struct ArchivePayload<void>
+        {
+            static constexpr bool ZeroCopy = true;
+            
+            static bool fits(uint64_t offset, uint64_t dataEnd);
+        };
+        
+        template <typename ConcreteAsEnum, typename Indices>
+        struct ArchiveTable;
+    }
+    
+    /**
+     Writes AsEnum values into archive file that can be read with 'ArchiveReader'.
+     Payloads are streamed to the file, while case and offset of each record are kept in memory
+     until 'finish' writes the index.
+     Record is added only if its payload is written, so writer stays usable if 'append' fails before I/O
+     (e.g. 'Serializer' throws). After I/O error or failed 'finish' the archive can't be completed.
+     @throws std::runtime_error on I/O errors.
+     */
+    template <typename ConcreteAsEnum>
+    class ArchiveWriter
+    {
+    public:
+        explicit ArchiveWriter(const std::string& path);
+        
+        /// Closes the file. Archive is valid only if 'finish' has been called.
+        ~ArchiveWriter();
+        
+        ArchiveWriter(const ArchiveWriter&) = delete;
+        ArchiveWriter& operator=(const ArchiveWriter&) = delete;
+        
+        /// @throws std::logic_error if archive is already finished.
+        /// @throws std::runtime_error if previous write failed.
+        void append(const ConcreteAsEnum& value);
+        
+        /// Writes index and header and closes the file.
+        /// @throws std::logic_error if archive is already finished.
+        /// @throws std::runtime_error if previous write failed.
+        void finish();
+        
+    private:
+        template <typename ConcreteAsEnum_, typename Indices>
+        friend struct details::ArchiveTable;
+        
+        void checkWritable() const;
+        
+        /// Appends record of case 'tag' which payload is written at 'offset'. Either both tag and offset are added or none.
+        void addRecord(uint16_t tag, uint64_t offset);
+        
+        /// Appends bytes to the buffer. Strongly exception safe unless flush fails, which marks writer failed.
+        void writeRaw(const void* data, size_t size, size_t alignment);
+        void flush();
+        
+        template <typename T>
+        void writeSection(uint64_t& sectionOffset, const std::vector<T>& values);
+        
+    private:
+        std::FILE* m_file;
+        bool m_failed = false;
+        uint64_t m_offset = sizeof(details::ArchiveHeader);
+        std::vector<uint8_t> m_buffer;
+        std::vector<uint16_t> m_tags;
+        std::vector<uint64_t> m_offsets;
+    };
+    
+    /**
+     Lightweight view of single archived record. Valid while the reader is alive.
+     Case is resolved from the tag index; payload bytes are read only when the value is requested.
+     Trivially copyable values are passed to handlers by reference pointing directly into the mapped file.
+     Record is validated on each access.
+     @throws std::runtime_error if case tag or payload offset of the record is corrupted.
+     */
+    template <typename ConcreteAsEnum>
+    class ArchiveRecord
+    {
+    public:
+        using Enum = typename ConcreteAsEnum::Enum;
+        
+        template <Enum C>
+        using UnderlyingType = typename ConcreteAsEnum::template UnderlyingType<C>;
+        
+        static constexpr const Enum (&AllCases)[details::ArraySize(ConcreteAsEnum::AllCases)] = ConcreteAsEnum::AllCases;
+        
+        Enum enumCase() const;
+        
+        template <Enum Case>
+        bool isCase() const;
+        
+        /// Same as 'AsEnum::ifCase'.
+        template <Enum Case, typename Handler>
+        bool ifCase(const Handler& handler) const;
+        
+        /// Same as 'AsEnum::doSwitch'.
+        details::AsSwitch<Enum, ArchiveRecord> doSwitch() const;
+        
+        /// Same as 'AsEnum::doMap'.
+        template <typename T>
+        details::AsMapRoot<T, Enum, ArchiveRecord> doMap() const;
+        
+        /// @return AsEnum holding copy of the record.
+        ConcreteAsEnum decode() const;
+        
+    private:
+        friend class ArchiveReader<ConcreteAsEnum>;
+        
+        ArchiveRecord(const ArchiveReader<ConcreteAsEnum>& reader, size_t index);
+        
+    private:
+        const ArchiveReader<ConcreteAsEnum>& m_reader;
+        size_t m_index;
+    };
+    
+    /**
+     Maps archive file into memory and gives access to records without decoding them upfront.
+     Header, case tags, section bounds and per-case index bounds are validated on open, in time independent of number of records.
+     Records are validated lazily, when accessed: case tag, payload bounds and alignment, and for 'forEach' - entry of per-case index.
+     @throws std::runtime_error if file can't be mapped or is not a valid archive, or on access to corrupted record.
+     @throws std::invalid_argument if archive contains case unknown to 'ConcreteAsEnum'.
+     */
+    template <typename ConcreteAsEnum>
+    class ArchiveReader
+    {
+    public:
+        using Enum = typename ConcreteAsEnum::Enum;
+        
+        template <Enum C>
+        using UnderlyingType = typename ConcreteAsEnum::template UnderlyingType<C>;
+        
+        explicit ArchiveReader(const std::string& path);
+        ~ArchiveReader();
+        
+        ArchiveReader(const ArchiveReader&) = delete;
+        ArchiveReader& operator=(const ArchiveReader&) = delete;
+        
+        size_t size() const;
+        
+        ArchiveRecord<ConcreteAsEnum> operator[](size_t index) const;
+        
+        /// @return number of records of specified case. Uses per-case index.
+        template <Enum Case>
+        size_t count() const;
+        
+        /**
+         Walks records of specified case only, in order of appending. Uses per-case index.
+         
+         @param handler Function or functional object of signature void(UnderlyingType<Case>).
+         */
+        template <Enum Case, typename Handler>
+        void forEach(const Handler& handler) const;
+        
+    private:
+        friend class ArchiveRecord<ConcreteAsEnum>;
+        
+        template <typename ConcreteAsEnum_, typename Indices>
+        friend struct details::ArchiveTable;
+        
+        using Table = details::ArchiveTable<ConcreteAsEnum, typename details::MakeIndexSequence<details::ArraySize(ConcreteAsEnum::AllCases)>::type>;
+        static constexpr size_t CaseCount = details::ArraySize(ConcreteAsEnum::AllCases);
+        
+        const details::ArchiveHeader& header() const;
+        const uint8_t* section(uint64_t offset, uint64_t size, size_t alignment) const;
+        
+        /// @return index of case of record in archive case tags.
+        /// @throws std::runtime_error if tag of record is not in archive case tags.
+        size_t archiveCase(size_t index) const;
+        
+        /// @return index of case of record in 'ConcreteAsEnum::AllCases'.
+        size_t caseIndex(size_t index) const;
+        
+        /// @return offset of payload of record which case index is 'I'.
+        /// @throws std::runtime_error if payload doesn't fit payload section (see 'ArchivePayload::fits').
+        template <size_t I>
+        uint64_t payloadOffset(size_t index) const;
+        
+        template <size_t I, typename Handler>
+        void callPayload(uint64_t offset, const Handler& handler) const;
+        
+        template <typename T, typename Handler>
+        void callPayload(uint64_t offset, const Handler& handler, const void*, std::true_type) const;
+        
+        template <typename T, typename Handler>
+        void callPayload(uint64_t offset, const Handler& handler, const T*, std::true_type) const;
+        
+        template <typename T, typename Handler>
+        void callPayload(uint64_t offset, const Handler& handler, const T*, std::false_type) const;
+        
+    private:
+        const uint8_t* m_data = nullptr;
+        size_t m_size = 0;
+        
+        const uint8_t* m_tags8 = nullptr;
+        const uint16_t* m_tags16 = nullptr;
+        const uint64_t* m_offsets = nullptr;
+        const uint64_t* m_caseStarts = nullptr;
+        const uint64_t* m_caseRecords = nullptr;
+        
+        /// Archive case index -> reader case index.
+        std::vector<uint16_t> m_caseMap;
+        /// Reader case index -> archive case index or 'NoArchiveCase'.
+        uint32_t m_archiveCases[CaseCount];
+    };
+    
+    namespace details
+    {
+        template <typename ConcreteAsEnum, size_t... I>
+        struct ArchiveTable<ConcreteAsEnum, IndexSequence<I...>>
+        {
+            using Reader = ArchiveReader<ConcreteAsEnum>;
+            using Writer = ArchiveWriter<ConcreteAsEnum>;
+            
+            static ConcreteAsEnum decode(const Reader& reader, size_t index);
+            
+            template <size_t Index>
+            static ConcreteAsEnum decodeCase(const Reader& reader, size_t index);
+            
+            template <typename Enum, Enum Case>
+            static ConcreteAsEnum decodeValue(const Reader& reader, uint64_t offset, const void*);
+            
+            template <typename Enum, Enum Case, typename T>
+            static ConcreteAsEnum decodeValue(const Reader& reader, uint64_t offset, const T*);
+            
+            template <size_t Index>
+            void visit(const void*) const;
+            
+            template <size_t Index, typename T>
+            void visit(const T* value) const;
+            
+            /// @return offset of written payload.
+            template <typename T>
+            uint64_t writePayload(const T& value, std::true_type) const;
+            
+            template <typename T>
+            uint64_t writePayload(const T& value, std::false_type) const;
+            
+            Writer& writer;
+        };
+    }
+}
+
+
+// ArchiveWriter public
+
+template <typename ConcreteAsEnum>
+asenum::ArchiveWriter<ConcreteAsEnum>::ArchiveWriter(const std::string& path)
+: m_file(std::fopen(path.c_str(), "wb"))
+{
+    if (!m_file)
+    {
+        details::RaiseError<std::runtime_error>("Failed to create archive file.");
+    }
+    
+    // Destructor is not called if constructor fails, so file is closed here.
+    ASENUM_TRY
+    {
+        const details::ArchiveHeader header = {};
+        writeRaw(&header, sizeof(header), 1);
+        m_offset = sizeof(header);
+    }
+    ASENUM_CATCH_ALL
+    {
+        std::fclose(m_file);
+        ASENUM_RETHROW;
+    }
+}
+
+template <typename ConcreteAsEnum>
+asenum::ArchiveWriter<ConcreteAsEnum>::~ArchiveWriter()
+{
+    if (m_file)
+    {
+        std::fclose(m_file);
+    }
+}
+
+template <typename ConcreteAsEnum>
+void asenum::ArchiveWriter<ConcreteAsEnum>::append(const ConcreteAsEnum& value)
+{
+    checkWritable();
+    
+    using Table = details::ArchiveTable<ConcreteAsEnum, typename details::MakeIndexSequence<details::ArraySize(ConcreteAsEnum::AllCases)>::type>;
+    details::AsEnumAccess::visit<void>(value, Table { *this });
+}
+
+template <typename ConcreteAsEnum>
+void asenum::ArchiveWriter<ConcreteAsEnum>::finish()
+{
+    static constexpr size_t CaseCount = details::ArraySize(ConcreteAsEnum::AllCases);
+    checkWritable();
+    
+    // Index is appended to payloads: if anything below fails, archive can't be completed.
+    m_failed = true;
+    
+    details::ArchiveHeader header = {};
+    std::memcpy(header.magic, details::ArchiveMagic, sizeof(header.magic));
+    header.version = details::ArchiveVersion;
+    header.caseCount = CaseCount;
+    header.recordCount = m_tags.size();
+    header.dataEnd = m_offset;
+    
+    std::vector<uint64_t> caseTags;
+    for (const auto enumCase : ConcreteAsEnum::AllCases)
+    {
+        caseTags.push_back(details::EncodeCaseTag(enumCase));
+    }
+    writeSection(header.caseTagsOffset, caseTags);
+    
+    if (CaseCount <= UINT8_MAX + 1)
+    {
+        writeSection(header.tagsOffset, std::vector<uint8_t>(m_tags.begin(), m_tags.end()));
+    }
+    else
+    {
+        writeSection(header.tagsOffset, m_tags);
+    }
+    
+    writeSection(header.offsetsOffset, m_offsets);
+    
+    // Counting sort of records by case keeps records of each case in order of appending.
+    std::vector<uint64_t> caseIndex(CaseCount + 1 + m_tags.size());
+    for (const uint16_t tag : m_tags)
+    {
+        caseIndex[tag + 1]++;
+    }
+    for (size_t i = 0; i < CaseCount; i++)
+    {
+        caseIndex[i + 1] += caseIndex[i];
+    }
+    std::vector<uint64_t> positions(caseIndex.begin(), caseIndex.begin() + CaseCount);
+    for (size_t i = 0; i < m_tags.size(); i++)
+    {
+        caseIndex[CaseCount + 1 + positions[m_tags[i]]++] = i;
+    }
+    writeSection(header.caseIndexOffset, caseIndex);
+    
+    flush();
+    const bool written = std::fseek(m_file, 0, SEEK_SET) == 0 && std::fwrite(&header, sizeof(header), 1, m_file) == 1;
+    const bool closed = std::fclose(m_file) == 0;
+    m_file = nullptr;
+    if (!written || !closed)
+    {
+        details::RaiseError<std::runtime_error>("Failed to write archive file.");
+    }
+    m_failed = false;
+}
+
+// ArchiveWriter private
+
+template <typename ConcreteAsEnum>
+void asenum::ArchiveWriter<ConcreteAsEnum>::checkWritable() const
+{
+    if (m_failed)
+    {
+        details::RaiseError<std::runtime_error>("Archive can't be completed after failed write.");
+    }
+    if (!m_file)
+    {
+        details::RaiseError<std::logic_error>("Archive is already finished.");
+    }
+}
+
+template <typename ConcreteAsEnum>
+void asenum::ArchiveWriter<ConcreteAsEnum>::addRecord(const uint16_t tag, const uint64_t offset)
+{
+    m_offsets.push_back(offset);
+    ASENUM_TRY
+    {
+        m_tags.push_back(tag);
+    }
+    ASENUM_CATCH_ALL
+    {
+        m_offsets.pop_back();
+        ASENUM_RETHROW;
+    }
+}
+
+template <typename ConcreteAsEnum>
+void asenum::ArchiveWriter<ConcreteAsEnum>::writeRaw(const void* data, const size_t size, const size_t alignment)
+{
+    const uint64_t offset = details::AlignOffset(m_offset, alignment);
+    
+    // Single resize zero-fills alignment padding and leaves buffer intact if it throws.
+    m_buffer.resize(m_buffer.size() + static_cast<size_t>(offset - m_offset) + size);
+    if (size)
+    {
+        std::memcpy(m_buffer.data() + m_buffer.size() - size, data, size);
+    }
+    m_offset = offset + size;
+    
+    constexpr size_t FlushSize = 1 << 20;
+    if (m_buffer.size() >= FlushSize)
+    {
+        flush();
+    }
+}
+
+template <typename ConcreteAsEnum>
+void asenum::ArchiveWriter<ConcreteAsEnum>::flush()
+{
+    if (!m_buffer.empty() && std::fwrite(m_buffer.data(), m_buffer.size(), 1, m_file) != 1)
+    {
+        // Part of the buffer may be already in the file, so offsets of following payloads are unknown.
+        m_failed = true;
+        details::RaiseError<std::runtime_error>("Failed to write archive file.");
+    }
+    m_buffer.clear();
+}
+
+template <typename ConcreteAsEnum>
+template <typename T>
+void asenum::ArchiveWriter<ConcreteAsEnum>::writeSection(uint64_t& sectionOffset, const std::vector<T>& values)
+{
+    sectionOffset = details::AlignOffset(m_offset, alignof(uint64_t));
+    writeRaw(values.data(), values.size() * sizeof(T), alignof(uint64_t));
+}
+
+// ArchiveRecord public
+
+template <typename ConcreteAsEnum>
+constexpr const typename asenum::ArchiveRecord<ConcreteAsEnum>::Enum (&asenum::ArchiveRecord<ConcreteAsEnum>::AllCases)[details::ArraySize(ConcreteAsEnum::AllCases)];
+
+template <typename ConcreteAsEnum>
+typename asenum::ArchiveRecord<ConcreteAsEnum>::Enum asenum::ArchiveRecord<ConcreteAsEnum>::enumCase() const
+{
+    return ConcreteAsEnum::AllCases[m_reader.caseIndex(m_index)];
+}
+
+template <typename ConcreteAsEnum>
+template <typename asenum::ArchiveRecord<ConcreteAsEnum>::Enum Case>
+bool asenum::ArchiveRecord<ConcreteAsEnum>::isCase() const
+{
+    return m_reader.caseIndex(m_index) == details::AsEnumAccess::caseIndex<ConcreteAsEnum, Case>();
+}
+
+template <typename ConcreteAsEnum>
+template <typename asenum::ArchiveRecord<ConcreteAsEnum>::Enum Case, typename Handler>
+bool asenum::ArchiveRecord<ConcreteAsEnum>::ifCase(const Handler& handler) const
+{
+    const bool isType = isCase<Case>();
+    if (isType)
+    {
+        static constexpr size_t I = details::AsEnumAccess::caseIndex<ConcreteAsEnum, Case>();
+        m_reader.template callPayload<I>(m_reader.template payloadOffset<I>(m_index), handler);
+    }
+    
+    return isType;
+}
+
+template <typename ConcreteAsEnum>
+asenum::details::AsSwitch<typename asenum::ArchiveRecord<ConcreteAsEnum>::Enum, asenum::ArchiveRecord<ConcreteAsEnum>> asenum::ArchiveRecord<ConcreteAsEnum>::doSwitch() const
+{
+    return details::AsSwitch<Enum, ArchiveRecord>(*this);
+}
+
+template <typename ConcreteAsEnum>
+template <typename T>
+asenum::details::AsMapRoot<T, typename asenum::ArchiveRecord<ConcreteAsEnum>::Enum, asenum::ArchiveRecord<ConcreteAsEnum>> asenum::ArchiveRecord<ConcreteAsEnum>::doMap() const
+{
+    return details::AsMapRoot<T, Enum, ArchiveRecord>(*this);
+}
+
+template <typename ConcreteAsEnum>
+ConcreteAsEnum asenum::ArchiveRecord<ConcreteAsEnum>::decode() const
+{
+    return ArchiveReader<ConcreteAsEnum>::Table::decode(m_reader, m_index);
+}
+
+// ArchiveRecord private
+
+template <typename ConcreteAsEnum>
+asenum::ArchiveRecord<ConcreteAsEnum>::ArchiveRecord(const ArchiveReader<ConcreteAsEnum>& reader, const size_t index)
+: m_reader(reader)
+, m_index(index)
+{}
+
+// ArchiveReader public
+
+template <typename ConcreteAsEnum>
+asenum::ArchiveReader<ConcreteAsEnum>::ArchiveReader(const std::string& path)
+{
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        details::RaiseError<std::runtime_error>("Failed to open archive file.");
+    }
+    
+    struct stat st = {};
+    if (::fstat(fd, &st) != 0 || static_cast<uint64_t>(st.st_size) < sizeof(details::ArchiveHeader))
+    {
+        ::close(fd);
+        details::RaiseError<std::runtime_error>("Archive file is too small.");
+    }
+    
+    m_size = static_cast<size_t>(st.st_size);
+    void* data = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED)
+    {
+        details::RaiseError<std::runtime_error>("Failed to map archive file.");
+    }
+    m_data = static_cast<const uint8_t*>(data);
+    
+    ASENUM_TRY
+    {
+        const details::ArchiveHeader& header = this->header();
+        if (std::memcmp(header.magic, details::ArchiveMagic, sizeof(header.magic)) != 0 || header.version != details::ArchiveVersion)
+        {
+            details::RaiseError<std::runtime_error>("Not an archive file or unsupported version.");
+        }
+        // Every record has 8-byte offset, so larger count can't fit. Also keeps section size computations below from overflow.
+        if (header.dataEnd > m_size || header.caseCount == 0 || header.caseCount > UINT16_MAX + 1 || header.recordCount > m_size / sizeof(uint64_t))
+        {
+            details::RaiseError<std::runtime_error>("Archive header is corrupted.");
+        }
+        
+        const uint64_t recordCount = header.recordCount;
+        const uint64_t* caseTags = reinterpret_cast<const uint64_t*>(section(header.caseTagsOffset, header.caseCount * sizeof(uint64_t), alignof(uint64_t)));
+        if (header.caseCount <= UINT8_MAX + 1)
+        {
+            m_tags8 = section(header.tagsOffset, recordCount, 1);
+        }
+        else
+        {
+            m_tags16 = reinterpret_cast<const uint16_t*>(section(header.tagsOffset, recordCount * sizeof(uint16_t), alignof(uint16_t)));
+        }
+        m_offsets = reinterpret_cast<const uint64_t*>(section(header.offsetsOffset, recordCount * sizeof(uint64_t), alignof(uint64_t)));
+        m_caseStarts = reinterpret_cast<const uint64_t*>(section(header.caseIndexOffset, (header.caseCount + 1 + recordCount) * sizeof(uint64_t), alignof(uint64_t)));
+        m_caseRecords = m_caseStarts + header.caseCount + 1;
+        
+        for (size_t i = 0; i < CaseCount; i++)
+        {
+            m_archiveCases[i] = details::NoArchiveCase;
+        }
+        
+        m_caseMap.resize(header.caseCount);
+        for (uint32_t archiveCase = 0; archiveCase < header.caseCount; archiveCase++)
+        {
+            if (m_caseStarts[archiveCase] > m_caseStarts[archiveCase + 1] || m_caseStarts[archiveCase + 1] > recordCount)
+            {
+                details::RaiseError<std::runtime_error>("Archive case index is corrupted.");
+            }
+            
+            // Archived cases must be known, but reader may know more cases than archive has.
+            const uint64_t tag = caseTags[archiveCase];
+            const size_t readerCase = details::CaseIndexOfTag<ConcreteAsEnum>(tag);
+            if (readerCase == CaseCount)
+            {
+                details::RaiseError<std::invalid_argument>("Unknown case tag.");
+            }
+            
+            m_caseMap[archiveCase] = static_cast<uint16_t>(readerCase);
+            m_archiveCases[readerCase] = archiveCase;
+        }
+    }
+    ASENUM_CATCH_ALL
+    {
+        ::munmap(const_cast<uint8_t*>(m_data), m_size);
+        ASENUM_RETHROW;
+    }
+}
+
+template <typename ConcreteAsEnum>
+asenum::ArchiveReader<ConcreteAsEnum>::~ArchiveReader()
+{
+    ::munmap(const_cast<uint8_t*>(m_data), m_size);
+}
+
+template <typename ConcreteAsEnum>
+size_t asenum::ArchiveReader<ConcreteAsEnum>::size() const
+{
+    return static_cast<size_t>(header().recordCount);
+}
+
+template <typename ConcreteAsEnum>
+asenum::ArchiveRecord<ConcreteAsEnum> asenum::ArchiveReader<ConcreteAsEnum>::operator[](const size_t index) const
+{
+    return ArchiveRecord<ConcreteAsEnum>(*this, index);
+}
+
+template <typename ConcreteAsEnum>
+template <typename asenum::ArchiveReader<ConcreteAsEnum>::Enum Case>
+size_t asenum::ArchiveReader<ConcreteAsEnum>::count() const
+{
+    const uint32_t archiveCase = m_archiveCases[details::AsEnumAccess::caseIndex<ConcreteAsEnum, Case>()];
+    return archiveCase == details::NoArchiveCase ? 0 : static_cast<size_t>(m_caseStarts[archiveCase + 1] - m_caseStarts[archiveCase]);
+}
+
+template <typename ConcreteAsEnum>
+template <typename asenum::ArchiveReader<ConcreteAsEnum>::Enum Case, typename Handler>
+void asenum::ArchiveReader<ConcreteAsEnum>::forEach(const Handler& handler) const
+{
+    static constexpr size_t I = details::AsEnumAccess::caseIndex<ConcreteAsEnum, Case>();
+    const uint32_t archiveCase = m_archiveCases[I];
+    if (archiveCase == details::NoArchiveCase)
+    {
+        return;
+    }
+    
+    const uint64_t recordCount = header().recordCount;
+    const uint64_t end = m_caseStarts[archiveCase + 1];
+    for (uint64_t i = m_caseStarts[archiveCase]; i < end; i++)
+    {
+        const uint64_t record = m_caseRecords[i];
+        if (record >= recordCount || this->archiveCase(static_cast<size_t>(record)) != archiveCase)
+        {
+            details::RaiseError<std::runtime_error>("Archive case index is corrupted.");
+        }
+        
+        callPayload<I>(payloadOffset<I>(static_cast<size_t>(record)), handler);
+    }
+}
+
+// ArchiveReader private
+
+template <typename ConcreteAsEnum>
+const asenum::details::ArchiveHeader& asenum::ArchiveReader<ConcreteAsEnum>::header() const
+{
+    return *reinterpret_cast<const details::ArchiveHeader*>(m_data);
+}
+
+template <typename ConcreteAsEnum>
+const uint8_t* asenum::ArchiveReader<ConcreteAsEnum>::section(const uint64_t offset, const uint64_t size, const size_t alignment) const
+{
+    if (offset % alignment != 0 || offset > m_size || size > m_size - offset)
+    {
+        details::RaiseError<std::runtime_error>("Archive section is out of file bounds.");
+    }
+    
+    return m_data + offset;
+}
+
+template <typename ConcreteAsEnum>
+size_t asenum::ArchiveReader<ConcreteAsEnum>::archiveCase(const size_t index) const
+{
+    const size_t archiveCase = m_tags8 ? m_tags8[index] : m_tags16[index];
+    if (archiveCase >= m_caseMap.size())
+    {
+        details::RaiseError<std::runtime_error>("Archive record is corrupted.");
+    }
+    
+    return archiveCase;
+}
+
+template <typename ConcreteAsEnum>
+size_t asenum::ArchiveReader<ConcreteAsEnum>::caseIndex(const size_t index) const
+{
+    return m_caseMap[archiveCase(index)];
+}
+
+template <typename ConcreteAsEnum>
+template <size_t I>
+uint64_t asenum::ArchiveReader<ConcreteAsEnum>::payloadOffset(const size_t index) const
+{
+    const uint64_t offset = m_offsets[index];
+    if (!details::ArchivePayload<UnderlyingType<ConcreteAsEnum::AllCases[I]>>::fits(offset, header().dataEnd))
+    {
+        details::RaiseError<std::runtime_error>("Archive record is corrupted.");
+    }
+    
+    return offset;
+}
+
+template <typename ConcreteAsEnum>
+template <size_t I, typename Handler>
+void asenum::ArchiveReader<ConcreteAsEnum>::callPayload(const uint64_t offset, const Handler& handler) const
+{
+    using T = UnderlyingType<ConcreteAsEnum::AllCases[I]>;
+    callPayload<T>(offset, handler, static_cast<const T*>(nullptr), std::integral_constant<bool, details::ArchivePayload<T>::ZeroCopy>());
+}
+
+template <typename ConcreteAsEnum>
+template <typename T, typename Handler>
+void asenum::ArchiveReader<ConcreteAsEnum>::callPayload(uint64_t, const Handler& handler, const void*, std::true_type) const
+{
+    handler();
+}
+
+template <typename ConcreteAsEnum>
+template <typename T, typename Handler>
+void asenum::ArchiveReader<ConcreteAsEnum>::callPayload(const uint64_t offset, const Handler& handler, const T*, std::true_type) const
+{
+    handler(*reinterpret_cast<const T*>(m_data + offset));
+}
+
+template <typename ConcreteAsEnum>
+template <typename T, typename Handler>
+void asenum::ArchiveReader<ConcreteAsEnum>::callPayload(const uint64_t offset, const Handler& handler, const T*, std::false_type) const
+{
+    BinaryReader reader(m_data + offset, static_cast<size_t>(header().dataEnd - offset));
+    const T value = reader.readValue<T>();
+    handler(value);
+}
+
+// Private details
+
+inline uint64_t asenum::details::AlignOffset(const uint64_t offset, const size_t alignment)
+{
+    return (offset + alignment - 1) / alignment * alignment;
+}
+
+template <typename T>
+bool asenum::details::ArchivePayload<T>::fits(const uint64_t offset, const uint64_t dataEnd)
+{
+    if (offset < sizeof(ArchiveHeader) || offset > dataEnd)
+    {
+        return false;
+    }
+    
+    // Encoded payloads are bounded by 'dataEnd' while decoding.
+    return !ZeroCopy || (offset % alignof(T) == 0 && sizeof(T) <= dataEnd - offset);
+}
+
+inline bool asenum::details::ArchivePayload<void>::fits(uint64_t, uint64_t)
+{
+    return true;
+}
+
+template <typename ConcreteAsEnum, size_t... I>
+ConcreteAsEnum asenum::details::ArchiveTable<ConcreteAsEnum, asenum::details::IndexSequence<I...>>::decode(const Reader& reader, const size_t index)
+{
+    using CaseFunction = ConcreteAsEnum (*)(const Reader&, size_t);
+    static constexpr CaseFunction s_table[] = { &decodeCase<I>... };
+    
+    return s_table[reader.caseIndex(index)](reader, index);
+}
+
+template <typename ConcreteAsEnum, size_t... I>
+template <size_t Index>
+ConcreteAsEnum asenum::details::ArchiveTable<ConcreteAsEnum, asenum::details::IndexSequence<I...>>::decodeCase(const Reader& reader, const size_t index)
+{
+    using Enum = typename ConcreteAsEnum::Enum;
+    static constexpr Enum Case = ConcreteAsEnum::AllCases[Index];
+    using UT = typename ConcreteAsEnum::template UnderlyingType<Case>;
+    
+    return decodeValue<Enum, Case>(reader, reader.template payloadOffset<Index>(index), static_cast<const UT*>(nullptr));
+}
+
+template <typename ConcreteAsEnum, size_t... I>
+template <typename Enum, Enum Case>
+ConcreteAsEnum asenum::details::ArchiveTable<ConcreteAsEnum, asenum::details::IndexSequence<I...>>::decodeValue(const Reader&, uint64_t, const void*)
+{
+    return ConcreteAsEnum::template create<Case>();
+}
+
+template <typename ConcreteAsEnum, size_t... I>
+template <typename Enum, Enum Case, typename T>
+ConcreteAsEnum asenum::details::ArchiveTable<ConcreteAsEnum, asenum::details::IndexSequence<I...>>::decodeValue(const Reader& reader, const uint64_t offset, const T*)
+{
+    MapResult<ConcreteAsEnum> result;
+    reader.template callPayload<AsEnumAccess::caseIndex<ConcreteAsEnum, Case>()>(offset, [&result] (const T& value) {
+        result.emplace(ConcreteAsEnum::template create<Case>(value));
+    });
+    
+    return result.take();
+}
+
+template <typename ConcreteAsEnum, size_t... I>
+template <size_t Index>
+void asenum::details::ArchiveTable<ConcreteAsEnum, asenum::details::IndexSequence<I...>>::visit(const void*) const
+{
+    writer.addRecord(static_cast<uint16_t>(Index), writer.m_offset);
+}
+
+template <typename ConcreteAsEnum, size_t... I>
+template <size_t Index, typename T>
+void asenum::details::ArchiveTable<ConcreteAsEnum, asenum::details::IndexSequence<I...>>::visit(const T* value) const
+{
+    const uint64_t offset = writePayload(*value, std::integral_constant<bool, ArchivePayload<T>::ZeroCopy>());
+    writer.addRecord(static_cast<uint16_t>(Index), offset);
+}
+
+template <typename ConcreteAsEnum, size_t... I>
+template <typename T>
+uint64_t asenum::details::ArchiveTable<ConcreteAsEnum, asenum::details::IndexSequence<I...>>::writePayload(const T& value, std::true_type) const
+{
+    const uint64_t offset = AlignOffset(writer.m_offset, alignof(T));
+    writer.writeRaw(&value, sizeof(T), alignof(T));
+    
+    return offset;
+}
+
+template <typename ConcreteAsEnum, size_t... I>
+template <typename T>
+uint64_t asenum::details::ArchiveTable<ConcreteAsEnum, asenum::details::IndexSequence<I...>>::writePayload(const T& value, std::false_type) const
+{
+    std::vector<uint8_t> bytes;
+    BinaryWriter encoder(bytes);
+    encoder.writeValue(value);
+    
+    const uint64_t offset = writer.m_offset;
+    writer.writeRaw(bytes.data(), bytes.size(), 1);
+    
+    return offset;
+}
@@ -24,8 +24,56 @@
 
 #pragma once
 
-#include <memory>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <exception>
 #include <functional>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#if __cplusplus > 201402L
+#include <memory_resource>
+#endif
+
+#if defined(ASENUM_INSTRUMENTATION)
+#include <asenum/instrumentation.h>
+#endif
+
+/// Defined if compiler supports exceptions (i.e. not built with '-fno-exceptions').
+#if defined(__cpp_exceptions) || defined(__EXCEPTIONS) || defined(_CPPUNWIND)
+#define ASENUM_HAS_EXCEPTIONS
+#endif
+
+/**
+ Errors are reported with exceptions unless exceptions are disabled by compiler (e.g. '-fno-exceptions') or 'ASENUM_NO_EXCEPTIONS' is defined.
+ Without exceptions errors are passed to 'ASENUM_ERROR_HANDLER(message)' if it is defined,
+ otherwise message is printed to stderr. Then 'std::terminate' is called: handler never returns to failed operation.
+ */
+#if !defined(ASENUM_NO_EXCEPTIONS) && !defined(ASENUM_HAS_EXCEPTIONS)
+#define ASENUM_NO_EXCEPTIONS
+#endif
+
+/**
+ Cleanup on failure: 'ASENUM_TRY { ... } ASENUM_CATCH_ALL { cleanup; ASENUM_RETHROW; }'.
+ Depends only on compiler support: with 'ASENUM_NO_EXCEPTIONS' user code may still throw, so cleanup is kept.
+ Without exceptions cleanup block is never entered.
+ */
+#if defined(ASENUM_HAS_EXCEPTIONS)
+#define ASENUM_TRY try
+#define ASENUM_CATCH_ALL catch (...)
+#define ASENUM_RETHROW throw
+#else
+#define ASENUM_TRY if (true)
+#define ASENUM_CATCH_ALL else
+#define ASENUM_RETHROW
+#endif
 
 namespace asenum
 {
@@ -44,6 +92,45 @@ namespace asenum
     using Case = Case11<decltype(T_Code), T_Code, T>;
 #endif
     
+    /// Ownership policy: heap values are shared between copies with atomic reference counter (as 'std::shared_ptr').
+    struct SharedOwnership {};
+    
+    /**
+     Ownership policy: heap values are shared between copies with plain (non-atomic) reference counter.
+     Copies of the same value must not be created or destroyed concurrently: use it for values that never leave single thread.
+     */
+    struct LocalSharedOwnership {};
+    
+    /// Ownership policy: each copy owns its heap value. Copying AsEnum copies the value, no reference counter is kept.
+    struct DeepCopyOwnership {};
+    
+    /**
+     Storage policy of AsEnum.
+     Values that fit into 'T_Size' bytes with alignment not greater than 'T_Align' (and are nothrow-movable)
+     are stored directly inside AsEnum instance. Bigger values are allocated on the heap with 'T_Allocator'
+     (see also 'PooledStorage' from 'asenum/pool.h') and are owned according to 'T_Ownership' policy.
+     */
+    template <size_t T_Size, size_t T_Align = alignof(void*), template <typename T> class T_Allocator = std::allocator, typename T_Ownership = SharedOwnership>
+    struct InlineStorage
+    {
+        static constexpr size_t Size = T_Size;
+        static constexpr size_t Align = T_Align;
+        
+        template <typename T>
+        using Allocator = T_Allocator<T>;
+        
+        using Ownership = T_Ownership;
+    };
+    
+    /// Default storage policy: values up to two pointers in size are stored inline.
+    using DefaultStorage = InlineStorage<2 * sizeof(void*)>;
+    
+    /// Same as 'DefaultStorage', but heap values are shared with non-atomic reference counter (see 'LocalSharedOwnership').
+    using LocalStorage = InlineStorage<2 * sizeof(void*), alignof(void*), std::allocator, LocalSharedOwnership>;
+    
+    /// Same as 'DefaultStorage', but heap values are copied together with AsEnum (see 'DeepCopyOwnership').
+    using DeepCopyStorage = InlineStorage<2 * sizeof(void*), alignof(void*), std::allocator, DeepCopyOwnership>;
+    
     namespace details
     {
         template <typename... Cases>
@@ -52,22 +139,62 @@ namespace asenum
         template <typename Enum, Enum Value, typename... Cases>
         struct UnderlyingTypeResolver;
         
+        template <typename Enum, Enum Value, typename... Cases>
+        struct CaseIndexResolver;
+        
+        template <size_t I>
+        struct InPlaceIndex {};
+        
+        template <size_t I>
+        struct AllocatedIndex {};
+        
+        template <typename Storage, typename... Cases>
+        class PayloadStorage;
+        
+        template <typename Storage, typename... Cases>
+        class LiteralPayloadStorage;
+        
+        template <typename Storage, typename... Cases>
+        struct PayloadStorageSelector;
+        
+        template <typename ConcreteAsEnum>
+        class ConsumingAsEnum;
+        
         template <typename Enum, typename ConcreteAsEnum, Enum... types>
         class AsSwitch;
         
         template <typename T, typename Enum, typename ConcreteAsEnum, Enum... Types>
         class AsMap;
         
-        template <typename ConcreteAsEnum, template <typename T> class Cmp, typename... T_Cases>
+        template <typename T, typename Enum, typename ConcreteAsEnum>
+        class AsMapRoot;
+        
+        template <typename T, typename ConcreteAsEnum, typename... Handlers>
+        class AsVisit;
+        
+        template <typename T, typename ConcreteAsEnum>
+        class AsVisitRoot;
+        
+        struct NoDefaultHandler;
+        
+        template <typename T, typename ConcreteAsEnum, typename Default, typename... Handlers>
+        class AsMatcher;
+        
+        template <typename ConcreteAsEnum, typename Indices>
         struct Comparator;
+        
+        template <typename ConcreteAsEnum, typename Indices>
+        struct Hasher;
+        
+        struct AsEnumAccess;
     }
     
     /**
-     Associated Enum type.
-     AsEnum should be specialized with single or multiple 'Case/Case11' types that represent associations.
+     Associated Enum type with custom storage policy (see 'InlineStorage').
+     Usually you want to use 'AsEnum' alias.
      */
-    template <typename... T_Cases>
-    class AsEnum
+    template <typename T_Storage, typename... T_Cases>
+    class BasicAsEnum
     {
         static_assert(sizeof...(T_Cases) > 0, "Failed to instantiate AsEnum with no cases.");
         
@@ -82,6 +209,27 @@ namespace asenum
         /// Array of all cases associated with concrete AsEnum.
         static constexpr Enum AllCases[] = { T_Cases::Code... };
         
+        /**
+         Position of enum value in 'AllCases' resolved in constant time:
+         by offset if values of cases are sequential or with perfect hash generated at compile time otherwise.
+         
+         @return Index of case or number of cases if 'value' is not a case of AsEnum.
+         */
+        static constexpr size_t indexOf(Enum value);
+        
+        /**
+         Same as 'indexOf', but rejects unknown values. Use it for untrusted (e.g. received from network) values.
+         
+         @throws std::invalid_argument exception if 'value' is not a case of AsEnum.
+         */
+        static size_t checkedIndexOf(Enum value);
+        
+        /**
+         @return Enum case at position 'index' of 'AllCases'.
+         @throws std::out_of_range exception if 'index' is not less than number of cases.
+         */
+        static constexpr Enum fromIndex(size_t index);
+        
         /**
          Creates AsEnum instance of specific case.
          
@@ -89,7 +237,7 @@ namespace asenum
          @return AsEnum instance holding value of specified case.
          */
         template <Enum Case, typename U = typename std::enable_if<!std::is_same<UnderlyingType<Case>, void>::value>::type>
-        static AsEnum create(UnderlyingType<Case> value) { return createImpl<Case, UnderlyingType<Case>>(std::move(value)); }
+        static constexpr BasicAsEnum create(UnderlyingType<Case> value) { return createImpl<Case, UnderlyingType<Case>>(std::move(value)); }
         
         /**
          Creates AsEnum instance of specific case with 'void' associated type.
@@ -97,18 +245,47 @@ namespace asenum
          @return AsEnum instance holding value of specified case.
          */
         template <Enum Case, typename T = typename std::enable_if<std::is_same<UnderlyingType<Case>, void>::value>::type>
-        static AsEnum create();
+        static constexpr BasicAsEnum create();
+        
+        /**
+         Creates AsEnum instance of specific case. If value is stored on the heap (see 'storesInline'),
+         it is allocated with 'allocator' together with its reference counter in single block.
+         Values stored inline don't allocate and ignore the allocator.
+         
+         @warning Memory behind the allocator (e.g. arena or pool) must outlive all copies of created AsEnum.
+         @param allocator Allocator satisfying standard Allocator requirements.
+         @param value Value related to specified enum case.
+         @return AsEnum instance holding value of specified case.
+         */
+        template <Enum Case, typename Allocator, typename U = typename std::enable_if<!std::is_same<UnderlyingType<Case>, void>::value>::type>
+        static BasicAsEnum create(std::allocator_arg_t, const Allocator& allocator, UnderlyingType<Case> value);
+        
+#if __cplusplus > 201402L
+        /**
+         Creates AsEnum instance of specific case allocating heap value from memory resource.
+         Shortcut for 'create<Case>(std::allocator_arg, std::pmr::polymorphic_allocator<char>(resource), value)'.
+         
+         @warning 'resource' must outlive all copies of created AsEnum.
+         */
+        template <Enum Case, typename U = typename std::enable_if<!std::is_same<UnderlyingType<Case>, void>::value>::type>
+        static BasicAsEnum create(std::pmr::memory_resource* resource, UnderlyingType<Case> value);
+#endif
         
         /**
          @return enum case of current instance of AsEnum.
          */
-        Enum enumCase() const;
+        constexpr Enum enumCase() const;
+        
+        /**
+         @return Position of enum case of current instance of AsEnum in 'AllCases'. Doesn't require lookup.
+         */
+        constexpr size_t caseIndex() const;
         
         /**
          @return Boolean indicates if current instance of AsEnum holds exactly specified case...or not.
          */
         template <Enum Case>
-        bool isCase() const;
+        constexpr bool isCase() const;
         
         /**
          Unwraps AsEnum and provides access to value that it holds.
@@ -118,7 +295,7 @@ namespace asenum
          @return Boolean indicates if handler has been called.
          */
         template <Enum Case, typename Handler>
-        bool ifCase(const Handler& handler) const;
+        constexpr bool ifCase(const Handler& handler) const;
         
         /**
          @warning Usually ou don't want to use this method. Use safer 'ifCase'.
@@ -128,65 +305,255 @@ namespace asenum
          @throws std::invalid_argument exception if 'Case' doesn't correspond to stored case.
          */
         template <Enum Case, typename R = UnderlyingType<Case>, typename = typename std::enable_if<!std::is_same<R, void>::value>::type>
-        const R& forceAsCase() const;
+        constexpr const R& forceAsCase() const;
+        
+        /**
+         Same as 'forceAsCase', but doesn't check stored case (checked by 'assert' in debug builds only).
+         Use it when case is already known, e.g. checked by 'isCase' or 'caseIndex'.
+         
+         @return Const reference to underlying value. Behavior is undefined if 'Case' doesn't correspond to stored case.
+         */
+        template <Enum Case, typename R = UnderlyingType<Case>, typename = typename std::enable_if<!std::is_same<R, void>::value>::type>
+        constexpr const R& getUnchecked() const noexcept;
+        
+        /**
+         Unwraps AsEnum taking ownership of value that it holds.
+         Value is moved out if it is owned exclusively by this instance (always true for values stored inline),
+         otherwise (heap value shared with other copies) it is copied.
+         
+         @return Underlying value.
+         @throws std::invalid_argument exception if 'Case' doesn't correspond to stored case.
+         */
+        template <Enum Case, typename R = UnderlyingType<Case>, typename = typename std::enable_if<!std::is_same<R, void>::value>::type>
+        R take() &&;
+        
+        /**
+         Provides mutable access to value of specified case.
+         Value is changed in place if it is owned exclusively by this instance (always true for values stored inline),
+         otherwise (heap value shared with other copies) it is copied first, so other copies never observe the change.
+         The copy is allocated with allocator of storage policy.
+         
+         @param handler Function or functional object of signature void(UnderlyingType<Case>&).
+         @return Boolean indicates if handler has been called.
+         */
+        template <Enum Case, typename Handler, typename R = UnderlyingType<Case>, typename = typename std::enable_if<!std::is_same<R, void>::value>::type>
+        bool modify(const Handler& handler);
+        
+        /**
+         Replaces value of this instance with value of specified case constructed from 'args'.
+         If instance holds exclusively owned value of the same case, the value is assigned in place,
+         so its storage (heap block, capacity of strings and containers) is reused.
+         */
+        template <Enum Case, typename... Args>
+        void replace(Args&&... args);
+        
+        /**
+         @return Boolean indicates if value of specified case is stored directly inside AsEnum instance
+         or allocated on the heap. Depends on storage policy.
+         */
+        template <Enum Case>
+        static constexpr bool storesInline();
         
         /**
          Performs switch-like action allowing to wotk with values of different cases.
          */
-        details::AsSwitch<Enum, AsEnum<T_Cases...>> doSwitch() const;
+        details::AsSwitch<Enum, BasicAsEnum> doSwitch() const&;
+        
+        /**
+         Same as 'doSwitch', but consumes AsEnum: handlers may accept value as 'UnderlyingType<Case>&&'.
+         Value is moved if it is owned exclusively by this instance, otherwise handler receives its copy.
+         */
+        details::AsSwitch<Enum, details::ConsumingAsEnum<BasicAsEnum>> doSwitch() &&;
         
         /**
          Maps (converts) AsEnum value depends on stored case to type 'T'.
          */
         template <typename T>
-        details::AsMap<T, Enum, AsEnum<T_Cases...>> doMap() const;
+        details::AsMapRoot<T, Enum, BasicAsEnum> doMap() const&;
+        
+        /**
+         Same as 'doMap', but consumes AsEnum: handlers may accept value as 'UnderlyingType<Case>&&'.
+         Value is moved if it is owned exclusively by this instance, otherwise handler receives its copy.
+         */
+        template <typename T>
+        details::AsMapRoot<T, Enum, details::ConsumingAsEnum<BasicAsEnum>> doMap() &&;
+        
+        /**
+         Performs switch-like (or map-like if 'T' is not void) action with constant-time dispatch.
+         Unlike 'doSwitch', handlers are collected first and the stored case is then resolved
+         through compile-time table indexed by case, so cost of dispatch doesn't depend on number of cases.
+         Handlers for all cases or terminating 'ifDefault' are required.
+         Chain is returned by rvalue reference to 'root', argument that must be left default:
+         it lives until the end of full-expression, so chain can't be stored (even with C++17 copy elision).
+         */
+        template <typename T = void>
+        details::AsVisit<T, BasicAsEnum>&& match(details::AsVisitRoot<T, BasicAsEnum>&& root = details::AsVisitRoot<T, BasicAsEnum>()) const;
+        
+        /**
+         Creates reusable matcher: handlers are collected once (by value) and then applied
+         to any number of AsEnum instances with constant-time dispatch: 'matcher(asEnum)'.
+         Handlers for all cases or 'ifDefault' are required to call the matcher.
+         */
+        template <typename T = void>
+        static details::AsMatcher<T, BasicAsEnum, details::NoDefaultHandler> matcher();
+        
+        /**
+         Three-way comparison of two AsEnum instances.
+         1) First compare types. If types differ, applies comparison to type itself;
+         2) If types equal, compares underlying values using 'operator<' only.
+         Values that are not ordered by 'operator<' (e.g. NaN) are equivalent to any value.
+         @return Negative if this instance is less than other, zero if equivalent, positive otherwise.
+         */
+        constexpr int compare(const BasicAsEnum& other) const;
         
         /**
          Check for equality two AsEnum instances. Instance meant to be equal if and only if
          1) Underlying enum cases are equal;
-         2) Underlying values are equal.
+         2) Underlying values are equal (using 'operator==').
          */
-        bool operator==(const AsEnum& other) const;
-        bool operator!=(const AsEnum& other) const;
+        constexpr bool operator==(const BasicAsEnum& other) const;
+        constexpr bool operator!=(const BasicAsEnum& other) const;
         
         /**
-         Compares two AsEnum instances.
-         1) First compare types. If types differ, applies comparison to type itself;
-         2) If types equal, compares underlying values.
+         Compares two AsEnum instances. Like 'compare', first compares types, but values of the same type
+         are compared with the same operator of underlying type (e.g. 'operator<=' for '<=').
          */
-        bool operator<(const AsEnum& other) const;
-        bool operator<=(const AsEnum& other) const;
-        bool operator>(const AsEnum& other) const;
-        bool operator>=(const AsEnum& other) const;
+        constexpr bool operator<(const BasicAsEnum& other) const;
+        constexpr bool operator<=(const BasicAsEnum& other) const;
+        constexpr bool operator>(const BasicAsEnum& other) const;
+        constexpr bool operator>=(const BasicAsEnum& other) const;
         
     private:
-        AsEnum(const Enum relatedCase, std::shared_ptr<void> value);
+        template <Enum Case>
+        using CaseIndex = details::CaseIndexResolver<Enum, Case, T_Cases...>;
+        
+        template <size_t Index, typename... Args>
+        constexpr explicit BasicAsEnum(details::InPlaceIndex<Index>, Args&&... args);
+        
+        template <size_t Index, typename Allocator, typename... Args>
+        constexpr BasicAsEnum(details::AllocatedIndex<Index>, const Allocator& allocator, Args&&... args);
         
         template <Enum Case, typename T>
-        static AsEnum createImpl(T&& value);
+        static constexpr BasicAsEnum createImpl(T&& value);
         
+        /// Calls 'handler' with the value. Returns 'true', so it can be used inside constant expressions.
         template <typename T, typename Handler>
-        static typename std::enable_if<std::is_same<T, void>::value, void>::type call(const void*, const Handler& handler);
+        static constexpr typename std::enable_if<std::is_same<T, void>::value, bool>::type call(const T*, const Handler& handler);
         
         template <typename T, typename Handler>
-        static typename std::enable_if<!std::is_same<T, void>::value, void>::type call(const void* value, const Handler& handler);
+        static constexpr typename std::enable_if<!std::is_same<T, void>::value, bool>::type call(const T* value, const Handler& handler);
         
     private:
-        Enum m_enumCase;
-        std::shared_ptr<void> m_value;
+        friend struct details::AsEnumAccess;
+        
+        typename details::PayloadStorageSelector<T_Storage, T_Cases...>::type m_storage;
     };
     
+    /**
+     Associated Enum type.
+     AsEnum should be specialized with single or multiple 'Case/Case11' types that represent associations.
+     */
+    template <typename... T_Cases>
+    using AsEnum = BasicAsEnum<DefaultStorage, T_Cases...>;
+    
+    /// AsEnum for values that never cross threads: copies don't touch atomic reference counters (see 'LocalSharedOwnership').
+    template <typename... T_Cases>
+    using LocalAsEnum = BasicAsEnum<LocalStorage, T_Cases...>;
+    
+    /// AsEnum with value semantics: each copy owns its heap value (see 'DeepCopyOwnership').
+    template <typename... T_Cases>
+    using DeepCopyAsEnum = BasicAsEnum<DeepCopyStorage, T_Cases...>;
+    
     
     // Private details
     
     namespace details
     {
+        /**
+         Throws 'Exception' with 'message'.
+         With 'ASENUM_NO_EXCEPTIONS' calls 'ASENUM_ERROR_HANDLER(message)' (or prints message) and terminates.
+         */
+        template <typename Exception>
+        [[noreturn]] void RaiseError(const char* message);
+        
         template <typename T, size_t N>
         constexpr size_t ArraySize(T (&array)[N])
         {
             return sizeof(array) / sizeof(array[0]);
         }
         
+        template <size_t... I>
+        struct IndexSequence {};
+        
+        template <typename First, typename Second>
+        struct ConcatIndexSequence;
+        
+        template <size_t... I, size_t... J>
+        struct ConcatIndexSequence<IndexSequence<I...>, IndexSequence<J...>>
+        {
+            using type = IndexSequence<I..., (sizeof...(I) + J)...>;
+        };
+        
+        /// 'IndexSequence<0, ..., N - 1>'. Built from halves, so instantiation depth is logarithmic.
+        template <size_t N>
+        struct MakeIndexSequence : ConcatIndexSequence<typename MakeIndexSequence<N / 2>::type, typename MakeIndexSequence<N - N / 2>::type> {};
+        
+        template <>
+        struct MakeIndexSequence<0>
+        {
+            using type = IndexSequence<>;
+        };
+        
+        template <>
+        struct MakeIndexSequence<1>
+        {
+            using type = IndexSequence<0>;
+        };
+        
+        template <bool... Values>
+        struct BoolPack {};
+        
+        /// True if all 'Values' are true. Pack is compared with itself shifted by one, without recursion over it.
+        template <bool... Values>
+        struct AllOf : std::is_same<BoolPack<true, Values...>, BoolPack<Values..., true>> {};
+        
+        constexpr size_t FirstTrueMerge(const size_t left, const size_t middle, const size_t right)
+        {
+            return left != middle ? left : right;
+        }
+        
+        /// Index of the first true flag in [begin, end) or 'end' if there is no such. Recursion depth is logarithmic.
+        constexpr size_t FirstTrue(const bool* flags, const size_t begin, const size_t end)
+        {
+            return end - begin <= 1
+            ? (begin != end && flags[begin] ? begin : end)
+            : FirstTrueMerge(FirstTrue(flags, begin, begin + (end - begin) / 2), begin + (end - begin) / 2, FirstTrue(flags, begin + (end - begin) / 2, end));
+        }
+        
+        /// Uninitialized in-place storage for result of 'doMap'. Doesn't require 'T' to be default-constructible.
+        template <typename T>
+        class MapResult
+        {
+        public:
+            MapResult() = default;
+            MapResult(MapResult&& other);
+            MapResult(const MapResult&) = delete;
+            MapResult& operator=(const MapResult&) = delete;
+            ~MapResult();
+            
+            bool hasValue() const;
+            
+            template <typename... Args>
+            void emplace(Args&&... args);
+            
+            /// Moves stored value out, leaving storage empty.
+            T take();
+            
+        private:
+            typename std::aligned_storage<sizeof(T), alignof(T)>::type m_buffer;
+            bool m_hasValue = false;
+        };
+        
         template <bool IsFinalStep, typename T, typename Enum, typename ConcreteAsEnum, Enum... Types>
         struct AsMapResultMaker;
         
@@ -195,14 +562,12 @@ namespace asenum
         {
             template <Enum T_type>
             static T
-            makeResult(const ConcreteAsEnum&, std::unique_ptr<T> result)
+            makeResult(const ConcreteAsEnum&, MapResult<T>& result)
             {
-                if (!result)
-                {
-                    throw std::logic_error("Unexpected empty result. Please contact author and attach an example.");
-                }
+                // chain has handler for every case, so one of them has produced result
+                assert(result.hasValue());
                 
-                return std::move(*result);
+                return result.take();
             }
         };
         
@@ -211,20 +576,64 @@ namespace asenum
         {
             template <Enum T_type>
             static AsMap<T, Enum, ConcreteAsEnum, T_type, Types...>
-            makeResult(const ConcreteAsEnum& asEnum, std::unique_ptr<T> result)
+            makeResult(const ConcreteAsEnum& asEnum, MapResult<T>& result)
             {
                 return AsMap<T, Enum, ConcreteAsEnum, T_type, Types...>(asEnum, std::move(result));
             }
         };
         
         
-        template<typename Enum, Enum...> struct Contains;
-        template<typename Enum, Enum T_type> struct Contains<Enum, T_type> { static const bool value = false; };
-        template<typename Enum, Enum T_type1, Enum T_type2> struct Contains<Enum, T_type1, T_type2> { static const bool value = T_type1 == T_type2; };
+        /// True if 'Value' is one of 'Values'. Single instantiation regardless of number of values.
+        template <typename Enum, Enum Value, Enum... Values>
+        struct Contains : std::integral_constant<bool, !AllOf<(Value != Values)...>::value> {};
+        
+        
+        /// Describes how AsSwitch and AsMap hold AsEnum and pass its values to handlers.
+        template <typename ConcreteAsEnum>
+        struct AsEnumTraits
+        {
+            using Holder = const ConcreteAsEnum&;
+            
+            template <typename T>
+            using Payload = const T&;
+        };
         
-        template<typename Enum, Enum T_type1, Enum T_type2, Enum... T_other>
-        struct Contains<Enum, T_type1, T_type2, T_other...> { static const bool value = Contains<Enum, T_type1, T_type2>::value || Contains<Enum, T_type2, T_other...>::value; };
+        template <typename ConcreteAsEnum>
+        struct AsEnumTraits<ConsumingAsEnum<ConcreteAsEnum>>
+        {
+            using Holder = ConsumingAsEnum<ConcreteAsEnum>;
+            
+            template <typename T>
+            using Payload = T&&;
+        };
         
+        /// Adapts AsEnum being consumed to AsSwitch and AsMap: handlers receive values as rvalues.
+        template <typename ConcreteAsEnum>
+        class ConsumingAsEnum
+        {
+        public:
+            using Enum = typename ConcreteAsEnum::Enum;
+            
+            template <Enum C>
+            using UnderlyingType = typename ConcreteAsEnum::template UnderlyingType<C>;
+            
+            static constexpr const Enum (&AllCases)[ArraySize(ConcreteAsEnum::AllCases)] = ConcreteAsEnum::AllCases;
+            
+            explicit ConsumingAsEnum(ConcreteAsEnum& asEnum);
+            
+            template <Enum Case, typename Handler>
+            bool ifCase(const Handler& handler) const;
+            
+        private:
+            template <size_t I, typename Handler>
+            void consume(const Handler& handler, std::true_type) const;
+            
+            template <size_t I, typename Handler>
+            void consume(const Handler& handler, std::false_type) const;
+            
+        private:
+            ConcreteAsEnum& m_asEnum;
+        };
         
         template <typename Enum, typename ConcreteAsEnum, Enum... Types>
         class AsSwitch
@@ -240,7 +649,7 @@ namespace asenum
             void ifDefault(const Handler& handler);
             
         private:
-            const ConcreteAsEnum& m_asEnum;
+            typename AsEnumTraits<ConcreteAsEnum>::Holder m_asEnum;
             bool m_handled;
         };
         
@@ -259,16 +668,15 @@ namespace asenum
             using UnderlyingType = typename ConcreteAsEnum::template UnderlyingType<T_type>;
             
         public:
-            AsMap(const ConcreteAsEnum& asEnum, std::unique_ptr<T> result);
-            explicit AsMap(const ConcreteAsEnum& asEnum);
+            AsMap(const ConcreteAsEnum& asEnum, MapResult<T>&& result);
             
             template <Enum T_type, typename Handler, typename UT = UnderlyingType<T_type>>
             static typename std::enable_if<std::is_same<UT, void>::value, void>::type
-            ifCaseCall(const ConcreteAsEnum& asEnum, std::unique_ptr<T>& result, const Handler& handler);
+            ifCaseCall(const ConcreteAsEnum& asEnum, MapResult<T>& result, const Handler& handler);
             
             template <Enum T_type, typename Handler, typename UT = UnderlyingType<T_type>>
             static typename std::enable_if<!std::is_same<UT, void>::value, void>::type
-            ifCaseCall(const ConcreteAsEnum& asEnum, std::unique_ptr<T>& result, const Handler& handler);
+            ifCaseCall(const ConcreteAsEnum& asEnum, MapResult<T>& result, const Handler& handler);
             
             template <typename Handler>
             T ifDefault(const Handler& handler);
@@ -276,209 +684,1691 @@ namespace asenum
             template <Enum T_type, typename CaseHandler, typename R = IfCaseResult<T_type>>
             R ifCase(const CaseHandler& handler);
             
-        private:
-            std::unique_ptr<T> m_result;
-            const ConcreteAsEnum& m_asEnum;
+        protected:
+            /// Each step owns the result, so stored step stays valid. Result is moved to the next step only after it is produced.
+            MapResult<T> m_result;
+            typename AsEnumTraits<ConcreteAsEnum>::Holder m_asEnum;
         };
         
-        template <typename Case>
-        struct CaseSet<Case>
+        /// First link of 'doMap' chain: starts with empty result.
+        template <typename T, typename Enum, typename ConcreteAsEnum>
+        class AsMapRoot : public AsMap<T, Enum, ConcreteAsEnum>
         {
-            using Enum = typename Case::Enum;
-            static_assert(std::is_enum<Enum>::value, "All cases must relate to enum values.");
+        public:
+            explicit AsMapRoot(const ConcreteAsEnum& asEnum);
         };
         
-        template <typename Case, typename... Cases>
-        struct CaseSet<Case, Cases...>
+        /// Gives library internals access to AsEnum storage.
+        struct AsEnumAccess
         {
-            static_assert(std::is_same<typename CaseSet<Case>::Enum, typename CaseSet<Cases...>::Enum>::value, "All cases must relate to the same enum.");
-            using Enum = typename CaseSet<Cases...>::Enum;
+            template <typename ConcreteAsEnum>
+            static constexpr auto storage(const ConcreteAsEnum& asEnum) -> decltype((asEnum.m_storage));
+            
+            template <typename ConcreteAsEnum>
+            static auto mutableStorage(ConcreteAsEnum& asEnum) -> decltype((asEnum.m_storage));
+            
+            template <typename ConcreteAsEnum, typename ConcreteAsEnum::Enum Case>
+            static constexpr size_t caseIndex();
+            
+            /**
+             Calls 'visitor.template visit<I>(payload)' where 'I' is index of case stored in AsEnum
+             and 'payload' is pointer to stored value ('const void*' for 'void' cases).
+             Stored case is resolved with single lookup in table of per-case functions.
+             */
+            template <typename T, typename ConcreteAsEnum, typename Visitor>
+            static T visit(const ConcreteAsEnum& asEnum, const Visitor& visitor);
         };
         
+        template <typename T, typename ConcreteAsEnum, typename Visitor, typename Indices>
+        struct VisitTable;
         
-        template <typename Enum, Enum Value, typename... Cases>
-        struct UnderlyingTypeResolver
+        template <typename T, typename ConcreteAsEnum, typename Visitor, size_t... I>
+        struct VisitTable<T, ConcreteAsEnum, Visitor, IndexSequence<I...>>
         {
-            template <Enum E, typename Default, typename... Args>
-            struct TypeMap;
-            
-            template <Enum E, typename Default, typename T, typename... Args>
-            struct TypeMap<E, Default, T, Args...>
-            {
-                using type = typename std::conditional<E == T::Code, typename T::Type, typename TypeMap<E, Default, Args...>::type>::type;
-            };
-            
-            template <Enum E, typename Default, typename T>
-            struct TypeMap<E, Default, T>
-            {
-                using type = typename std::conditional<E == T::Code, typename T::Type, Default>::type;
-            };
+            template <size_t Index>
+            static T visitCase(const ConcreteAsEnum& asEnum, const Visitor& visitor);
             
+            static T visit(const ConcreteAsEnum& asEnum, const Visitor& visitor);
+        };
+        
+        template <typename T>
+        struct HandlerInvoker
+        {
+            template <typename Handler>
+            static T invoke(const Handler& handler, const void*);
             
-            struct Dummy {};
-            using type = typename TypeMap<Value, Dummy, Cases...>::type;
-            static_assert(!std::is_same<type, Dummy>::value, "Type is missing for specified enum value.");
+            template <typename Handler, typename UT>
+            static T invoke(const Handler& handler, const UT* value);
         };
         
+        /// Type-erased reference to handler collected by AsVisit.
+        union HandlerSlot
+        {
+            const void* object;
+            void (*function)();
+        };
         
-        template <typename ConcreteAsEnum, template <typename T> class Cmp, typename T_Case>
-        struct Comparator<ConcreteAsEnum, Cmp, T_Case>
+        template <typename Handler, bool IsFunction = std::is_function<Handler>::value>
+        struct HandlerSlotAccess
         {
-            template <typename T>
-            static typename std::enable_if<!std::is_same<T, void>::value, bool>::type
-            compare(const ConcreteAsEnum& first, const ConcreteAsEnum& second);
+            static HandlerSlot store(const Handler& handler) { HandlerSlot slot; slot.object = &handler; return slot; }
+            static const Handler& load(const HandlerSlot& slot) { return *static_cast<const Handler*>(slot.object); }
+        };
+        
+        template <typename Handler>
+        struct HandlerSlotAccess<Handler, true>
+        {
+            static HandlerSlot store(Handler& handler) { HandlerSlot slot; slot.function = reinterpret_cast<void (*)()>(&handler); return slot; }
+            static Handler& load(const HandlerSlot& slot) { return *reinterpret_cast<Handler*>(slot.function); }
+        };
+        
+        template <typename Enum, Enum T_Code, typename T_Handler>
+        struct VisitHandler
+        {
+            static constexpr Enum Code = T_Code;
+            using Handler = T_Handler;
+        };
+        
+        /// Visitor that calls handler collected by AsVisit for stored case or default handler if there is no such.
+        template <typename T, typename ConcreteAsEnum, typename Default, typename... Handlers>
+        class AsVisitCaller
+        {
+        public:
+            AsVisitCaller(const HandlerSlot* slots, const Default& defaultHandler);
             
-            template <typename T>
-            static typename std::enable_if<std::is_same<T, void>::value, bool>::type
-            compare(const ConcreteAsEnum& first, const ConcreteAsEnum& second);
+            template <size_t I, typename UT>
+            T visit(const UT* value) const;
+            
+        private:
+            template <size_t I, size_t Position, typename UT>
+            T call(const UT* value, std::true_type) const;
             
-            static bool compare(const ConcreteAsEnum& first, const ConcreteAsEnum& second, bool& finalVerdict);
-            static bool compare(const ConcreteAsEnum& first, const ConcreteAsEnum& second);
+            template <size_t I, size_t Position, typename UT>
+            T call(const UT* value, std::false_type) const;
+            
+        private:
+            const HandlerSlot* m_slots;
+            const Default& m_default;
         };
         
-        template <typename ConcreteAsEnum, template <typename T> class Cmp, typename T_Case, typename... T_Cases>
-        struct Comparator<ConcreteAsEnum, Cmp, T_Case, T_Cases...>
+        template <bool IsFinalStep, typename T, typename ConcreteAsEnum, typename... Handlers>
+        struct AsVisitResultMaker;
+        
+        /// Placeholder of the next step after the last 'ifCase' of 'match' chain, which returns result instead.
+        struct AsVisitFinalStep {};
+        
+        template <typename T, typename ConcreteAsEnum, typename... Handlers>
+        struct AsVisitResultMaker<true, T, ConcreteAsEnum, Handlers...>
         {
-            static bool compare(const ConcreteAsEnum& first, const ConcreteAsEnum& second);
+            static T makeResult(const ConcreteAsEnum& asEnum, HandlerSlot* slots, AsVisitFinalStep& next);
         };
-    }
-}
-
-
-// AsEnum public
-
-template <typename... T_Cases>
-constexpr typename asenum::AsEnum<T_Cases...>::Enum asenum::AsEnum<T_Cases...>::AllCases[];
-
-template <typename... T_Cases>
-template <typename asenum::AsEnum<T_Cases...>::Enum Case, typename T>
-asenum::AsEnum<T_Cases...> asenum::AsEnum<T_Cases...>::createImpl(T&& value)
-{
-    std::shared_ptr<void> internalValue(new T(std::forward<T>(value)), [] (void* ptr) {
-        if (ptr)
+        
+        template <typename T, typename ConcreteAsEnum, typename... Handlers>
+        struct AsVisitResultMaker<false, T, ConcreteAsEnum, Handlers...>
         {
-            delete reinterpret_cast<T*>(ptr);
-        }
-    });
-    
-    return asenum::AsEnum<T_Cases...>(Case, internalValue);
-}
-
-template <typename... T_Cases>
-template <typename asenum::AsEnum<T_Cases...>::Enum Case, typename T>
-asenum::AsEnum<T_Cases...> asenum::AsEnum<T_Cases...>::create()
-{
-    return asenum::AsEnum<T_Cases...>(Case, nullptr);
-}
-
-template <typename... T_Cases>
-typename asenum::AsEnum<T_Cases...>::Enum asenum::AsEnum<T_Cases...>::enumCase() const
-{
-    return m_enumCase;
-}
-
-template <typename... T_Cases>
-template <typename asenum::AsEnum<T_Cases...>::Enum Case>
-bool asenum::AsEnum<T_Cases...>::isCase() const
-{
-    return Case == m_enumCase;
-}
-
-template <typename... T_Cases>
-template <typename asenum::AsEnum<T_Cases...>::Enum Case, typename Handler>
-bool asenum::AsEnum<T_Cases...>::ifCase(const Handler& handler) const
-{
-    const bool isType = isCase<Case>();
-    if (isType)
-    {
-        call<UnderlyingType<Case>>(m_value.get(), handler);
-    }
-    
-    return isType;
+            static AsVisit<T, ConcreteAsEnum, Handlers...>&& makeResult(const ConcreteAsEnum& asEnum, HandlerSlot* slots, AsVisit<T, ConcreteAsEnum, Handlers...>& next);
+        };
+        
+        /**
+         Collects handlers of 'match' into table of slots indexed by case.
+         Each 'ifCase' stores single reference, so building the chain doesn't depend on number of cases.
+         Referenced handlers and AsEnum live only until the end of full-expression, so steps can't be copied, moved or stored:
+         each step is a default argument of the previous one and is passed by rvalue reference, so the chain must be completed
+         as single expression.
+         */
+        template <typename T, typename ConcreteAsEnum, typename... Handlers>
+        class AsVisit
+        {
+            using Enum = typename ConcreteAsEnum::Enum;
+            static constexpr size_t AllCaseCount = ArraySize(ConcreteAsEnum::AllCases);
+            static constexpr size_t CurrentCaseCount = sizeof...(Handlers);
+            static constexpr bool IsPreLastCase = AllCaseCount == CurrentCaseCount + 1;
+            
+            template <Enum T_type, typename CaseHandler>
+            using ResultMaker = AsVisitResultMaker<IsPreLastCase, T, ConcreteAsEnum, Handlers..., VisitHandler<Enum, T_type, CaseHandler>>;
+            
+            template <Enum T_type, typename CaseHandler>
+            using NextStep = typename std::conditional<IsPreLastCase, AsVisitFinalStep, AsVisit<T, ConcreteAsEnum, Handlers..., VisitHandler<Enum, T_type, CaseHandler>>>::type;
+            
+            template <Enum T_type, typename CaseHandler>
+            using IfCaseResult = typename std::conditional<IsPreLastCase, T, NextStep<T_type, CaseHandler>&&>::type;
+            
+            template <typename, typename, typename...>
+            friend class AsVisit;
+            
+            template <bool, typename, typename, typename...>
+            friend struct AsVisitResultMaker;
+            
+        public:
+            AsVisit(const AsVisit&) = delete;
+            AsVisit& operator=(const AsVisit&) = delete;
+            
+            /// @param next Storage of the next step. Must be left default.
+            template <Enum T_type, typename CaseHandler, typename R = IfCaseResult<T_type, CaseHandler>>
+            R ifCase(const CaseHandler& handler, NextStep<T_type, CaseHandler>&& next = NextStep<T_type, CaseHandler>()) &&;
+            
+            template <typename Handler>
+            T ifDefault(const Handler& handler) &&;
+            
+        protected:
+            AsVisit() = default;
+            
+        protected:
+            const ConcreteAsEnum* m_asEnum = nullptr;
+            HandlerSlot* m_slots = nullptr;
+        };
+        
+        struct NoDefaultHandler {};
+        
+        /// Reusable set of per-case handlers. Dispatches AsEnum value to handler of its case in constant time.
+        template <typename T, typename ConcreteAsEnum, typename Default, typename... Handlers>
+        class AsMatcher
+        {
+            using Enum = typename ConcreteAsEnum::Enum;
+            static constexpr size_t AllCaseCount = ArraySize(ConcreteAsEnum::AllCases);
+            static constexpr bool IsComplete = sizeof...(Handlers) == AllCaseCount || !std::is_same<Default, NoDefaultHandler>::value;
+            
+            template <Enum T_type, typename CaseHandler>
+            using Next = AsMatcher<T, ConcreteAsEnum, Default, Handlers..., VisitHandler<Enum, T_type, typename std::decay<CaseHandler>::type>>;
+            
+        public:
+            AsMatcher() = default;
+            AsMatcher(std::tuple<typename Handlers::Handler...> handlers, Default defaultHandler);
+            
+            template <Enum T_type, typename CaseHandler>
+            Next<T_type, CaseHandler> ifCase(const CaseHandler& handler) const;
+            
+            template <typename Handler>
+            AsMatcher<T, ConcreteAsEnum, typename std::decay<Handler>::type, Handlers...> ifDefault(const Handler& handler) const;
+            
+            T operator()(const ConcreteAsEnum& asEnum) const;
+            
+            template <size_t I, typename UT>
+            T visit(const UT* value) const;
+            
+        private:
+            template <size_t Position, typename UT>
+            T call(const UT* value, std::true_type) const;
+            
+            template <size_t Position, typename UT>
+            T call(const UT* value, std::false_type) const;
+            
+        private:
+            std::tuple<typename Handlers::Handler...> m_handlers;
+            Default m_default;
+        };
+        
+        /// First link of 'match' chain. Owns slots for handlers of all cases.
+        template <typename T, typename ConcreteAsEnum>
+        class AsVisitRoot : public AsVisit<T, ConcreteAsEnum>
+        {
+            template <typename, typename...>
+            friend class asenum::BasicAsEnum;
+            
+        private:
+            AsVisitRoot();
+            
+            AsVisit<T, ConcreteAsEnum>&& bind(const ConcreteAsEnum& asEnum);
+            
+        private:
+            HandlerSlot m_storage[ArraySize(ConcreteAsEnum::AllCases)];
+        };
+        
+        template <typename Case, typename... Cases>
+        struct CaseSet<Case, Cases...>
+        {
+            using Enum = typename Case::Enum;
+            static_assert(std::is_enum<Enum>::value, "All cases must relate to enum values.");
+            static_assert(AllOf<std::is_same<Enum, typename Cases::Enum>::value...>::value, "All cases must relate to the same enum.");
+        };
+        
+        /**
+         Position of the first of 'Cases' (any types with static 'Code') which 'Code' equals to 'Value'. Equals to number of cases if not found.
+         Codes are compared by single pack expansion, so lookup doesn't instantiate templates per case.
+         */
+        template <typename Enum, Enum Value, typename... Cases>
+        struct CasePosition
+        {
+            static constexpr bool Matches[] = { (Value == Cases::Code)..., false };
+            static constexpr size_t value = FirstTrue(Matches, 0, sizeof...(Cases));
+        };
+        
+        template <typename Enum, Enum Value, typename... Cases>
+        struct CaseIndexResolver
+        {
+            static constexpr size_t value = CasePosition<Enum, Value, Cases...>::value;
+            static_assert(value < sizeof...(Cases), "Index is missing for specified enum value.");
+        };
+        
+        template <size_t I, typename T>
+        struct IndexedType
+        {
+            using type = T;
+        };
+        
+        template <typename Indices, typename... Types>
+        struct IndexedTypes;
+        
+        template <size_t... I, typename... Types>
+        struct IndexedTypes<IndexSequence<I...>, Types...> : IndexedType<I, Types>... {};
+        
+        /// Never called: selects base of 'IndexedTypes' by index during overload resolution.
+        template <size_t I, typename T>
+        IndexedType<I, T> SelectIndexedType(const IndexedType<I, T>&);
+        
+        /// I-th of 'Cases' (any types). Resolved through 'IndexedTypes' that is instantiated once per pack.
+        template <size_t I, typename... Cases>
+        struct CaseAt
+        {
+            using type = typename decltype(SelectIndexedType<I>(std::declval<IndexedTypes<typename MakeIndexSequence<sizeof...(Cases)>::type, Cases...>>()))::type;
+        };
+        
+        template <typename Enum, Enum Value, typename... Cases>
+        struct UnderlyingTypeResolver
+        {
+            static constexpr size_t Position = CasePosition<Enum, Value, Cases...>::value;
+            static_assert(Position < sizeof...(Cases), "Type is missing for specified enum value.");
+            
+            using type = typename CaseAt<(Position < sizeof...(Cases) ? Position : 0), Cases...>::type::Type;
+        };
+        
+        
+        constexpr size_t Max(const size_t first, const size_t second)
+        {
+            return first > second ? first : second;
+        }
+        
+        /// Distance that keeps data written by different threads in separate cache lines.
+        constexpr size_t CacheLineSize = 64;
+        
+        /// Order-preserving conversion of enum value to unsigned key: signed values are shifted by 2^63.
+        template <typename Enum>
+        constexpr uint64_t CaseKey(const Enum value)
+        {
+            return std::is_signed<typename std::underlying_type<Enum>::type>::value
+            ? static_cast<uint64_t>(static_cast<int64_t>(value)) ^ (uint64_t(1) << 63)
+            : static_cast<uint64_t>(value);
+        }
+        
+        /// Keys of enum values of all cases in declaration order.
+        template <typename Enum, Enum... Codes>
+        struct CaseKeys
+        {
+            static constexpr size_t Count = sizeof...(Codes);
+            static constexpr uint64_t Values[] = { CaseKey(Codes)... };
+            
+            using Index = typename std::conditional<Count <= UINT8_MAX, uint8_t, uint16_t>::type;
+        };
+        
+        /// True if keys in [begin, end) go one by one starting from the first key.
+        constexpr bool IsSequential(const uint64_t* keys, const size_t begin, const size_t end)
+        {
+            return end - begin <= 1
+            ? (begin == end || keys[begin] == keys[0] + begin)
+            : IsSequential(keys, begin, begin + (end - begin) / 2) && IsSequential(keys, begin + (end - begin) / 2, end);
+        }
+        
+        /// Dense mapping: values of cases are sequential, so index is direct offset from the first one.
+        template <typename Keys>
+        struct SequentialCaseMapping
+        {
+            static constexpr size_t indexOf(const uint64_t key)
+            {
+                return key - Keys::Values[0] < Keys::Count ? static_cast<size_t>(key - Keys::Values[0]) : Keys::Count;
+            }
+        };
+        
+        /// Final mixing step of MurmurHash3.
+        constexpr uint64_t MixBits(const uint64_t value)
+        {
+            return value ^ (value >> 33);
+        }
+        
+        constexpr uint64_t Fmix64(const uint64_t value)
+        {
+            return MixBits(MixBits(MixBits(value) * 0xff51afd7ed558ccdULL) * 0xc4ceb9fe1a85ec53ULL);
+        }
+        
+        constexpr uint64_t HashMultiplier(const size_t seed)
+        {
+            return Fmix64(seed + 0x9e3779b97f4a7c15ULL) | 1;
+        }
+        
+        /// Multiplicative hash of 'key' into table of '2^bits' slots.
+        constexpr size_t HashSlot(const uint64_t key, const uint64_t multiplier, const size_t bits)
+        {
+            return bits == 0 ? 0 : static_cast<size_t>((key * multiplier) >> (64 - bits));
+        }
+        
+        constexpr size_t CeilLog2(const size_t value, const size_t bits = 0)
+        {
+            return (size_t(1) << bits) >= value ? bits : CeilLog2(value, bits + 1);
+        }
+        
+        /// Number of buckets of the first level of perfect hash of 'count' keys.
+        constexpr size_t BucketCount(const size_t count)
+        {
+            return size_t(1) << CeilLog2(count);
+        }
+        
+        constexpr size_t PopCount(const uint64_t value)
+        {
+            return value == 0 ? 0 : 1 + PopCount(value & (value - 1));
+        }
+        
+        /// Number of keys taken from run 'A' among the first 'q' keys of stable merge of runs 'A' and 'B' (see 'MergedAt').
+        constexpr size_t MergeRank(const size_t* buckets, const size_t* a, const size_t* b, const size_t q, const size_t low, const size_t high)
+        {
+            return low >= high ? low
+            : buckets[a[(low + high) / 2]] <= buckets[b[q - (low + high) / 2 - 1]]
+            ? MergeRank(buckets, a, b, q, (low + high) / 2 + 1, high)
+            : MergeRank(buckets, a, b, q, low, (low + high) / 2);
+        }
+        
+        constexpr size_t MergeTake(const size_t* buckets, const size_t* a, const size_t aSize, const size_t* b, const size_t bSize, const size_t q, const size_t rank)
+        {
+            return rank < aSize && (q - rank >= bSize || buckets[a[rank]] <= buckets[b[q - rank]]) ? a[rank] : b[q - rank];
+        }
+        
+        constexpr size_t MergeRuns(const size_t* buckets, const size_t* a, const size_t aSize, const size_t* b, const size_t bSize, const size_t q)
+        {
+            return MergeTake(buckets, a, aSize, b, bSize, q, MergeRank(buckets, a, b, q, q > bSize ? q - bSize : 0, q < aSize ? q : aSize));
+        }
+        
+        constexpr size_t Min(const size_t first, const size_t second)
+        {
+            return first < second ? first : second;
+        }
+        
+        /**
+         Key at 'position' of 'order' sorted by bucket in runs of '2 * width' keys, given 'order' sorted in runs of 'width' keys.
+         Each position is resolved independently by binary search of merge path, so sorting takes O(N log^2 N) constexpr steps.
+         */
+        constexpr size_t MergedAt(const size_t* buckets, const size_t* order, const size_t count, const size_t width, const size_t position)
+        {
+            return MergeRuns(buckets,
+                             order + position / (2 * width) * (2 * width), Min(width, count - position / (2 * width) * (2 * width)),
+                             order + Min(position / (2 * width) * (2 * width) + width, count), Min(width, count - Min(position / (2 * width) * (2 * width) + width, count)),
+                             position % (2 * width));
+        }
+        
+        /// Position of the first key in 'order' sorted by bucket which bucket is not less than 'bucket'.
+        constexpr size_t LowerBound(const size_t* buckets, const size_t* order, const size_t begin, const size_t end, const size_t bucket)
+        {
+            return begin >= end ? begin
+            : buckets[order[(begin + end) / 2]] < bucket
+            ? LowerBound(buckets, order, (begin + end) / 2 + 1, end, bucket)
+            : LowerBound(buckets, order, begin, (begin + end) / 2, bucket);
+        }
+        
+        constexpr size_t MaxDifference(const size_t* values, const size_t begin, const size_t end)
+        {
+            return end - begin <= 1
+            ? (begin != end ? values[begin + 1] - values[begin] : 0)
+            : Max(MaxDifference(values, begin, begin + (end - begin) / 2), MaxDifference(values, begin + (end - begin) / 2, end));
+        }
+        
+        /// Bit mask of second level slots occupied by 'members' of the bucket. Requires at most 64 slots.
+        constexpr uint64_t SlotMask(const uint64_t* keys, const size_t* members, const size_t load, const uint64_t multiplier, const size_t bits)
+        {
+            return load == 0 ? 0 : (uint64_t(1) << HashSlot(keys[members[load - 1]], multiplier, bits)) | SlotMask(keys, members, load - 1, multiplier, bits);
+        }
+        
+        /// Index of key among 'members' of the bucket that is placed into 'slot' of second level or 'count' if slot is empty.
+        constexpr size_t SlotKey(const uint64_t* keys, const size_t* members, const size_t load, const uint64_t multiplier, const size_t bits, const size_t slot, const size_t count)
+        {
+            return load == 0 ? count
+            : HashSlot(keys[members[load - 1]], multiplier, bits) == slot ? members[load - 1]
+            : SlotKey(keys, members, load - 1, multiplier, bits, slot, count);
+        }
+        
+        constexpr size_t MaxBucketLoad = 8;
+        constexpr size_t MaxHashSeed = 64;
+        
+        /// Multiplier that places 'members' of the bucket into distinct slots of second level or 0 if there is no such.
+        constexpr uint64_t FindSlotMultiplier(const uint64_t* keys, const size_t* members, const size_t load, const size_t bits, const size_t seed = 0)
+        {
+            return seed == MaxHashSeed ? 0
+            : PopCount(SlotMask(keys, members, load, HashMultiplier(seed), bits)) == load ? HashMultiplier(seed)
+            : FindSlotMultiplier(keys, members, load, bits, seed + 1);
+        }
+        
+        /// First level of perfect hash: bucket of each key with multiplier generated from 'Seed'.
+        template <typename Keys, size_t Seed, typename Indices = typename MakeIndexSequence<Keys::Count>::type>
+        struct PerfectHashLevel;
+        
+        template <typename Keys, size_t Seed, size_t... I>
+        struct PerfectHashLevel<Keys, Seed, IndexSequence<I...>>
+        {
+            static constexpr uint64_t Multiplier = HashMultiplier(Seed);
+            static constexpr size_t Bits = CeilLog2(Keys::Count);
+            static constexpr size_t Buckets[] = { HashSlot(Keys::Values[I], Multiplier, Bits)... };
+        };
+        
+        /// Indices of keys sorted by bucket in runs of 'Width' keys. Merge sort has logarithmic instantiation depth.
+        template <typename Keys, size_t Seed, size_t Width, typename Indices = typename MakeIndexSequence<Keys::Count>::type>
+        struct PerfectHashOrder;
+        
+        template <typename Keys, size_t Seed, size_t... I>
+        struct PerfectHashOrder<Keys, Seed, 1, IndexSequence<I...>>
+        {
+            static constexpr size_t Values[] = { I... };
+        };
+        
+        template <typename Keys, size_t Seed, size_t Width, size_t... I>
+        struct PerfectHashOrder<Keys, Seed, Width, IndexSequence<I...>>
+        {
+            static constexpr size_t Values[] = { MergedAt(PerfectHashLevel<Keys, Seed>::Buckets, PerfectHashOrder<Keys, Seed, Width / 2>::Values, Keys::Count, Width / 2, I)... };
+        };
+        
+        /// Buckets of the first level as ranges of keys sorted by bucket.
+        template <typename Keys, size_t Seed, typename Buckets = typename MakeIndexSequence<BucketCount(Keys::Count) + 1>::type>
+        struct PerfectHashBuckets;
+        
+        template <typename Keys, size_t Seed, size_t... B>
+        struct PerfectHashBuckets<Keys, Seed, IndexSequence<B...>>
+        {
+            using Order = PerfectHashOrder<Keys, Seed, BucketCount(Keys::Count)>;
+            static constexpr size_t Starts[] = { LowerBound(PerfectHashLevel<Keys, Seed>::Buckets, Order::Values, 0, Keys::Count, B)... };
+            
+            /// True if all buckets are small enough to build second level.
+            static constexpr bool Fits = MaxDifference(Starts, 0, sizeof...(B) - 1) <= MaxBucketLoad;
+        };
+        
+        /// Number of keys in 'bucket' given 'starts' of buckets in keys sorted by bucket.
+        constexpr size_t BucketLoad(const size_t* starts, const size_t bucket)
+        {
+            return starts[bucket + 1] - starts[bucket];
+        }
+        
+        /// Number of bits of second level table of bucket with 'load' keys: at least 'load^2' slots.
+        constexpr size_t SlotBits(const size_t load)
+        {
+            return CeilLog2(load <= MaxBucketLoad ? load * load : 1);
+        }
+        
+        /// True if every non-empty bucket (range of 'starts') has multiplier of second level.
+        constexpr bool AllPlaced(const size_t* starts, const uint64_t* multipliers, const size_t begin, const size_t end)
+        {
+            return end - begin <= 1
+            ? (begin == end || BucketLoad(starts, begin) == 0 || multipliers[begin] != 0)
+            : AllPlaced(starts, multipliers, begin, begin + (end - begin) / 2) && AllPlaced(starts, multipliers, begin + (end - begin) / 2, end);
+        }
+        
+        /// Position of the first of sorted 'values' in [begin, end) that is greater than 'value'.
+        constexpr size_t UpperBound(const size_t* values, const size_t begin, const size_t end, const size_t value)
+        {
+            return begin >= end ? begin
+            : values[(begin + end) / 2] <= value
+            ? UpperBound(values, (begin + end) / 2 + 1, end, value)
+            : UpperBound(values, begin, (begin + end) / 2, value);
+        }
+        
+        /// Index of key placed into 'slot' of flat table of second level or 'count' if slot is empty.
+        constexpr size_t TableSlotKey(const uint64_t* keys, const size_t count, const size_t* order, const size_t* starts,
+                                      const uint64_t* multipliers, const size_t* bits, const size_t* ends, const size_t bucket, const size_t slot)
+        {
+            return SlotKey(keys, order + starts[bucket], BucketLoad(starts, bucket), multipliers[bucket], bits[bucket], slot - (ends[bucket] - (size_t(1) << bits[bucket])), count);
+        }
+        
+        /// Second level of perfect hash: keys of each bucket are placed into own table of at least 'Load^2' slots without collisions.
+        template <typename Keys, size_t Seed, typename Buckets = typename MakeIndexSequence<BucketCount(Keys::Count)>::type>
+        struct PerfectHashSecondLevel;
+        
+        template <typename Keys, size_t Seed, size_t... B>
+        struct PerfectHashSecondLevel<Keys, Seed, IndexSequence<B...>>
+        {
+            using Buckets = PerfectHashBuckets<Keys, Seed>;
+            
+            static constexpr size_t Bits[] = { SlotBits(BucketLoad(Buckets::Starts, B))... };
+            static constexpr uint64_t Multipliers[] = { (BucketLoad(Buckets::Starts, B) <= MaxBucketLoad
+                                                         ? FindSlotMultiplier(Keys::Values, Buckets::Order::Values + Buckets::Starts[B], BucketLoad(Buckets::Starts, B), Bits[B])
+                                                         : 0)... };
+            static_assert(AllPlaced(Buckets::Starts, Multipliers, 0, sizeof...(B)), "Failed to build perfect hash of enum values. Are they unique?");
+            
+            /// Number of slots of each bucket.
+            static constexpr size_t Sizes[] = { size_t(1) << Bits[B]... };
+        };
+        
+        /// Inclusive prefix sums of 'Source::Sizes' by doubling 'Step', so instantiation depth is logarithmic.
+        template <typename Source, size_t Step, typename Indices = typename MakeIndexSequence<ArraySize(Source::Sizes)>::type>
+        struct PrefixSums;
+        
+        template <typename Source, size_t... I>
+        struct PrefixSums<Source, 0, IndexSequence<I...>>
+        {
+            static constexpr size_t Values[] = { Source::Sizes[I]... };
+        };
+        
+        template <typename Source, size_t Step, size_t... I>
+        struct PrefixSums<Source, Step, IndexSequence<I...>>
+        {
+            using Previous = PrefixSums<Source, Step / 2>;
+            static constexpr size_t Values[] = { Previous::Values[I] + (I >= Step ? Previous::Values[I - Step] : 0)... };
+        };
+        
+        /// Two-level perfect hash: first level splits keys into buckets, each bucket has collision-free table of key indices.
+        template <typename Keys, size_t Seed,
+        typename Buckets = typename MakeIndexSequence<BucketCount(Keys::Count)>::type,
+        typename Slots = typename MakeIndexSequence<PrefixSums<PerfectHashSecondLevel<Keys, Seed>, BucketCount(Keys::Count) / 2>::Values[BucketCount(Keys::Count) - 1]>::type>
+        struct PerfectHashTable;
+        
+        template <typename Keys, size_t Seed, size_t... B, size_t... S>
+        struct PerfectHashTable<Keys, Seed, IndexSequence<B...>, IndexSequence<S...>>
+        {
+            using Level = PerfectHashLevel<Keys, Seed>;
+            using Buckets = PerfectHashBuckets<Keys, Seed>;
+            using SecondLevel = PerfectHashSecondLevel<Keys, Seed>;
+            using Ends = PrefixSums<SecondLevel, sizeof...(B) / 2>;
+            
+            struct Entry
+            {
+                size_t offset;
+                uint64_t multiplier;
+                size_t bits;
+            };
+            
+            static constexpr Entry Entries[] = { { Ends::Values[B] - SecondLevel::Sizes[B], SecondLevel::Multipliers[B], SecondLevel::Bits[B] }... };
+            
+            /// Index of key placed into each slot of second level or number of keys for empty slots.
+            static constexpr typename Keys::Index Slots[] = {
+                static_cast<typename Keys::Index>(TableSlotKey(Keys::Values, Keys::Count, Buckets::Order::Values, Buckets::Starts,
+                                                               SecondLevel::Multipliers, SecondLevel::Bits, Ends::Values,
+                                                               UpperBound(Ends::Values, 0, sizeof...(B), S), S))...
+            };
+            
+            static constexpr size_t indexOf(const uint64_t key)
+            {
+                return verify(key, Entries[HashSlot(key, Level::Multiplier, Level::Bits)]);
+            }
+            
+        private:
+            static constexpr size_t verify(const uint64_t key, const Entry& entry)
+            {
+                return verify(key, Slots[entry.offset + HashSlot(key, entry.multiplier, entry.bits)]);
+            }
+            
+            static constexpr size_t verify(const uint64_t key, const size_t index)
+            {
+                return index < Keys::Count && Keys::Values[index] == key ? index : Keys::Count;
+            }
+        };
+        
+        /// Tries seeds of the first level until all buckets are small enough.
+        template <typename Keys, size_t Seed = 0>
+        struct PerfectHashSearch : std::conditional<PerfectHashBuckets<Keys, Seed>::Fits || Seed + 1 == MaxHashSeed, PerfectHashTable<Keys, Seed>, PerfectHashSearch<Keys, Seed + 1>>::type {};
+        
+        /// Maps key of enum value to its position in 'Keys' in constant time. Position equals to number of keys for unknown values.
+        template <typename Keys>
+        struct CaseMapping : std::conditional<IsSequential(Keys::Values, 0, Keys::Count), SequentialCaseMapping<Keys>, PerfectHashSearch<Keys>>::type {};
+        
+        
+        /// Payloads that fit into storage policy bounds are placed inside AsEnum. 'void' never requires storage.
+        template <typename T, typename Storage>
+        struct IsInlinePayload : std::integral_constant<bool, sizeof(T) <= Storage::Size && alignof(T) <= Storage::Align && std::is_nothrow_move_constructible<T>::value> {};
+        
+        template <typename Storage>
+        struct IsInlinePayload<void, Storage> : std::true_type {};
+        
+        /// Payloads that allow AsEnum to be literal type: stored inline and trivially copyable (so trivially destructible too).
+        template <typename T, typename Storage>
+        struct IsLiteralPayload : std::integral_constant<bool, IsInlinePayload<T, Storage>::value && std::is_trivially_copyable<T>::value> {};
+        
+        template <typename Storage>
+        struct IsLiteralPayload<void, Storage> : std::true_type {};
+        
+        /// Holds payload of single case inside 'LiteralUnion'.
+        template <typename T>
+        struct LiteralSlot
+        {
+            template <typename... Args>
+            constexpr explicit LiteralSlot(Args&&... args) : value(std::forward<Args>(args)...) {}
+            
+            constexpr const T* get() const { return &value; }
+            
+            T value;
+        };
+        
+        template <>
+        struct LiteralSlot<void>
+        {
+            constexpr const void* get() const { return nullptr; }
+        };
+        
+        /**
+         Union of payloads of 'Cases' in range [Begin, End).
+         Built as balanced tree of halves, so each payload is reached in logarithmic instantiation depth.
+         */
+        template <typename Cases, size_t Begin, size_t End, bool Leaf = (End - Begin == 1)>
+        union LiteralUnion;
+        
+        template <typename... Cases, size_t Begin, size_t End>
+        union LiteralUnion<CaseSet<Cases...>, Begin, End, true>
+        {
+            template <typename... Args>
+            constexpr explicit LiteralUnion(InPlaceIndex<Begin>, Args&&... args) : slot(std::forward<Args>(args)...) {}
+            
+            constexpr const typename CaseAt<Begin, Cases...>::type::Type* get(InPlaceIndex<Begin>) const { return slot.get(); }
+            
+            LiteralSlot<typename CaseAt<Begin, Cases...>::type::Type> slot;
+        };
+        
+        template <typename... Cases, size_t Begin, size_t End>
+        union LiteralUnion<CaseSet<Cases...>, Begin, End, false>
+        {
+            template <size_t I, typename... Args>
+            constexpr explicit LiteralUnion(InPlaceIndex<I> index, Args&&... args)
+            : LiteralUnion(std::integral_constant<bool, (I < Begin + (End - Begin) / 2)>(), index, std::forward<Args>(args)...) {}
+            
+            template <size_t I, typename... Args>
+            constexpr LiteralUnion(std::true_type, InPlaceIndex<I> index, Args&&... args) : left(index, std::forward<Args>(args)...) {}
+            
+            template <size_t I, typename... Args>
+            constexpr LiteralUnion(std::false_type, InPlaceIndex<I> index, Args&&... args) : right(index, std::forward<Args>(args)...) {}
+            
+            template <size_t I>
+            constexpr const typename CaseAt<I, Cases...>::type::Type* get(InPlaceIndex<I> index) const
+            {
+                return get(index, std::integral_constant<bool, (I < Begin + (End - Begin) / 2)>());
+            }
+            
+            template <size_t I>
+            constexpr const typename CaseAt<I, Cases...>::type::Type* get(InPlaceIndex<I> index, std::true_type) const { return left.get(index); }
+            
+            template <size_t I>
+            constexpr const typename CaseAt<I, Cases...>::type::Type* get(InPlaceIndex<I> index, std::false_type) const { return right.get(index); }
+            
+            LiteralUnion<CaseSet<Cases...>, Begin, Begin + (End - Begin) / 2> left;
+            LiteralUnion<CaseSet<Cases...>, Begin + (End - Begin) / 2, End> right;
+        };
+        
+        /// Size of payload allocated on the heap. Zero for payloads placed inside AsEnum.
+        template <typename T, typename Storage, bool Inline = IsInlinePayload<T, Storage>::value>
+        struct HeapPayloadSize : std::integral_constant<size_t, 0> {};
+        
+        template <typename T, typename Storage>
+        struct HeapPayloadSize<T, Storage, false> : std::integral_constant<size_t, sizeof(T)> {};
+        
+        /**
+         Assigns payload in place from single argument it is assignable from, so the payload may reuse its resources.
+         @return false if payload can't be assigned (e.g. 'void' or not assignable type): arguments are not touched then.
+         */
+        template <typename T, typename Arg>
+        auto AssignPayload(T* payload, Arg&& arg) -> decltype(*payload = std::forward<Arg>(arg), bool())
+        {
+            *payload = std::forward<Arg>(arg);
+            return true;
+        }
+        
+        /// Assigns payload in place from temporary constructed from 'args'.
+        template <typename T, typename... Args>
+        auto AssignPayload(T* payload, Args&&... args) -> decltype(*payload = T(std::forward<Args>(args)...), bool())
+        {
+            *payload = T(std::forward<Args>(args)...);
+            return true;
+        }
+        
+        template <typename... Args>
+        bool AssignPayload(const void*, Args&&...)
+        {
+            return false;
+        }
+        
+        /// Type-specific operations over raw payload buffer of PayloadStorage.
+        template <typename T, typename Storage, bool Inline = IsInlinePayload<T, Storage>::value>
+        struct PayloadOps;
+        
+        template <typename Storage>
+        struct PayloadOps<void, Storage, true>
+        {
+            static void construct(void*) {}
+            static const void* get(const void*) { return nullptr; }
+            static void* exclusive(void*) { return nullptr; }
+            static void copy(void*, const void*) {}
+            static void move(void*, void*) noexcept {}
+            static void destroy(void*) noexcept {}
+        };
+        
+        template <typename T, typename Storage>
+        struct PayloadOps<T, Storage, true>
+        {
+            template <typename... Args>
+            static void construct(void* buffer, Args&&... args) { new (buffer) T(std::forward<Args>(args)...); }
+            template <typename Allocator, typename... Args>
+            static void allocate(void* buffer, const Allocator&, Args&&... args) { construct(buffer, std::forward<Args>(args)...); }
+            static const T* get(const void* buffer) { return static_cast<const T*>(buffer); }
+            static T* exclusive(void* buffer) { return static_cast<T*>(buffer); }
+            static void copy(void* buffer, const void* other) { new (buffer) T(*get(other)); }
+            static void move(void* buffer, void* other) noexcept { new (buffer) T(std::move(*static_cast<T*>(other))); }
+            static void destroy(void* buffer) noexcept { static_cast<T*>(buffer)->~T(); }
+        };
+        
+        /**
+         Heap value with plain reference counter used by 'LocalSharedOwnership' and 'DeepCopyOwnership'.
+         Allocator the block was created with is erased behind 'release' and 'clone' (see 'AllocatedHeapBlock').
+         */
+        template <typename T>
+        struct HeapBlock
+        {
+            template <typename... Args>
+            explicit HeapBlock(void (*release)(HeapBlock*), HeapBlock* (*clone)(const HeapBlock&), Args&&... args)
+            : value(std::forward<Args>(args)...), references(1), release(release), clone(clone) {}
+            
+            T value;
+            size_t references;
+            
+            /// Destroys the value and frees the block.
+            void (*release)(HeapBlock*);
+            
+            /// @return new block with copy of the value allocated with the same allocator.
+            HeapBlock* (*clone)(const HeapBlock&);
+        };
+        
+        template <typename T, typename Allocator>
+        struct AllocatedHeapBlock : HeapBlock<T>
+        {
+            using BlockAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<AllocatedHeapBlock>;
+            using BlockTraits = std::allocator_traits<BlockAllocator>;
+            
+            template <typename... Args>
+            explicit AllocatedHeapBlock(const BlockAllocator& allocator, Args&&... args)
+            : HeapBlock<T>(&release, &clone, std::forward<Args>(args)...), allocator(allocator) {}
+            
+            template <typename... Args>
+            static HeapBlock<T>* create(const Allocator& allocator, Args&&... args);
+            static void release(HeapBlock<T>* block);
+            static HeapBlock<T>* clone(const HeapBlock<T>& block);
+            
+            BlockAllocator allocator;
+        };
+        
+        /// Operations over handle of heap value owned according to 'Ownership' policy.
+        template <typename T, typename Ownership>
+        struct HeapPayloadOps;
+        
+        template <typename T>
+        struct HeapPayloadOps<T, SharedOwnership>
+        {
+            using Handle = std::shared_ptr<T>;
+            
+            template <typename Allocator, typename... Args>
+            static void allocate(void* buffer, const Allocator& allocator, Args&&... args) { new (buffer) Handle(std::allocate_shared<T>(allocator, std::forward<Args>(args)...)); }
+            static const T* get(const void* buffer) { return static_cast<const Handle*>(buffer)->get(); }
+            static T* exclusive(void* buffer);
+            static void copy(void* buffer, const void* other) { new (buffer) Handle(*static_cast<const Handle*>(other)); }
+            static void move(void* buffer, void* other) noexcept { new (buffer) Handle(std::move(*static_cast<Handle*>(other))); }
+            static void destroy(void* buffer) noexcept { static_cast<Handle*>(buffer)->~Handle(); }
+        };
+        
+        template <typename T>
+        struct HeapPayloadOps<T, LocalSharedOwnership>
+        {
+            using Handle = HeapBlock<T>*;
+            
+            template <typename Allocator, typename... Args>
+            static void allocate(void* buffer, const Allocator& allocator, Args&&... args) { new (buffer) Handle(AllocatedHeapBlock<T, Allocator>::create(allocator, std::forward<Args>(args)...)); }
+            static const T* get(const void* buffer) { const Handle block = *static_cast<const Handle*>(buffer); return block ? &block->value : nullptr; }
+            static T* exclusive(void* buffer) { const Handle block = *static_cast<Handle*>(buffer); return block && block->references == 1 ? &block->value : nullptr; }
+            static void copy(void* buffer, const void* other) { const Handle block = *static_cast<const Handle*>(other); if (block) block->references++; new (buffer) Handle(block); }
+            static void move(void* buffer, void* other) noexcept { new (buffer) Handle(*static_cast<Handle*>(other)); *static_cast<Handle*>(other) = nullptr; }
+            static void destroy(void* buffer) noexcept { const Handle block = *static_cast<Handle*>(buffer); if (block && --block->references == 0) block->release(block); }
+        };
+        
+        template <typename T>
+        struct HeapPayloadOps<T, DeepCopyOwnership>
+        {
+            using Handle = HeapBlock<T>*;
+            
+            template <typename Allocator, typename... Args>
+            static void allocate(void* buffer, const Allocator& allocator, Args&&... args) { new (buffer) Handle(AllocatedHeapBlock<T, Allocator>::create(allocator, std::forward<Args>(args)...)); }
+            static const T* get(const void* buffer) { const Handle block = *static_cast<const Handle*>(buffer); return block ? &block->value : nullptr; }
+            static T* exclusive(void* buffer) { const Handle block = *static_cast<Handle*>(buffer); return block ? &block->value : nullptr; }
+            static void copy(void* buffer, const void* other) { const Handle block = *static_cast<const Handle*>(other); new (buffer) Handle(block ? block->clone(*block) : nullptr); }
+            static void move(void* buffer, void* other) noexcept { new (buffer) Handle(*static_cast<Handle*>(other)); *static_cast<Handle*>(other) = nullptr; }
+            static void destroy(void* buffer) noexcept { const Handle block = *static_cast<Handle*>(buffer); if (block) block->release(block); }
+        };
+        
+        /// Heap payloads whose copies share single value (their copy only bumps reference counter).
+        template <typename T, typename Storage>
+        struct IsSharedPayload : std::integral_constant<bool, !IsInlinePayload<T, Storage>::value && !std::is_same<typename Storage::Ownership, DeepCopyOwnership>::value> {};
+        
+        template <typename T, typename Storage>
+        struct PayloadOps<T, Storage, false> : HeapPayloadOps<T, typename Storage::Ownership>
+        {
+            template <typename... Args>
+            static void construct(void* buffer, Args&&... args) { HeapPayloadOps<T, typename Storage::Ownership>::allocate(buffer, typename Storage::template Allocator<T>(), std::forward<Args>(args)...); }
+        };
+        
+        /**
+         Holds index of stored case and its payload.
+         Payload is either placed into internal buffer or referenced through shared heap handle.
+         Copy, move and destruction are dispatched through per-case table.
+         */
+        template <typename Storage, typename... Cases>
+        class PayloadStorage
+        {
+            using Index = typename std::conditional<sizeof...(Cases) <= UINT8_MAX, uint8_t, uint16_t>::type;
+            static_assert(sizeof...(Cases) <= UINT16_MAX, "Too many cases.");
+            
+            struct VTable
+            {
+                void (*copy)(void*, const void*);
+                void (*move)(void*, void*);
+                void (*destroy)(void*);
+                bool shared;
+            };
+            
+            static constexpr VTable s_vtable[] = { { &PayloadOps<typename Cases::Type, Storage>::copy, &PayloadOps<typename Cases::Type, Storage>::move, &PayloadOps<typename Cases::Type, Storage>::destroy, IsSharedPayload<typename Cases::Type, Storage>::value }... };
+            
+            static constexpr size_t BufferSize = Max(Storage::Size, sizeof(std::shared_ptr<void>));
+            static constexpr size_t BufferAlign = Max(Storage::Align, alignof(std::shared_ptr<void>));
+            
+        public:
+            template <size_t I>
+            using Type = typename CaseAt<I, Cases...>::type::Type;
+            
+            template <size_t I, typename... Args>
+            explicit PayloadStorage(InPlaceIndex<I>, Args&&... args);
+            
+            template <size_t I, typename Allocator, typename... Args>
+            PayloadStorage(AllocatedIndex<I>, const Allocator& allocator, Args&&... args);
+            
+            PayloadStorage(const PayloadStorage& other);
+            PayloadStorage(PayloadStorage&& other) noexcept;
+            PayloadStorage& operator=(const PayloadStorage& other);
+            PayloadStorage& operator=(PayloadStorage&& other) noexcept;
+            ~PayloadStorage();
+            
+            size_t index() const;
+            
+            template <size_t I>
+            const Type<I>* get() const;
+            
+            /// Moves payload out if it is owned exclusively by this storage, otherwise copies it.
+            template <size_t I>
+            Type<I> take();
+            
+            /// Calls 'handler(Type<I>&&)' with payload if it is owned exclusively by this storage, otherwise with its copy.
+            template <size_t I, typename Handler>
+            void consume(const Handler& handler);
+            
+            /// @return mutable payload if it is owned exclusively by this storage, nullptr otherwise.
+            template <size_t I>
+            Type<I>* exclusive();
+            
+            /// @return mutable payload. Heap payload shared with other storages is replaced with its copy first.
+            template <size_t I>
+            Type<I>* unshare();
+            
+        private:
+            Index m_index;
+            typename std::aligned_storage<BufferSize, BufferAlign>::type m_buffer;
+        };
+        
+        /**
+         Holds index of stored case and union of payloads. Used instead of 'PayloadStorage' when all payloads are literal
+         (see 'IsLiteralPayload'): storage is trivially copyable and destructible, so AsEnum is literal type
+         that can be created and inspected in constant expressions.
+         */
+        template <typename Storage, typename... Cases>
+        class LiteralPayloadStorage
+        {
+            using Index = typename std::conditional<sizeof...(Cases) <= UINT8_MAX, uint8_t, uint16_t>::type;
+            static_assert(sizeof...(Cases) <= UINT16_MAX, "Too many cases.");
+            
+        public:
+            template <size_t I>
+            using Type = typename CaseAt<I, Cases...>::type::Type;
+            
+            template <size_t I, typename... Args>
+            constexpr explicit LiteralPayloadStorage(InPlaceIndex<I>, Args&&... args);
+            
+            /// Payloads are always inline, so allocator is not used.
+            template <size_t I, typename Allocator, typename... Args>
+            constexpr LiteralPayloadStorage(AllocatedIndex<I>, const Allocator& allocator, Args&&... args);
+            
+            constexpr size_t index() const;
+            
+            template <size_t I>
+            constexpr const Type<I>* get() const;
+            
+            template <size_t I>
+            Type<I> take();
+            
+            template <size_t I, typename Handler>
+            void consume(const Handler& handler);
+            
+            /// Payloads are always inline, so they are always owned exclusively.
+            template <size_t I>
+            Type<I>* exclusive();
+            
+            template <size_t I>
+            Type<I>* unshare();
+            
+        private:
+            Index m_index;
+            LiteralUnion<CaseSet<Cases...>, 0, sizeof...(Cases)> m_payloads;
+        };
+        
+        /// Selects 'LiteralPayloadStorage' if all payloads are literal. Instrumentation counts copies, so it always uses 'PayloadStorage'.
+        template <typename Storage, typename... Cases>
+        struct PayloadStorageSelector
+        {
+#if defined(ASENUM_INSTRUMENTATION)
+            static constexpr bool Literal = false;
+#else
+            static constexpr bool Literal = AllOf<IsLiteralPayload<typename Cases::Type, Storage>::value...>::value;
+#endif
+            
+            using type = typename std::conditional<Literal, LiteralPayloadStorage<Storage, Cases...>, PayloadStorage<Storage, Cases...>>::type;
+        };
+        
+        
+        /// Relational operators of AsEnum applied to its cases and values. Constexpr unlike 'std::less' and others in C++11.
+        struct LessRelation { template <typename T> constexpr bool operator()(const T& first, const T& second) const { return first < second; } };
+        struct LessEqualRelation { template <typename T> constexpr bool operator()(const T& first, const T& second) const { return first <= second; } };
+        struct GreaterRelation { template <typename T> constexpr bool operator()(const T& first, const T& second) const { return first > second; } };
+        struct GreaterEqualRelation { template <typename T> constexpr bool operator()(const T& first, const T& second) const { return first >= second; } };
+        
+        /// Compares AsEnum instances in constant time: both cases are resolved by stored index.
+        template <typename ConcreteAsEnum, size_t... I>
+        struct Comparator<ConcreteAsEnum, IndexSequence<I...>>
+        {
+            static constexpr int compare(const ConcreteAsEnum& first, const ConcreteAsEnum& second);
+            static constexpr bool equal(const ConcreteAsEnum& first, const ConcreteAsEnum& second);
+            
+            /// Applies 'Relation' to cases if they differ or to values of the same case otherwise. 'void' values are compared as equal 'bool's.
+            template <typename Relation>
+            static constexpr bool relation(const ConcreteAsEnum& first, const ConcreteAsEnum& second);
+            
+        private:
+            template <size_t Index>
+            static constexpr int compareCase(const ConcreteAsEnum& first, const ConcreteAsEnum& second);
+            
+            template <size_t Index>
+            static constexpr bool equalCase(const ConcreteAsEnum& first, const ConcreteAsEnum& second);
+            
+            static constexpr int compareValues(const void*, const void*);
+            
+            template <typename T>
+            static constexpr int compareValues(const T* first, const T* second);
+            
+            static constexpr bool equalValues(const void*, const void*);
+            
+            template <typename T>
+            static constexpr bool equalValues(const T* first, const T* second);
+            
+            template <typename Relation, size_t Index>
+            static constexpr bool relationCase(const ConcreteAsEnum& first, const ConcreteAsEnum& second);
+            
+            template <typename Relation>
+            static constexpr bool relationValues(const void*, const void*);
+            
+            template <typename Relation, typename T>
+            static constexpr bool relationValues(const T* first, const T* second);
+            
+            using CompareFunction = int (*)(const ConcreteAsEnum&, const ConcreteAsEnum&);
+            using EqualFunction = bool (*)(const ConcreteAsEnum&, const ConcreteAsEnum&);
+            
+            template <typename Relation>
+            struct RelationTable
+            {
+                static constexpr EqualFunction s_table[] = { &relationCase<Relation, I>... };
+            };
+            
+            static constexpr CompareFunction s_compareTable[] = { &compareCase<I>... };
+            static constexpr EqualFunction s_equalTable[] = { &equalCase<I>... };
+        };
+        
+        /// Spreads entropy of 'value' over all bits (see 'Fmix64').
+        size_t MixHash(size_t value);
+        
+        /// Hashes AsEnum instances: case tag is mixed with hash of the payload. 'void' cases are hashed by tag only.
+        template <typename ConcreteAsEnum, size_t... I>
+        struct Hasher<ConcreteAsEnum, IndexSequence<I...>>
+        {
+            static size_t hash(const ConcreteAsEnum& asEnum);
+            
+        private:
+            template <size_t Index>
+            static size_t hashCase(const ConcreteAsEnum& asEnum);
+            
+            static size_t hashValue(size_t tag, const void*);
+            
+            template <typename T>
+            static size_t hashValue(size_t tag, const T* value);
+        };
+    }
+}
+
+namespace std
+{
+    /// Allows AsEnum to be used as key of unordered containers. Payloads of all non-void cases must be hashable.
+    template <typename T_Storage, typename... T_Cases>
+    struct hash<asenum::BasicAsEnum<T_Storage, T_Cases...>>
+    {
+        size_t operator()(const asenum::BasicAsEnum<T_Storage, T_Cases...>& asEnum) const;
+    };
+}
+
+
+// AsEnum public
+
+template <typename T_Storage, typename... T_Cases>
+constexpr typename asenum::BasicAsEnum<T_Storage, T_Cases...>::Enum asenum::BasicAsEnum<T_Storage, T_Cases...>::AllCases[];
+
+template <typename T_Storage, typename... T_Cases>
+template <typename asenum::BasicAsEnum<T_Storage, T_Cases...>::Enum Case, typename T>
+constexpr asenum::BasicAsEnum<T_Storage, T_Cases...> asenum::BasicAsEnum<T_Storage, T_Cases...>::createImpl(T&& value)
+{
+    return asenum::BasicAsEnum<T_Storage, T_Cases...>(details::InPlaceIndex<CaseIndex<Case>::value>(), std::forward<T>(value));
+}
+
+template <typename T_Storage, typename... T_Cases>
+template <typename asenum::BasicAsEnum<T_Storage, T_Cases...>::Enum Case, typename T>
+constexpr asenum::BasicAsEnum<T_Storage, T_Cases...> asenum::BasicAsEnum<T_Storage, T_Cases...>::create()
+{
+    return asenum::BasicAsEnum<T_Storage, T_Cases...>(details::InPlaceIndex<CaseIndex<Case>::value>());
+}
+
+template <typename T_Storage, typename... T_Cases>
+template <typename asenum::BasicAsEnum<T_Storage, T_Cases...>::Enum Case, typename Allocator, typename U>
+asenum::BasicAsEnum<T_Storage, T_Cases...> asenum::BasicAsEnum<T_Storage, T_Cases...>::create(std::allocator_arg_t, const Allocator& allocator, UnderlyingType<Case> value)
+{
+    return asenum::BasicAsEnum<T_Storage, T_Cases...>(details::AllocatedIndex<CaseIndex<Case>::value>(), allocator, std::move(value));
+}
+
+#if __cplusplus > 201402L
+template <typename T_Storage, typename... T_Cases>
+template <typename asenum::BasicAsEnum<T_Storage, T_Cases...>::Enum Case, typename U>
+asenum::BasicAsEnum<T_Storage, T_Cases...> asenum::BasicAsEnum<T_Storage, T_Cases...>::create(std::pmr::memory_resource* resource, UnderlyingType<Case> value)
+{
+    return create<Case>(std::allocator_arg, std::pmr::polymorphic_allocator<char>(resource), std::move(value));
+}
+#endif
+
+template <typename T_Storage, typename... T_Cases>
+constexpr size_t asenum::BasicAsEnum<T_Storage, T_Cases...>::indexOf(const Enum value)
+{
+    return details::CaseMapping<details::CaseKeys<Enum, T_Cases::Code...>>::indexOf(details::CaseKey(value));
+}
+
+template <typename T_Storage, typename... T_Cases>
+size_t asenum::BasicAsEnum<T_Storage, T_Cases...>::checkedIndexOf(const Enum value)
+{
+    const size_t index = indexOf(value);
+    if (index == sizeof...(T_Cases))
+    {
+        details::RaiseError<std::invalid_argument>("Value does not correspond to any case.");
+    }
+    
+    return index;
+}
+
+template <typename T_Storage, typename... T_Cases>
+constexpr typename asenum::BasicAsEnum<T_Storage, T_Cases...>::Enum asenum::BasicAsEnum<T_Storage, T_Cases...>::fromIndex(const size_t index)
+{
+    return index < sizeof...(T_Cases) ? AllCases[index] : (details::RaiseError<std::out_of_range>("Case index is out of range."), AllCases[0]);
+}
+
+template <typename T_Storage, typename... T_Cases>
+constexpr typename asenum::BasicAsEnum<T_Storage, T_Cases...>::Enum asenum::BasicAsEnum<T_Storage, T_Cases...>::enumCase() const
+{
+    return AllCases[m_storage.index()];
+}
+
+template <typename T_Storage, typename... T_Cases>
+constexpr size_t asenum::BasicAsEnum<T_Storage, T_Cases...>::caseIndex() const
+{
+    return m_storage.index();
+}
+
+template <typename T_Storage, typename... T_Cases>
+template <typename asenum::BasicAsEnum<T_Storage, T_Cases...>::Enum Case>
+constexpr bool asenum::BasicAsEnum<T_Storage, T_Cases...>::isCase() const
+{
+    return CaseIndex<Case>::value == m_storage.index();
+}
+
+template <typename T_Storage, typename... T_Cases>
+template <typename asenum::BasicAsEnum<T_Storage, T_Cases...>::Enum Case, typename Handler>
+constexpr bool asenum::BasicAsEnum<T_Storage, T_Cases...>::ifCase(const Handler& handler) const
+{
+    return isCase<Case>()
+#if defined(ASENUM_INSTRUMENTATION)
+    && (details::InstrumentationCounters<BasicAsEnum>::add(InstrumentationCounter::IfCaseHits, CaseIndex<Case>::value, 1), true)
+#endif
+    && call<UnderlyingType<Case>>(m_storage.template get<CaseIndex<Case>::value>(), handler);
+}
+
+template <typename T_Storage, typename... T_Cases>
+template <typename asenum::BasicAsEnum<T_Storage, T_Cases...>::Enum Case, typename R, typename>
+constexpr const R& asenum::BasicAsEnum<T_Storage, T_Cases...>::forceAsCase() const
+{
+    return isCase<Case>()
+    ? *m_storage.template get<CaseIndex<Case>::value>()
+    : (details::RaiseError<std::invalid_argument>("Unwrapping case does not correspond to stored case."), *m_storage.template get<CaseIndex<Case>::value>());
+}
+
+template <typename T_Storage, typename... T_Cases>
+template <typename asenum::BasicAsEnum<T_Storage, T_Cases...>::Enum Case, typename R, typename>
+constexpr const R& asenum::BasicAsEnum<T_Storage, T_Cases...>::getUnchecked() const noexcept
+{
+    return assert(isCase<Case>()), *m_storage.template get<CaseIndex<Case>::value>();
+}
+
+template <typename T_Storage, typename... T_Cases>
+template <typename asenum::BasicAsEnum<T_Storage, T_Cases...>::Enum Case, typename R, typename>
+R asenum::BasicAsEnum<T_Storage, T_Cases...>::take() &&
+{
+    if (!isCase<Case>())
+    {
+        details::RaiseError<std::invalid_argument>("Unwrapping case does not correspond to stored case.");
+    }
+    
+    return m_storage.template take<CaseIndex<Case>::value>();
+}
+
+template <typename T_Storage, typename... T_Cases>
+template <typename asenum::BasicAsEnum<T_Storage, T_Cases...>::Enum Case, typename Handler, typename R, typename>
+bool asenum::BasicAsEnum<T_Storage, T_Cases...>::modify(const Handler& handler)
+{
+    if (!isCase<Case>())
+    {
+        return false;
+    }
+    
+    handler(*m_storage.template unshare<CaseIndex<Case>::value>());
+    return true;
+}
+
+template <typename T_Storage, typename... T_Cases>
+template <typename asenum::BasicAsEnum<T_Storage, T_Cases...>::Enum Case, typename... Args>
+void asenum::BasicAsEnum<T_Storage, T_Cases...>::replace(Args&&... args)
+{
+    // Arguments are forwarded twice only if they are not consumed by assignment (see 'AssignPayload').
+    UnderlyingType<Case>* const exclusive = isCase<Case>() ? m_storage.template exclusive<CaseIndex<Case>::value>() : nullptr;
+    if (!exclusive || !details::AssignPayload(exclusive, std::forward<Args>(args)...))
+    {
+        *this = BasicAsEnum(details::InPlaceIndex<CaseIndex<Case>::value>(), std::forward<Args>(args)...);
+    }
+}
+
+template <typename T_Storage, typename... T_Cases>
+template <typename asenum::BasicAsEnum<T_Storage, T_Cases...>::Enum Case>
+constexpr bool asenum::BasicAsEnum<T_Storage, T_Cases...>::storesInline()
+{
+    return details::IsInlinePayload<UnderlyingType<Case>, T_Storage>::value;
+}
+
+template <typename T_Storage, typename... T_Cases>
+asenum::details::AsSwitch<typename asenum::BasicAsEnum<T_Storage, T_Cases...>::Enum, asenum::BasicAsEnum<T_Storage, T_Cases...>> asenum::BasicAsEnum<T_Storage, T_Cases...>::doSwitch() const&
+{
+    return details::AsSwitch<Enum, BasicAsEnum>(*this);
+}
+
+template <typename T_Storage, typename... T_Cases>
+asenum::details::AsSwitch<typename asenum::BasicAsEnum<T_Storage, T_Cases...>::Enum, asenum::details::ConsumingAsEnum<asenum::BasicAsEnum<T_Storage, T_Cases...>>> asenum::BasicAsEnum<T_Storage, T_Cases...>::doSwitch() &&
+{
+    return details::AsSwitch<Enum, details::ConsumingAsEnum<BasicAsEnum>>(details::ConsumingAsEnum<BasicAsEnum>(*this));
+}
+
+template <typename T_Storage, typename... T_Cases>
+template <typename T>
+asenum::details::AsMapRoot<T, typename asenum::BasicAsEnum<T_Storage, T_Cases...>::Enum, asenum::BasicAsEnum<T_Storage, T_Cases...>> asenum::BasicAsEnum<T_Storage, T_Cases...>::doMap() const&
+{
+    return details::AsMapRoot<T, Enum, BasicAsEnum>(*this);
+}
+
+template <typename T_Storage, typename... T_Cases>
+template <typename T>
+asenum::details::AsMapRoot<T, typename asenum::BasicAsEnum<T_Storage, T_Cases...>::Enum, asenum::details::ConsumingAsEnum<asenum::BasicAsEnum<T_Storage, T_Cases...>>> asenum::BasicAsEnum<T_Storage, T_Cases...>::doMap() &&
+{
+    return details::AsMapRoot<T, Enum, details::ConsumingAsEnum<BasicAsEnum>>(details::ConsumingAsEnum<BasicAsEnum>(*this));
+}
+
+template <typename T_Storage, typename... T_Cases>
+template <typename T>
+asenum::details::AsMatcher<T, asenum::BasicAsEnum<T_Storage, T_Cases...>, asenum::details::NoDefaultHandler> asenum::BasicAsEnum<T_Storage, T_Cases...>::matcher()
+{
+    return details::AsMatcher<T, BasicAsEnum, details::NoDefaultHandler>();
+}
+
+template <typename T_Storage, typename... T_Cases>
+template <typename T>
+asenum::details::AsVisit<T, asenum::BasicAsEnum<T_Storage, T_Cases...>>&& asenum::BasicAsEnum<T_Storage, T_Cases...>::match(details::AsVisitRoot<T, BasicAsEnum>&& root) const
+{
+    return root.bind(*this);
+}
+
+template <typename T_Storage, typename... T_Cases>
+constexpr int asenum::BasicAsEnum<T_Storage, T_Cases...>::compare(const BasicAsEnum& other) const
+{
+    return details::Comparator<BasicAsEnum, typename details::MakeIndexSequence<sizeof...(T_Cases)>::type>::compare(*this, other);
+}
+
+template <typename T_Storage, typename... T_Cases>
+constexpr bool asenum::BasicAsEnum<T_Storage, T_Cases...>::operator==(const BasicAsEnum& other) const
+{
+    return details::Comparator<BasicAsEnum, typename details::MakeIndexSequence<sizeof...(T_Cases)>::type>::equal(*this, other);
+}
+
+template <typename T_Storage, typename... T_Cases>
+constexpr bool asenum::BasicAsEnum<T_Storage, T_Cases...>::operator!=(const BasicAsEnum& other) const
+{
+    return !(*this == other);
+}
+
+template <typename T_Storage, typename... T_Cases>
+constexpr bool asenum::BasicAsEnum<T_Storage, T_Cases...>::operator<(const BasicAsEnum& other) const
+{
+    return details::Comparator<BasicAsEnum, typename details::MakeIndexSequence<sizeof...(T_Cases)>::type>::template relation<details::LessRelation>(*this, other);
+}
+
+template <typename T_Storage, typename... T_Cases>
+constexpr bool asenum::BasicAsEnum<T_Storage, T_Cases...>::operator<=(const BasicAsEnum& other) const
+{
+    return details::Comparator<BasicAsEnum, typename details::MakeIndexSequence<sizeof...(T_Cases)>::type>::template relation<details::LessEqualRelation>(*this, other);
+}
+
+template <typename T_Storage, typename... T_Cases>
+constexpr bool asenum::BasicAsEnum<T_Storage, T_Cases...>::operator>(const BasicAsEnum& other) const
+{
+    return details::Comparator<BasicAsEnum, typename details::MakeIndexSequence<sizeof...(T_Cases)>::type>::template relation<details::GreaterRelation>(*this, other);
+}
+
+template <typename T_Storage, typename... T_Cases>
+constexpr bool asenum::BasicAsEnum<T_Storage, T_Cases...>::operator>=(const BasicAsEnum& other) const
+{
+    return details::Comparator<BasicAsEnum, typename details::MakeIndexSequence<sizeof...(T_Cases)>::type>::template relation<details::GreaterEqualRelation>(*this, other);
+}
+
+
+// AsEnum private
+
+template <typename T_Storage, typename... T_Cases>
+template <size_t Index, typename... Args>
+constexpr asenum::BasicAsEnum<T_Storage, T_Cases...>::BasicAsEnum(details::InPlaceIndex<Index>, Args&&... args)
+: m_storage(details::InPlaceIndex<Index>(), std::forward<Args>(args)...)
+{}
+
+template <typename T_Storage, typename... T_Cases>
+template <size_t Index, typename Allocator, typename... Args>
+constexpr asenum::BasicAsEnum<T_Storage, T_Cases...>::BasicAsEnum(details::AllocatedIndex<Index>, const Allocator& allocator, Args&&... args)
+: m_storage(details::AllocatedIndex<Index>(), allocator, std::forward<Args>(args)...)
+{}
+
+template <typename T_Storage, typename... T_Cases>
+template <typename T, typename Handler>
+constexpr typename std::enable_if<std::is_same<T, void>::value, bool>::type asenum::BasicAsEnum<T_Storage, T_Cases...>::call(const T*, const Handler& handler)
+{
+    return static_cast<void>(handler()), true;
+}
+
+template <typename T_Storage, typename... T_Cases>
+template <typename T, typename Handler>
+constexpr typename std::enable_if<!std::is_same<T, void>::value, bool>::type asenum::BasicAsEnum<T_Storage, T_Cases...>::call(const T* value, const Handler& handler)
+{
+    return static_cast<void>(handler(*value)), true;
+}
+
+// Private details - RaiseError
+
+template <typename Exception>
+void asenum::details::RaiseError(const char* const message)
+{
+#if defined(ASENUM_NO_EXCEPTIONS)
+#if defined(ASENUM_ERROR_HANDLER)
+    ASENUM_ERROR_HANDLER(message);
+#else
+    std::fprintf(stderr, "asenum: %s\n", message);
+#endif
+    std::terminate();
+#else
+    throw Exception(message);
+#endif
+}
+
+// Private details - CasePosition
+
+template <typename Enum, Enum Value, typename... Cases>
+constexpr bool asenum::details::CasePosition<Enum, Value, Cases...>::Matches[];
+
+template <typename Enum, Enum Value, typename... Cases>
+constexpr size_t asenum::details::CasePosition<Enum, Value, Cases...>::value;
+
+// Private details - CaseMapping
+
+template <typename Enum, Enum... Codes>
+constexpr uint64_t asenum::details::CaseKeys<Enum, Codes...>::Values[];
+
+template <typename Keys, size_t Seed, size_t... I>
+constexpr size_t asenum::details::PerfectHashLevel<Keys, Seed, asenum::details::IndexSequence<I...>>::Buckets[];
+
+template <typename Keys, size_t Seed, size_t... I>
+constexpr size_t asenum::details::PerfectHashOrder<Keys, Seed, 1, asenum::details::IndexSequence<I...>>::Values[];
+
+template <typename Keys, size_t Seed, size_t Width, size_t... I>
+constexpr size_t asenum::details::PerfectHashOrder<Keys, Seed, Width, asenum::details::IndexSequence<I...>>::Values[];
+
+template <typename Keys, size_t Seed, size_t... B>
+constexpr size_t asenum::details::PerfectHashBuckets<Keys, Seed, asenum::details::IndexSequence<B...>>::Starts[];
+
+template <typename Keys, size_t Seed, size_t... B>
+constexpr size_t asenum::details::PerfectHashSecondLevel<Keys, Seed, asenum::details::IndexSequence<B...>>::Bits[];
+
+template <typename Keys, size_t Seed, size_t... B>
+constexpr uint64_t asenum::details::PerfectHashSecondLevel<Keys, Seed, asenum::details::IndexSequence<B...>>::Multipliers[];
+
+template <typename Keys, size_t Seed, size_t... B>
+constexpr size_t asenum::details::PerfectHashSecondLevel<Keys, Seed, asenum::details::IndexSequence<B...>>::Sizes[];
+
+template <typename Source, size_t... I>
+constexpr size_t asenum::details::PrefixSums<Source, 0, asenum::details::IndexSequence<I...>>::Values[];
+
+template <typename Source, size_t Step, size_t... I>
+constexpr size_t asenum::details::PrefixSums<Source, Step, asenum::details::IndexSequence<I...>>::Values[];
+
+template <typename Keys, size_t Seed, size_t... B, size_t... S>
+constexpr typename asenum::details::PerfectHashTable<Keys, Seed, asenum::details::IndexSequence<B...>, asenum::details::IndexSequence<S...>>::Entry asenum::details::PerfectHashTable<Keys, Seed, asenum::details::IndexSequence<B...>, asenum::details::IndexSequence<S...>>::Entries[];
+
+template <typename Keys, size_t Seed, size_t... B, size_t... S>
+constexpr typename Keys::Index asenum::details::PerfectHashTable<Keys, Seed, asenum::details::IndexSequence<B...>, asenum::details::IndexSequence<S...>>::Slots[];
+
+// Private details - HeapPayloadOps
+
+template <typename T>
+T* asenum::details::HeapPayloadOps<T, asenum::SharedOwnership>::exclusive(void* buffer)
+{
+    Handle& handle = *static_cast<Handle*>(buffer);
+    if (handle.use_count() != 1)
+    {
+        return nullptr;
+    }
+    
+    // 'use_count' is relaxed load: pair it with release decrement of the copy just destroyed by other thread,
+    // so its writes to the value happen before ours.
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return handle.get();
+}
+
+// Private details - AllocatedHeapBlock
+
+template <typename T, typename Allocator>
+template <typename... Args>
+asenum::details::HeapBlock<T>* asenum::details::AllocatedHeapBlock<T, Allocator>::create(const Allocator& allocator, Args&&... args)
+{
+    BlockAllocator blockAllocator(allocator);
+    AllocatedHeapBlock* const block = BlockTraits::allocate(blockAllocator, 1);
+    ASENUM_TRY
+    {
+        new (block) AllocatedHeapBlock(blockAllocator, std::forward<Args>(args)...);
+    }
+    ASENUM_CATCH_ALL
+    {
+        BlockTraits::deallocate(blockAllocator, block, 1);
+        ASENUM_RETHROW;
+    }
+    
+    return block;
+}
+
+template <typename T, typename Allocator>
+void asenum::details::AllocatedHeapBlock<T, Allocator>::release(HeapBlock<T>* const block)
+{
+    AllocatedHeapBlock* const allocated = static_cast<AllocatedHeapBlock*>(block);
+    BlockAllocator allocator(std::move(allocated->allocator));
+    allocated->~AllocatedHeapBlock();
+    BlockTraits::deallocate(allocator, allocated, 1);
 }
 
-template <typename... T_Cases>
-template <typename asenum::AsEnum<T_Cases...>::Enum Case, typename R, typename>
-const R& asenum::AsEnum<T_Cases...>::forceAsCase() const
+template <typename T, typename Allocator>
+asenum::details::HeapBlock<T>* asenum::details::AllocatedHeapBlock<T, Allocator>::clone(const HeapBlock<T>& block)
 {
-    if (!isCase<Case>())
+    const AllocatedHeapBlock& allocated = static_cast<const AllocatedHeapBlock&>(block);
+    return create(Allocator(allocated.allocator), allocated.value);
+}
+
+// Private details - PayloadStorage
+
+template <typename Storage, typename... Cases>
+constexpr typename asenum::details::PayloadStorage<Storage, Cases...>::VTable asenum::details::PayloadStorage<Storage, Cases...>::s_vtable[];
+
+template <typename Storage, typename... Cases>
+template <size_t I, typename... Args>
+asenum::details::PayloadStorage<Storage, Cases...>::PayloadStorage(InPlaceIndex<I>, Args&&... args)
+: m_index(static_cast<Index>(I))
+{
+    PayloadOps<Type<I>, Storage>::construct(&m_buffer, std::forward<Args>(args)...);
+    
+#if defined(ASENUM_INSTRUMENTATION)
+    using Counters = InstrumentationCounters<BasicAsEnum<Storage, Cases...>>;
+    Counters::add(InstrumentationCounter::Created, I, 1);
+    Counters::add(InstrumentationCounter::AllocatedBytes, I, HeapPayloadSize<Type<I>, Storage>::value);
+#endif
+}
+
+template <typename Storage, typename... Cases>
+template <size_t I, typename Allocator, typename... Args>
+asenum::details::PayloadStorage<Storage, Cases...>::PayloadStorage(AllocatedIndex<I>, const Allocator& allocator, Args&&... args)
+: m_index(static_cast<Index>(I))
+{
+    PayloadOps<Type<I>, Storage>::allocate(&m_buffer, allocator, std::forward<Args>(args)...);
+    
+#if defined(ASENUM_INSTRUMENTATION)
+    using Counters = InstrumentationCounters<BasicAsEnum<Storage, Cases...>>;
+    Counters::add(InstrumentationCounter::Created, I, 1);
+    Counters::add(InstrumentationCounter::AllocatedBytes, I, HeapPayloadSize<Type<I>, Storage>::value);
+#endif
+}
+
+template <typename Storage, typename... Cases>
+asenum::details::PayloadStorage<Storage, Cases...>::PayloadStorage(const PayloadStorage& other)
+: m_index(other.m_index)
+{
+    s_vtable[m_index].copy(&m_buffer, &other.m_buffer);
+    
+#if defined(ASENUM_INSTRUMENTATION)
+    using Counters = InstrumentationCounters<BasicAsEnum<Storage, Cases...>>;
+    Counters::add(InstrumentationCounter::Copied, m_index, 1);
+    if (s_vtable[m_index].shared)
+    {
+        Counters::add(InstrumentationCounter::SharedCopies, m_index, 1);
+    }
+#endif
+}
+
+template <typename Storage, typename... Cases>
+asenum::details::PayloadStorage<Storage, Cases...>::PayloadStorage(PayloadStorage&& other) noexcept
+: m_index(other.m_index)
+{
+    s_vtable[m_index].move(&m_buffer, &other.m_buffer);
+}
+
+template <typename Storage, typename... Cases>
+asenum::details::PayloadStorage<Storage, Cases...>& asenum::details::PayloadStorage<Storage, Cases...>::operator=(const PayloadStorage& other)
+{
+    if (this != &other)
     {
-        throw std::invalid_argument("Unwrapping case does not correspond to stored case.");
+        PayloadStorage copy(other);
+        *this = std::move(copy);
     }
     
-    return *reinterpret_cast<const UnderlyingType<Case>*>(m_value.get());
+    return *this;
 }
 
-template <typename... T_Cases>
-asenum::details::AsSwitch<typename asenum::AsEnum<T_Cases...>::Enum, asenum::AsEnum<T_Cases...>> asenum::AsEnum<T_Cases...>::doSwitch() const
+template <typename Storage, typename... Cases>
+asenum::details::PayloadStorage<Storage, Cases...>& asenum::details::PayloadStorage<Storage, Cases...>::operator=(PayloadStorage&& other) noexcept
 {
-    return details::AsSwitch<Enum, AsEnum<T_Cases...>>(*this);
+    if (this != &other)
+    {
+        s_vtable[m_index].destroy(&m_buffer);
+        m_index = other.m_index;
+        s_vtable[m_index].move(&m_buffer, &other.m_buffer);
+    }
+    
+    return *this;
 }
 
-template <typename... T_Cases>
-template <typename T>
-asenum::details::AsMap<T, typename asenum::AsEnum<T_Cases...>::Enum, asenum::AsEnum<T_Cases...>> asenum::AsEnum<T_Cases...>::doMap() const
+template <typename Storage, typename... Cases>
+asenum::details::PayloadStorage<Storage, Cases...>::~PayloadStorage()
+{
+    s_vtable[m_index].destroy(&m_buffer);
+}
+
+template <typename Storage, typename... Cases>
+size_t asenum::details::PayloadStorage<Storage, Cases...>::index() const
+{
+    return m_index;
+}
+
+template <typename Storage, typename... Cases>
+template <size_t I>
+const typename asenum::details::PayloadStorage<Storage, Cases...>::template Type<I>* asenum::details::PayloadStorage<Storage, Cases...>::get() const
+{
+    return PayloadOps<Type<I>, Storage>::get(&m_buffer);
+}
+
+template <typename Storage, typename... Cases>
+template <size_t I>
+typename asenum::details::PayloadStorage<Storage, Cases...>::template Type<I> asenum::details::PayloadStorage<Storage, Cases...>::take()
+{
+    Type<I>* const exclusive = PayloadOps<Type<I>, Storage>::exclusive(&m_buffer);
+    return exclusive ? Type<I>(std::move(*exclusive)) : Type<I>(*get<I>());
+}
+
+template <typename Storage, typename... Cases>
+template <size_t I, typename Handler>
+void asenum::details::PayloadStorage<Storage, Cases...>::consume(const Handler& handler)
+{
+    if (Type<I>* const exclusive = PayloadOps<Type<I>, Storage>::exclusive(&m_buffer))
+    {
+        handler(std::move(*exclusive));
+    }
+    else
+    {
+        Type<I> copy(*get<I>());
+        handler(std::move(copy));
+    }
+}
+
+template <typename Storage, typename... Cases>
+template <size_t I>
+typename asenum::details::PayloadStorage<Storage, Cases...>::template Type<I>* asenum::details::PayloadStorage<Storage, Cases...>::exclusive()
+{
+    return PayloadOps<Type<I>, Storage>::exclusive(&m_buffer);
+}
+
+template <typename Storage, typename... Cases>
+template <size_t I>
+typename asenum::details::PayloadStorage<Storage, Cases...>::template Type<I>* asenum::details::PayloadStorage<Storage, Cases...>::unshare()
 {
-    return details::AsMap<T, Enum, AsEnum<T_Cases...>>(*this);
+    if (Type<I>* const value = exclusive<I>())
+    {
+        return value;
+    }
+    
+    PayloadStorage copy(InPlaceIndex<I>(), *get<I>());
+    *this = std::move(copy);
+    
+    return exclusive<I>();
 }
 
-template <typename... T_Cases>
-bool asenum::AsEnum<T_Cases...>::operator==(const AsEnum& other) const
+// Private details - LiteralPayloadStorage
+
+template <typename Storage, typename... Cases>
+template <size_t I, typename... Args>
+constexpr asenum::details::LiteralPayloadStorage<Storage, Cases...>::LiteralPayloadStorage(InPlaceIndex<I> index, Args&&... args)
+: m_index(static_cast<Index>(I))
+, m_payloads(index, std::forward<Args>(args)...)
+{}
+
+template <typename Storage, typename... Cases>
+template <size_t I, typename Allocator, typename... Args>
+constexpr asenum::details::LiteralPayloadStorage<Storage, Cases...>::LiteralPayloadStorage(AllocatedIndex<I>, const Allocator&, Args&&... args)
+: LiteralPayloadStorage(InPlaceIndex<I>(), std::forward<Args>(args)...)
+{}
+
+template <typename Storage, typename... Cases>
+constexpr size_t asenum::details::LiteralPayloadStorage<Storage, Cases...>::index() const
 {
-    return details::Comparator<AsEnum, std::equal_to, T_Cases...>::compare(*this, other);
+    return m_index;
 }
 
-template <typename... T_Cases>
-bool asenum::AsEnum<T_Cases...>::operator!=(const AsEnum& other) const
+template <typename Storage, typename... Cases>
+template <size_t I>
+constexpr const typename asenum::details::LiteralPayloadStorage<Storage, Cases...>::template Type<I>* asenum::details::LiteralPayloadStorage<Storage, Cases...>::get() const
 {
-    return details::Comparator<AsEnum, std::not_equal_to, T_Cases...>::compare(*this, other);
+    return m_payloads.get(InPlaceIndex<I>());
 }
 
-template <typename... T_Cases>
-bool asenum::AsEnum<T_Cases...>::operator<(const AsEnum& other) const
+template <typename Storage, typename... Cases>
+template <size_t I>
+typename asenum::details::LiteralPayloadStorage<Storage, Cases...>::template Type<I> asenum::details::LiteralPayloadStorage<Storage, Cases...>::take()
 {
-    return details::Comparator<AsEnum, std::less, T_Cases...>::compare(*this, other);
+    return *get<I>();
 }
 
-template <typename... T_Cases>
-bool asenum::AsEnum<T_Cases...>::operator<=(const AsEnum& other) const
+template <typename Storage, typename... Cases>
+template <size_t I, typename Handler>
+void asenum::details::LiteralPayloadStorage<Storage, Cases...>::consume(const Handler& handler)
 {
-    return details::Comparator<AsEnum, std::less_equal, T_Cases...>::compare(*this, other);
+    Type<I> copy(*get<I>());
+    handler(std::move(copy));
 }
 
-template <typename... T_Cases>
-bool asenum::AsEnum<T_Cases...>::operator>(const AsEnum& other) const
+template <typename Storage, typename... Cases>
+template <size_t I>
+typename asenum::details::LiteralPayloadStorage<Storage, Cases...>::template Type<I>* asenum::details::LiteralPayloadStorage<Storage, Cases...>::exclusive()
 {
-    return details::Comparator<AsEnum, std::greater, T_Cases...>::compare(*this, other);
+    return const_cast<Type<I>*>(get<I>());
 }
 
-template <typename... T_Cases>
-bool asenum::AsEnum<T_Cases...>::operator>=(const AsEnum& other) const
+template <typename Storage, typename... Cases>
+template <size_t I>
+typename asenum::details::LiteralPayloadStorage<Storage, Cases...>::template Type<I>* asenum::details::LiteralPayloadStorage<Storage, Cases...>::unshare()
 {
-    return details::Comparator<AsEnum, std::greater_equal, T_Cases...>::compare(*this, other);
+    return exclusive<I>();
 }
 
+// Private details - ConsumingAsEnum
 
-// AsEnum private
+template <typename ConcreteAsEnum>
+constexpr const typename asenum::details::ConsumingAsEnum<ConcreteAsEnum>::Enum (&asenum::details::ConsumingAsEnum<ConcreteAsEnum>::AllCases)[ArraySize(ConcreteAsEnum::AllCases)];
 
-template <typename... T_Cases>
-asenum::AsEnum<T_Cases...>::AsEnum(const Enum relatedCase, std::shared_ptr<void> value)
-: m_enumCase(relatedCase)
-, m_value(value)
+template <typename ConcreteAsEnum>
+asenum::details::ConsumingAsEnum<ConcreteAsEnum>::ConsumingAsEnum(ConcreteAsEnum& asEnum)
+: m_asEnum(asEnum)
 {}
 
-template <typename... T_Cases>
-template <typename T, typename Handler>
-typename std::enable_if<std::is_same<T, void>::value, void>::type asenum::AsEnum<T_Cases...>::call(const void*, const Handler& handler)
+template <typename ConcreteAsEnum>
+template <typename asenum::details::ConsumingAsEnum<ConcreteAsEnum>::Enum Case, typename Handler>
+bool asenum::details::ConsumingAsEnum<ConcreteAsEnum>::ifCase(const Handler& handler) const
+{
+    const bool isType = m_asEnum.template isCase<Case>();
+    if (isType)
+    {
+#if defined(ASENUM_INSTRUMENTATION)
+        InstrumentCase<ConcreteAsEnum, Enum, Case>(InstrumentationCounter::IfCaseHits);
+#endif
+        consume<AsEnumAccess::caseIndex<ConcreteAsEnum, Case>()>(handler, std::is_same<UnderlyingType<Case>, void>());
+    }
+    
+    return isType;
+}
+
+template <typename ConcreteAsEnum>
+template <size_t I, typename Handler>
+void asenum::details::ConsumingAsEnum<ConcreteAsEnum>::consume(const Handler& handler, std::true_type) const
 {
     handler();
 }
 
-template <typename... T_Cases>
-template <typename T, typename Handler>
-typename std::enable_if<!std::is_same<T, void>::value, void>::type asenum::AsEnum<T_Cases...>::call(const void* value, const Handler& handler)
+template <typename ConcreteAsEnum>
+template <size_t I, typename Handler>
+void asenum::details::ConsumingAsEnum<ConcreteAsEnum>::consume(const Handler& handler, std::false_type) const
 {
-    handler(*reinterpret_cast<const T*>(value));
+    AsEnumAccess::mutableStorage(m_asEnum).template consume<I>(handler);
 }
 
 // Private details - AsSwitch
@@ -503,6 +2393,12 @@ asenum::details::AsSwitch<Enum, ConcreteAsEnum, T_type, Types...> asenum::detail
     if (!m_handled)
     {
         m_handled = m_asEnum.template ifCase<T_type>(handler);
+#if defined(ASENUM_INSTRUMENTATION)
+        if (m_handled)
+        {
+            InstrumentCase<ConcreteAsEnum, Enum, T_type>(InstrumentationCounter::SwitchHits);
+        }
+#endif
     }
     
     return AsSwitch<Enum, ConcreteAsEnum, T_type, Types...>(m_asEnum, m_handled);
@@ -521,34 +2417,80 @@ void asenum::details::AsSwitch<Enum, ConcreteAsEnum, Types...>::ifDefault(const
 
 // Private details - AsMap
 
+template <typename T>
+asenum::details::MapResult<T>::MapResult(MapResult&& other)
+: m_hasValue(other.m_hasValue)
+{
+    if (m_hasValue)
+    {
+        new (&m_buffer) T(std::move(*reinterpret_cast<T*>(&other.m_buffer)));
+    }
+}
+
+template <typename T>
+asenum::details::MapResult<T>::~MapResult()
+{
+    if (m_hasValue)
+    {
+        reinterpret_cast<T*>(&m_buffer)->~T();
+    }
+}
+
+template <typename T>
+bool asenum::details::MapResult<T>::hasValue() const
+{
+    return m_hasValue;
+}
+
+template <typename T>
+template <typename... Args>
+void asenum::details::MapResult<T>::emplace(Args&&... args)
+{
+    new (&m_buffer) T(std::forward<Args>(args)...);
+    m_hasValue = true;
+}
+
+template <typename T>
+T asenum::details::MapResult<T>::take()
+{
+    T& value = *reinterpret_cast<T*>(&m_buffer);
+    T result(std::move(value));
+    value.~T();
+    m_hasValue = false;
+    
+    return result;
+}
+
 template <typename T, typename Enum, typename ConcreteAsEnum, Enum... Types>
-asenum::details::AsMap<T, Enum, ConcreteAsEnum, Types...>::AsMap(const ConcreteAsEnum& asEnum, std::unique_ptr<T> result)
+asenum::details::AsMap<T, Enum, ConcreteAsEnum, Types...>::AsMap(const ConcreteAsEnum& asEnum, MapResult<T>&& result)
 : m_result(std::move(result))
 , m_asEnum(asEnum)
 {}
 
-template <typename T, typename Enum, typename ConcreteAsEnum, Enum... Types>
-asenum::details::AsMap<T, Enum, ConcreteAsEnum, Types...>::AsMap(const ConcreteAsEnum& asEnum)
-: m_asEnum(asEnum)
-{}
-
 template <typename T, typename Enum, typename ConcreteAsEnum, Enum... Types>
 template <Enum T_type, typename Handler, typename UT>
 typename std::enable_if<std::is_same<UT, void>::value, void>::type
-asenum::details::AsMap<T, Enum, ConcreteAsEnum, Types...>::ifCaseCall(const ConcreteAsEnum& asEnum, std::unique_ptr<T>& result, const Handler& handler)
+asenum::details::AsMap<T, Enum, ConcreteAsEnum, Types...>::ifCaseCall(const ConcreteAsEnum& asEnum, MapResult<T>& result, const Handler& handler)
 {
     asEnum.template ifCase<T_type>([&] {
-        result.reset(new T(handler()));
+#if defined(ASENUM_INSTRUMENTATION)
+        InstrumentCase<ConcreteAsEnum, Enum, T_type>(InstrumentationCounter::MapHits);
+#endif
+        result.emplace(handler());
     });
 }
 
 template <typename T, typename Enum, typename ConcreteAsEnum, Enum... Types>
 template <Enum T_type, typename Handler, typename UT>
 typename std::enable_if<!std::is_same<UT, void>::value, void>::type
-asenum::details::AsMap<T, Enum, ConcreteAsEnum, Types...>::ifCaseCall(const ConcreteAsEnum& asEnum, std::unique_ptr<T>& result, const Handler& handler)
+asenum::details::AsMap<T, Enum, ConcreteAsEnum, Types...>::ifCaseCall(const ConcreteAsEnum& asEnum, MapResult<T>& result, const Handler& handler)
 {
-    asEnum.template ifCase<T_type>([&] (const UT& value) {
-        result.reset(new T(handler(value)));
+    using Payload = typename AsEnumTraits<ConcreteAsEnum>::template Payload<UT>;
+    asEnum.template ifCase<T_type>([&] (Payload value) {
+#if defined(ASENUM_INSTRUMENTATION)
+        InstrumentCase<ConcreteAsEnum, Enum, T_type>(InstrumentationCounter::MapHits);
+#endif
+        result.emplace(handler(std::forward<Payload>(value)));
     });
 }
 
@@ -556,7 +2498,12 @@ template <typename T, typename Enum, typename ConcreteAsEnum, Enum... Types>
 template <typename Handler>
 T asenum::details::AsMap<T, Enum, ConcreteAsEnum, Types...>::ifDefault(const Handler& handler)
 {
-    return m_result ? std::move(*m_result) : handler();
+    if (m_result.hasValue())
+    {
+        return m_result.take();
+    }
+    
+    return handler();
 }
 
 template <typename T, typename Enum, typename ConcreteAsEnum, Enum... Types>
@@ -565,74 +2512,358 @@ R asenum::details::AsMap<T, Enum, ConcreteAsEnum, Types...>::ifCase(const CaseHa
 {
     static_assert(!Contains<Enum, T_type, Types...>::value, "Duplicated map case");
     
-    if (!m_result)
+    if (!m_result.hasValue())
     {
         ifCaseCall<T_type>(m_asEnum, m_result, handler);
     }
     
-    return ResultMaker::template makeResult<T_type>(m_asEnum, std::move(m_result));
+    return ResultMaker::template makeResult<T_type>(m_asEnum, m_result);
 }
 
-// Private details - Comparator
+template <typename T, typename Enum, typename ConcreteAsEnum>
+asenum::details::AsMapRoot<T, Enum, ConcreteAsEnum>::AsMapRoot(const ConcreteAsEnum& asEnum)
+: AsMap<T, Enum, ConcreteAsEnum>(asEnum, MapResult<T>())
+{}
+
+// Private details - AsVisit
 
-template <typename ConcreteAsEnum, template <typename T> class Cmp, typename T_Case>
-bool asenum::details::Comparator<ConcreteAsEnum, Cmp, T_Case>::compare(const ConcreteAsEnum& first, const ConcreteAsEnum& second, bool& finalVerdict)
+template <typename ConcreteAsEnum>
+constexpr auto asenum::details::AsEnumAccess::storage(const ConcreteAsEnum& asEnum) -> decltype((asEnum.m_storage))
 {
-    // If AsEnums cases are NOT equal.
-    if (first.enumCase() != second.enumCase())
-    {
-        finalVerdict = true;
-        
-        static constexpr Cmp<typename T_Case::Enum> s_comparator;
-        return s_comparator(first.enumCase(), second.enumCase());
-    }
+    return asEnum.m_storage;
+}
+
+template <typename ConcreteAsEnum>
+auto asenum::details::AsEnumAccess::mutableStorage(ConcreteAsEnum& asEnum) -> decltype((asEnum.m_storage))
+{
+    return asEnum.m_storage;
+}
+
+template <typename ConcreteAsEnum, typename ConcreteAsEnum::Enum Case>
+constexpr size_t asenum::details::AsEnumAccess::caseIndex()
+{
+    return ConcreteAsEnum::template CaseIndex<Case>::value;
+}
+
+template <typename T, typename ConcreteAsEnum, typename Visitor>
+T asenum::details::AsEnumAccess::visit(const ConcreteAsEnum& asEnum, const Visitor& visitor)
+{
+    using Indices = typename MakeIndexSequence<ArraySize(ConcreteAsEnum::AllCases)>::type;
+    return VisitTable<T, ConcreteAsEnum, Visitor, Indices>::visit(asEnum, visitor);
+}
+
+template <typename T, typename ConcreteAsEnum, typename Visitor, size_t... I>
+template <size_t Index>
+T asenum::details::VisitTable<T, ConcreteAsEnum, Visitor, asenum::details::IndexSequence<I...>>::visitCase(const ConcreteAsEnum& asEnum, const Visitor& visitor)
+{
+    return visitor.template visit<Index>(AsEnumAccess::storage(asEnum).template get<Index>());
+}
+
+template <typename T, typename ConcreteAsEnum, typename Visitor, size_t... I>
+T asenum::details::VisitTable<T, ConcreteAsEnum, Visitor, asenum::details::IndexSequence<I...>>::visit(const ConcreteAsEnum& asEnum, const Visitor& visitor)
+{
+    using CaseFunction = T (*)(const ConcreteAsEnum&, const Visitor&);
+    static constexpr CaseFunction s_table[] = { &visitCase<I>... };
     
-    // Both AsEnums cases are equal. Check if they are equal to Comparator's case.
-    if (first.enumCase() == T_Case::Code)
-    {
-        finalVerdict = true;
-        
-        return compare<typename T_Case::Type>(first, second);
-    }
+    return s_table[AsEnumAccess::storage(asEnum).index()](asEnum, visitor);
+}
+
+template <typename T>
+template <typename Handler>
+T asenum::details::HandlerInvoker<T>::invoke(const Handler& handler, const void*)
+{
+    return static_cast<T>(handler());
+}
+
+template <typename T>
+template <typename Handler, typename UT>
+T asenum::details::HandlerInvoker<T>::invoke(const Handler& handler, const UT* value)
+{
+    return static_cast<T>(handler(*value));
+}
+
+template <typename T, typename ConcreteAsEnum, typename Default, typename... Handlers>
+asenum::details::AsVisitCaller<T, ConcreteAsEnum, Default, Handlers...>::AsVisitCaller(const HandlerSlot* slots, const Default& defaultHandler)
+: m_slots(slots)
+, m_default(defaultHandler)
+{}
+
+template <typename T, typename ConcreteAsEnum, typename Default, typename... Handlers>
+template <size_t I, typename UT>
+T asenum::details::AsVisitCaller<T, ConcreteAsEnum, Default, Handlers...>::visit(const UT* value) const
+{
+    using Enum = typename ConcreteAsEnum::Enum;
+    static constexpr size_t Position = CasePosition<Enum, ConcreteAsEnum::AllCases[I], Handlers...>::value;
+    
+    return call<I, Position>(value, std::integral_constant<bool, (Position < sizeof...(Handlers))>());
+}
+
+template <typename T, typename ConcreteAsEnum, typename Default, typename... Handlers>
+template <size_t I, size_t Position, typename UT>
+T asenum::details::AsVisitCaller<T, ConcreteAsEnum, Default, Handlers...>::call(const UT* value, std::true_type) const
+{
+    using Handler = typename CaseAt<Position, Handlers...>::type::Handler;
+    return HandlerInvoker<T>::invoke(HandlerSlotAccess<Handler>::load(m_slots[I]), value);
+}
+
+template <typename T, typename ConcreteAsEnum, typename Default, typename... Handlers>
+template <size_t I, size_t Position, typename UT>
+T asenum::details::AsVisitCaller<T, ConcreteAsEnum, Default, Handlers...>::call(const UT*, std::false_type) const
+{
+    return HandlerInvoker<T>::invoke(m_default, nullptr);
+}
+
+template <typename T, typename ConcreteAsEnum, typename... Handlers>
+T asenum::details::AsVisitResultMaker<true, T, ConcreteAsEnum, Handlers...>::makeResult(const ConcreteAsEnum& asEnum, HandlerSlot* slots, AsVisitFinalStep&)
+{
+    const std::nullptr_t noDefault = nullptr;
+    const AsVisitCaller<T, ConcreteAsEnum, std::nullptr_t, Handlers...> caller(slots, noDefault);
+    
+    return AsEnumAccess::visit<T>(asEnum, caller);
+}
+
+template <typename T, typename ConcreteAsEnum, typename... Handlers>
+asenum::details::AsVisit<T, ConcreteAsEnum, Handlers...>&&
+asenum::details::AsVisitResultMaker<false, T, ConcreteAsEnum, Handlers...>::makeResult(const ConcreteAsEnum& asEnum, HandlerSlot* slots, AsVisit<T, ConcreteAsEnum, Handlers...>& next)
+{
+    next.m_asEnum = &asEnum;
+    next.m_slots = slots;
+    
+    return std::move(next);
+}
+
+template <typename T, typename ConcreteAsEnum, typename... Handlers>
+template <typename asenum::details::AsVisit<T, ConcreteAsEnum, Handlers...>::Enum T_type, typename CaseHandler, typename R>
+R asenum::details::AsVisit<T, ConcreteAsEnum, Handlers...>::ifCase(const CaseHandler& handler, NextStep<T_type, CaseHandler>&& next) &&
+{
+    static_assert(!Contains<Enum, T_type, Handlers::Code...>::value, "Duplicated match case.");
+    
+    m_slots[AsEnumAccess::caseIndex<ConcreteAsEnum, T_type>()] = HandlerSlotAccess<CaseHandler>::store(handler);
+    return ResultMaker<T_type, CaseHandler>::makeResult(*m_asEnum, m_slots, next);
+}
+
+template <typename T, typename ConcreteAsEnum, typename... Handlers>
+template <typename Handler>
+T asenum::details::AsVisit<T, ConcreteAsEnum, Handlers...>::ifDefault(const Handler& handler) &&
+{
+    const AsVisitCaller<T, ConcreteAsEnum, Handler, Handlers...> caller(m_slots, handler);
+    return AsEnumAccess::visit<T>(*m_asEnum, caller);
+}
+
+template <typename T, typename ConcreteAsEnum>
+asenum::details::AsVisitRoot<T, ConcreteAsEnum>::AsVisitRoot()
+{
+    this->m_slots = m_storage;
+}
+
+template <typename T, typename ConcreteAsEnum>
+asenum::details::AsVisit<T, ConcreteAsEnum>&& asenum::details::AsVisitRoot<T, ConcreteAsEnum>::bind(const ConcreteAsEnum& asEnum)
+{
+    this->m_asEnum = &asEnum;
+    
+    return std::move(*this);
+}
+
+// Private details - AsMatcher
+
+template <typename T, typename ConcreteAsEnum, typename Default, typename... Handlers>
+asenum::details::AsMatcher<T, ConcreteAsEnum, Default, Handlers...>::AsMatcher(std::tuple<typename Handlers::Handler...> handlers, Default defaultHandler)
+: m_handlers(std::move(handlers))
+, m_default(std::move(defaultHandler))
+{}
+
+template <typename T, typename ConcreteAsEnum, typename Default, typename... Handlers>
+template <typename asenum::details::AsMatcher<T, ConcreteAsEnum, Default, Handlers...>::Enum T_type, typename CaseHandler>
+typename asenum::details::AsMatcher<T, ConcreteAsEnum, Default, Handlers...>::template Next<T_type, CaseHandler>
+asenum::details::AsMatcher<T, ConcreteAsEnum, Default, Handlers...>::ifCase(const CaseHandler& handler) const
+{
+    static_assert(!Contains<Enum, T_type, Handlers::Code...>::value, "Duplicated matcher case.");
+    
+    using Handler = typename std::decay<CaseHandler>::type;
+    return Next<T_type, CaseHandler>(std::tuple_cat(m_handlers, std::tuple<Handler>(handler)), m_default);
+}
+
+template <typename T, typename ConcreteAsEnum, typename Default, typename... Handlers>
+template <typename Handler>
+asenum::details::AsMatcher<T, ConcreteAsEnum, typename std::decay<Handler>::type, Handlers...>
+asenum::details::AsMatcher<T, ConcreteAsEnum, Default, Handlers...>::ifDefault(const Handler& handler) const
+{
+    static_assert(std::is_same<Default, NoDefaultHandler>::value, "Duplicated matcher default.");
+    
+    return AsMatcher<T, ConcreteAsEnum, typename std::decay<Handler>::type, Handlers...>(m_handlers, handler);
+}
+
+template <typename T, typename ConcreteAsEnum, typename Default, typename... Handlers>
+T asenum::details::AsMatcher<T, ConcreteAsEnum, Default, Handlers...>::operator()(const ConcreteAsEnum& asEnum) const
+{
+    static_assert(IsComplete, "Matcher should handle all cases or have default handler.");
+    
+    return AsEnumAccess::visit<T>(asEnum, *this);
+}
+
+template <typename T, typename ConcreteAsEnum, typename Default, typename... Handlers>
+template <size_t I, typename UT>
+T asenum::details::AsMatcher<T, ConcreteAsEnum, Default, Handlers...>::visit(const UT* value) const
+{
+    static constexpr size_t Position = CasePosition<Enum, ConcreteAsEnum::AllCases[I], Handlers...>::value;
     
-    return false;
+    return call<Position>(value, std::integral_constant<bool, (Position < sizeof...(Handlers))>());
+}
+
+template <typename T, typename ConcreteAsEnum, typename Default, typename... Handlers>
+template <size_t Position, typename UT>
+T asenum::details::AsMatcher<T, ConcreteAsEnum, Default, Handlers...>::call(const UT* value, std::true_type) const
+{
+    return HandlerInvoker<T>::invoke(std::get<Position>(m_handlers), value);
+}
+
+template <typename T, typename ConcreteAsEnum, typename Default, typename... Handlers>
+template <size_t Position, typename UT>
+T asenum::details::AsMatcher<T, ConcreteAsEnum, Default, Handlers...>::call(const UT*, std::false_type) const
+{
+    return HandlerInvoker<T>::invoke(m_default, nullptr);
+}
+
+// Private details - Comparator
+
+template <typename ConcreteAsEnum, size_t... I>
+constexpr typename asenum::details::Comparator<ConcreteAsEnum, asenum::details::IndexSequence<I...>>::CompareFunction asenum::details::Comparator<ConcreteAsEnum, asenum::details::IndexSequence<I...>>::s_compareTable[];
+
+template <typename ConcreteAsEnum, size_t... I>
+constexpr typename asenum::details::Comparator<ConcreteAsEnum, asenum::details::IndexSequence<I...>>::EqualFunction asenum::details::Comparator<ConcreteAsEnum, asenum::details::IndexSequence<I...>>::s_equalTable[];
+
+template <typename ConcreteAsEnum, size_t... I>
+constexpr int asenum::details::Comparator<ConcreteAsEnum, asenum::details::IndexSequence<I...>>::compare(const ConcreteAsEnum& first, const ConcreteAsEnum& second)
+{
+    // Different cases are ordered by enum values, the same case - by values it holds.
+    return AsEnumAccess::storage(first).index() != AsEnumAccess::storage(second).index()
+    ? (first.enumCase() < second.enumCase() ? -1 : 1)
+    : s_compareTable[AsEnumAccess::storage(first).index()](first, second);
+}
+
+template <typename ConcreteAsEnum, size_t... I>
+constexpr bool asenum::details::Comparator<ConcreteAsEnum, asenum::details::IndexSequence<I...>>::equal(const ConcreteAsEnum& first, const ConcreteAsEnum& second)
+{
+    return AsEnumAccess::storage(first).index() == AsEnumAccess::storage(second).index()
+    && s_equalTable[AsEnumAccess::storage(first).index()](first, second);
+}
+
+template <typename ConcreteAsEnum, size_t... I>
+template <size_t Index>
+constexpr int asenum::details::Comparator<ConcreteAsEnum, asenum::details::IndexSequence<I...>>::compareCase(const ConcreteAsEnum& first, const ConcreteAsEnum& second)
+{
+    return compareValues(AsEnumAccess::storage(first).template get<Index>(), AsEnumAccess::storage(second).template get<Index>());
+}
+
+template <typename ConcreteAsEnum, size_t... I>
+template <size_t Index>
+constexpr bool asenum::details::Comparator<ConcreteAsEnum, asenum::details::IndexSequence<I...>>::equalCase(const ConcreteAsEnum& first, const ConcreteAsEnum& second)
+{
+    return equalValues(AsEnumAccess::storage(first).template get<Index>(), AsEnumAccess::storage(second).template get<Index>());
 }
 
-template <typename ConcreteAsEnum, template <typename T> class Cmp, typename T_Case>
-bool asenum::details::Comparator<ConcreteAsEnum, Cmp, T_Case>::compare(const ConcreteAsEnum& first, const ConcreteAsEnum& second)
+template <typename ConcreteAsEnum, size_t... I>
+constexpr int asenum::details::Comparator<ConcreteAsEnum, asenum::details::IndexSequence<I...>>::compareValues(const void*, const void*)
 {
-    bool finalVerdict = false;
-    return compare(first, second, finalVerdict);
+    return 0;
 }
 
-template <typename ConcreteAsEnum, template <typename T> class Cmp, typename T_Case>
+template <typename ConcreteAsEnum, size_t... I>
 template <typename T>
-typename std::enable_if<!std::is_same<T, void>::value, bool>::type
-asenum::details::Comparator<ConcreteAsEnum, Cmp, T_Case>::compare(const ConcreteAsEnum& first, const ConcreteAsEnum& second)
+constexpr int asenum::details::Comparator<ConcreteAsEnum, asenum::details::IndexSequence<I...>>::compareValues(const T* first, const T* second)
 {
-    using UT = typename ConcreteAsEnum::template UnderlyingType<T_Case::Code>;
-    static constexpr Cmp<UT> s_comparator;
-    return s_comparator(first.template forceAsCase<T_Case::Code>(), second.template forceAsCase<T_Case::Code>());
+    return *first < *second ? -1
+    : *second < *first ? 1 : 0;
 }
 
-template <typename ConcreteAsEnum, template <typename T> class Cmp, typename T_Case>
+template <typename ConcreteAsEnum, size_t... I>
+constexpr bool asenum::details::Comparator<ConcreteAsEnum, asenum::details::IndexSequence<I...>>::equalValues(const void*, const void*)
+{
+    return true;
+}
+
+template <typename ConcreteAsEnum, size_t... I>
 template <typename T>
-typename std::enable_if<std::is_same<T, void>::value, bool>::type
-asenum::details::Comparator<ConcreteAsEnum, Cmp, T_Case>::compare(const ConcreteAsEnum&, const ConcreteAsEnum&)
+constexpr bool asenum::details::Comparator<ConcreteAsEnum, asenum::details::IndexSequence<I...>>::equalValues(const T* first, const T* second)
+{
+    return *first == *second;
+}
+
+template <typename ConcreteAsEnum, size_t... I>
+template <typename Relation>
+constexpr typename asenum::details::Comparator<ConcreteAsEnum, asenum::details::IndexSequence<I...>>::EqualFunction asenum::details::Comparator<ConcreteAsEnum, asenum::details::IndexSequence<I...>>::RelationTable<Relation>::s_table[];
+
+template <typename ConcreteAsEnum, size_t... I>
+template <typename Relation>
+constexpr bool asenum::details::Comparator<ConcreteAsEnum, asenum::details::IndexSequence<I...>>::relation(const ConcreteAsEnum& first, const ConcreteAsEnum& second)
 {
-    static constexpr Cmp<bool> s_comparator;
-    return s_comparator(true, true);
+    return AsEnumAccess::storage(first).index() != AsEnumAccess::storage(second).index()
+    ? Relation()(first.enumCase(), second.enumCase())
+    : RelationTable<Relation>::s_table[AsEnumAccess::storage(first).index()](first, second);
 }
 
-template <typename ConcreteAsEnum, template <typename T> class Cmp, typename T_Case, typename... T_Cases>
-bool asenum::details::Comparator<ConcreteAsEnum, Cmp, T_Case, T_Cases...>::compare(const ConcreteAsEnum& first, const ConcreteAsEnum& second)
+template <typename ConcreteAsEnum, size_t... I>
+template <typename Relation, size_t Index>
+constexpr bool asenum::details::Comparator<ConcreteAsEnum, asenum::details::IndexSequence<I...>>::relationCase(const ConcreteAsEnum& first, const ConcreteAsEnum& second)
 {
-    bool finalVerdict = false;
-    const bool result = Comparator<ConcreteAsEnum, Cmp, T_Case>::compare(first, second, finalVerdict);
-    if (finalVerdict)
-    {
-        return result;
-    }
+    return relationValues<Relation>(AsEnumAccess::storage(first).template get<Index>(), AsEnumAccess::storage(second).template get<Index>());
+}
+
+template <typename ConcreteAsEnum, size_t... I>
+template <typename Relation>
+constexpr bool asenum::details::Comparator<ConcreteAsEnum, asenum::details::IndexSequence<I...>>::relationValues(const void*, const void*)
+{
+    return Relation()(true, true);
+}
+
+template <typename ConcreteAsEnum, size_t... I>
+template <typename Relation, typename T>
+constexpr bool asenum::details::Comparator<ConcreteAsEnum, asenum::details::IndexSequence<I...>>::relationValues(const T* first, const T* second)
+{
+    return Relation()(*first, *second);
+}
+
+// Private details - Hasher
+
+inline size_t asenum::details::MixHash(const size_t value)
+{
+    return static_cast<size_t>(Fmix64(value));
+}
+
+template <typename ConcreteAsEnum, size_t... I>
+size_t asenum::details::Hasher<ConcreteAsEnum, asenum::details::IndexSequence<I...>>::hash(const ConcreteAsEnum& asEnum)
+{
+    using CaseFunction = size_t (*)(const ConcreteAsEnum&);
+    static constexpr CaseFunction s_table[] = { &hashCase<I>... };
     
-    return Comparator<ConcreteAsEnum, Cmp, T_Cases...>::compare(first, second);
+    return s_table[AsEnumAccess::storage(asEnum).index()](asEnum);
+}
+
+template <typename ConcreteAsEnum, size_t... I>
+template <size_t Index>
+size_t asenum::details::Hasher<ConcreteAsEnum, asenum::details::IndexSequence<I...>>::hashCase(const ConcreteAsEnum& asEnum)
+{
+    return hashValue(Index, AsEnumAccess::storage(asEnum).template get<Index>());
+}
+
+template <typename ConcreteAsEnum, size_t... I>
+size_t asenum::details::Hasher<ConcreteAsEnum, asenum::details::IndexSequence<I...>>::hashValue(const size_t tag, const void*)
+{
+    return MixHash(tag);
+}
+
+template <typename ConcreteAsEnum, size_t... I>
+template <typename T>
+size_t asenum::details::Hasher<ConcreteAsEnum, asenum::details::IndexSequence<I...>>::hashValue(const size_t tag, const T* value)
+{
+    return MixHash(std::hash<T>()(*value) + tag * static_cast<size_t>(0x9e3779b97f4a7c15ULL));
+}
+
+// std::hash
+
+template <typename T_Storage, typename... T_Cases>
+size_t std::hash<asenum::BasicAsEnum<T_Storage, T_Cases...>>::operator()(const asenum::BasicAsEnum<T_Storage, T_Cases...>& asEnum) const
+{
+    using ConcreteAsEnum = asenum::BasicAsEnum<T_Storage, T_Cases...>;
+    return asenum::details::Hasher<ConcreteAsEnum, typename asenum::details::MakeIndexSequence<sizeof...(T_Cases)>::type>::hash(asEnum);
 }
@@ -0,0 +1,576 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Alkenso (Vladimir Vashurkin)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <asenum/asenum.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace asenum
+{
+    namespace details
+    {
+        template <typename ConcreteAsEnum>
+        class WordAsEnumCell;
+        
+        template <typename ConcreteAsEnum>
+        class HazardAsEnumCell;
+        
+        /// AsEnum that fits single 64-bit atomic word: trivially copyable (see 'LiteralPayloadStorage') and small enough.
+        template <typename ConcreteAsEnum>
+        struct IsWordAsEnum : std::integral_constant<bool, std::is_trivially_copyable<ConcreteAsEnum>::value && sizeof(ConcreteAsEnum) <= sizeof(uint64_t)> {};
+        
+        /// AsEnum which copies share heap values with non-atomic reference counter (see 'LocalSharedOwnership').
+        template <typename ConcreteAsEnum>
+        struct IsLocalSharedAsEnum : std::false_type {};
+        
+        template <typename Storage, typename... Cases>
+        struct IsLocalSharedAsEnum<BasicAsEnum<Storage, Cases...>> : std::is_same<typename Storage::Ownership, LocalSharedOwnership> {};
+    }
+    
+    /**
+     Atomic cell with AsEnum value: lock-free publication of state snapshots polled by many threads.
+     
+     Small trivially copyable AsEnum (e.g. 'void', enum or 'int' payloads) is kept in single 64-bit atomic word.
+     Other values are kept in immutable heap snapshots: each write publishes new snapshot and retires the previous one,
+     readers protect the snapshot they access with per-thread hazard pointer (see 'HazardGuard').
+     
+     Readers never block and never write to cache lines shared with other threads.
+     'read' gives access to the current value without copying it; 'load' returns a copy,
+     that for heap payloads increments their reference counter.
+     Writers don't block readers; they occasionally scan hazard pointers of all threads to free retired snapshots.
+     
+     Reads have acquire semantics, writes have release semantics.
+     */
+    template <typename ConcreteAsEnum>
+    class AtomicAsEnum
+    {
+        static_assert(details::IsWordAsEnum<ConcreteAsEnum>::value || !details::IsLocalSharedAsEnum<ConcreteAsEnum>::value, "Values with non-atomic reference counter can't be shared between threads.");
+        
+    public:
+        /// True if value is kept in single 64-bit atomic word and no heap snapshots are allocated.
+        static constexpr bool IsSingleWord = details::IsWordAsEnum<ConcreteAsEnum>::value;
+        
+        explicit AtomicAsEnum(ConcreteAsEnum value);
+        
+        AtomicAsEnum(const AtomicAsEnum&) = delete;
+        AtomicAsEnum& operator=(const AtomicAsEnum&) = delete;
+        
+        /// @return copy of the current value.
+        ConcreteAsEnum load() const;
+        
+        /// Replaces the current value.
+        void store(ConcreteAsEnum value);
+        
+        /// Replaces the current value. @return previous value.
+        ConcreteAsEnum exchange(ConcreteAsEnum value);
+        
+        /**
+         Replaces the current value with 'desired' if it is equal to 'expected'.
+         Values are compared with 'operator==' (not bitwise), so padding bytes never cause spurious failure.
+         @return true if value is replaced. Otherwise 'expected' receives the current value.
+         */
+        bool compareExchange(ConcreteAsEnum& expected, ConcreteAsEnum desired);
+        
+        /**
+         Calls 'handler(const ConcreteAsEnum&)' with the current value and returns its result.
+         Value is not copied and is guaranteed to stay alive until handler returns, even if it is replaced concurrently.
+         Handler may read other AtomicAsEnum cells, nesting depth is limited by 'HazardRecord::SlotCount'.
+         */
+        template <typename Handler>
+        auto read(const Handler& handler) const -> decltype(handler(std::declval<const ConcreteAsEnum&>()));
+        
+    private:
+        using Cell = typename std::conditional<IsSingleWord, details::WordAsEnumCell<ConcreteAsEnum>, details::HazardAsEnumCell<ConcreteAsEnum>>::type;
+        
+        Cell m_cell;
+    };
+    
+    namespace details
+    {
+        /**
+         Hazard pointers of single thread. Each record occupies own cache line: only owning thread writes it,
+         writers of AtomicAsEnum read all records when they free retired snapshots.
+         */
+        struct alignas(CacheLineSize) HazardRecord
+        {
+            /// Maximum number of pointers protected by one thread at once (nested 'AtomicAsEnum::read').
+            static constexpr size_t SlotCount = 4;
+            
+            HazardRecord();
+            
+            std::atomic<const void*> slots[SlotCount];
+            std::atomic<bool> active;
+            
+            /// Records form lock-free list that only grows: 'next' is immutable after the record is published.
+            HazardRecord* next;
+        };
+        
+        /**
+         Protects pointer read from atomic source against reclamation while the guard is alive.
+         Takes next free slot of the current thread's hazard record, so guards must be destroyed in reverse order.
+         */
+        class HazardGuard
+        {
+        public:
+            HazardGuard();
+            ~HazardGuard();
+            
+            HazardGuard(const HazardGuard&) = delete;
+            HazardGuard& operator=(const HazardGuard&) = delete;
+            
+            /// @return value of 'source' that is protected until 'reset' or guard destruction.
+            template <typename T>
+            T* protect(const std::atomic<T*>& source);
+            
+            void reset();
+            
+        private:
+            std::atomic<const void*>& m_slot;
+        };
+        
+        /// @return sorted pointers protected by all threads at the moment.
+        std::vector<const void*> ProtectedPointers();
+        
+        /**
+         Hazard record of the current thread taken from the list on first use and the number of occupied slots.
+         Records are never freed: record of exited thread is reused by new threads.
+         */
+        struct LocalHazards
+        {
+            ~LocalHazards();
+            
+            HazardRecord* record = nullptr;
+            size_t depth = 0;
+        };
+        
+        std::atomic<HazardRecord*>& HazardRecords();
+        LocalHazards& CurrentHazards();
+        HazardRecord* AcquireHazardRecord();
+        
+        template <typename ConcreteAsEnum>
+        class WordAsEnumCell
+        {
+        public:
+            explicit WordAsEnumCell(const ConcreteAsEnum& value);
+            
+            ConcreteAsEnum load() const;
+            void store(const ConcreteAsEnum& value);
+            ConcreteAsEnum exchange(const ConcreteAsEnum& value);
+            bool compareExchange(ConcreteAsEnum& expected, const ConcreteAsEnum& desired);
+            
+            template <typename Handler>
+            auto read(const Handler& handler) const -> decltype(handler(std::declval<const ConcreteAsEnum&>()));
+            
+        private:
+            static uint64_t Encode(const ConcreteAsEnum& value);
+            static ConcreteAsEnum Decode(uint64_t word);
+            
+        private:
+            std::atomic<uint64_t> m_word;
+        };
+        
+        template <typename ConcreteAsEnum>
+        class HazardAsEnumCell
+        {
+        public:
+            explicit HazardAsEnumCell(ConcreteAsEnum&& value);
+            ~HazardAsEnumCell();
+            
+            ConcreteAsEnum load() const;
+            void store(ConcreteAsEnum&& value);
+            ConcreteAsEnum exchange(ConcreteAsEnum&& value);
+            bool compareExchange(ConcreteAsEnum& expected, ConcreteAsEnum&& desired);
+            
+            template <typename Handler>
+            auto read(const Handler& handler) const -> decltype(handler(std::declval<const ConcreteAsEnum&>()));
+            
+        private:
+            struct Snapshot
+            {
+                ConcreteAsEnum value;
+            };
+            
+            /// Retired snapshots are scanned at least after this number of writes.
+            static constexpr size_t MinScanThreshold = 32;
+            
+            void retire(Snapshot* snapshot);
+            
+        private:
+            std::atomic<Snapshot*> m_current;
+            
+            std::mutex m_retiredMutex;
+            std::vector<Snapshot*> m_retired;
+            size_t m_scanThreshold = MinScanThreshold;
+        };
+    }
+}
+
+
+// Public - AtomicAsEnum
+
+template <typename ConcreteAsEnum>
+constexpr bool asenum::AtomicAsEnum<ConcreteAsEnum>::IsSingleWord;
+
+template <typename ConcreteAsEnum>
+asenum::AtomicAsEnum<ConcreteAsEnum>::AtomicAsEnum(ConcreteAsEnum value)
+: m_cell(std::move(value))
+{}
+
+template <typename ConcreteAsEnum>
+ConcreteAsEnum asenum::AtomicAsEnum<ConcreteAsEnum>::load() const
+{
+    return m_cell.load();
+}
+
+template <typename ConcreteAsEnum>
+void asenum::AtomicAsEnum<ConcreteAsEnum>::store(ConcreteAsEnum value)
+{
+    m_cell.store(std::move(value));
+}
+
+template <typename ConcreteAsEnum>
+ConcreteAsEnum asenum::AtomicAsEnum<ConcreteAsEnum>::exchange(ConcreteAsEnum value)
+{
+    return m_cell.exchange(std::move(value));
+}
+
+template <typename ConcreteAsEnum>
+bool asenum::AtomicAsEnum<ConcreteAsEnum>::compareExchange(ConcreteAsEnum& expected, ConcreteAsEnum desired)
+{
+    return m_cell.compareExchange(expected, std::move(desired));
+}
+
+template <typename ConcreteAsEnum>
+template <typename Handler>
+auto asenum::AtomicAsEnum<ConcreteAsEnum>::read(const Handler& handler) const -> decltype(handler(std::declval<const ConcreteAsEnum&>()))
+{
+    return m_cell.read(handler);
+}
+
+// Private details - hazard pointers
+
+inline asenum::details::HazardRecord::HazardRecord()
+: active(true)
+, next(nullptr)
+{
+    for (std::atomic<const void*>& slot : slots)
+    {
+        slot.store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+inline asenum::details::HazardGuard::HazardGuard()
+: m_slot([] () -> std::atomic<const void*>& {
+    LocalHazards& local = CurrentHazards();
+    if (!local.record)
+    {
+        local.record = AcquireHazardRecord();
+    }
+    if (local.depth == HazardRecord::SlotCount)
+    {
+        details::RaiseError<std::logic_error>("Too many nested AtomicAsEnum reads.");
+    }
+    return local.record->slots[local.depth++];
+}())
+{}
+
+inline asenum::details::HazardGuard::~HazardGuard()
+{
+    reset();
+    CurrentHazards().depth--;
+}
+
+template <typename T>
+T* asenum::details::HazardGuard::protect(const std::atomic<T*>& source)
+{
+    T* value = source.load(std::memory_order_acquire);
+    while (true)
+    {
+        // Publish the hazard before re-reading the source: writer that replaced the value afterwards sees the hazard in its scan.
+        m_slot.store(value, std::memory_order_seq_cst);
+        T* const actual = source.load(std::memory_order_seq_cst);
+        if (actual == value)
+        {
+            return value;
+        }
+        value = actual;
+    }
+}
+
+inline void asenum::details::HazardGuard::reset()
+{
+    m_slot.store(nullptr, std::memory_order_release);
+}
+
+inline std::vector<const void*> asenum::details::ProtectedPointers()
+{
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    
+    std::vector<const void*> pointers;
+    for (const HazardRecord* record = HazardRecords().load(std::memory_order_acquire); record; record = record->next)
+    {
+        for (const std::atomic<const void*>& slot : record->slots)
+        {
+            if (const void* const pointer = slot.load(std::memory_order_seq_cst))
+            {
+                pointers.push_back(pointer);
+            }
+        }
+    }
+    
+    std::sort(pointers.begin(), pointers.end());
+    return pointers;
+}
+
+inline asenum::details::LocalHazards::~LocalHazards()
+{
+    if (record)
+    {
+        record->active.store(false, std::memory_order_release);
+    }
+}
+
+inline std::atomic<asenum::details::HazardRecord*>& asenum::details::HazardRecords()
+{
+    static std::atomic<HazardRecord*> s_head(nullptr);
+    return s_head;
+}
+
+inline asenum::details::LocalHazards& asenum::details::CurrentHazards()
+{
+    static thread_local LocalHazards s_hazards;
+    return s_hazards;
+}
+
+inline asenum::details::HazardRecord* asenum::details::AcquireHazardRecord()
+{
+    std::atomic<HazardRecord*>& head = HazardRecords();
+    for (HazardRecord* record = head.load(std::memory_order_acquire); record; record = record->next)
+    {
+        bool active = false;
+        if (!record->active.load(std::memory_order_relaxed) && record->active.compare_exchange_strong(active, true, std::memory_order_acquire))
+        {
+            return record;
+        }
+    }
+    
+    // Intentionally never freed: other threads may walk the list at any moment.
+    void* const memory = ::operator new(sizeof(HazardRecord) + CacheLineSize - 1);
+    const uintptr_t address = (reinterpret_cast<uintptr_t>(memory) + CacheLineSize - 1) / CacheLineSize * CacheLineSize;
+    HazardRecord* const record = new (reinterpret_cast<void*>(address)) HazardRecord();
+    
+    record->next = head.load(std::memory_order_relaxed);
+    while (!head.compare_exchange_weak(record->next, record, std::memory_order_release, std::memory_order_relaxed))
+    {}
+    
+    return record;
+}
+
+// Private details - WordAsEnumCell
+
+template <typename ConcreteAsEnum>
+asenum::details::WordAsEnumCell<ConcreteAsEnum>::WordAsEnumCell(const ConcreteAsEnum& value)
+: m_word(Encode(value))
+{}
+
+template <typename ConcreteAsEnum>
+ConcreteAsEnum asenum::details::WordAsEnumCell<ConcreteAsEnum>::load() const
+{
+    return Decode(m_word.load(std::memory_order_acquire));
+}
+
+template <typename ConcreteAsEnum>
+void asenum::details::WordAsEnumCell<ConcreteAsEnum>::store(const ConcreteAsEnum& value)
+{
+    m_word.store(Encode(value), std::memory_order_release);
+}
+
+template <typename ConcreteAsEnum>
+ConcreteAsEnum asenum::details::WordAsEnumCell<ConcreteAsEnum>::exchange(const ConcreteAsEnum& value)
+{
+    return Decode(m_word.exchange(Encode(value), std::memory_order_acq_rel));
+}
+
+template <typename ConcreteAsEnum>
+bool asenum::details::WordAsEnumCell<ConcreteAsEnum>::compareExchange(ConcreteAsEnum& expected, const ConcreteAsEnum& desired)
+{
+    const uint64_t desiredWord = Encode(desired);
+    uint64_t current = Encode(expected);
+    while (!m_word.compare_exchange_weak(current, desiredWord, std::memory_order_acq_rel, std::memory_order_acquire))
+    {
+        // Equal values may differ in padding and inactive payload bytes: retry with the actual representation.
+        const ConcreteAsEnum actual = Decode(current);
+        if (!(actual == expected))
+        {
+            expected = actual;
+            return false;
+        }
+    }
+    
+    return true;
+}
+
+template <typename ConcreteAsEnum>
+template <typename Handler>
+auto asenum::details::WordAsEnumCell<ConcreteAsEnum>::read(const Handler& handler) const -> decltype(handler(std::declval<const ConcreteAsEnum&>()))
+{
+    const ConcreteAsEnum value = load();
+    return handler(value);
+}
+
+template <typename ConcreteAsEnum>
+uint64_t asenum::details::WordAsEnumCell<ConcreteAsEnum>::Encode(const ConcreteAsEnum& value)
+{
+    uint64_t word = 0;
+    std::memcpy(&word, &value, sizeof(ConcreteAsEnum));
+    return word;
+}
+
+template <typename ConcreteAsEnum>
+ConcreteAsEnum asenum::details::WordAsEnumCell<ConcreteAsEnum>::Decode(const uint64_t word)
+{
+    typename std::aligned_storage<sizeof(ConcreteAsEnum), alignof(ConcreteAsEnum)>::type buffer;
+    std::memcpy(&buffer, &word, sizeof(ConcreteAsEnum));
+    return *reinterpret_cast<const ConcreteAsEnum*>(&buffer);
+}
+
+// Private details - HazardAsEnumCell
+
+template <typename ConcreteAsEnum>
+constexpr size_t asenum::details::HazardAsEnumCell<ConcreteAsEnum>::MinScanThreshold;
+
+template <typename ConcreteAsEnum>
+asenum::details::HazardAsEnumCell<ConcreteAsEnum>::HazardAsEnumCell(ConcreteAsEnum&& value)
+: m_current(new Snapshot { std::move(value) })
+{}
+
+template <typename ConcreteAsEnum>
+asenum::details::HazardAsEnumCell<ConcreteAsEnum>::~HazardAsEnumCell()
+{
+    delete m_current.load(std::memory_order_relaxed);
+    for (Snapshot* snapshot : m_retired)
+    {
+        delete snapshot;
+    }
+}
+
+template <typename ConcreteAsEnum>
+ConcreteAsEnum asenum::details::HazardAsEnumCell<ConcreteAsEnum>::load() const
+{
+    HazardGuard guard;
+    return guard.protect(m_current)->value;
+}
+
+template <typename ConcreteAsEnum>
+void asenum::details::HazardAsEnumCell<ConcreteAsEnum>::store(ConcreteAsEnum&& value)
+{
+    retire(m_current.exchange(new Snapshot { std::move(value) }, std::memory_order_seq_cst));
+}
+
+template <typename ConcreteAsEnum>
+ConcreteAsEnum asenum::details::HazardAsEnumCell<ConcreteAsEnum>::exchange(ConcreteAsEnum&& value)
+{
+    Snapshot* const previous = m_current.exchange(new Snapshot { std::move(value) }, std::memory_order_seq_cst);
+    
+    // Readers may still access previous snapshot, so its value is copied, not moved.
+    ConcreteAsEnum result = previous->value;
+    retire(previous);
+    
+    return result;
+}
+
+template <typename ConcreteAsEnum>
+bool asenum::details::HazardAsEnumCell<ConcreteAsEnum>::compareExchange(ConcreteAsEnum& expected, ConcreteAsEnum&& desired)
+{
+    std::unique_ptr<Snapshot> snapshot(new Snapshot { std::move(desired) });
+    
+    HazardGuard guard;
+    while (true)
+    {
+        Snapshot* current = guard.protect(m_current);
+        if (!(current->value == expected))
+        {
+            expected = current->value;
+            return false;
+        }
+        
+        if (m_current.compare_exchange_strong(current, snapshot.get(), std::memory_order_seq_cst))
+        {
+            snapshot.release();
+            guard.reset();
+            retire(current);
+            return true;
+        }
+    }
+}
+
+template <typename ConcreteAsEnum>
+template <typename Handler>
+auto asenum::details::HazardAsEnumCell<ConcreteAsEnum>::read(const Handler& handler) const -> decltype(handler(std::declval<const ConcreteAsEnum&>()))
+{
+    HazardGuard guard;
+    return handler(guard.protect(m_current)->value);
+}
+
+template <typename ConcreteAsEnum>
+void asenum::details::HazardAsEnumCell<ConcreteAsEnum>::retire(Snapshot* const snapshot)
+{
+    std::vector<Snapshot*> reclaimed;
+    {
+        std::lock_guard<std::mutex> lock(m_retiredMutex);
+        m_retired.push_back(snapshot);
+        if (m_retired.size() < m_scanThreshold)
+        {
+            return;
+        }
+        
+        const std::vector<const void*> hazards = ProtectedPointers();
+        const auto isProtected = [&hazards] (const Snapshot* retired) {
+            return std::binary_search(hazards.begin(), hazards.end(), static_cast<const void*>(retired));
+        };
+        
+        const auto kept = std::partition(m_retired.begin(), m_retired.end(), isProtected);
+        reclaimed.assign(kept, m_retired.end());
+        m_retired.erase(kept, m_retired.end());
+        
+        // Snapshots protected for long time are scanned again only after proportional number of writes.
+        m_scanThreshold = std::max(MinScanThreshold, 2 * m_retired.size());
+    }
+    
+    for (Snapshot* retired : reclaimed)
+    {
+        delete retired;
+    }
+}
@@ -0,0 +1,312 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Alkenso (Vladimir Vashurkin)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <asenum/asenum.h>
+
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+namespace asenum
+{
+    /**
+     Indices of batch values grouped by case.
+     Built by counting sort over case indices: one pass counts values of each case, second pass scatters their positions.
+     Grouping is stable: inside each group indices are ascending.
+     Keep instance between batches to reuse its buffers.
+     */
+    class CaseGroups
+    {
+    public:
+        /// Groups indices of 'count' values by case. Previous grouping is discarded.
+        template <typename ConcreteAsEnum>
+        void assign(const ConcreteAsEnum* values, size_t count);
+        
+        /// @return total number of grouped indices.
+        size_t size() const;
+        
+        /// @return number of groups, equal to number of cases of grouped AsEnum.
+        size_t groupCount() const;
+        
+        /// @return all indices ordered by case index.
+        const size_t* indices() const;
+        
+        /// @return indices of values which case index equals 'caseIndex'.
+        const size_t* groupBegin(size_t caseIndex) const;
+        const size_t* groupEnd(size_t caseIndex) const;
+        
+        size_t groupSize(size_t caseIndex) const;
+        
+    private:
+        std::vector<size_t> m_offsets;
+        std::vector<size_t> m_indices;
+    };
+    
+    /// Order of outputs of 'groupedMap'.
+    enum class BatchOrder
+    {
+        /// 'output[i]' is result for 'values[i]'.
+        Original,
+        
+        /// 'output[k]' is result for 'values[groups.indices()[k]]'. Outputs are written sequentially.
+        Grouped
+    };
+    
+    /**
+     Calls handler of each case over whole group of values of that case.
+     Dispatch by case is made once per group instead of once per value,
+     so loop over each group calls single handler and has no data-dependent branches.
+     Handlers of different cases are called in order of cases, values of the same case - in original order.
+     
+     @param groups Grouping of 'values' made by 'CaseGroups::assign'.
+     @param matcher Reusable matcher created with 'AsEnum::matcher<T>()'.
+     @throws std::invalid_argument exception if 'groups' were made for AsEnum with different number of cases, even if they are empty.
+     */
+    template <typename ConcreteAsEnum, typename Matcher>
+    void groupedForEachCase(const CaseGroups& groups, const ConcreteAsEnum* values, const Matcher& matcher);
+    
+    /// Same as above, but groups values with temporary 'CaseGroups'.
+    template <typename ConcreteAsEnum, typename Matcher>
+    void groupedForEachCase(const ConcreteAsEnum* values, size_t count, const Matcher& matcher);
+    
+    /**
+     Same as 'groupedForEachCase', but writes results of handlers into 'output'.
+     
+     @param output Preallocated output of at least 'groups.size()' elements.
+     @param order Position of results in 'output': original position of value or position in 'groups.indices()'.
+     */
+    template <typename ConcreteAsEnum, typename Matcher, typename T>
+    void groupedMap(const CaseGroups& groups, const ConcreteAsEnum* values, const Matcher& matcher, T* output, BatchOrder order = BatchOrder::Original);
+    
+    /// Same as above, but groups values with temporary 'CaseGroups'. Results are written in original order.
+    template <typename ConcreteAsEnum, typename Matcher, typename T>
+    void groupedMap(const ConcreteAsEnum* values, size_t count, const Matcher& matcher, T* output);
+    
+    namespace details
+    {
+        template <typename ConcreteAsEnum, typename Matcher, typename Indices>
+        struct GroupedTable;
+        
+        /// Per-case loops over groups. Each loop calls handler of its case directly.
+        template <typename ConcreteAsEnum, typename Matcher, size_t... I>
+        struct GroupedTable<ConcreteAsEnum, Matcher, IndexSequence<I...>>
+        {
+            static void checkGroups(const CaseGroups& groups);
+            
+            static void forEach(const CaseGroups& groups, const ConcreteAsEnum* values, const Matcher& matcher);
+            
+            template <typename T>
+            static void map(const CaseGroups& groups, const ConcreteAsEnum* values, const Matcher& matcher, T* output, BatchOrder order);
+            
+            template <size_t Index>
+            static void forEachCase(const size_t* begin, const size_t* end, const ConcreteAsEnum* values, const Matcher& matcher);
+            
+            template <size_t Index, typename T>
+            static void mapCase(const size_t* begin, const size_t* end, const ConcreteAsEnum* values, const Matcher& matcher, T* output);
+            
+            template <size_t Index, typename T>
+            static void mapCaseGrouped(const size_t* begin, const size_t* end, const ConcreteAsEnum* values, const Matcher& matcher, T* output);
+        };
+        
+        template <typename ConcreteAsEnum, typename Matcher>
+        using GroupedTableOf = GroupedTable<ConcreteAsEnum, Matcher, typename MakeIndexSequence<ArraySize(ConcreteAsEnum::AllCases)>::type>;
+    }
+}
+
+
+// Public - CaseGroups
+
+template <typename ConcreteAsEnum>
+void asenum::CaseGroups::assign(const ConcreteAsEnum* values, const size_t count)
+{
+    const size_t caseCount = details::ArraySize(ConcreteAsEnum::AllCases);
+    
+    m_offsets.assign(caseCount + 1, 0);
+    m_indices.resize(count);
+    
+    for (size_t i = 0; i < count; i++)
+    {
+        m_offsets[values[i].caseIndex()]++;
+    }
+    
+    size_t offset = 0;
+    for (size_t c = 0; c < caseCount; c++)
+    {
+        const size_t groupSize = m_offsets[c];
+        m_offsets[c] = offset;
+        offset += groupSize;
+    }
+    
+    // after scatter each offset points to the end of its group, that is the beginning of the next one
+    for (size_t i = 0; i < count; i++)
+    {
+        m_indices[m_offsets[values[i].caseIndex()]++] = i;
+    }
+    
+    for (size_t c = caseCount; c > 0; c--)
+    {
+        m_offsets[c] = m_offsets[c - 1];
+    }
+    m_offsets[0] = 0;
+}
+
+inline size_t asenum::CaseGroups::size() const
+{
+    return m_indices.size();
+}
+
+inline size_t asenum::CaseGroups::groupCount() const
+{
+    return m_offsets.empty() ? 0 : m_offsets.size() - 1;
+}
+
+inline const size_t* asenum::CaseGroups::indices() const
+{
+    return m_indices.data();
+}
+
+inline const size_t* asenum::CaseGroups::groupBegin(const size_t caseIndex) const
+{
+    return m_indices.data() + m_offsets[caseIndex];
+}
+
+inline const size_t* asenum::CaseGroups::groupEnd(const size_t caseIndex) const
+{
+    return m_indices.data() + m_offsets[caseIndex + 1];
+}
+
+inline size_t asenum::CaseGroups::groupSize(const size_t caseIndex) const
+{
+    return m_offsets[caseIndex + 1] - m_offsets[caseIndex];
+}
+
+// Public - algorithms
+
+template <typename ConcreteAsEnum, typename Matcher>
+void asenum::groupedForEachCase(const CaseGroups& groups, const ConcreteAsEnum* values, const Matcher& matcher)
+{
+    details::GroupedTableOf<ConcreteAsEnum, Matcher>::forEach(groups, values, matcher);
+}
+
+template <typename ConcreteAsEnum, typename Matcher>
+void asenum::groupedForEachCase(const ConcreteAsEnum* values, const size_t count, const Matcher& matcher)
+{
+    CaseGroups groups;
+    groups.assign(values, count);
+    groupedForEachCase(groups, values, matcher);
+}
+
+template <typename ConcreteAsEnum, typename Matcher, typename T>
+void asenum::groupedMap(const CaseGroups& groups, const ConcreteAsEnum* values, const Matcher& matcher, T* output, const BatchOrder order)
+{
+    details::GroupedTableOf<ConcreteAsEnum, Matcher>::map(groups, values, matcher, output, order);
+}
+
+template <typename ConcreteAsEnum, typename Matcher, typename T>
+void asenum::groupedMap(const ConcreteAsEnum* values, const size_t count, const Matcher& matcher, T* output)
+{
+    CaseGroups groups;
+    groups.assign(values, count);
+    groupedMap(groups, values, matcher, output, BatchOrder::Original);
+}
+
+// Private details - GroupedTable
+
+template <typename ConcreteAsEnum, typename Matcher, size_t... I>
+void asenum::details::GroupedTable<ConcreteAsEnum, Matcher, asenum::details::IndexSequence<I...>>::checkGroups(const CaseGroups& groups)
+{
+    // never assigned groups have no groups at all and are safe to iterate
+    if (groups.groupCount() != 0 && groups.groupCount() != sizeof...(I))
+    {
+        details::RaiseError<std::invalid_argument>("Groups were made for AsEnum with different cases.");
+    }
+}
+
+template <typename ConcreteAsEnum, typename Matcher, size_t... I>
+void asenum::details::GroupedTable<ConcreteAsEnum, Matcher, asenum::details::IndexSequence<I...>>::forEach(const CaseGroups& groups, const ConcreteAsEnum* values, const Matcher& matcher)
+{
+    using CaseFunction = void (*)(const size_t*, const size_t*, const ConcreteAsEnum*, const Matcher&);
+    static constexpr CaseFunction s_table[] = { &forEachCase<I>... };
+    
+    checkGroups(groups);
+    for (size_t c = 0; c < groups.groupCount(); c++)
+    {
+        s_table[c](groups.groupBegin(c), groups.groupEnd(c), values, matcher);
+    }
+}
+
+template <typename ConcreteAsEnum, typename Matcher, size_t... I>
+template <typename T>
+void asenum::details::GroupedTable<ConcreteAsEnum, Matcher, asenum::details::IndexSequence<I...>>::map(const CaseGroups& groups, const ConcreteAsEnum* values, const Matcher& matcher, T* output, const BatchOrder order)
+{
+    using CaseFunction = void (*)(const size_t*, const size_t*, const ConcreteAsEnum*, const Matcher&, T*);
+    static constexpr CaseFunction s_original[] = { &mapCase<I, T>... };
+    static constexpr CaseFunction s_grouped[] = { &mapCaseGrouped<I, T>... };
+    
+    checkGroups(groups);
+    for (size_t c = 0; c < groups.groupCount(); c++)
+    {
+        if (order == BatchOrder::Original)
+        {
+            s_original[c](groups.groupBegin(c), groups.groupEnd(c), values, matcher, output);
+        }
+        else
+        {
+            s_grouped[c](groups.groupBegin(c), groups.groupEnd(c), values, matcher, output + (groups.groupBegin(c) - groups.indices()));
+        }
+    }
+}
+
+template <typename ConcreteAsEnum, typename Matcher, size_t... I>
+template <size_t Index>
+void asenum::details::GroupedTable<ConcreteAsEnum, Matcher, asenum::details::IndexSequence<I...>>::forEachCase(const size_t* begin, const size_t* end, const ConcreteAsEnum* values, const Matcher& matcher)
+{
+    for (; begin != end; begin++)
+    {
+        matcher.template visit<Index>(AsEnumAccess::storage(values[*begin]).template get<Index>());
+    }
+}
+
+template <typename ConcreteAsEnum, typename Matcher, size_t... I>
+template <size_t Index, typename T>
+void asenum::details::GroupedTable<ConcreteAsEnum, Matcher, asenum::details::IndexSequence<I...>>::mapCase(const size_t* begin, const size_t* end, const ConcreteAsEnum* values, const Matcher& matcher, T* output)
+{
+    for (; begin != end; begin++)
+    {
+        output[*begin] = matcher.template visit<Index>(AsEnumAccess::storage(values[*begin]).template get<Index>());
+    }
+}
+
+template <typename ConcreteAsEnum, typename Matcher, size_t... I>
+template <size_t Index, typename T>
+void asenum::details::GroupedTable<ConcreteAsEnum, Matcher, asenum::details::IndexSequence<I...>>::mapCaseGrouped(const size_t* begin, const size_t* end, const ConcreteAsEnum* values, const Matcher& matcher, T* output)
+{
+    for (; begin != end; begin++, output++)
+    {
+        *output = matcher.template visit<Index>(AsEnumAccess::storage(values[*begin]).template get<Index>());
+    }
+}
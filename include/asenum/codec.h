@@ -0,0 +1,540 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Alkenso (Vladimir Vashurkin)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <asenum/asenum.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace asenum
+{
+    class BinaryWriter;
+    class BinaryReader;
+    
+    namespace details
+    {
+        /// Types serialized as their bytes. 'bool' and enums are excluded: not every byte pattern is their valid value.
+        template <typename T>
+        struct IsRawSerializable : std::integral_constant<bool, std::is_trivially_copyable<T>::value && !std::is_same<T, bool>::value && !std::is_enum<T>::value> {};
+    }
+    
+    /**
+     Binary serializer of values of type 'T'. Specialize it to make AsEnum with payloads of 'T' serializable:
+     
+     template <> struct Serializer<MyType>
+     {
+        static void write(BinaryWriter& writer, const MyType& value);
+        static MyType read(BinaryReader& reader);
+     };
+     
+     Trivially copyable types are serialized as their bytes (in native byte order), 'std::string' and vectors
+     of trivially copyable types (except 'std::vector<bool>') as varint length followed by elements.
+     'bool' is serialized as single byte that must be 0 or 1, enums as their underlying type.
+     */
+    template <typename T, typename Enable = void>
+    struct Serializer;
+    
+    /**
+     Appends encoded values to the end of byte buffer.
+     Each AsEnum is encoded as varint case tag (enum value of the case) followed by payload bytes. 'void' cases have no payload bytes.
+     */
+    class BinaryWriter
+    {
+    public:
+        explicit BinaryWriter(std::vector<uint8_t>& output);
+        
+        void writeBytes(const void* data, size_t size);
+        void writeVarint(uint64_t value);
+        
+        /// Writes value with 'Serializer<T>'.
+        template <typename T>
+        void writeValue(const T& value);
+        
+        /// Writes case tag and payload of AsEnum.
+        template <typename T_Storage, typename... T_Cases>
+        void write(const BasicAsEnum<T_Storage, T_Cases...>& value);
+        
+    private:
+        static constexpr size_t SmallWriteSize = 16;
+        
+    private:
+        std::vector<uint8_t>& m_output;
+    };
+    
+    /**
+     Decodes values one by one from byte buffer without copying it.
+     @throws std::out_of_range if buffer ends in the middle of value.
+     @throws std::invalid_argument if data is malformed: unknown case tag or too long varint.
+     */
+    class BinaryReader
+    {
+    public:
+        BinaryReader(const void* data, size_t size);
+        
+        /// @return true if all bytes are consumed.
+        bool atEnd() const;
+        
+        /// @return number of bytes left.
+        size_t remaining() const;
+        
+        void readBytes(void* data, size_t size);
+        uint64_t readVarint();
+        
+        /// @return pointer to next 'size' bytes in the buffer; moves past them.
+        const uint8_t* skip(size_t size);
+        
+        /// Reads value with 'Serializer<T>'.
+        template <typename T>
+        T readValue();
+        
+        /// Reads next AsEnum.
+        template <typename ConcreteAsEnum>
+        ConcreteAsEnum read();
+        
+        /**
+         Reads case of the next AsEnum without reading its payload.
+         @return index of the case in 'ConcreteAsEnum::AllCases'.
+         */
+        template <typename ConcreteAsEnum>
+        size_t readCaseIndex();
+        
+    private:
+        const uint8_t* m_cursor;
+        const uint8_t* m_end;
+    };
+    
+    template <typename T>
+    struct Serializer<T, typename std::enable_if<details::IsRawSerializable<T>::value>::type>
+    {
+        static void write(BinaryWriter& writer, const T& value);
+        static T read(BinaryReader& reader);
+    };
+    
+    template <>
+    struct Serializer<bool>
+    {
+        static void write(BinaryWriter& writer, bool value);
+        static bool read(BinaryReader& reader);
+    };
+    
+    template <typename T>
+    struct Serializer<T, typename std::enable_if<std::is_enum<T>::value>::type>
+    {
+        static void write(BinaryWriter& writer, const T& value);
+        static T read(BinaryReader& reader);
+    };
+    
+    template <>
+    struct Serializer<std::string>
+    {
+        static void write(BinaryWriter& writer, const std::string& value);
+        static std::string read(BinaryReader& reader);
+    };
+    
+    /// 'std::vector<bool>' is bit-packed and has no contiguous data, so it has no serializer.
+    template <typename T>
+    struct Serializer<std::vector<T>, typename std::enable_if<std::is_trivially_copyable<T>::value && !std::is_same<T, bool>::value>::type>
+    {
+        static void write(BinaryWriter& writer, const std::vector<T>& value);
+        static std::vector<T> read(BinaryReader& reader);
+    };
+    
+    namespace details
+    {
+        /// Case tag: enum value of the case. Signed values are zigzag-encoded to keep small negative tags short.
+        template <typename Enum>
+        uint64_t EncodeCaseTag(Enum value);
+        
+        template <typename Enum>
+        uint64_t EncodeCaseTag(Enum value, std::true_type isSigned);
+        
+        template <typename Enum>
+        uint64_t EncodeCaseTag(Enum value, std::false_type isSigned);
+        
+        /// Position of the case of 'ConcreteAsEnum' with 'tag' or number of cases if 'tag' is unknown. Constant time.
+        template <typename ConcreteAsEnum>
+        size_t CaseIndexOfTag(uint64_t tag);
+        
+        template <typename Enum>
+        Enum DecodeCaseTag(uint64_t tag, std::true_type isSigned);
+        
+        template <typename Enum>
+        Enum DecodeCaseTag(uint64_t tag, std::false_type isSigned);
+        
+        /// Maximum number of bytes of varint encoding of uint64_t.
+        constexpr size_t MaxVarintSize = 10;
+        
+        struct CaseWriter
+        {
+            template <size_t I>
+            void visit(const void*) const;
+            
+            template <size_t I, typename T>
+            void visit(const T* value) const;
+            
+            BinaryWriter& writer;
+        };
+        
+        template <typename ConcreteAsEnum, typename Indices>
+        struct CaseDecoder;
+        
+        template <typename ConcreteAsEnum, size_t... I>
+        struct CaseDecoder<ConcreteAsEnum, IndexSequence<I...>>
+        {
+            static size_t caseIndex(uint64_t tag);
+            static ConcreteAsEnum decode(size_t index, BinaryReader& reader);
+            
+            template <size_t Index>
+            static ConcreteAsEnum decodeCase(BinaryReader& reader);
+            
+            template <typename Enum, Enum Case>
+            static ConcreteAsEnum decodeValue(BinaryReader& reader, const void*);
+            
+            template <typename Enum, Enum Case, typename T>
+            static ConcreteAsEnum decodeValue(BinaryReader& reader, const T*);
+        };
+        
+        template <typename ConcreteAsEnum>
+        using CaseDecoderFor = CaseDecoder<ConcreteAsEnum, typename MakeIndexSequence<ArraySize(ConcreteAsEnum::AllCases)>::type>;
+    }
+}
+
+
+// BinaryWriter public
+
+inline asenum::BinaryWriter::BinaryWriter(std::vector<uint8_t>& output)
+: m_output(output)
+{}
+
+inline void asenum::BinaryWriter::writeBytes(const void* data, const size_t size)
+{
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    if (size <= SmallWriteSize)
+    {
+        // 'push_back' has inline fast path unlike 'insert' and 'resize' calls.
+        for (size_t i = 0; i < size; i++)
+        {
+            m_output.push_back(bytes[i]);
+        }
+        return;
+    }
+    
+    const size_t offset = m_output.size();
+    m_output.resize(offset + size);
+    std::memcpy(m_output.data() + offset, bytes, size);
+}
+
+inline void asenum::BinaryWriter::writeVarint(uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        m_output.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    m_output.push_back(static_cast<uint8_t>(value));
+}
+
+template <typename T>
+void asenum::BinaryWriter::writeValue(const T& value)
+{
+    Serializer<T>::write(*this, value);
+}
+
+template <typename T_Storage, typename... T_Cases>
+void asenum::BinaryWriter::write(const BasicAsEnum<T_Storage, T_Cases...>& value)
+{
+    writeVarint(details::EncodeCaseTag(value.enumCase()));
+    details::AsEnumAccess::visit<void>(value, details::CaseWriter { *this });
+}
+
+// BinaryReader public
+
+inline asenum::BinaryReader::BinaryReader(const void* data, const size_t size)
+: m_cursor(static_cast<const uint8_t*>(data))
+, m_end(static_cast<const uint8_t*>(data) + size)
+{}
+
+inline bool asenum::BinaryReader::atEnd() const
+{
+    return m_cursor == m_end;
+}
+
+inline size_t asenum::BinaryReader::remaining() const
+{
+    return static_cast<size_t>(m_end - m_cursor);
+}
+
+inline void asenum::BinaryReader::readBytes(void* data, const size_t size)
+{
+    std::memcpy(data, skip(size), size);
+}
+
+inline uint64_t asenum::BinaryReader::readVarint()
+{
+    uint64_t value = 0;
+    for (size_t i = 0; i < details::MaxVarintSize; i++)
+    {
+        if (m_cursor == m_end)
+        {
+            details::RaiseError<std::out_of_range>("Unexpected end of buffer.");
+        }
+        
+        const uint8_t byte = *m_cursor++;
+        // The last byte holds only the highest bit of uint64_t.
+        if (i == details::MaxVarintSize - 1 && byte > 1)
+        {
+            details::RaiseError<std::invalid_argument>("Varint overflows 64 bits.");
+        }
+        
+        value |= static_cast<uint64_t>(byte & 0x7F) << (7 * i);
+        if (!(byte & 0x80))
+        {
+            return value;
+        }
+    }
+    
+    details::RaiseError<std::invalid_argument>("Varint is too long.");
+}
+
+inline const uint8_t* asenum::BinaryReader::skip(const size_t size)
+{
+    if (remaining() < size)
+    {
+        details::RaiseError<std::out_of_range>("Unexpected end of buffer.");
+    }
+    
+    const uint8_t* data = m_cursor;
+    m_cursor += size;
+    
+    return data;
+}
+
+template <typename T>
+T asenum::BinaryReader::readValue()
+{
+    return Serializer<T>::read(*this);
+}
+
+template <typename ConcreteAsEnum>
+ConcreteAsEnum asenum::BinaryReader::read()
+{
+    return details::CaseDecoderFor<ConcreteAsEnum>::decode(readCaseIndex<ConcreteAsEnum>(), *this);
+}
+
+template <typename ConcreteAsEnum>
+size_t asenum::BinaryReader::readCaseIndex()
+{
+    return details::CaseDecoderFor<ConcreteAsEnum>::caseIndex(readVarint());
+}
+
+// Serializers
+
+template <typename T>
+void asenum::Serializer<T, typename std::enable_if<asenum::details::IsRawSerializable<T>::value>::type>::write(BinaryWriter& writer, const T& value)
+{
+    writer.writeBytes(&value, sizeof(T));
+}
+
+template <typename T>
+T asenum::Serializer<T, typename std::enable_if<asenum::details::IsRawSerializable<T>::value>::type>::read(BinaryReader& reader)
+{
+    typename std::aligned_storage<sizeof(T), alignof(T)>::type value;
+    reader.readBytes(&value, sizeof(T));
+    
+    return *reinterpret_cast<const T*>(&value);
+}
+
+inline void asenum::Serializer<bool>::write(BinaryWriter& writer, const bool value)
+{
+    writer.writeValue(static_cast<uint8_t>(value ? 1 : 0));
+}
+
+inline bool asenum::Serializer<bool>::read(BinaryReader& reader)
+{
+    const uint8_t value = reader.readValue<uint8_t>();
+    if (value > 1)
+    {
+        details::RaiseError<std::invalid_argument>("Invalid bool value.");
+    }
+    
+    return value != 0;
+}
+
+template <typename T>
+void asenum::Serializer<T, typename std::enable_if<std::is_enum<T>::value>::type>::write(BinaryWriter& writer, const T& value)
+{
+    writer.writeValue(static_cast<typename std::underlying_type<T>::type>(value));
+}
+
+template <typename T>
+T asenum::Serializer<T, typename std::enable_if<std::is_enum<T>::value>::type>::read(BinaryReader& reader)
+{
+    return static_cast<T>(reader.readValue<typename std::underlying_type<T>::type>());
+}
+
+inline void asenum::Serializer<std::string>::write(BinaryWriter& writer, const std::string& value)
+{
+    writer.writeVarint(value.size());
+    writer.writeBytes(value.data(), value.size());
+}
+
+inline std::string asenum::Serializer<std::string>::read(BinaryReader& reader)
+{
+    const size_t size = static_cast<size_t>(reader.readVarint());
+    const char* data = reinterpret_cast<const char*>(reader.skip(size));
+    
+    return std::string(data, size);
+}
+
+template <typename T>
+void asenum::Serializer<std::vector<T>, typename std::enable_if<std::is_trivially_copyable<T>::value && !std::is_same<T, bool>::value>::type>::write(BinaryWriter& writer, const std::vector<T>& value)
+{
+    writer.writeVarint(value.size());
+    writer.writeBytes(value.data(), value.size() * sizeof(T));
+}
+
+template <typename T>
+std::vector<T> asenum::Serializer<std::vector<T>, typename std::enable_if<std::is_trivially_copyable<T>::value && !std::is_same<T, bool>::value>::type>::read(BinaryReader& reader)
+{
+    const uint64_t size = reader.readVarint();
+    if (size > reader.remaining() / sizeof(T))
+    {
+        details::RaiseError<std::out_of_range>("Unexpected end of buffer.");
+    }
+    
+    std::vector<T> value(static_cast<size_t>(size));
+    reader.readBytes(value.data(), value.size() * sizeof(T));
+    
+    return value;
+}
+
+// Private details
+
+template <typename Enum>
+uint64_t asenum::details::EncodeCaseTag(const Enum value)
+{
+    using Underlying = typename std::underlying_type<Enum>::type;
+    return EncodeCaseTag(value, std::is_signed<Underlying>());
+}
+
+template <typename Enum>
+uint64_t asenum::details::EncodeCaseTag(const Enum value, std::true_type)
+{
+    const int64_t signedValue = static_cast<int64_t>(value);
+    return (static_cast<uint64_t>(signedValue) << 1) ^ static_cast<uint64_t>(signedValue >> 63);
+}
+
+template <typename Enum>
+uint64_t asenum::details::EncodeCaseTag(const Enum value, std::false_type)
+{
+    return static_cast<uint64_t>(value);
+}
+
+template <typename ConcreteAsEnum>
+size_t asenum::details::CaseIndexOfTag(const uint64_t tag)
+{
+    using Enum = typename ConcreteAsEnum::Enum;
+    const Enum value = DecodeCaseTag<Enum>(tag, std::is_signed<typename std::underlying_type<Enum>::type>());
+    
+    // Tags out of range of enum are truncated by decoding and do not survive encoding back.
+    return EncodeCaseTag(value) == tag ? ConcreteAsEnum::indexOf(value) : ArraySize(ConcreteAsEnum::AllCases);
+}
+
+template <typename Enum>
+Enum asenum::details::DecodeCaseTag(const uint64_t tag, std::true_type)
+{
+    using Underlying = typename std::underlying_type<Enum>::type;
+    return static_cast<Enum>(static_cast<Underlying>(static_cast<int64_t>((tag >> 1) ^ (~(tag & 1) + 1))));
+}
+
+template <typename Enum>
+Enum asenum::details::DecodeCaseTag(const uint64_t tag, std::false_type)
+{
+    using Underlying = typename std::underlying_type<Enum>::type;
+    return static_cast<Enum>(static_cast<Underlying>(tag));
+}
+
+template <size_t I>
+void asenum::details::CaseWriter::visit(const void*) const
+{}
+
+template <size_t I, typename T>
+void asenum::details::CaseWriter::visit(const T* value) const
+{
+    writer.writeValue(*value);
+}
+
+template <typename ConcreteAsEnum, size_t... I>
+size_t asenum::details::CaseDecoder<ConcreteAsEnum, asenum::details::IndexSequence<I...>>::caseIndex(const uint64_t tag)
+{
+    const size_t index = CaseIndexOfTag<ConcreteAsEnum>(tag);
+    if (index == sizeof...(I))
+    {
+        details::RaiseError<std::invalid_argument>("Unknown case tag.");
+    }
+    
+    return index;
+}
+
+template <typename ConcreteAsEnum, size_t... I>
+ConcreteAsEnum asenum::details::CaseDecoder<ConcreteAsEnum, asenum::details::IndexSequence<I...>>::decode(const size_t index, BinaryReader& reader)
+{
+    using CaseFunction = ConcreteAsEnum (*)(BinaryReader&);
+    static constexpr CaseFunction s_table[] = { &decodeCase<I>... };
+    
+    return s_table[index](reader);
+}
+
+template <typename ConcreteAsEnum, size_t... I>
+template <size_t Index>
+ConcreteAsEnum asenum::details::CaseDecoder<ConcreteAsEnum, asenum::details::IndexSequence<I...>>::decodeCase(BinaryReader& reader)
+{
+    using Enum = typename ConcreteAsEnum::Enum;
+    static constexpr Enum Case = ConcreteAsEnum::AllCases[Index];
+    using UT = typename ConcreteAsEnum::template UnderlyingType<Case>;
+    
+    return decodeValue<Enum, Case>(reader, static_cast<const UT*>(nullptr));
+}
+
+template <typename ConcreteAsEnum, size_t... I>
+template <typename Enum, Enum Case>
+ConcreteAsEnum asenum::details::CaseDecoder<ConcreteAsEnum, asenum::details::IndexSequence<I...>>::decodeValue(BinaryReader&, const void*)
+{
+    return ConcreteAsEnum::template create<Case>();
+}
+
+template <typename ConcreteAsEnum, size_t... I>
+template <typename Enum, Enum Case, typename T>
+ConcreteAsEnum asenum::details::CaseDecoder<ConcreteAsEnum, asenum::details::IndexSequence<I...>>::decodeValue(BinaryReader& reader, const T*)
+{
+    return ConcreteAsEnum::template create<Case>(reader.readValue<T>());
+}
@@ -0,0 +1,584 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Alkenso (Vladimir Vashurkin)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <asenum/asenum.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace asenum
+{
+    namespace details
+    {
+        template <typename Key, typename Mapped>
+        struct FlatSlot
+        {
+            template <typename... Args>
+            explicit FlatSlot(const Key& k, Args&&... args) : key(k), value(std::forward<Args>(args)...) {}
+            
+            Key key;
+            Mapped value;
+        };
+        
+        template <typename Key>
+        struct FlatSlot<Key, void>
+        {
+            explicit FlatSlot(const Key& k) : key(k) {}
+            
+            Key key;
+        };
+        
+        /**
+         Open-addressing hash table with linear probing over AsEnum keys.
+         Metadata of each slot (part of the hash and case tag) is kept in separate contiguous array,
+         so probing rejects slots of mismatched cases or hashes without touching the keys.
+         */
+        template <typename ConcreteAsEnum, typename Mapped, typename Hash, typename KeyEqual>
+        class FlatHashTable
+        {
+        public:
+            using Slot = FlatSlot<ConcreteAsEnum, Mapped>;
+            
+            FlatHashTable() = default;
+            FlatHashTable(const FlatHashTable& other);
+            FlatHashTable(FlatHashTable&& other) noexcept;
+            FlatHashTable& operator=(FlatHashTable other) noexcept;
+            ~FlatHashTable();
+            
+            size_t size() const;
+            size_t capacity() const;
+            
+            void clear();
+            void reserve(size_t count);
+            
+            /// Returns existing slot of 'key' or slot constructed from 'args' and 'true' if it was inserted.
+            template <typename... Args>
+            std::pair<Slot*, bool> emplace(const ConcreteAsEnum& key, Args&&... args);
+            
+            Slot* find(const ConcreteAsEnum& key) const;
+            bool erase(const ConcreteAsEnum& key);
+            
+            template <typename Handler>
+            void forEach(const Handler& handler) const;
+            
+        private:
+            struct Meta
+            {
+                uint32_t hash;
+                uint8_t tag;
+            };
+            
+            enum : uint8_t
+            {
+                EmptyTag = 0,
+                DeletedTag = 1,
+                FirstCaseTag = 2
+            };
+            
+            using SlotBuffer = typename std::aligned_storage<sizeof(Slot), alignof(Slot)>::type;
+            
+            static constexpr size_t MinCapacity = 8;
+            static constexpr size_t NotFound = static_cast<size_t>(-1);
+            
+            static size_t maxUsed(size_t capacity);
+            static uint8_t makeTag(const ConcreteAsEnum& key);
+            static uint32_t makeHashBits(size_t hash);
+            
+            Slot& slot(size_t index) const;
+            size_t lookup(const ConcreteAsEnum& key, size_t hash, uint8_t tag) const;
+            void rehash(size_t capacity);
+            
+        private:
+            std::vector<Meta> m_meta;
+            std::unique_ptr<SlotBuffer[]> m_slots;
+            size_t m_size = 0;
+            size_t m_used = 0;
+            Hash m_hash;
+            KeyEqual m_equal;
+        };
+    }
+    
+    /**
+     Flat (open-addressing) hash set of AsEnum values.
+     Lookups reject values of mismatched cases by comparing case tag stored next to hash, without reading the payload.
+     */
+    template <typename ConcreteAsEnum, typename Hash = std::hash<ConcreteAsEnum>, typename KeyEqual = std::equal_to<ConcreteAsEnum>>
+    class FlatHashSet
+    {
+    public:
+        size_t size() const;
+        bool empty() const;
+        
+        void clear();
+        void reserve(size_t count);
+        
+        /// @return true if value was inserted, false if it is already presented in the set.
+        bool insert(const ConcreteAsEnum& value);
+        bool contains(const ConcreteAsEnum& value) const;
+        bool erase(const ConcreteAsEnum& value);
+        
+        /// Calls 'handler(const ConcreteAsEnum&)' for each value in unspecified order.
+        template <typename Handler>
+        void forEach(const Handler& handler) const;
+        
+    private:
+        details::FlatHashTable<ConcreteAsEnum, void, Hash, KeyEqual> m_table;
+    };
+    
+    /**
+     Flat (open-addressing) hash map with AsEnum keys.
+     Lookups reject keys of mismatched cases by comparing case tag stored next to hash, without reading the payload.
+     */
+    template <typename ConcreteAsEnum, typename T, typename Hash = std::hash<ConcreteAsEnum>, typename KeyEqual = std::equal_to<ConcreteAsEnum>>
+    class FlatHashMap
+    {
+    public:
+        size_t size() const;
+        bool empty() const;
+        
+        void clear();
+        void reserve(size_t count);
+        
+        /// @return true if value was inserted, false if the key is already presented in the map.
+        template <typename... Args>
+        bool emplace(const ConcreteAsEnum& key, Args&&... args);
+        
+        /// Returns value associated with 'key', inserting default-constructed one if needed.
+        T& operator[](const ConcreteAsEnum& key);
+        
+        /// @return pointer to value associated with 'key' or nullptr if there is no such key.
+        T* find(const ConcreteAsEnum& key);
+        const T* find(const ConcreteAsEnum& key) const;
+        
+        bool erase(const ConcreteAsEnum& key);
+        
+        /// Calls 'handler(const ConcreteAsEnum&, const T&)' for each key-value pair in unspecified order.
+        template <typename Handler>
+        void forEach(const Handler& handler) const;
+        
+    private:
+        details::FlatHashTable<ConcreteAsEnum, T, Hash, KeyEqual> m_table;
+    };
+}
+
+
+// FlatHashSet public
+
+template <typename ConcreteAsEnum, typename Hash, typename KeyEqual>
+size_t asenum::FlatHashSet<ConcreteAsEnum, Hash, KeyEqual>::size() const
+{
+    return m_table.size();
+}
+
+template <typename ConcreteAsEnum, typename Hash, typename KeyEqual>
+bool asenum::FlatHashSet<ConcreteAsEnum, Hash, KeyEqual>::empty() const
+{
+    return m_table.size() == 0;
+}
+
+template <typename ConcreteAsEnum, typename Hash, typename KeyEqual>
+void asenum::FlatHashSet<ConcreteAsEnum, Hash, KeyEqual>::clear()
+{
+    m_table.clear();
+}
+
+template <typename ConcreteAsEnum, typename Hash, typename KeyEqual>
+void asenum::FlatHashSet<ConcreteAsEnum, Hash, KeyEqual>::reserve(const size_t count)
+{
+    m_table.reserve(count);
+}
+
+template <typename ConcreteAsEnum, typename Hash, typename KeyEqual>
+bool asenum::FlatHashSet<ConcreteAsEnum, Hash, KeyEqual>::insert(const ConcreteAsEnum& value)
+{
+    return m_table.emplace(value).second;
+}
+
+template <typename ConcreteAsEnum, typename Hash, typename KeyEqual>
+bool asenum::FlatHashSet<ConcreteAsEnum, Hash, KeyEqual>::contains(const ConcreteAsEnum& value) const
+{
+    return m_table.find(value) != nullptr;
+}
+
+template <typename ConcreteAsEnum, typename Hash, typename KeyEqual>
+bool asenum::FlatHashSet<ConcreteAsEnum, Hash, KeyEqual>::erase(const ConcreteAsEnum& value)
+{
+    return m_table.erase(value);
+}
+
+template <typename ConcreteAsEnum, typename Hash, typename KeyEqual>
+template <typename Handler>
+void asenum::FlatHashSet<ConcreteAsEnum, Hash, KeyEqual>::forEach(const Handler& handler) const
+{
+    m_table.forEach([&handler] (const typename details::FlatHashTable<ConcreteAsEnum, void, Hash, KeyEqual>::Slot& slot) {
+        handler(slot.key);
+    });
+}
+
+// FlatHashMap public
+
+template <typename ConcreteAsEnum, typename T, typename Hash, typename KeyEqual>
+size_t asenum::FlatHashMap<ConcreteAsEnum, T, Hash, KeyEqual>::size() const
+{
+    return m_table.size();
+}
+
+template <typename ConcreteAsEnum, typename T, typename Hash, typename KeyEqual>
+bool asenum::FlatHashMap<ConcreteAsEnum, T, Hash, KeyEqual>::empty() const
+{
+    return m_table.size() == 0;
+}
+
+template <typename ConcreteAsEnum, typename T, typename Hash, typename KeyEqual>
+void asenum::FlatHashMap<ConcreteAsEnum, T, Hash, KeyEqual>::clear()
+{
+    m_table.clear();
+}
+
+template <typename ConcreteAsEnum, typename T, typename Hash, typename KeyEqual>
+void asenum::FlatHashMap<ConcreteAsEnum, T, Hash, KeyEqual>::reserve(const size_t count)
+{
+    m_table.reserve(count);
+}
+
+template <typename ConcreteAsEnum, typename T, typename Hash, typename KeyEqual>
+template <typename... Args>
+bool asenum::FlatHashMap<ConcreteAsEnum, T, Hash, KeyEqual>::emplace(const ConcreteAsEnum& key, Args&&... args)
+{
+    return m_table.emplace(key, std::forward<Args>(args)...).second;
+}
+
+template <typename ConcreteAsEnum, typename T, typename Hash, typename KeyEqual>
+T& asenum::FlatHashMap<ConcreteAsEnum, T, Hash, KeyEqual>::operator[](const ConcreteAsEnum& key)
+{
+    return m_table.emplace(key).first->value;
+}
+
+template <typename ConcreteAsEnum, typename T, typename Hash, typename KeyEqual>
+T* asenum::FlatHashMap<ConcreteAsEnum, T, Hash, KeyEqual>::find(const ConcreteAsEnum& key)
+{
+    const auto slot = m_table.find(key);
+    return slot ? &slot->value : nullptr;
+}
+
+template <typename ConcreteAsEnum, typename T, typename Hash, typename KeyEqual>
+const T* asenum::FlatHashMap<ConcreteAsEnum, T, Hash, KeyEqual>::find(const ConcreteAsEnum& key) const
+{
+    const auto slot = m_table.find(key);
+    return slot ? &slot->value : nullptr;
+}
+
+template <typename ConcreteAsEnum, typename T, typename Hash, typename KeyEqual>
+bool asenum::FlatHashMap<ConcreteAsEnum, T, Hash, KeyEqual>::erase(const ConcreteAsEnum& key)
+{
+    return m_table.erase(key);
+}
+
+template <typename ConcreteAsEnum, typename T, typename Hash, typename KeyEqual>
+template <typename Handler>
+void asenum::FlatHashMap<ConcreteAsEnum, T, Hash, KeyEqual>::forEach(const Handler& handler) const
+{
+    m_table.forEach([&handler] (const typename details::FlatHashTable<ConcreteAsEnum, T, Hash, KeyEqual>::Slot& slot) {
+        handler(slot.key, slot.value);
+    });
+}
+
+// Private details - FlatHashTable
+
+template <typename ConcreteAsEnum, typename Mapped, typename Hash, typename KeyEqual>
+constexpr size_t asenum::details::FlatHashTable<ConcreteAsEnum, Mapped, Hash, KeyEqual>::MinCapacity;
+
+template <typename ConcreteAsEnum, typename Mapped, typename Hash, typename KeyEqual>
+constexpr size_t asenum::details::FlatHashTable<ConcreteAsEnum, Mapped, Hash, KeyEqual>::NotFound;
+
+template <typename ConcreteAsEnum, typename Mapped, typename Hash, typename KeyEqual>
+asenum::details::FlatHashTable<ConcreteAsEnum, Mapped, Hash, KeyEqual>::FlatHashTable(const FlatHashTable& other)
+: FlatHashTable()
+{
+    // Delegated constructor has completed, so if copying a slot throws, destructor releases slots copied so far:
+    // each slot is marked as used only after it is constructed.
+    m_hash = other.m_hash;
+    m_equal = other.m_equal;
+    m_meta.assign(other.m_meta.size(), Meta { 0, EmptyTag });
+    m_slots.reset(other.m_meta.empty() ? nullptr : new SlotBuffer[other.m_meta.size()]);
+    
+    for (size_t i = 0; i < m_meta.size(); i++)
+    {
+        if (other.m_meta[i].tag >= FirstCaseTag)
+        {
+            new (&m_slots[i]) Slot(other.slot(i));
+            m_size++;
+        }
+        m_meta[i] = other.m_meta[i];
+    }
+    m_used = other.m_used;
+}
+
+template <typename ConcreteAsEnum, typename Mapped, typename Hash, typename KeyEqual>
+asenum::details::FlatHashTable<ConcreteAsEnum, Mapped, Hash, KeyEqual>::FlatHashTable(FlatHashTable&& other) noexcept
+: m_meta(std::move(other.m_meta))
+, m_slots(std::move(other.m_slots))
+, m_size(other.m_size)
+, m_used(other.m_used)
+, m_hash(std::move(other.m_hash))
+, m_equal(std::move(other.m_equal))
+{
+    other.m_meta.clear();
+    other.m_size = 0;
+    other.m_used = 0;
+}
+
+template <typename ConcreteAsEnum, typename Mapped, typename Hash, typename KeyEqual>
+asenum::details::FlatHashTable<ConcreteAsEnum, Mapped, Hash, KeyEqual>&
+asenum::details::FlatHashTable<ConcreteAsEnum, Mapped, Hash, KeyEqual>::operator=(FlatHashTable other) noexcept
+{
+    std::swap(m_meta, other.m_meta);
+    std::swap(m_slots, other.m_slots);
+    std::swap(m_size, other.m_size);
+    std::swap(m_used, other.m_used);
+    std::swap(m_hash, other.m_hash);
+    std::swap(m_equal, other.m_equal);
+    
+    return *this;
+}
+
+template <typename ConcreteAsEnum, typename Mapped, typename Hash, typename KeyEqual>
+asenum::details::FlatHashTable<ConcreteAsEnum, Mapped, Hash, KeyEqual>::~FlatHashTable()
+{
+    clear();
+}
+
+template <typename ConcreteAsEnum, typename Mapped, typename Hash, typename KeyEqual>
+size_t asenum::details::FlatHashTable<ConcreteAsEnum, Mapped, Hash, KeyEqual>::size() const
+{
+    return m_size;
+}
+
+template <typename ConcreteAsEnum, typename Mapped, typename Hash, typename KeyEqual>
+size_t asenum::details::FlatHashTable<ConcreteAsEnum, Mapped, Hash, KeyEqual>::capacity() const
+{
+    return m_meta.size();
+}
+
+template <typename ConcreteAsEnum, typename Mapped, typename Hash, typename KeyEqual>
+void asenum::details::FlatHashTable<ConcreteAsEnum, Mapped, Hash, KeyEqual>::clear()
+{
+    for (size_t i = 0; i < m_meta.size(); i++)
+    {
+        if (m_meta[i].tag >= FirstCaseTag)
+        {
+            slot(i).~Slot();
+        }
+        m_meta[i].tag = EmptyTag;
+    }
+    
+    m_size = 0;
+    m_used = 0;
+}
+
+template <typename ConcreteAsEnum, typename Mapped, typename Hash, typename KeyEqual>
+void asenum::details::FlatHashTable<ConcreteAsEnum, Mapped, Hash, KeyEqual>::reserve(const size_t count)
+{
+    size_t capacity = MinCapacity;
+    while (maxUsed(capacity) < count)
+    {
+        capacity *= 2;
+    }
+    
+    if (capacity > m_meta.size())
+    {
+        rehash(capacity);
+    }
+}
+
+template <typename ConcreteAsEnum, typename Mapped, typename Hash, typename KeyEqual>
+template <typename... Args>
+std::pair<typename asenum::details::FlatHashTable<ConcreteAsEnum, Mapped, Hash, KeyEqual>::Slot*, bool>
+asenum::details::FlatHashTable<ConcreteAsEnum, Mapped, Hash, KeyEqual>::emplace(const ConcreteAsEnum& key, Args&&... args)
+{
+    const size_t hash = MixHash(m_hash(key));
+    const uint8_t tag = makeTag(key);
+    
+    const size_t found = lookup(key, hash, tag);
+    if (found != NotFound)
+    {
+        return std::make_pair(&slot(found), false);
+    }
+    
+    if (m_used + 1 > maxUsed(m_meta.size()))
+    {
+        // Grow only if most of used slots hold live values. Otherwise just drop deleted slots.
+        rehash(m_size + 1 > maxUsed(m_meta.size()) / 2 ? std::max(m_meta.size() * 2, MinCapacity) : m_meta.size());
+    }
+    
+    const size_t mask = m_meta.size() - 1;
+    size_t index = hash & mask;
+    while (m_meta[index].tag >= FirstCaseTag)
+    {
+        index = (index + 1) & mask;
+    }
+    
+    new (&m_slots[index]) Slot(key, std::forward<Args>(args)...);
+    if (m_meta[index].tag == EmptyTag)
+    {
+        m_used++;
+    }
+    m_meta[index].hash = makeHashBits(hash);
+    m_meta[index].tag = tag;
+    m_size++;
+    
+    return std::make_pair(&slot(index), true);
+}
+
+template <typename ConcreteAsEnum, typename Mapped, typename Hash, typename KeyEqual>
+typename asenum::details::FlatHashTable<ConcreteAsEnum, Mapped, Hash, KeyEqual>::Slot*
+asenum::details::FlatHashTable<ConcreteAsEnum, Mapped, Hash, KeyEqual>::find(const ConcreteAsEnum& key) const
+{
+    const size_t index = lookup(key, MixHash(m_hash(key)), makeTag(key));
+    return index != NotFound ? &slot(index) : nullptr;
+}
+
+template <typename ConcreteAsEnum, typename Mapped, typename Hash, typename KeyEqual>
+bool asenum::details::FlatHashTable<ConcreteAsEnum, Mapped, Hash, KeyEqual>::erase(const ConcreteAsEnum& key)
+{
+    const size_t index = lookup(key, MixHash(m_hash(key)), makeTag(key));
+    if (index == NotFound)
+    {
+        return false;
+    }
+    
+    slot(index).~Slot();
+    m_meta[index].tag = DeletedTag;
+    m_size--;
+    
+    return true;
+}
+
+template <typename ConcreteAsEnum, typename Mapped, typename Hash, typename KeyEqual>
+template <typename Handler>
+void asenum::details::FlatHashTable<ConcreteAsEnum, Mapped, Hash, KeyEqual>::forEach(const Handler& handler) const
+{
+    for (size_t i = 0; i < m_meta.size(); i++)
+    {
+        if (m_meta[i].tag >= FirstCaseTag)
+        {
+            handler(static_cast<const Slot&>(slot(i)));
+        }
+    }
+}
+
+template <typename ConcreteAsEnum, typename Mapped, typename Hash, typename KeyEqual>
+size_t asenum::details::FlatHashTable<ConcreteAsEnum, Mapped, Hash, KeyEqual>::maxUsed(const size_t capacity)
+{
+    // Linear probing degrades quickly on high load: keep load factor not greater than 1/2.
+    return capacity / 2;
+}
+
+template <typename ConcreteAsEnum, typename Mapped, typename Hash, typename KeyEqual>
+uint8_t asenum::details::FlatHashTable<ConcreteAsEnum, Mapped, Hash, KeyEqual>::makeTag(const ConcreteAsEnum& key)
+{
+    return static_cast<uint8_t>(FirstCaseTag + AsEnumAccess::storage(key).index() % (256 - FirstCaseTag));
+}
+
+template <typename ConcreteAsEnum, typename Mapped, typename Hash, typename KeyEqual>
+uint32_t asenum::details::FlatHashTable<ConcreteAsEnum, Mapped, Hash, KeyEqual>::makeHashBits(const size_t hash)
+{
+    // Low bits select the slot: keeping them allows to rehash without hashing keys again.
+    return static_cast<uint32_t>(hash);
+}
+
+template <typename ConcreteAsEnum, typename Mapped, typename Hash, typename KeyEqual>
+typename asenum::details::FlatHashTable<ConcreteAsEnum, Mapped, Hash, KeyEqual>::Slot&
+asenum::details::FlatHashTable<ConcreteAsEnum, Mapped, Hash, KeyEqual>::slot(const size_t index) const
+{
+    return *reinterpret_cast<Slot*>(&m_slots[index]);
+}
+
+template <typename ConcreteAsEnum, typename Mapped, typename Hash, typename KeyEqual>
+size_t asenum::details::FlatHashTable<ConcreteAsEnum, Mapped, Hash, KeyEqual>::lookup(const ConcreteAsEnum& key, const size_t hash, const uint8_t tag) const
+{
+    if (m_meta.empty())
+    {
+        return NotFound;
+    }
+    
+    const uint32_t hashBits = makeHashBits(hash);
+    const size_t mask = m_meta.size() - 1;
+    for (size_t index = hash & mask; ; index = (index + 1) & mask)
+    {
+        const Meta& meta = m_meta[index];
+        if (meta.tag == EmptyTag)
+        {
+            return NotFound;
+        }
+        
+        if (meta.tag == tag && meta.hash == hashBits && m_equal(slot(index).key, key))
+        {
+            return index;
+        }
+    }
+}
+
+template <typename ConcreteAsEnum, typename Mapped, typename Hash, typename KeyEqual>
+void asenum::details::FlatHashTable<ConcreteAsEnum, Mapped, Hash, KeyEqual>::rehash(const size_t capacity)
+{
+    // Slots are moved into separate table, or copied if their move may throw: if it throws,
+    // this table stays intact and slots constructed so far are destroyed together with the new one.
+    FlatHashTable table;
+    table.m_hash = m_hash;
+    table.m_equal = m_equal;
+    table.m_meta.assign(capacity, Meta { 0, EmptyTag });
+    table.m_slots.reset(new SlotBuffer[capacity]);
+    
+    const size_t mask = capacity - 1;
+    for (size_t i = 0; i < m_meta.size(); i++)
+    {
+        if (m_meta[i].tag < FirstCaseTag)
+        {
+            continue;
+        }
+        
+        size_t index = m_meta[i].hash & mask;
+        while (table.m_meta[index].tag != EmptyTag)
+        {
+            index = (index + 1) & mask;
+        }
+        
+        new (&table.m_slots[index]) Slot(std::move_if_noexcept(slot(i)));
+        table.m_meta[index] = m_meta[i];
+        table.m_size++;
+    }
+    table.m_used = table.m_size;
+    
+    *this = std::move(table);
+}
@@ -0,0 +1,429 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Alkenso (Vladimir Vashurkin)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <typeinfo>
+#include <vector>
+
+/**
+ Opt-in instrumentation of AsEnum hot paths.
+ Define 'ASENUM_INSTRUMENTATION' for the whole project (every translation unit including 'asenum/asenum.h')
+ to count per-case events of each AsEnum type. Without the macro hooks are not compiled at all
+ and snapshot functions return no data.
+ */
+
+namespace asenum
+{
+    template <typename T_Storage, typename... T_Cases>
+    class BasicAsEnum;
+    
+    /// Per-case events counted by instrumentation.
+    enum class InstrumentationCounter
+    {
+        Created,        ///< AsEnum instances constructed with the case ('create', decoding, 'toAsEnum'...).
+        AllocatedBytes, ///< Payload bytes allocated on the heap (see 'storesInline').
+        Copied,         ///< Copies of AsEnum instances (copy construction and assignment).
+        SharedCopies,   ///< Copies that only bumped reference counter of heap payload.
+        IfCaseHits,     ///< Handlers called through 'ifCase', including ones called by 'doSwitch' and 'doMap'.
+        SwitchHits,     ///< Cases handled by 'doSwitch' (excluding 'ifDefault').
+        MapHits,        ///< Cases handled by 'doMap' (excluding 'ifDefault').
+    };
+    
+    namespace details
+    {
+        constexpr size_t InstrumentationCounterCount = 7;
+        
+        struct InstrumentedType;
+        
+        template <typename ConcreteAsEnum>
+        class ConsumingAsEnum;
+    }
+    
+    /// Counters of single case. Indexed by 'InstrumentationCounter'.
+    struct CaseCounters
+    {
+        int64_t code;
+        uint64_t values[details::InstrumentationCounterCount];
+        
+        uint64_t operator[](InstrumentationCounter counter) const;
+    };
+    
+    /// Counters of all cases of single AsEnum type.
+    struct AsEnumCounters
+    {
+        /// Name of AsEnum type as reported by 'typeid'.
+        const char* typeName;
+        
+        /// Counters of each case in order of 'AllCases'.
+        std::vector<CaseCounters> cases;
+    };
+    
+    /// @return Counters of 'ConcreteAsEnum' summed over all threads since last 'ResetInstrumentation'.
+    template <typename ConcreteAsEnum>
+    AsEnumCounters InstrumentationSnapshot();
+    
+    /// @return Counters of all AsEnum types used so far, summed over all threads since last 'ResetInstrumentation'.
+    std::vector<AsEnumCounters> InstrumentationSnapshot();
+    
+    /// Starts counting from zero. Doesn't block threads updating counters.
+    void ResetInstrumentation();
+    
+    /// @return Name of the counter suitable as metric name, e.g. "allocated_bytes".
+    const char* InstrumentationCounterName(InstrumentationCounter counter);
+    
+    namespace details
+    {
+        /// Counters of single AsEnum type collected from all threads. Guarded by registry mutex.
+        struct InstrumentedType
+        {
+            const char* typeName;
+            std::vector<int64_t> codes;
+            std::vector<const std::atomic<uint64_t>*> threads;
+            std::vector<uint64_t> retired;
+            std::vector<uint64_t> baseline;
+        };
+        
+        class InstrumentationRegistry
+        {
+        public:
+            static InstrumentationRegistry& shared();
+            
+            InstrumentedType& add(const char* typeName, std::vector<int64_t> codes);
+            
+            void attach(InstrumentedType& type, const std::atomic<uint64_t>* values);
+            void detach(InstrumentedType& type, const std::atomic<uint64_t>* values);
+            
+            AsEnumCounters snapshot(const InstrumentedType& type);
+            std::vector<AsEnumCounters> snapshot();
+            void reset();
+            
+        private:
+            static std::vector<uint64_t> totals(const InstrumentedType& type);
+            static AsEnumCounters makeCounters(const InstrumentedType& type);
+            
+        private:
+            std::mutex m_mutex;
+            std::vector<std::unique_ptr<InstrumentedType>> m_types;
+        };
+        
+        /**
+         Per-thread counters of single AsEnum type.
+         Only owning thread writes its counters, so they are updated without locked instructions;
+         readers sum counters of live threads with ones left by exited threads.
+         */
+        template <typename ConcreteAsEnum>
+        class InstrumentationCounters
+        {
+        public:
+            static void add(InstrumentationCounter counter, size_t index, uint64_t amount);
+            static AsEnumCounters snapshot();
+            
+        private:
+            static constexpr size_t CaseCount = std::extent<decltype(ConcreteAsEnum::AllCases)>::value;
+            
+            struct LocalCounters
+            {
+                LocalCounters();
+                ~LocalCounters();
+                
+                std::atomic<uint64_t> values[CaseCount * InstrumentationCounterCount];
+            };
+            
+            static std::vector<int64_t> codes();
+            static InstrumentedType& type();
+            static LocalCounters& local();
+        };
+        
+        /// Views that are not AsEnum (e.g. archive records) are not instrumented.
+        template <>
+        class InstrumentationCounters<void>
+        {
+        public:
+            static void add(InstrumentationCounter, size_t, uint64_t) {}
+        };
+        
+        /// AsEnum type which counters are updated when dispatching over 'ConcreteAsEnum'.
+        template <typename ConcreteAsEnum>
+        struct InstrumentedAsEnum
+        {
+            using type = void;
+        };
+        
+        template <typename T_Storage, typename... T_Cases>
+        struct InstrumentedAsEnum<BasicAsEnum<T_Storage, T_Cases...>>
+        {
+            using type = BasicAsEnum<T_Storage, T_Cases...>;
+        };
+        
+        template <typename ConcreteAsEnum>
+        struct InstrumentedAsEnum<ConsumingAsEnum<ConcreteAsEnum>> : InstrumentedAsEnum<ConcreteAsEnum> {};
+        
+        template <typename Enum, size_t N>
+        constexpr size_t InstrumentedCasePosition(const Enum (&cases)[N], const Enum value, const size_t index = 0)
+        {
+            return index == N || cases[index] == value ? index : InstrumentedCasePosition(cases, value, index + 1);
+        }
+        
+        template <typename ConcreteAsEnum, typename Enum, Enum Case>
+        struct InstrumentedCaseIndex : std::integral_constant<size_t, InstrumentedCasePosition(ConcreteAsEnum::AllCases, Case)> {};
+        
+        template <typename Enum, Enum Case>
+        struct InstrumentedCaseIndex<void, Enum, Case> : std::integral_constant<size_t, 0> {};
+        
+        /// Counts event of 'Case' of AsEnum behind 'ConcreteAsEnum' (AsEnum itself or its consuming adapter).
+        template <typename ConcreteAsEnum, typename Enum, Enum Case>
+        void InstrumentCase(InstrumentationCounter counter);
+    }
+}
+
+
+// Public
+
+inline uint64_t asenum::CaseCounters::operator[](const InstrumentationCounter counter) const
+{
+    return values[static_cast<size_t>(counter)];
+}
+
+template <typename ConcreteAsEnum>
+asenum::AsEnumCounters asenum::InstrumentationSnapshot()
+{
+    return details::InstrumentationCounters<ConcreteAsEnum>::snapshot();
+}
+
+inline std::vector<asenum::AsEnumCounters> asenum::InstrumentationSnapshot()
+{
+    return details::InstrumentationRegistry::shared().snapshot();
+}
+
+inline void asenum::ResetInstrumentation()
+{
+    details::InstrumentationRegistry::shared().reset();
+}
+
+inline const char* asenum::InstrumentationCounterName(const InstrumentationCounter counter)
+{
+    static const char* const s_names[details::InstrumentationCounterCount] =
+    {
+        "created",
+        "allocated_bytes",
+        "copied",
+        "shared_copies",
+        "if_case_hits",
+        "switch_hits",
+        "map_hits",
+    };
+    
+    return s_names[static_cast<size_t>(counter)];
+}
+
+// Private details - InstrumentationRegistry
+
+inline asenum::details::InstrumentationRegistry& asenum::details::InstrumentationRegistry::shared()
+{
+    // Intentionally never destroyed: thread-local counters are detached during shutdown.
+    static InstrumentationRegistry* const s_shared = new InstrumentationRegistry();
+    return *s_shared;
+}
+
+inline asenum::details::InstrumentedType& asenum::details::InstrumentationRegistry::add(const char* typeName, std::vector<int64_t> codes)
+{
+    std::unique_ptr<InstrumentedType> type(new InstrumentedType());
+    type->typeName = typeName;
+    type->retired.assign(codes.size() * InstrumentationCounterCount, 0);
+    type->baseline.assign(codes.size() * InstrumentationCounterCount, 0);
+    type->codes = std::move(codes);
+    
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_types.push_back(std::move(type));
+    
+    return *m_types.back();
+}
+
+inline void asenum::details::InstrumentationRegistry::attach(InstrumentedType& type, const std::atomic<uint64_t>* values)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    type.threads.push_back(values);
+}
+
+inline void asenum::details::InstrumentationRegistry::detach(InstrumentedType& type, const std::atomic<uint64_t>* values)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (size_t i = 0; i < type.retired.size(); i++)
+    {
+        type.retired[i] += values[i].load(std::memory_order_relaxed);
+    }
+    
+    for (size_t i = 0; i < type.threads.size(); i++)
+    {
+        if (type.threads[i] == values)
+        {
+            type.threads[i] = type.threads.back();
+            type.threads.pop_back();
+            break;
+        }
+    }
+}
+
+inline asenum::AsEnumCounters asenum::details::InstrumentationRegistry::snapshot(const InstrumentedType& type)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return makeCounters(type);
+}
+
+inline std::vector<asenum::AsEnumCounters> asenum::details::InstrumentationRegistry::snapshot()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    
+    std::vector<AsEnumCounters> result;
+    result.reserve(m_types.size());
+    for (const auto& type : m_types)
+    {
+        result.push_back(makeCounters(*type));
+    }
+    
+    return result;
+}
+
+inline void asenum::details::InstrumentationRegistry::reset()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const auto& type : m_types)
+    {
+        type->baseline = totals(*type);
+    }
+}
+
+inline std::vector<uint64_t> asenum::details::InstrumentationRegistry::totals(const InstrumentedType& type)
+{
+    std::vector<uint64_t> result = type.retired;
+    for (const std::atomic<uint64_t>* values : type.threads)
+    {
+        for (size_t i = 0; i < result.size(); i++)
+        {
+            result[i] += values[i].load(std::memory_order_relaxed);
+        }
+    }
+    
+    return result;
+}
+
+inline asenum::AsEnumCounters asenum::details::InstrumentationRegistry::makeCounters(const InstrumentedType& type)
+{
+    const std::vector<uint64_t> values = totals(type);
+    
+    AsEnumCounters result;
+    result.typeName = type.typeName;
+    result.cases.resize(type.codes.size());
+    for (size_t i = 0; i < result.cases.size(); i++)
+    {
+        CaseCounters& counters = result.cases[i];
+        counters.code = type.codes[i];
+        for (size_t j = 0; j < InstrumentationCounterCount; j++)
+        {
+            const size_t offset = i * InstrumentationCounterCount + j;
+            counters.values[j] = values[offset] - type.baseline[offset];
+        }
+    }
+    
+    return result;
+}
+
+// Private details - InstrumentationCounters
+
+template <typename ConcreteAsEnum>
+constexpr size_t asenum::details::InstrumentationCounters<ConcreteAsEnum>::CaseCount;
+
+template <typename ConcreteAsEnum>
+void asenum::details::InstrumentationCounters<ConcreteAsEnum>::add(const InstrumentationCounter counter, const size_t index, const uint64_t amount)
+{
+    std::atomic<uint64_t>& value = local().values[index * InstrumentationCounterCount + static_cast<size_t>(counter)];
+    value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+}
+
+template <typename ConcreteAsEnum>
+asenum::AsEnumCounters asenum::details::InstrumentationCounters<ConcreteAsEnum>::snapshot()
+{
+    return InstrumentationRegistry::shared().snapshot(type());
+}
+
+template <typename ConcreteAsEnum>
+std::vector<int64_t> asenum::details::InstrumentationCounters<ConcreteAsEnum>::codes()
+{
+    std::vector<int64_t> result;
+    result.reserve(CaseCount);
+    for (const auto code : ConcreteAsEnum::AllCases)
+    {
+        result.push_back(static_cast<int64_t>(code));
+    }
+    
+    return result;
+}
+
+template <typename ConcreteAsEnum>
+asenum::details::InstrumentedType& asenum::details::InstrumentationCounters<ConcreteAsEnum>::type()
+{
+    static InstrumentedType& s_type = InstrumentationRegistry::shared().add(typeid(ConcreteAsEnum).name(), codes());
+    return s_type;
+}
+
+template <typename ConcreteAsEnum>
+typename asenum::details::InstrumentationCounters<ConcreteAsEnum>::LocalCounters& asenum::details::InstrumentationCounters<ConcreteAsEnum>::local()
+{
+    static thread_local LocalCounters s_counters;
+    return s_counters;
+}
+
+template <typename ConcreteAsEnum>
+asenum::details::InstrumentationCounters<ConcreteAsEnum>::LocalCounters::LocalCounters()
+{
+    for (std::atomic<uint64_t>& value : values)
+    {
+        value.store(0, std::memory_order_relaxed);
+    }
+    
+    InstrumentationRegistry::shared().attach(type(), values);
+}
+
+template <typename ConcreteAsEnum>
+asenum::details::InstrumentationCounters<ConcreteAsEnum>::LocalCounters::~LocalCounters()
+{
+    InstrumentationRegistry::shared().detach(type(), values);
+}
+
+// Private details - InstrumentCase
+
+template <typename ConcreteAsEnum, typename Enum, Enum Case>
+void asenum::details::InstrumentCase(const InstrumentationCounter counter)
+{
+    using Target = typename InstrumentedAsEnum<ConcreteAsEnum>::type;
+    InstrumentationCounters<Target>::add(counter, InstrumentedCaseIndex<Target, Enum, Case>::value, 1);
+}
@@ -0,0 +1,299 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Alkenso (Vladimir Vashurkin)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <asenum/asenum.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace asenum
+{
+    /**
+     Fixed set of worker threads for parallel batch algorithms.
+     Range is split into chunks that threads claim one by one from shared counter,
+     so threads that finish early take more chunks. The calling thread processes chunks too.
+     */
+    class ThreadPool
+    {
+    public:
+        /// @param threadCount Total number of threads including the calling one. 0 means 'std::thread::hardware_concurrency()'.
+        explicit ThreadPool(size_t threadCount = 0);
+        ~ThreadPool();
+        
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+        
+        /// @return total number of threads including the calling one.
+        size_t threadCount() const;
+        
+        /**
+         Calls 'body(begin, end)' concurrently for chunks of [0, count) of at most 'grain' elements
+         and returns when all chunks are processed.
+         If 'body' throws, remaining chunks are skipped and the first exception is rethrown.
+         Must not be called concurrently for the same pool.
+         */
+        template <typename Body>
+        void parallelFor(size_t count, size_t grain, const Body& body);
+        
+    private:
+        template <typename Body>
+        static void invokeBody(const void* body, size_t begin, size_t end);
+        
+        void workerLoop();
+        void runChunks();
+        
+        /// Wakes up started workers to exit and joins them.
+        void stopWorkers();
+        
+    private:
+        std::vector<std::thread> m_workers;
+        std::mutex m_mutex;
+        std::condition_variable m_wakeup;
+        std::condition_variable m_done;
+        uint64_t m_generation = 0;
+        size_t m_active = 0;
+        bool m_stop = false;
+        
+        const void* m_body = nullptr;
+        void (*m_invoke)(const void*, size_t, size_t) = nullptr;
+        size_t m_count = 0;
+        size_t m_grain = 0;
+        std::atomic<size_t> m_next;
+        std::exception_ptr m_error;
+    };
+    
+    /**
+     Writes 'matcher(values[i])' into 'output[i]' for each of 'count' values using all threads of the pool.
+     Values are passed to the matcher by const reference: payloads are only read, their reference counters are not touched.
+     
+     @param matcher Reusable matcher created with 'AsEnum::matcher<T>()' or any other function object accepting AsEnum.
+     @param output Preallocated output of at least 'count' elements.
+     */
+    template <typename ConcreteAsEnum, typename Matcher, typename T>
+    void parallelMap(ThreadPool& pool, const ConcreteAsEnum* values, size_t count, const Matcher& matcher, T* output);
+    
+    /**
+     Calls 'matcher(values[i])' for each of 'count' values using all threads of the pool.
+     Handlers are called concurrently and must be thread-safe.
+     */
+    template <typename ConcreteAsEnum, typename Matcher>
+    void parallelForEachCase(ThreadPool& pool, const ConcreteAsEnum* values, size_t count, const Matcher& matcher);
+    
+    namespace details
+    {
+        /// Chunk size that gives each thread several chunks to balance the load but keeps chunks big enough to hide scheduling cost.
+        size_t ParallelGrain(size_t count, size_t threadCount);
+    }
+}
+
+
+// Public - ThreadPool
+
+inline asenum::ThreadPool::ThreadPool(size_t threadCount)
+: m_next(0)
+{
+    if (!threadCount)
+    {
+        threadCount = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    }
+    
+    // Destructor is not called if constructor fails, so workers that are already started are stopped here.
+    ASENUM_TRY
+    {
+        m_workers.reserve(threadCount - 1);
+        for (size_t i = 1; i < threadCount; i++)
+        {
+            m_workers.emplace_back(&ThreadPool::workerLoop, this);
+        }
+    }
+    ASENUM_CATCH_ALL
+    {
+        stopWorkers();
+        ASENUM_RETHROW;
+    }
+}
+
+inline asenum::ThreadPool::~ThreadPool()
+{
+    stopWorkers();
+}
+
+inline size_t asenum::ThreadPool::threadCount() const
+{
+    return m_workers.size() + 1;
+}
+
+template <typename Body>
+void asenum::ThreadPool::parallelFor(const size_t count, const size_t grain, const Body& body)
+{
+    if (m_workers.empty() || count <= grain)
+    {
+        if (count)
+        {
+            body(0, count);
+        }
+        return;
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_body = &body;
+        m_invoke = &invokeBody<Body>;
+        m_count = count;
+        m_grain = std::max<size_t>(grain, 1);
+        m_next = 0;
+        m_error = nullptr;
+        m_active = m_workers.size();
+        m_generation++;
+    }
+    m_wakeup.notify_all();
+    
+    runChunks();
+    
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_done.wait(lock, [this] { return m_active == 0; });
+    
+    if (m_error)
+    {
+        std::exception_ptr error = m_error;
+        m_error = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+// Private - ThreadPool
+
+template <typename Body>
+void asenum::ThreadPool::invokeBody(const void* body, const size_t begin, const size_t end)
+{
+    (*static_cast<const Body*>(body))(begin, end);
+}
+
+inline void asenum::ThreadPool::workerLoop()
+{
+    uint64_t generation = 0;
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true)
+    {
+        m_wakeup.wait(lock, [this, generation] { return m_stop || m_generation != generation; });
+        if (m_stop)
+        {
+            return;
+        }
+        
+        generation = m_generation;
+        lock.unlock();
+        runChunks();
+        lock.lock();
+        
+        if (--m_active == 0)
+        {
+            m_done.notify_one();
+        }
+    }
+}
+
+inline void asenum::ThreadPool::runChunks()
+{
+    while (true)
+    {
+        const size_t begin = m_next.fetch_add(m_grain, std::memory_order_relaxed);
+        if (begin >= m_count)
+        {
+            return;
+        }
+        
+        ASENUM_TRY
+        {
+            m_invoke(m_body, begin, std::min(begin + m_grain, m_count));
+        }
+        ASENUM_CATCH_ALL
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_error)
+            {
+                m_error = std::current_exception();
+            }
+            m_next = m_count;
+        }
+    }
+}
+
+inline void asenum::ThreadPool::stopWorkers()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wakeup.notify_all();
+    
+    for (std::thread& worker : m_workers)
+    {
+        worker.join();
+    }
+}
+
+// Public - algorithms
+
+template <typename ConcreteAsEnum, typename Matcher, typename T>
+void asenum::parallelMap(ThreadPool& pool, const ConcreteAsEnum* values, const size_t count, const Matcher& matcher, T* output)
+{
+    pool.parallelFor(count, details::ParallelGrain(count, pool.threadCount()), [values, &matcher, output] (const size_t begin, const size_t end) {
+        for (size_t i = begin; i < end; i++)
+        {
+            output[i] = matcher(values[i]);
+        }
+    });
+}
+
+template <typename ConcreteAsEnum, typename Matcher>
+void asenum::parallelForEachCase(ThreadPool& pool, const ConcreteAsEnum* values, const size_t count, const Matcher& matcher)
+{
+    pool.parallelFor(count, details::ParallelGrain(count, pool.threadCount()), [values, &matcher] (const size_t begin, const size_t end) {
+        for (size_t i = begin; i < end; i++)
+        {
+            matcher(values[i]);
+        }
+    });
+}
+
+// Private details
+
+inline size_t asenum::details::ParallelGrain(const size_t count, const size_t threadCount)
+{
+    constexpr size_t MinGrain = 1024;
+    constexpr size_t ChunksPerThread = 8;
+    
+    return std::max(MinGrain, count / (threadCount * ChunksPerThread));
+}
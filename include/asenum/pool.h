@@ -0,0 +1,322 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Alkenso (Vladimir Vashurkin)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <asenum/asenum.h>
+
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace asenum
+{
+    namespace details
+    {
+        /**
+         Pool of fixed-size blocks for objects of type 'T'.
+         Each thread keeps its own free list, so allocation and deallocation normally don't synchronize.
+         Blocks are carved from slabs that are never returned to the system.
+         Thread caching too many freed blocks (e.g. consumer of producer-consumer pair) returns them
+         to shared list in batches; other threads pick whole batches from there before allocating new slab.
+         */
+        template <typename T>
+        class SlabPool
+        {
+        public:
+            static void* allocate();
+            static void deallocate(void* ptr) noexcept;
+            
+        private:
+            /// Free block. Head block of batch in shared list also links to the next batch and keeps size of its batch.
+            struct Block
+            {
+                Block* next;
+                Block* nextBatch;
+                size_t count;
+            };
+            
+            struct Shared
+            {
+                std::mutex mutex;
+                Block* batches = nullptr;
+                std::vector<void*> slabs;
+            };
+            
+            struct LocalCache
+            {
+                ~LocalCache();
+                
+                Block* head = nullptr;
+                size_t count = 0;
+            };
+            
+            static constexpr size_t BlockAlign = Max(alignof(T), alignof(Block));
+            static constexpr size_t BlockSize = (Max(sizeof(T), sizeof(Block)) + BlockAlign - 1) / BlockAlign * BlockAlign;
+            static constexpr size_t BatchSize = 64;
+            
+            static Shared& shared();
+            
+            /// @return cache of current thread or nullptr if it is already destroyed at thread exit.
+            static LocalCache* local();
+            
+            /// Trivially destructible flag that stays readable after thread-local cache is destroyed.
+            static bool& localDestroyed();
+            
+            static void* take(LocalCache& cache);
+            static void refill(LocalCache& cache);
+            static Block* popBatch(LocalCache& cache);
+            static void pushBatch(Block* head, size_t count) noexcept;
+        };
+    }
+    
+    /**
+     Allocator that takes single objects from per-type 'SlabPool' and falls back to 'std::allocator'
+     for arrays and over-aligned types.
+     Being used as AsEnum allocator, it gives separate pool to each payload type (heap value with its reference counter).
+     Cases with the same payload type share one pool: blocks of such cases have the same size anyway.
+     */
+    template <typename T>
+    struct PoolAllocator
+    {
+        using value_type = T;
+        
+        PoolAllocator() = default;
+        
+        template <typename U>
+        PoolAllocator(const PoolAllocator<U>&) {}
+        
+        T* allocate(size_t count);
+        void deallocate(T* ptr, size_t count) noexcept;
+        
+        template <typename U>
+        bool operator==(const PoolAllocator<U>&) const { return true; }
+        
+        template <typename U>
+        bool operator!=(const PoolAllocator<U>&) const { return false; }
+    };
+    
+    /// Storage policy that allocates heap values from per-type pools (see 'PoolAllocator').
+    template <size_t T_Size = 2 * sizeof(void*), size_t T_Align = alignof(void*)>
+    using PooledStorage = InlineStorage<T_Size, T_Align, PoolAllocator>;
+    
+    /// AsEnum that allocates heap values from per-type pools.
+    template <typename... T_Cases>
+    using PooledAsEnum = BasicAsEnum<PooledStorage<>, T_Cases...>;
+}
+
+
+// PoolAllocator public
+
+template <typename T>
+T* asenum::PoolAllocator<T>::allocate(const size_t count)
+{
+    if (count != 1 || alignof(T) > alignof(std::max_align_t))
+    {
+        return std::allocator<T>().allocate(count);
+    }
+    
+    return static_cast<T*>(details::SlabPool<T>::allocate());
+}
+
+template <typename T>
+void asenum::PoolAllocator<T>::deallocate(T* ptr, const size_t count) noexcept
+{
+    if (count != 1 || alignof(T) > alignof(std::max_align_t))
+    {
+        std::allocator<T>().deallocate(ptr, count);
+        return;
+    }
+    
+    details::SlabPool<T>::deallocate(ptr);
+}
+
+// Private details - SlabPool
+
+template <typename T>
+constexpr size_t asenum::details::SlabPool<T>::BlockAlign;
+
+template <typename T>
+constexpr size_t asenum::details::SlabPool<T>::BlockSize;
+
+template <typename T>
+constexpr size_t asenum::details::SlabPool<T>::BatchSize;
+
+template <typename T>
+void* asenum::details::SlabPool<T>::allocate()
+{
+    LocalCache* const cache = local();
+    if (!cache)
+    {
+        // Temporary cache returns the rest of refilled batch to shared list when destroyed.
+        LocalCache orphan;
+        return take(orphan);
+    }
+    
+    return take(*cache);
+}
+
+template <typename T>
+void asenum::details::SlabPool<T>::deallocate(void* ptr) noexcept
+{
+    Block* const block = static_cast<Block*>(ptr);
+    
+    LocalCache* const cache = local();
+    if (!cache)
+    {
+        // Late release at thread exit (e.g. from other thread-local object) goes directly to shared list.
+        block->next = nullptr;
+        pushBatch(block, 1);
+        return;
+    }
+    
+    block->next = cache->head;
+    cache->head = block;
+    cache->count++;
+    
+    if (cache->count >= 2 * BatchSize)
+    {
+        pushBatch(popBatch(*cache), BatchSize);
+    }
+}
+
+template <typename T>
+typename asenum::details::SlabPool<T>::Shared& asenum::details::SlabPool<T>::shared()
+{
+    // Intentionally never destroyed: blocks may be released by thread-local caches and static objects during shutdown.
+    static Shared* const s_shared = new Shared();
+    return *s_shared;
+}
+
+template <typename T>
+typename asenum::details::SlabPool<T>::LocalCache* asenum::details::SlabPool<T>::local()
+{
+    // Destroyed cache must not be touched at all, so the flag is checked before the cache is referenced.
+    if (localDestroyed())
+    {
+        return nullptr;
+    }
+    
+    static thread_local LocalCache s_cache;
+    return &s_cache;
+}
+
+template <typename T>
+bool& asenum::details::SlabPool<T>::localDestroyed()
+{
+    static thread_local bool s_destroyed = false;
+    return s_destroyed;
+}
+
+template <typename T>
+void* asenum::details::SlabPool<T>::take(LocalCache& cache)
+{
+    if (!cache.head)
+    {
+        refill(cache);
+    }
+    
+    Block* const block = cache.head;
+    cache.head = block->next;
+    cache.count--;
+    
+    return block;
+}
+
+template <typename T>
+void asenum::details::SlabPool<T>::refill(LocalCache& cache)
+{
+    Shared& state = shared();
+    {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        if (Block* const batch = state.batches)
+        {
+            state.batches = batch->nextBatch;
+            
+            cache.head = batch;
+            cache.count = batch->count;
+            return;
+        }
+    }
+    
+    char* const slab = static_cast<char*>(::operator new(BlockSize * BatchSize));
+    for (size_t i = BatchSize; i > 0; i--)
+    {
+        Block* const block = reinterpret_cast<Block*>(slab + (i - 1) * BlockSize);
+        block->next = cache.head;
+        cache.head = block;
+    }
+    cache.count = BatchSize;
+    
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.slabs.push_back(slab);
+}
+
+template <typename T>
+typename asenum::details::SlabPool<T>::Block* asenum::details::SlabPool<T>::popBatch(LocalCache& cache)
+{
+    Block* const batch = cache.head;
+    
+    Block* last = cache.head;
+    for (size_t i = 1; i < BatchSize; i++)
+    {
+        last = last->next;
+    }
+    
+    cache.head = last->next;
+    cache.count -= BatchSize;
+    last->next = nullptr;
+    
+    return batch;
+}
+
+template <typename T>
+void asenum::details::SlabPool<T>::pushBatch(Block* const head, const size_t count) noexcept
+{
+    // Batches are linked through their head blocks, so releasing memory never allocates.
+    head->count = count;
+    
+    Shared& state = shared();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    head->nextBatch = state.batches;
+    state.batches = head;
+}
+
+template <typename T>
+asenum::details::SlabPool<T>::LocalCache::~LocalCache()
+{
+    // Besides thread cache, only temporary caches used after its destruction exist, so the flag is never set early.
+    localDestroyed() = true;
+    if (!head)
+    {
+        return;
+    }
+    
+    pushBatch(head, count);
+    
+    head = nullptr;
+    count = 0;
+}
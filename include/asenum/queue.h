@@ -0,0 +1,307 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Alkenso (Vladimir Vashurkin)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <asenum/asenum.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+
+namespace asenum
+{
+    /**
+     Bounded lock-free multi-producer multi-consumer queue of AsEnum messages.
+     Slots are allocated once: pushing moves AsEnum into its slot (heap payload is passed by its handle,
+     inline payloads are copied), so neither producers nor consumers allocate.
+     
+     Each slot has sequence number that tells whether it is free or holds message of the current lap,
+     so producers and consumers synchronize only on the slots they use and on their own position counter.
+     */
+    template <typename ConcreteAsEnum>
+    class AsEnumQueue
+    {
+    public:
+        /// @param capacity Maximum number of queued messages. Rounded up to power of two.
+        explicit AsEnumQueue(size_t capacity);
+        
+        /// Destroys messages left in the queue. Must not be called concurrently with other methods.
+        ~AsEnumQueue();
+        
+        AsEnumQueue(const AsEnumQueue&) = delete;
+        AsEnumQueue& operator=(const AsEnumQueue&) = delete;
+        
+        size_t capacity() const;
+        
+        /// @return true if message is queued; false if queue is full (message is left untouched then).
+        bool tryPush(ConcreteAsEnum&& message);
+        bool tryPush(const ConcreteAsEnum& message);
+        
+        /// @return true if message is taken from the queue into 'message'; false if queue is empty.
+        bool tryPop(ConcreteAsEnum& message);
+        
+        /**
+         Takes messages that are ready in batches and calls 'matcher(message)' for each of them in queue order.
+         Each batch is claimed with single update of shared consumer position.
+         
+         If matcher throws, the rest of claimed batch is discarded and the exception is propagated.
+         
+         @param matcher Reusable matcher created with 'AsEnum::matcher<void>()' or any other function object accepting AsEnum.
+         @param maxCount Maximum number of messages to take.
+         @return Number of processed messages. Zero if queue is empty.
+         */
+        template <typename Matcher>
+        size_t drain(const Matcher& matcher, size_t maxCount = std::numeric_limits<size_t>::max());
+        
+    private:
+        struct Slot
+        {
+            std::atomic<size_t> sequence;
+            typename std::aligned_storage<sizeof(ConcreteAsEnum), alignof(ConcreteAsEnum)>::type message;
+        };
+        
+        /// Maximum number of messages claimed by 'drain' at once: bounds time other consumers wait for them.
+        static constexpr size_t MaxBatch = 64;
+        
+        static ConcreteAsEnum& Message(Slot& slot);
+        
+        /// Claims up to 'maxCount' consecutive ready slots. @return number of claimed slots starting from 'position'.
+        size_t claim(size_t& position, size_t maxCount);
+        
+        /// Moves message out of claimed slot and frees the slot for producers.
+        ConcreteAsEnum release(size_t position);
+        
+    private:
+        const size_t m_mask;
+        const std::unique_ptr<Slot[]> m_slots;
+        
+        alignas(details::CacheLineSize) std::atomic<size_t> m_pushPosition;
+        alignas(details::CacheLineSize) std::atomic<size_t> m_popPosition;
+    };
+    
+    namespace details
+    {
+        inline size_t QueueCapacity(size_t capacity);
+    }
+}
+
+
+// Public - AsEnumQueue
+
+template <typename ConcreteAsEnum>
+constexpr size_t asenum::AsEnumQueue<ConcreteAsEnum>::MaxBatch;
+
+template <typename ConcreteAsEnum>
+asenum::AsEnumQueue<ConcreteAsEnum>::AsEnumQueue(const size_t capacity)
+: m_mask(details::QueueCapacity(capacity) - 1)
+, m_slots(new Slot[m_mask + 1])
+, m_pushPosition(0)
+, m_popPosition(0)
+{
+    for (size_t i = 0; i <= m_mask; i++)
+    {
+        m_slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+template <typename ConcreteAsEnum>
+asenum::AsEnumQueue<ConcreteAsEnum>::~AsEnumQueue()
+{
+    const size_t end = m_pushPosition.load(std::memory_order_relaxed);
+    for (size_t position = m_popPosition.load(std::memory_order_relaxed); position != end; position++)
+    {
+        Message(m_slots[position & m_mask]).~ConcreteAsEnum();
+    }
+}
+
+template <typename ConcreteAsEnum>
+size_t asenum::AsEnumQueue<ConcreteAsEnum>::capacity() const
+{
+    return m_mask + 1;
+}
+
+template <typename ConcreteAsEnum>
+bool asenum::AsEnumQueue<ConcreteAsEnum>::tryPush(ConcreteAsEnum&& message)
+{
+    size_t position = m_pushPosition.load(std::memory_order_relaxed);
+    while (true)
+    {
+        Slot& slot = m_slots[position & m_mask];
+        const intptr_t lag = static_cast<intptr_t>(slot.sequence.load(std::memory_order_acquire) - position);
+        if (lag == 0)
+        {
+            if (m_pushPosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+            {
+                // AsEnum move is noexcept: claimed slot is always filled.
+                new (&slot.message) ConcreteAsEnum(std::move(message));
+                slot.sequence.store(position + 1, std::memory_order_release);
+                return true;
+            }
+        }
+        else if (lag < 0)
+        {
+            // Slot still holds message of the previous lap.
+            return false;
+        }
+        else
+        {
+            position = m_pushPosition.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+template <typename ConcreteAsEnum>
+bool asenum::AsEnumQueue<ConcreteAsEnum>::tryPush(const ConcreteAsEnum& message)
+{
+    ConcreteAsEnum copy(message);
+    return tryPush(std::move(copy));
+}
+
+template <typename ConcreteAsEnum>
+bool asenum::AsEnumQueue<ConcreteAsEnum>::tryPop(ConcreteAsEnum& message)
+{
+    size_t position = 0;
+    if (!claim(position, 1))
+    {
+        return false;
+    }
+    
+    message = release(position);
+    return true;
+}
+
+template <typename ConcreteAsEnum>
+template <typename Matcher>
+size_t asenum::AsEnumQueue<ConcreteAsEnum>::drain(const Matcher& matcher, const size_t maxCount)
+{
+    size_t processed = 0;
+    while (processed < maxCount)
+    {
+        size_t position = 0;
+        const size_t count = claim(position, std::min(maxCount - processed, MaxBatch));
+        if (!count)
+        {
+            break;
+        }
+        
+        for (size_t i = 0; i < count; i++)
+        {
+            const ConcreteAsEnum message = release(position + i);
+            ASENUM_TRY
+            {
+                matcher(message);
+            }
+            ASENUM_CATCH_ALL
+            {
+                // Claimed slots must be returned to producers.
+                for (size_t j = i + 1; j < count; j++)
+                {
+                    release(position + j);
+                }
+                ASENUM_RETHROW;
+            }
+        }
+        processed += count;
+    }
+    
+    return processed;
+}
+
+// Private - AsEnumQueue
+
+template <typename ConcreteAsEnum>
+ConcreteAsEnum& asenum::AsEnumQueue<ConcreteAsEnum>::Message(Slot& slot)
+{
+    return *reinterpret_cast<ConcreteAsEnum*>(&slot.message);
+}
+
+template <typename ConcreteAsEnum>
+size_t asenum::AsEnumQueue<ConcreteAsEnum>::claim(size_t& position, const size_t maxCount)
+{
+    position = m_popPosition.load(std::memory_order_relaxed);
+    while (true)
+    {
+        const intptr_t lag = static_cast<intptr_t>(m_slots[position & m_mask].sequence.load(std::memory_order_acquire) - (position + 1));
+        if (lag < 0)
+        {
+            // Slot is not filled yet: queue is empty.
+            return 0;
+        }
+        if (lag > 0)
+        {
+            position = m_popPosition.load(std::memory_order_relaxed);
+            continue;
+        }
+        
+        // Messages published after the first one can be claimed together with it.
+        size_t count = 1;
+        while (count < maxCount && m_slots[(position + count) & m_mask].sequence.load(std::memory_order_acquire) == position + count + 1)
+        {
+            count++;
+        }
+        
+        if (m_popPosition.compare_exchange_weak(position, position + count, std::memory_order_relaxed))
+        {
+            return count;
+        }
+    }
+}
+
+template <typename ConcreteAsEnum>
+ConcreteAsEnum asenum::AsEnumQueue<ConcreteAsEnum>::release(const size_t position)
+{
+    Slot& slot = m_slots[position & m_mask];
+    ConcreteAsEnum& stored = Message(slot);
+    
+    ConcreteAsEnum message(std::move(stored));
+    stored.~ConcreteAsEnum();
+    slot.sequence.store(position + m_mask + 1, std::memory_order_release);
+    
+    return message;
+}
+
+// Private details
+
+inline size_t asenum::details::QueueCapacity(const size_t capacity)
+{
+    if (capacity < 2 || capacity > std::numeric_limits<size_t>::max() / 2 + 1)
+    {
+        details::RaiseError<std::invalid_argument>("Queue capacity is out of range.");
+    }
+    
+    size_t rounded = 1;
+    while (rounded < capacity)
+    {
+        rounded <<= 1;
+    }
+    
+    return rounded;
+}
@@ -0,0 +1,781 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Alkenso (Vladimir Vashurkin)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <asenum/asenum.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#if defined(__x86_64__) || defined(_M_X64) || (defined(__i386__) && defined(__SSE2__))
+#   define ASENUM_SIMD_X86 1
+#   include <emmintrin.h>
+#   if defined(__GNUC__)
+#       define ASENUM_SIMD_AVX2 1
+#       include <immintrin.h>
+#   endif
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#   define ASENUM_SIMD_NEON 1
+#   include <arm_neon.h>
+#endif
+
+namespace asenum
+{
+    /// Instruction sets used by batch functions over tag arrays.
+    enum class SimdLevel
+    {
+        Scalar,
+        SSE2,
+        AVX2,
+        NEON
+    };
+    
+    /// @return the best instruction set supported by the running CPU. Detected once.
+    SimdLevel ActiveSimdLevel();
+    
+    /// @return number of tags equal to 'value'.
+    template <typename Enum>
+    size_t countCase(const Enum* tags, size_t count, Enum value);
+    
+    /**
+     Writes positions of tags equal to 'value' into 'indices' in ascending order.
+     
+     @param indices Output buffer. Must have room for 'count' elements in the worst case.
+     @return number of written indices.
+     */
+    template <typename Enum>
+    size_t selectCase(const Enum* tags, size_t count, Enum value, size_t* indices);
+    
+    /**
+     Counts tags by their underlying values: 'histogram[v]' is set to number of tags with underlying value 'v'.
+     Tags with underlying values outside of [0, bins) are not counted, so sparse or negative enums need
+     'bins' covering the largest value or lose counts. Use overload by case index for such enums.
+     Vector kernels are used only if 'bins' is not greater than 8.
+     */
+    template <typename Enum>
+    void caseHistogram(const Enum* tags, size_t count, size_t* histogram, size_t bins);
+    
+    /**
+     Counts tags by case of 'ConcreteAsEnum': 'histogram[i]' is set to number of tags equal to 'ConcreteAsEnum::AllCases[i]'.
+     Tags that are not cases of 'ConcreteAsEnum' are not counted.
+     Cases with values 0, 1, 2... are histogrammed by underlying values, up to 8 other cases are counted with 'countCase' one by one,
+     more cases are mapped to case index with 'ConcreteAsEnum::indexOf'.
+     
+     @param histogram Output of number of cases of 'ConcreteAsEnum' elements.
+     */
+    template <typename ConcreteAsEnum>
+    void caseHistogram(const typename ConcreteAsEnum::Enum* tags, size_t count, size_t* histogram);
+    
+    namespace details
+    {
+        /// Unsigned integer of the same size as enum, used to process tags as plain numbers.
+        template <size_t Size>
+        struct TagWord;
+        
+        template <> struct TagWord<1> { using type = uint8_t; };
+        template <> struct TagWord<2> { using type = uint16_t; };
+        template <> struct TagWord<4> { using type = uint32_t; };
+        template <> struct TagWord<8> { using type = uint64_t; };
+        
+        SimdLevel DetectSimdLevel();
+        unsigned PopCount(uint32_t value);
+        unsigned CountTrailingZeros(uint32_t value);
+        
+        /// Tags with up to this number of bins are histogrammed with vector compares in single pass.
+        constexpr size_t SimdHistogramBins = 8;
+        
+        /// Portable kernels over arrays of 'T'.
+        template <typename T>
+        struct ScalarTagKernels
+        {
+            static size_t countScalar(const T* tags, size_t count, T value);
+            static size_t selectScalar(const T* tags, size_t count, T value, size_t* indices, size_t offset);
+            static void histogramScalar(const T* tags, size_t count, size_t* histogram, size_t bins);
+        };
+        
+        /// Kernels over arrays of 'T' for each instruction set. Callers must check the instruction set is supported.
+        template <typename T>
+        struct TagKernels: ScalarTagKernels<T>
+        {
+            using ScalarTagKernels<T>::countScalar;
+            using ScalarTagKernels<T>::selectScalar;
+            using ScalarTagKernels<T>::histogramScalar;
+            
+            static size_t count(SimdLevel level, const T* tags, size_t count, T value);
+            static size_t select(SimdLevel level, const T* tags, size_t count, T value, size_t* indices);
+            static void histogram(SimdLevel level, const T* tags, size_t count, size_t* histogram, size_t bins);
+            
+#if ASENUM_SIMD_X86
+            static size_t countSSE2(const T* tags, size_t count, T value);
+            static size_t selectSSE2(const T* tags, size_t count, T value, size_t* indices);
+            static void histogramSSE2(const T* tags, size_t count, size_t* histogram, size_t bins);
+#endif
+#if ASENUM_SIMD_AVX2
+            __attribute__((target("avx2"))) static size_t countAVX2(const T* tags, size_t count, T value);
+            __attribute__((target("avx2"))) static size_t selectAVX2(const T* tags, size_t count, T value, size_t* indices);
+            __attribute__((target("avx2"))) static void histogramAVX2(const T* tags, size_t count, size_t* histogram, size_t bins);
+#endif
+#if ASENUM_SIMD_NEON
+            static size_t countNEON(const T* tags, size_t count, T value);
+            static size_t selectNEON(const T* tags, size_t count, T value, size_t* indices);
+            static void histogramNEON(const T* tags, size_t count, size_t* histogram, size_t bins);
+#endif
+        };
+        
+        /// 64-bit lanes are not compared by SSE2: 64-bit tags are always processed by scalar kernels.
+        template <>
+        struct TagKernels<uint64_t>: ScalarTagKernels<uint64_t>
+        {
+            static size_t count(SimdLevel, const uint64_t* tags, size_t count, uint64_t value) { return countScalar(tags, count, value); }
+            static size_t select(SimdLevel, const uint64_t* tags, size_t count, uint64_t value, size_t* indices) { return selectScalar(tags, count, value, indices, 0); }
+            static void histogram(SimdLevel, const uint64_t* tags, size_t count, size_t* histogram, size_t bins) { histogramScalar(tags, count, histogram, bins); }
+        };
+        
+#if ASENUM_SIMD_X86
+        /// Lane-wise equality of 128-bit vectors for lanes of 'T'.
+        __m128i CompareLanes128(__m128i lhs, __m128i rhs, uint8_t);
+        __m128i CompareLanes128(__m128i lhs, __m128i rhs, uint16_t);
+        __m128i CompareLanes128(__m128i lhs, __m128i rhs, uint32_t);
+        
+        __m128i Splat128(uint8_t value);
+        __m128i Splat128(uint16_t value);
+        __m128i Splat128(uint32_t value);
+#endif
+#if ASENUM_SIMD_AVX2
+        __attribute__((target("avx2"))) __m256i CompareLanes256(__m256i lhs, __m256i rhs, uint8_t);
+        __attribute__((target("avx2"))) __m256i CompareLanes256(__m256i lhs, __m256i rhs, uint16_t);
+        __attribute__((target("avx2"))) __m256i CompareLanes256(__m256i lhs, __m256i rhs, uint32_t);
+#endif
+#if ASENUM_SIMD_NEON
+        uint8x16_t CompareLanesNEON(uint8x16_t lhs, uint8_t value);
+        uint8x16_t CompareLanesNEON(uint8x16_t lhs, uint16_t value);
+        uint8x16_t CompareLanesNEON(uint8x16_t lhs, uint32_t value);
+#endif
+        
+        /// Mask of 'movemask' bits that has single bit per lane of 'T'.
+        constexpr uint32_t LaneMask(const size_t laneSize)
+        {
+            return laneSize == 1 ? 0xFFFFFFFFu : laneSize == 2 ? 0x55555555u : 0x11111111u;
+        }
+    }
+}
+
+
+// Public
+
+inline asenum::SimdLevel asenum::ActiveSimdLevel()
+{
+    static const SimdLevel s_level = details::DetectSimdLevel();
+    return s_level;
+}
+
+template <typename Enum>
+size_t asenum::countCase(const Enum* tags, const size_t count, const Enum value)
+{
+    using Word = typename details::TagWord<sizeof(Enum)>::type;
+    return details::TagKernels<Word>::count(ActiveSimdLevel(), reinterpret_cast<const Word*>(tags), count, static_cast<Word>(value));
+}
+
+template <typename Enum>
+size_t asenum::selectCase(const Enum* tags, const size_t count, const Enum value, size_t* indices)
+{
+    using Word = typename details::TagWord<sizeof(Enum)>::type;
+    return details::TagKernels<Word>::select(ActiveSimdLevel(), reinterpret_cast<const Word*>(tags), count, static_cast<Word>(value), indices);
+}
+
+template <typename Enum>
+void asenum::caseHistogram(const Enum* tags, const size_t count, size_t* histogram, const size_t bins)
+{
+    using Word = typename details::TagWord<sizeof(Enum)>::type;
+    details::TagKernels<Word>::histogram(ActiveSimdLevel(), reinterpret_cast<const Word*>(tags), count, histogram, bins);
+}
+
+template <typename ConcreteAsEnum>
+void asenum::caseHistogram(const typename ConcreteAsEnum::Enum* tags, const size_t count, size_t* histogram)
+{
+    static constexpr size_t CaseCount = details::ArraySize(ConcreteAsEnum::AllCases);
+    
+    bool byValue = true;
+    for (size_t i = 0; i < CaseCount; i++)
+    {
+        byValue = byValue && static_cast<uint64_t>(ConcreteAsEnum::AllCases[i]) == i;
+    }
+    
+    if (byValue)
+    {
+        caseHistogram(tags, count, histogram, CaseCount);
+    }
+    else if (CaseCount <= details::SimdHistogramBins)
+    {
+        for (size_t i = 0; i < CaseCount; i++)
+        {
+            histogram[i] = countCase(tags, count, ConcreteAsEnum::AllCases[i]);
+        }
+    }
+    else
+    {
+        for (size_t i = 0; i < CaseCount; i++)
+        {
+            histogram[i] = 0;
+        }
+        for (size_t i = 0; i < count; i++)
+        {
+            const size_t index = ConcreteAsEnum::indexOf(tags[i]);
+            if (index < CaseCount)
+            {
+                histogram[index]++;
+            }
+        }
+    }
+}
+
+// Private details - helpers
+
+inline asenum::SimdLevel asenum::details::DetectSimdLevel()
+{
+#if ASENUM_SIMD_AVX2
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+    {
+        return SimdLevel::AVX2;
+    }
+#endif
+#if ASENUM_SIMD_X86
+    return SimdLevel::SSE2;
+#elif ASENUM_SIMD_NEON
+    return SimdLevel::NEON;
+#else
+    return SimdLevel::Scalar;
+#endif
+}
+
+inline unsigned asenum::details::PopCount(uint32_t value)
+{
+#if defined(__GNUC__)
+    return static_cast<unsigned>(__builtin_popcount(value));
+#else
+    value = value - ((value >> 1) & 0x55555555u);
+    value = (value & 0x33333333u) + ((value >> 2) & 0x33333333u);
+    return (((value + (value >> 4)) & 0x0F0F0F0Fu) * 0x01010101u) >> 24;
+#endif
+}
+
+inline unsigned asenum::details::CountTrailingZeros(uint32_t value)
+{
+#if defined(__GNUC__)
+    return static_cast<unsigned>(__builtin_ctz(value));
+#else
+    unsigned result = 0;
+    while (!(value & 1))
+    {
+        value >>= 1;
+        result++;
+    }
+    return result;
+#endif
+}
+
+// Private details - TagKernels dispatch
+
+template <typename T>
+size_t asenum::details::TagKernels<T>::count(const SimdLevel level, const T* tags, const size_t count, const T value)
+{
+    switch (level)
+    {
+#if ASENUM_SIMD_AVX2
+        case SimdLevel::AVX2:
+            return countAVX2(tags, count, value);
+#endif
+#if ASENUM_SIMD_X86
+        case SimdLevel::SSE2:
+            return countSSE2(tags, count, value);
+#endif
+#if ASENUM_SIMD_NEON
+        case SimdLevel::NEON:
+            return countNEON(tags, count, value);
+#endif
+        default:
+            return countScalar(tags, count, value);
+    }
+}
+
+template <typename T>
+size_t asenum::details::TagKernels<T>::select(const SimdLevel level, const T* tags, const size_t count, const T value, size_t* indices)
+{
+    switch (level)
+    {
+#if ASENUM_SIMD_AVX2
+        case SimdLevel::AVX2:
+            return selectAVX2(tags, count, value, indices);
+#endif
+#if ASENUM_SIMD_X86
+        case SimdLevel::SSE2:
+            return selectSSE2(tags, count, value, indices);
+#endif
+#if ASENUM_SIMD_NEON
+        case SimdLevel::NEON:
+            return selectNEON(tags, count, value, indices);
+#endif
+        default:
+            return selectScalar(tags, count, value, indices, 0);
+    }
+}
+
+template <typename T>
+void asenum::details::TagKernels<T>::histogram(const SimdLevel level, const T* tags, const size_t count, size_t* histogram, const size_t bins)
+{
+    if (bins > SimdHistogramBins)
+    {
+        return histogramScalar(tags, count, histogram, bins);
+    }
+    
+    switch (level)
+    {
+#if ASENUM_SIMD_AVX2
+        case SimdLevel::AVX2:
+            return histogramAVX2(tags, count, histogram, bins);
+#endif
+#if ASENUM_SIMD_X86
+        case SimdLevel::SSE2:
+            return histogramSSE2(tags, count, histogram, bins);
+#endif
+#if ASENUM_SIMD_NEON
+        case SimdLevel::NEON:
+            return histogramNEON(tags, count, histogram, bins);
+#endif
+        default:
+            return histogramScalar(tags, count, histogram, bins);
+    }
+}
+
+// Private details - ScalarTagKernels
+
+template <typename T>
+size_t asenum::details::ScalarTagKernels<T>::countScalar(const T* tags, const size_t count, const T value)
+{
+    size_t result = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        result += tags[i] == value;
+    }
+    
+    return result;
+}
+
+template <typename T>
+size_t asenum::details::ScalarTagKernels<T>::selectScalar(const T* tags, const size_t count, const T value, size_t* indices, const size_t offset)
+{
+    size_t result = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        indices[result] = offset + i;
+        result += tags[i] == value;
+    }
+    
+    return result;
+}
+
+template <typename T>
+void asenum::details::ScalarTagKernels<T>::histogramScalar(const T* tags, const size_t count, size_t* histogram, const size_t bins)
+{
+    for (size_t bin = 0; bin < bins; bin++)
+    {
+        histogram[bin] = 0;
+    }
+    
+    for (size_t i = 0; i < count; i++)
+    {
+        if (tags[i] < bins)
+        {
+            histogram[tags[i]]++;
+        }
+    }
+}
+
+#if ASENUM_SIMD_X86
+
+// Private details - TagKernels SSE2
+// Equal lanes are counted bytewise: each equal lane subtracts -1 from 'sizeof(T)' byte counters.
+// Byte counters are flushed before they overflow, every 255 blocks.
+
+inline __m128i asenum::details::CompareLanes128(const __m128i lhs, const __m128i rhs, uint8_t)
+{
+    return _mm_cmpeq_epi8(lhs, rhs);
+}
+
+inline __m128i asenum::details::CompareLanes128(const __m128i lhs, const __m128i rhs, uint16_t)
+{
+    return _mm_cmpeq_epi16(lhs, rhs);
+}
+
+inline __m128i asenum::details::CompareLanes128(const __m128i lhs, const __m128i rhs, uint32_t)
+{
+    return _mm_cmpeq_epi32(lhs, rhs);
+}
+
+inline __m128i asenum::details::Splat128(const uint8_t value)
+{
+    return _mm_set1_epi8(static_cast<char>(value));
+}
+
+inline __m128i asenum::details::Splat128(const uint16_t value)
+{
+    return _mm_set1_epi16(static_cast<short>(value));
+}
+
+inline __m128i asenum::details::Splat128(const uint32_t value)
+{
+    return _mm_set1_epi32(static_cast<int>(value));
+}
+
+template <typename T>
+size_t asenum::details::TagKernels<T>::countSSE2(const T* tags, const size_t count, const T value)
+{
+    constexpr size_t Lanes = sizeof(__m128i) / sizeof(T);
+    const __m128i needle = Splat128(value);
+    const __m128i zero = _mm_setzero_si128();
+    
+    size_t bytes = 0;
+    size_t i = 0;
+    while (count - i >= Lanes)
+    {
+        const size_t blocks = (count - i) / Lanes;
+        const size_t end = i + (blocks < 255 ? blocks : 255) * Lanes;
+        
+        __m128i counters = zero;
+        for (; i < end; i += Lanes)
+        {
+            const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(tags + i));
+            counters = _mm_sub_epi8(counters, CompareLanes128(block, needle, T()));
+        }
+        
+        const __m128i sums = _mm_sad_epu8(counters, zero);
+        bytes += static_cast<size_t>(_mm_cvtsi128_si32(sums)) + static_cast<size_t>(_mm_extract_epi16(sums, 4));
+    }
+    
+    return bytes / sizeof(T) + countScalar(tags + i, count - i, value);
+}
+
+template <typename T>
+size_t asenum::details::TagKernels<T>::selectSSE2(const T* tags, const size_t count, const T value, size_t* indices)
+{
+    constexpr size_t Lanes = sizeof(__m128i) / sizeof(T);
+    const __m128i needle = Splat128(value);
+    
+    size_t result = 0;
+    size_t i = 0;
+    for (; count - i >= Lanes; i += Lanes)
+    {
+        const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(tags + i));
+        uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(CompareLanes128(block, needle, T()))) & LaneMask(sizeof(T));
+        while (mask)
+        {
+            indices[result++] = i + CountTrailingZeros(mask) / sizeof(T);
+            mask &= mask - 1;
+        }
+    }
+    
+    return result + selectScalar(tags + i, count - i, value, indices + result, i);
+}
+
+template <typename T>
+void asenum::details::TagKernels<T>::histogramSSE2(const T* tags, const size_t count, size_t* histogram, const size_t bins)
+{
+    constexpr size_t Lanes = sizeof(__m128i) / sizeof(T);
+    const __m128i zero = _mm_setzero_si128();
+    
+    __m128i needles[SimdHistogramBins];
+    size_t bytes[SimdHistogramBins] = {};
+    for (size_t bin = 0; bin < bins; bin++)
+    {
+        needles[bin] = Splat128(static_cast<T>(bin));
+    }
+    
+    size_t i = 0;
+    while (count - i >= Lanes)
+    {
+        const size_t blocks = (count - i) / Lanes;
+        const size_t end = i + (blocks < 255 ? blocks : 255) * Lanes;
+        
+        __m128i counters[SimdHistogramBins];
+        for (size_t bin = 0; bin < bins; bin++)
+        {
+            counters[bin] = zero;
+        }
+        
+        for (; i < end; i += Lanes)
+        {
+            const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(tags + i));
+            for (size_t bin = 0; bin < bins; bin++)
+            {
+                counters[bin] = _mm_sub_epi8(counters[bin], CompareLanes128(block, needles[bin], T()));
+            }
+        }
+        
+        for (size_t bin = 0; bin < bins; bin++)
+        {
+            const __m128i sums = _mm_sad_epu8(counters[bin], zero);
+            bytes[bin] += static_cast<size_t>(_mm_cvtsi128_si32(sums)) + static_cast<size_t>(_mm_extract_epi16(sums, 4));
+        }
+    }
+    
+    histogramScalar(tags + i, count - i, histogram, bins);
+    for (size_t bin = 0; bin < bins; bin++)
+    {
+        histogram[bin] += bytes[bin] / sizeof(T);
+    }
+}
+
+#endif
+
+#if ASENUM_SIMD_AVX2
+
+// Private details - TagKernels AVX2
+// Same as SSE2 kernels on 256-bit vectors. Compiled for AVX2 with function attributes and called only if CPU supports it.
+
+__attribute__((target("avx2"))) inline __m256i asenum::details::CompareLanes256(const __m256i lhs, const __m256i rhs, uint8_t)
+{
+    return _mm256_cmpeq_epi8(lhs, rhs);
+}
+
+__attribute__((target("avx2"))) inline __m256i asenum::details::CompareLanes256(const __m256i lhs, const __m256i rhs, uint16_t)
+{
+    return _mm256_cmpeq_epi16(lhs, rhs);
+}
+
+__attribute__((target("avx2"))) inline __m256i asenum::details::CompareLanes256(const __m256i lhs, const __m256i rhs, uint32_t)
+{
+    return _mm256_cmpeq_epi32(lhs, rhs);
+}
+
+template <typename T>
+__attribute__((target("avx2"))) size_t asenum::details::TagKernels<T>::countAVX2(const T* tags, const size_t count, const T value)
+{
+    constexpr size_t Lanes = sizeof(__m256i) / sizeof(T);
+    const __m256i needle = _mm256_broadcastsi128_si256(Splat128(value));
+    const __m256i zero = _mm256_setzero_si256();
+    
+    size_t bytes = 0;
+    size_t i = 0;
+    while (count - i >= Lanes)
+    {
+        const size_t blocks = (count - i) / Lanes;
+        const size_t end = i + (blocks < 255 ? blocks : 255) * Lanes;
+        
+        __m256i counters = zero;
+        for (; i < end; i += Lanes)
+        {
+            const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(tags + i));
+            counters = _mm256_sub_epi8(counters, CompareLanes256(block, needle, T()));
+        }
+        
+        const __m256i sums = _mm256_sad_epu8(counters, zero);
+        bytes += static_cast<size_t>(_mm256_extract_epi16(sums, 0)) + static_cast<size_t>(_mm256_extract_epi16(sums, 4))
+        + static_cast<size_t>(_mm256_extract_epi16(sums, 8)) + static_cast<size_t>(_mm256_extract_epi16(sums, 12));
+    }
+    
+    return bytes / sizeof(T) + countScalar(tags + i, count - i, value);
+}
+
+template <typename T>
+__attribute__((target("avx2"))) size_t asenum::details::TagKernels<T>::selectAVX2(const T* tags, const size_t count, const T value, size_t* indices)
+{
+    constexpr size_t Lanes = sizeof(__m256i) / sizeof(T);
+    const __m256i needle = _mm256_broadcastsi128_si256(Splat128(value));
+    
+    size_t result = 0;
+    size_t i = 0;
+    for (; count - i >= Lanes; i += Lanes)
+    {
+        const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(tags + i));
+        uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(CompareLanes256(block, needle, T()))) & LaneMask(sizeof(T));
+        while (mask)
+        {
+            indices[result++] = i + CountTrailingZeros(mask) / sizeof(T);
+            mask &= mask - 1;
+        }
+    }
+    
+    return result + selectScalar(tags + i, count - i, value, indices + result, i);
+}
+
+template <typename T>
+__attribute__((target("avx2"))) void asenum::details::TagKernels<T>::histogramAVX2(const T* tags, const size_t count, size_t* histogram, const size_t bins)
+{
+    constexpr size_t Lanes = sizeof(__m256i) / sizeof(T);
+    const __m256i zero = _mm256_setzero_si256();
+    
+    __m256i needles[SimdHistogramBins];
+    size_t bytes[SimdHistogramBins] = {};
+    for (size_t bin = 0; bin < bins; bin++)
+    {
+        needles[bin] = _mm256_broadcastsi128_si256(Splat128(static_cast<T>(bin)));
+    }
+    
+    size_t i = 0;
+    while (count - i >= Lanes)
+    {
+        const size_t blocks = (count - i) / Lanes;
+        const size_t end = i + (blocks < 255 ? blocks : 255) * Lanes;
+        
+        __m256i counters[SimdHistogramBins];
+        for (size_t bin = 0; bin < bins; bin++)
+        {
+            counters[bin] = zero;
+        }
+        
+        for (; i < end; i += Lanes)
+        {
+            const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(tags + i));
+            for (size_t bin = 0; bin < bins; bin++)
+            {
+                counters[bin] = _mm256_sub_epi8(counters[bin], CompareLanes256(block, needles[bin], T()));
+            }
+        }
+        
+        for (size_t bin = 0; bin < bins; bin++)
+        {
+            const __m256i sums = _mm256_sad_epu8(counters[bin], zero);
+            bytes[bin] += static_cast<size_t>(_mm256_extract_epi16(sums, 0)) + static_cast<size_t>(_mm256_extract_epi16(sums, 4))
+            + static_cast<size_t>(_mm256_extract_epi16(sums, 8)) + static_cast<size_t>(_mm256_extract_epi16(sums, 12));
+        }
+    }
+    
+    histogramScalar(tags + i, count - i, histogram, bins);
+    for (size_t bin = 0; bin < bins; bin++)
+    {
+        histogram[bin] += bytes[bin] / sizeof(T);
+    }
+}
+
+#endif
+
+#if ASENUM_SIMD_NEON
+
+// Private details - TagKernels NEON
+// Same counting scheme as SSE2 kernels. NEON has no 'movemask', so 'select' rescans only blocks that have matches.
+
+inline uint8x16_t asenum::details::CompareLanesNEON(const uint8x16_t lhs, const uint8_t value)
+{
+    return vceqq_u8(lhs, vdupq_n_u8(value));
+}
+
+inline uint8x16_t asenum::details::CompareLanesNEON(const uint8x16_t lhs, const uint16_t value)
+{
+    return vreinterpretq_u8_u16(vceqq_u16(vreinterpretq_u16_u8(lhs), vdupq_n_u16(value)));
+}
+
+inline uint8x16_t asenum::details::CompareLanesNEON(const uint8x16_t lhs, const uint32_t value)
+{
+    return vreinterpretq_u8_u32(vceqq_u32(vreinterpretq_u32_u8(lhs), vdupq_n_u32(value)));
+}
+
+template <typename T>
+size_t asenum::details::TagKernels<T>::countNEON(const T* tags, const size_t count, const T value)
+{
+    constexpr size_t Lanes = sizeof(uint8x16_t) / sizeof(T);
+    
+    size_t bytes = 0;
+    size_t i = 0;
+    while (count - i >= Lanes)
+    {
+        const size_t blocks = (count - i) / Lanes;
+        const size_t end = i + (blocks < 255 ? blocks : 255) * Lanes;
+        
+        uint8x16_t counters = vdupq_n_u8(0);
+        for (; i < end; i += Lanes)
+        {
+            const uint8x16_t block = vld1q_u8(reinterpret_cast<const uint8_t*>(tags + i));
+            counters = vsubq_u8(counters, CompareLanesNEON(block, value));
+        }
+        
+        bytes += vaddlvq_u8(counters);
+    }
+    
+    return bytes / sizeof(T) + countScalar(tags + i, count - i, value);
+}
+
+template <typename T>
+size_t asenum::details::TagKernels<T>::selectNEON(const T* tags, const size_t count, const T value, size_t* indices)
+{
+    constexpr size_t Lanes = sizeof(uint8x16_t) / sizeof(T);
+    
+    size_t result = 0;
+    size_t i = 0;
+    for (; count - i >= Lanes; i += Lanes)
+    {
+        const uint8x16_t block = vld1q_u8(reinterpret_cast<const uint8_t*>(tags + i));
+        if (vmaxvq_u8(CompareLanesNEON(block, value)))
+        {
+            result += selectScalar(tags + i, Lanes, value, indices + result, i);
+        }
+    }
+    
+    return result + selectScalar(tags + i, count - i, value, indices + result, i);
+}
+
+template <typename T>
+void asenum::details::TagKernels<T>::histogramNEON(const T* tags, const size_t count, size_t* histogram, const size_t bins)
+{
+    constexpr size_t Lanes = sizeof(uint8x16_t) / sizeof(T);
+    
+    size_t bytes[SimdHistogramBins] = {};
+    size_t i = 0;
+    while (count - i >= Lanes)
+    {
+        const size_t blocks = (count - i) / Lanes;
+        const size_t end = i + (blocks < 255 ? blocks : 255) * Lanes;
+        
+        uint8x16_t counters[SimdHistogramBins];
+        for (size_t bin = 0; bin < bins; bin++)
+        {
+            counters[bin] = vdupq_n_u8(0);
+        }
+        
+        for (; i < end; i += Lanes)
+        {
+            const uint8x16_t block = vld1q_u8(reinterpret_cast<const uint8_t*>(tags + i));
+            for (size_t bin = 0; bin < bins; bin++)
+            {
+                counters[bin] = vsubq_u8(counters[bin], CompareLanesNEON(block, static_cast<T>(bin)));
+            }
+        }
+        
+        for (size_t bin = 0; bin < bins; bin++)
+        {
+            bytes[bin] += vaddlvq_u8(counters[bin]);
+        }
+    }
+    
+    histogramScalar(tags + i, count - i, histogram, bins);
+    for (size_t bin = 0; bin < bins; bin++)
+    {
+        histogram[bin] += bytes[bin] / sizeof(T);
+    }
+}
+
+#endif
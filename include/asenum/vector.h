@@ -0,0 +1,465 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Alkenso (Vladimir Vashurkin)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <asenum/asenum.h>
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace asenum
+{
+    namespace details
+    {
+        /// Column of 'void' case: values have no payload, so only their number is kept.
+        struct VoidColumn
+        {
+            size_t size() const { return count; }
+            void clear() { count = 0; }
+            
+            size_t count = 0;
+        };
+        
+        /// Column of values of single case and type-specific operations over it.
+        template <typename T>
+        struct ColumnOps
+        {
+            using Column = std::vector<T>;
+            
+            template <typename Handler>
+            static void call(const Column& column, const size_t offset, const Handler& handler) { handler(column[offset]); }
+            
+            template <typename Handler>
+            static void forEach(const Column& column, const Handler& handler) { for (const T& value : column) { handler(value); } }
+            
+            template <typename ConcreteAsEnum, typename ConcreteAsEnum::Enum Case>
+            static ConcreteAsEnum make(const Column& column, const size_t offset) { return ConcreteAsEnum::template create<Case>(column[offset]); }
+        };
+        
+        template <>
+        struct ColumnOps<void>
+        {
+            using Column = VoidColumn;
+            
+            template <typename Handler>
+            static void call(const Column&, size_t, const Handler& handler) { handler(); }
+            
+            template <typename Handler>
+            static void forEach(const Column& column, const Handler& handler) { for (size_t i = 0; i < column.count; i++) { handler(); } }
+            
+            template <typename ConcreteAsEnum, typename ConcreteAsEnum::Enum Case>
+            static ConcreteAsEnum make(const Column&, size_t) { return ConcreteAsEnum::template create<Case>(); }
+        };
+        
+        template <typename Vector, typename Indices>
+        struct AsEnumVectorTable;
+    }
+    
+    /**
+     Columnar (struct-of-arrays) container of AsEnum values.
+     Keeps compact array of case tags and separate contiguous column of values for each case,
+     so walking values of single case touches only memory of that case.
+     Values are only appended: order of elements and order of values inside each column are preserved.
+     Each column holds up to 2^32 values: appending more throws std::length_error.
+     */
+    template <typename... T_Cases>
+    class AsEnumVector
+    {
+        using Index = typename std::conditional<sizeof...(T_Cases) <= UINT8_MAX, uint8_t, uint16_t>::type;
+        
+        // std::vector<bool> packs bits and returns proxies, so references to its elements can't be given out.
+        static_assert(details::AllOf<!std::is_same<typename T_Cases::Type, bool>::value...>::value,
+                      "AsEnumVector doesn't support 'bool' payloads. Wrap value into struct or use integer type.");
+        
+        template <typename Vector, typename Indices>
+        friend struct details::AsEnumVectorTable;
+        
+    public:
+        /// Related enum type.
+        using Enum = typename details::CaseSet<T_Cases...>::Enum;
+        
+        /// Specific 'using' that allows to get accociated type with specific enum case.
+        template <Enum C>
+        using UnderlyingType = typename details::UnderlyingTypeResolver<Enum, C, T_Cases...>::type;
+        
+        /// AsEnum type of elements.
+        using value_type = AsEnum<T_Cases...>;
+        
+        /// Array of all cases associated with concrete AsEnumVector.
+        static constexpr Enum AllCases[] = { T_Cases::Code... };
+        
+        /// Lightweight read-only view of single element. Valid until the vector is modified.
+        class ConstReference
+        {
+        public:
+            Enum enumCase() const;
+            
+            template <Enum Case>
+            bool isCase() const;
+            
+            /// Same as 'AsEnum::ifCase'.
+            template <Enum Case, typename Handler>
+            bool ifCase(const Handler& handler) const;
+            
+            /**
+             @return Const reference to underlying value.
+             @throws std::invalid_argument exception if 'Case' doesn't correspond to stored case.
+             */
+            template <Enum Case, typename R = UnderlyingType<Case>, typename = typename std::enable_if<!std::is_same<R, void>::value>::type>
+            const R& forceAsCase() const;
+            
+            /// Same as 'AsEnum::getUnchecked': stored case is checked by 'assert' in debug builds only.
+            template <Enum Case, typename R = UnderlyingType<Case>, typename = typename std::enable_if<!std::is_same<R, void>::value>::type>
+            const R& getUnchecked() const noexcept;
+            
+        private:
+            friend class AsEnumVector;
+            
+            ConstReference(const AsEnumVector& vector, size_t index);
+            
+        private:
+            const AsEnumVector& m_vector;
+            size_t m_index;
+        };
+        
+        size_t size() const;
+        bool empty() const;
+        
+        void clear();
+        
+        /// Reserves space for 'count' tags. Columns grow independently.
+        void reserve(size_t count);
+        
+        /// Appends value of specific case.
+        template <Enum Case, typename U = typename std::enable_if<!std::is_same<UnderlyingType<Case>, void>::value>::type>
+        void push_back(UnderlyingType<Case> value);
+        
+        /// Appends value of specific case with 'void' associated type.
+        template <Enum Case, typename T = typename std::enable_if<std::is_same<UnderlyingType<Case>, void>::value>::type>
+        void push_back();
+        
+        /// Appends copy of value held by AsEnum with the same cases.
+        template <typename T_Storage>
+        void push_back(const BasicAsEnum<T_Storage, T_Cases...>& value);
+        
+        /// @return enum case of element at 'index'.
+        Enum enumCase(size_t index) const;
+        
+        /// @return view of element at 'index'.
+        ConstReference operator[](size_t index) const;
+        
+        /// @return AsEnum holding copy of element at 'index'.
+        value_type toAsEnum(size_t index) const;
+        
+        /// @return number of values of specified case.
+        template <Enum Case>
+        size_t count() const;
+        
+        /**
+         Walks values of specified case only, in order of insertion.
+         
+         @param handler Function or functional object of signature void(UnderlyingType<Case>).
+         */
+        template <Enum Case, typename Handler>
+        void forEach(const Handler& handler) const;
+        
+        /// @return contiguous column of values of specified case.
+        template <Enum Case, typename R = UnderlyingType<Case>, typename = typename std::enable_if<!std::is_same<R, void>::value>::type>
+        const std::vector<R>& column() const;
+        
+    private:
+        template <Enum Case>
+        using CaseIndex = details::CaseIndexResolver<Enum, Case, T_Cases...>;
+        
+        template <size_t I>
+        using Column = typename details::ColumnOps<typename details::CaseAt<I, T_Cases...>::type::Type>::Column;
+        
+        using Table = details::AsEnumVectorTable<AsEnumVector, typename details::MakeIndexSequence<sizeof...(T_Cases)>::type>;
+        
+        /// Checks offset of next value of case 'I' and grows tag storage, so 'appendTag' can't fail after value is added to the column.
+        template <size_t I>
+        uint32_t reserveTag();
+        
+        template <size_t I>
+        void appendTag(uint32_t offset) noexcept;
+        
+    private:
+        std::vector<Index> m_tags;
+        std::vector<uint32_t> m_offsets;
+        std::tuple<typename details::ColumnOps<typename T_Cases::Type>::Column...> m_columns;
+    };
+    
+    namespace details
+    {
+        /// Per-case operations of AsEnumVector resolved by stored tag.
+        template <typename Vector, size_t... I>
+        struct AsEnumVectorTable<Vector, IndexSequence<I...>>
+        {
+            using value_type = typename Vector::value_type;
+            
+            static value_type make(const Vector& vector, size_t index);
+            
+            template <size_t Index>
+            static value_type makeCase(const Vector& vector, size_t offset);
+            
+            template <size_t Index>
+            void visit(const void*) const;
+            
+            template <size_t Index, typename T>
+            void visit(const T* value) const;
+            
+            Vector& vector;
+        };
+    }
+}
+
+
+// AsEnumVector public
+
+template <typename... T_Cases>
+constexpr typename asenum::AsEnumVector<T_Cases...>::Enum asenum::AsEnumVector<T_Cases...>::AllCases[];
+
+template <typename... T_Cases>
+size_t asenum::AsEnumVector<T_Cases...>::size() const
+{
+    return m_tags.size();
+}
+
+template <typename... T_Cases>
+bool asenum::AsEnumVector<T_Cases...>::empty() const
+{
+    return m_tags.empty();
+}
+
+template <typename... T_Cases>
+void asenum::AsEnumVector<T_Cases...>::clear()
+{
+    m_tags.clear();
+    m_offsets.clear();
+    m_columns = decltype(m_columns)();
+}
+
+template <typename... T_Cases>
+void asenum::AsEnumVector<T_Cases...>::reserve(const size_t count)
+{
+    m_tags.reserve(count);
+    m_offsets.reserve(count);
+}
+
+template <typename... T_Cases>
+template <typename asenum::AsEnumVector<T_Cases...>::Enum Case, typename U>
+void asenum::AsEnumVector<T_Cases...>::push_back(UnderlyingType<Case> value)
+{
+    static constexpr size_t I = CaseIndex<Case>::value;
+    
+    const uint32_t offset = reserveTag<I>();
+    std::get<I>(m_columns).push_back(std::move(value));
+    appendTag<I>(offset);
+}
+
+template <typename... T_Cases>
+template <typename asenum::AsEnumVector<T_Cases...>::Enum Case, typename T>
+void asenum::AsEnumVector<T_Cases...>::push_back()
+{
+    static constexpr size_t I = CaseIndex<Case>::value;
+    
+    const uint32_t offset = reserveTag<I>();
+    std::get<I>(m_columns).count++;
+    appendTag<I>(offset);
+}
+
+template <typename... T_Cases>
+template <typename T_Storage>
+void asenum::AsEnumVector<T_Cases...>::push_back(const BasicAsEnum<T_Storage, T_Cases...>& value)
+{
+    const Table pusher = { *this };
+    details::AsEnumAccess::visit<void>(value, pusher);
+}
+
+template <typename... T_Cases>
+typename asenum::AsEnumVector<T_Cases...>::Enum asenum::AsEnumVector<T_Cases...>::enumCase(const size_t index) const
+{
+    return AllCases[m_tags[index]];
+}
+
+template <typename... T_Cases>
+typename asenum::AsEnumVector<T_Cases...>::ConstReference asenum::AsEnumVector<T_Cases...>::operator[](const size_t index) const
+{
+    return ConstReference(*this, index);
+}
+
+template <typename... T_Cases>
+typename asenum::AsEnumVector<T_Cases...>::value_type asenum::AsEnumVector<T_Cases...>::toAsEnum(const size_t index) const
+{
+    return Table::make(*this, index);
+}
+
+template <typename... T_Cases>
+template <typename asenum::AsEnumVector<T_Cases...>::Enum Case>
+size_t asenum::AsEnumVector<T_Cases...>::count() const
+{
+    return std::get<CaseIndex<Case>::value>(m_columns).size();
+}
+
+template <typename... T_Cases>
+template <typename asenum::AsEnumVector<T_Cases...>::Enum Case, typename Handler>
+void asenum::AsEnumVector<T_Cases...>::forEach(const Handler& handler) const
+{
+    details::ColumnOps<UnderlyingType<Case>>::forEach(std::get<CaseIndex<Case>::value>(m_columns), handler);
+}
+
+template <typename... T_Cases>
+template <typename asenum::AsEnumVector<T_Cases...>::Enum Case, typename R, typename>
+const std::vector<R>& asenum::AsEnumVector<T_Cases...>::column() const
+{
+    return std::get<CaseIndex<Case>::value>(m_columns);
+}
+
+template <typename... T_Cases>
+template <size_t I>
+uint32_t asenum::AsEnumVector<T_Cases...>::reserveTag()
+{
+    const size_t offset = std::get<I>(m_columns).size();
+    if (offset > UINT32_MAX)
+    {
+        details::RaiseError<std::length_error>("Too many values of single case in AsEnumVector.");
+    }
+    
+    const size_t size = m_tags.size();
+    if (size == m_tags.capacity() || size == m_offsets.capacity())
+    {
+        const size_t capacity = size < 8 ? 8 : size * 2;
+        m_tags.reserve(capacity);
+        m_offsets.reserve(capacity);
+    }
+    
+    return static_cast<uint32_t>(offset);
+}
+
+template <typename... T_Cases>
+template <size_t I>
+void asenum::AsEnumVector<T_Cases...>::appendTag(const uint32_t offset) noexcept
+{
+    m_tags.push_back(static_cast<Index>(I));
+    m_offsets.push_back(offset);
+}
+
+// AsEnumVector::ConstReference public
+
+template <typename... T_Cases>
+asenum::AsEnumVector<T_Cases...>::ConstReference::ConstReference(const AsEnumVector& vector, const size_t index)
+: m_vector(vector)
+, m_index(index)
+{}
+
+template <typename... T_Cases>
+typename asenum::AsEnumVector<T_Cases...>::Enum asenum::AsEnumVector<T_Cases...>::ConstReference::enumCase() const
+{
+    return m_vector.enumCase(m_index);
+}
+
+template <typename... T_Cases>
+template <typename asenum::AsEnumVector<T_Cases...>::Enum Case>
+bool asenum::AsEnumVector<T_Cases...>::ConstReference::isCase() const
+{
+    return m_vector.m_tags[m_index] == CaseIndex<Case>::value;
+}
+
+template <typename... T_Cases>
+template <typename asenum::AsEnumVector<T_Cases...>::Enum Case, typename Handler>
+bool asenum::AsEnumVector<T_Cases...>::ConstReference::ifCase(const Handler& handler) const
+{
+    const bool isType = isCase<Case>();
+    if (isType)
+    {
+        details::ColumnOps<UnderlyingType<Case>>::call(std::get<CaseIndex<Case>::value>(m_vector.m_columns), m_vector.m_offsets[m_index], handler);
+    }
+    
+    return isType;
+}
+
+template <typename... T_Cases>
+template <typename asenum::AsEnumVector<T_Cases...>::Enum Case, typename R, typename>
+const R& asenum::AsEnumVector<T_Cases...>::ConstReference::forceAsCase() const
+{
+    if (!isCase<Case>())
+    {
+        details::RaiseError<std::invalid_argument>("Unwrapping case does not correspond to stored case.");
+    }
+    
+    return std::get<CaseIndex<Case>::value>(m_vector.m_columns)[m_vector.m_offsets[m_index]];
+}
+
+template <typename... T_Cases>
+template <typename asenum::AsEnumVector<T_Cases...>::Enum Case, typename R, typename>
+const R& asenum::AsEnumVector<T_Cases...>::ConstReference::getUnchecked() const noexcept
+{
+    assert(isCase<Case>());
+    
+    return std::get<CaseIndex<Case>::value>(m_vector.m_columns)[m_vector.m_offsets[m_index]];
+}
+
+// Private details - AsEnumVectorTable
+
+template <typename Vector, size_t... I>
+typename asenum::details::AsEnumVectorTable<Vector, asenum::details::IndexSequence<I...>>::value_type
+asenum::details::AsEnumVectorTable<Vector, asenum::details::IndexSequence<I...>>::make(const Vector& vector, const size_t index)
+{
+    using CaseFunction = value_type (*)(const Vector&, size_t);
+    static constexpr CaseFunction s_table[] = { &makeCase<I>... };
+    
+    return s_table[vector.m_tags[index]](vector, vector.m_offsets[index]);
+}
+
+template <typename Vector, size_t... I>
+template <size_t Index>
+typename asenum::details::AsEnumVectorTable<Vector, asenum::details::IndexSequence<I...>>::value_type
+asenum::details::AsEnumVectorTable<Vector, asenum::details::IndexSequence<I...>>::makeCase(const Vector& vector, const size_t offset)
+{
+    static constexpr typename Vector::Enum Case = Vector::AllCases[Index];
+    using Ops = ColumnOps<typename Vector::template UnderlyingType<Case>>;
+    
+    return Ops::template make<value_type, Case>(std::get<Index>(vector.m_columns), offset);
+}
+
+template <typename Vector, size_t... I>
+template <size_t Index>
+void asenum::details::AsEnumVectorTable<Vector, asenum::details::IndexSequence<I...>>::visit(const void*) const
+{
+    vector.template push_back<Vector::AllCases[Index]>();
+}
+
+template <typename Vector, size_t... I>
+template <size_t Index, typename T>
+void asenum::details::AsEnumVectorTable<Vector, asenum::details::IndexSequence<I...>>::visit(const T* value) const
+{
+    vector.template push_back<Vector::AllCases[Index]>(*value);
+}
@@ -0,0 +1,405 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Alkenso (Vladimir Vashurkin)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <asenum/flat_hash.h>
+#include <asenum/archive.h>
+
+#include <gmock/gmock.h>
+
+#include "TestUtils.h"
+
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+namespace
+{
+    enum class EventType
+    {
+        Move,
+        Say,
+        Quit
+    };
+    
+    struct Move
+    {
+        int32_t dx;
+        double dy;
+        
+        bool operator==(const Move& other) const { return dx == other.dx && dy == other.dy; }
+    };
+    
+    using Event = asenum::AsEnum<
+    asenum::Case11<EventType, EventType::Move, Move>,
+    asenum::Case11<EventType, EventType::Say, std::string>,
+    asenum::Case11<EventType, EventType::Quit, void>
+    >;
+    
+    /// Older version of Event: doesn't know 'Say' case.
+    using OldEvent = asenum::AsEnum<
+    asenum::Case11<EventType, EventType::Move, Move>,
+    asenum::Case11<EventType, EventType::Quit, void>
+    >;
+    
+    /// Payload which serializer fails on request.
+    struct Note
+    {
+        std::string text;
+        
+        bool operator==(const Note& other) const { return text == other.text; }
+    };
+    
+    enum class NoteType
+    {
+        Note,
+        Count
+    };
+    
+    using NoteEvent = asenum::AsEnum<
+    asenum::Case11<NoteType, NoteType::Note, Note>,
+    asenum::Case11<NoteType, NoteType::Count, int>
+    >;
+    
+    /// Temporary file removed at the end of the test.
+    class TempFile
+    {
+    public:
+        TempFile()
+        {
+            char path[] = "/tmp/asenum_archive_XXXXXX";
+            const int fd = mkstemp(path);
+            EXPECT_GE(fd, 0);
+            close(fd);
+            m_path = path;
+        }
+        
+        ~TempFile()
+        {
+            std::remove(m_path.c_str());
+        }
+        
+        const std::string& path() const { return m_path; }
+        
+    private:
+        std::string m_path;
+    };
+    
+    std::vector<Event> MakeEvents(const size_t count)
+    {
+        std::vector<Event> events;
+        for (size_t i = 0; i < count; i++)
+        {
+            switch (i % 3)
+            {
+                case 0: events.push_back(Event::create<EventType::Move>(Move { static_cast<int32_t>(i), i * 0.5 })); break;
+                case 1: events.push_back(Event::create<EventType::Say>(std::string(i % 5, 'a'))); break;
+                default: events.push_back(Event::create<EventType::Quit>()); break;
+            }
+        }
+        
+        return events;
+    }
+    
+    void WriteEvents(const std::string& path, const std::vector<Event>& events)
+    {
+        asenum::ArchiveWriter<Event> writer(path);
+        for (const Event& event : events)
+        {
+            writer.append(event);
+        }
+        writer.finish();
+    }
+    
+    asenum::details::ArchiveHeader ReadHeader(const std::string& path)
+    {
+        asenum::details::ArchiveHeader header = {};
+        std::FILE* file = std::fopen(path.c_str(), "rb");
+        EXPECT_EQ(std::fread(&header, sizeof(header), 1, file), 1);
+        std::fclose(file);
+        
+        return header;
+    }
+    
+    template <typename T>
+    void Patch(const std::string& path, const uint64_t offset, const T& value)
+    {
+        std::FILE* file = std::fopen(path.c_str(), "r+b");
+        std::fseek(file, static_cast<long>(offset), SEEK_SET);
+        std::fwrite(&value, sizeof(value), 1, file);
+        std::fclose(file);
+    }
+}
+
+TEST(Archive, WriteRead)
+{
+    const TempFile file;
+    const auto events = MakeEvents(1000);
+    
+    asenum::ArchiveWriter<Event> writer(file.path());
+    for (const Event& event : events)
+    {
+        writer.append(event);
+    }
+    writer.finish();
+    
+    const asenum::ArchiveReader<Event> reader(file.path());
+    ASSERT_EQ(reader.size(), events.size());
+    
+    for (size_t i = 0; i < events.size(); i++)
+    {
+        const auto record = reader[i];
+        EXPECT_EQ(record.enumCase(), events[i].enumCase());
+        EXPECT_EQ(record.decode(), events[i]);
+    }
+    
+    // Trivially copyable payloads are referenced in place and are properly aligned.
+    EXPECT_TRUE(reader[3].ifCase<EventType::Move>([] (const Move& value) {
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(&value) % alignof(Move), 0);
+        EXPECT_EQ(value, (Move { 3, 1.5 }));
+    }));
+    EXPECT_FALSE(reader[3].isCase<EventType::Say>());
+    
+    const std::string text = reader[4].doMap<std::string>()
+    .ifCase<EventType::Say>([] (const std::string& value) {
+        return value;
+    })
+    .ifDefault([] {
+        return std::string("default");
+    });
+    EXPECT_EQ(text, "aaaa");
+    
+    bool quit = false;
+    reader[5].doSwitch()
+    .ifCase<EventType::Quit>([&quit] {
+        quit = true;
+    })
+    .ifDefault([] {});
+    EXPECT_TRUE(quit);
+    
+    EXPECT_EQ(reader.count<EventType::Move>(), 334);
+    EXPECT_EQ(reader.count<EventType::Say>(), 333);
+    EXPECT_EQ(reader.count<EventType::Quit>(), 333);
+    
+    std::vector<int32_t> moves;
+    reader.forEach<EventType::Move>([&moves] (const Move& value) {
+        moves.push_back(value.dx);
+    });
+    ASSERT_EQ(moves.size(), 334);
+    for (size_t i = 0; i < moves.size(); i++)
+    {
+        EXPECT_EQ(moves[i], static_cast<int32_t>(i * 3));
+    }
+}
+
+TEST(Archive, Empty)
+{
+    const TempFile file;
+    asenum::ArchiveWriter<Event> writer(file.path());
+    writer.finish();
+    
+    const asenum::ArchiveReader<Event> reader(file.path());
+    EXPECT_EQ(reader.size(), 0);
+    EXPECT_EQ(reader.count<EventType::Say>(), 0);
+}
+
+TEST(Archive, Validation)
+{
+    const TempFile file;
+    asenum::ArchiveWriter<Event> writer(file.path());
+    writer.append(Event::create<EventType::Say>("hello"));
+    writer.finish();
+    
+    // Reader doesn't know archived case.
+    EXPECT_ASENUM_ERROR(asenum::ArchiveReader<OldEvent> reader(file.path()), std::invalid_argument);
+    
+    // Reader knows more cases than archive contains.
+    const TempFile oldFile;
+    asenum::ArchiveWriter<OldEvent> oldWriter(oldFile.path());
+    oldWriter.append(OldEvent::create<EventType::Quit>());
+    oldWriter.finish();
+    const asenum::ArchiveReader<Event> reader(oldFile.path());
+    ASSERT_EQ(reader.size(), 1);
+    EXPECT_EQ(reader[0].enumCase(), EventType::Quit);
+    EXPECT_EQ(reader.count<EventType::Say>(), 0);
+    
+    // Not an archive.
+    const TempFile garbage;
+    std::FILE* garbageFile = std::fopen(garbage.path().c_str(), "wb");
+    const std::vector<char> bytes(100, 'x');
+    std::fwrite(bytes.data(), bytes.size(), 1, garbageFile);
+    std::fclose(garbageFile);
+    EXPECT_ASENUM_ERROR(asenum::ArchiveReader<Event> reader(garbage.path()), std::runtime_error);
+    
+    // Corrupted record count that would overflow section sizes.
+    const TempFile corrupted;
+    asenum::ArchiveWriter<Event> corruptedWriter(corrupted.path());
+    corruptedWriter.append(Event::create<EventType::Quit>());
+    corruptedWriter.finish();
+    std::FILE* corruptedFile = std::fopen(corrupted.path().c_str(), "r+b");
+    const uint64_t recordCount = uint64_t(1) << 61;
+    std::fseek(corruptedFile, offsetof(asenum::details::ArchiveHeader, recordCount), SEEK_SET);
+    std::fwrite(&recordCount, sizeof(recordCount), 1, corruptedFile);
+    std::fclose(corruptedFile);
+    EXPECT_ASENUM_ERROR(asenum::ArchiveReader<Event> reader(corrupted.path()), std::runtime_error);
+    
+    EXPECT_ASENUM_ERROR(asenum::ArchiveReader<Event> reader("/nonexistent/archive"), std::runtime_error);
+}
+
+TEST(Archive, RecordValidation)
+{
+    // Records: Move, Say, Quit.
+    const std::vector<Event> events = MakeEvents(3);
+    
+    const TempFile valid;
+    WriteEvents(valid.path(), events);
+    const asenum::details::ArchiveHeader header = ReadHeader(valid.path());
+    ASSERT_EQ(header.recordCount, 3);
+    {
+        const asenum::ArchiveReader<Event> reader(valid.path());
+        EXPECT_EQ(reader[0].decode(), events[0]);
+    }
+    
+    // Records are validated on access, so corrupted archive opens and its valid records are readable.
+    
+    // Case tag out of archived cases.
+    const TempFile badTag;
+    WriteEvents(badTag.path(), events);
+    Patch(badTag.path(), header.tagsOffset, uint8_t(7));
+    {
+        const asenum::ArchiveReader<Event> reader(badTag.path());
+        EXPECT_ASENUM_ERROR(reader[0].enumCase(), std::runtime_error);
+        EXPECT_ASENUM_ERROR(reader[0].decode(), std::runtime_error);
+        EXPECT_EQ(reader[1].decode(), events[1]);
+        EXPECT_ASENUM_ERROR(reader.forEach<EventType::Move>([] (const Move&) {}), std::runtime_error);
+    }
+    
+    // In-place payload past the end of payload section.
+    const TempFile badExtent;
+    WriteEvents(badExtent.path(), events);
+    Patch(badExtent.path(), header.offsetsOffset, header.dataEnd - sizeof(Move) / 2);
+    {
+        const asenum::ArchiveReader<Event> reader(badExtent.path());
+        EXPECT_EQ(reader[0].enumCase(), EventType::Move);
+        EXPECT_ASENUM_ERROR(reader[0].decode(), std::runtime_error);
+        EXPECT_ASENUM_ERROR(reader[0].ifCase<EventType::Move>([] (const Move&) {}), std::runtime_error);
+        EXPECT_ASENUM_ERROR(reader.forEach<EventType::Move>([] (const Move&) {}), std::runtime_error);
+    }
+    
+    // Misaligned in-place payload.
+    const TempFile misaligned;
+    WriteEvents(misaligned.path(), events);
+    Patch(misaligned.path(), header.offsetsOffset, uint64_t(sizeof(asenum::details::ArchiveHeader) + 1));
+    {
+        const asenum::ArchiveReader<Event> reader(misaligned.path());
+        EXPECT_ASENUM_ERROR(reader[0].decode(), std::runtime_error);
+    }
+    
+    // Encoded payload outside of payload section.
+    const TempFile badEncoded;
+    WriteEvents(badEncoded.path(), events);
+    Patch(badEncoded.path(), header.offsetsOffset + sizeof(uint64_t), header.dataEnd + 1);
+    {
+        const asenum::ArchiveReader<Event> reader(badEncoded.path());
+        EXPECT_ASENUM_ERROR(reader[1].decode(), std::runtime_error);
+        EXPECT_ASENUM_ERROR(reader.forEach<EventType::Say>([] (const std::string&) {}), std::runtime_error);
+    }
+    
+    // Per-case index refers to record of other case.
+    const TempFile badIndex;
+    WriteEvents(badIndex.path(), events);
+    Patch(badIndex.path(), header.caseIndexOffset + (header.caseCount + 1) * sizeof(uint64_t), uint64_t(1));
+    {
+        const asenum::ArchiveReader<Event> reader(badIndex.path());
+        EXPECT_EQ(reader[0].decode(), events[0]);
+        EXPECT_ASENUM_ERROR(reader.forEach<EventType::Move>([] (const Move&) {}), std::runtime_error);
+    }
+    
+    // Per-case index out of records.
+    const TempFile badStarts;
+    WriteEvents(badStarts.path(), events);
+    Patch(badStarts.path(), header.caseIndexOffset + sizeof(uint64_t), uint64_t(4));
+    EXPECT_ASENUM_ERROR(asenum::ArchiveReader<Event> reader(badStarts.path()), std::runtime_error);
+}
+
+TEST(Archive, AppendAfterFinish)
+{
+    const TempFile file;
+    asenum::ArchiveWriter<Event> writer(file.path());
+    writer.append(Event::create<EventType::Quit>());
+    writer.finish();
+    
+    EXPECT_ASENUM_ERROR(writer.append(Event::create<EventType::Quit>()), std::logic_error);
+    EXPECT_ASENUM_ERROR(writer.finish(), std::logic_error);
+}
+
+#if defined(ASENUM_HAS_EXCEPTIONS)
+namespace asenum
+{
+    template <>
+    struct Serializer<Note>
+    {
+        static void write(BinaryWriter& writer, const Note& value)
+        {
+            if (value.text == "fail")
+            {
+                throw std::runtime_error("serializer failure");
+            }
+            writer.writeValue(value.text);
+        }
+        
+        static Note read(BinaryReader& reader) { return Note { reader.readValue<std::string>() }; }
+    };
+}
+
+TEST(Archive, AppendAfterFailedSerializer)
+{
+    const TempFile file;
+    const std::vector<NoteEvent> events = {
+        NoteEvent::create<NoteType::Note>(Note { "first" }),
+        NoteEvent::create<NoteType::Count>(1),
+        NoteEvent::create<NoteType::Note>(Note { "second" }),
+        NoteEvent::create<NoteType::Count>(2),
+    };
+    
+    asenum::ArchiveWriter<NoteEvent> writer(file.path());
+    writer.append(events[0]);
+    writer.append(events[1]);
+    EXPECT_THROW(writer.append(NoteEvent::create<NoteType::Note>(Note { "fail" })), std::runtime_error);
+    writer.append(events[2]);
+    writer.append(events[3]);
+    writer.finish();
+    
+    const asenum::ArchiveReader<NoteEvent> reader(file.path());
+    ASSERT_EQ(reader.size(), events.size());
+    for (size_t i = 0; i < events.size(); i++)
+    {
+        EXPECT_EQ(reader[i].decode(), events[i]);
+    }
+    EXPECT_EQ(reader.count<NoteType::Note>(), 2);
+}
+#endif
@@ -26,7 +26,18 @@
 
 #include <gmock/gmock.h>
 
+#include "TestUtils.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <limits>
 #include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 using namespace ::testing;
 
@@ -49,7 +60,7 @@ namespace
     static_assert(std::is_same<TestAsEnum::UnderlyingType<TestEnum::StringOpt1>, std::string>::value, "Invalid underlying type");
     static_assert(std::is_same<TestAsEnum::UnderlyingType<TestEnum::VoidOpt2>, void>::value, "Invalid underlying type");
     
-    static_assert(GTEST_ARRAY_SIZE_(TestAsEnum::AllCases) == 3, "Invalid number of cases");
+    static_assert(std::extent<decltype(TestAsEnum::AllCases)>::value == 3, "Invalid number of cases");
     static_assert(TestAsEnum::AllCases[0] == TestEnum::Unknown3, "Invalid enum case");
     static_assert(TestAsEnum::AllCases[1] == TestEnum::StringOpt1, "Invalid enum case");
     static_assert(TestAsEnum::AllCases[2] == TestEnum::VoidOpt2, "Invalid enum case");
@@ -213,6 +224,68 @@ TEST(AsEnum, Map_All_Cases)
     EXPECT_TRUE(vv);
 }
 
+namespace
+{
+    struct MoveOnlyResult
+    {
+        explicit MoveOnlyResult(std::string value) : value(new std::string(std::move(value))) {}
+        
+        std::unique_ptr<std::string> value;
+    };
+}
+
+TEST(AsEnum, Map_MoveOnly_Result)
+{
+    static_assert(!std::is_default_constructible<MoveOnlyResult>::value, "");
+    static_assert(!std::is_copy_constructible<MoveOnlyResult>::value, "");
+    
+    const TestAsEnum value = TestAsEnum::create<TestEnum::StringOpt1>("test");
+    
+    const MoveOnlyResult all = value.doMap<MoveOnlyResult>()
+    .ifCase<TestEnum::Unknown3>([] (const int&) {
+        return MoveOnlyResult("int");
+    })
+    .ifCase<TestEnum::StringOpt1>([] (const std::string& value) {
+        return MoveOnlyResult(value);
+    })
+    .ifCase<TestEnum::VoidOpt2>([] {
+        return MoveOnlyResult("void");
+    });
+    
+    ASSERT_TRUE(all.value);
+    EXPECT_EQ(*all.value, "test");
+    
+    const MoveOnlyResult partial = value.doMap<MoveOnlyResult>()
+    .ifCase<TestEnum::VoidOpt2>([] {
+        return MoveOnlyResult("void");
+    })
+    .ifDefault([] {
+        return MoveOnlyResult("default");
+    });
+    
+    ASSERT_TRUE(partial.value);
+    EXPECT_EQ(*partial.value, "default");
+}
+
+TEST(AsEnum, Map_Stored_Step)
+{
+    const TestAsEnum value = TestAsEnum::create<TestEnum::StringOpt1>("test");
+    
+    auto matched = value.doMap<MoveOnlyResult>().ifCase<TestEnum::StringOpt1>([] (const std::string& value) {
+        return MoveOnlyResult(value);
+    });
+    auto skipped = matched.ifCase<TestEnum::VoidOpt2>([] {
+        return MoveOnlyResult("void");
+    });
+    
+    const MoveOnlyResult result = skipped.ifCase<TestEnum::Unknown3>([] (const int&) {
+        return MoveOnlyResult("int");
+    });
+    
+    ASSERT_TRUE(result.value);
+    EXPECT_EQ(*result.value, "test");
+}
+
 TEST(AsEnum, ForceAsCase)
 {
     const TestAsEnum value1 = TestAsEnum::create<TestEnum::StringOpt1>("test");
@@ -220,12 +293,27 @@ TEST(AsEnum, ForceAsCase)
     const TestAsEnum value3 = TestAsEnum::create<TestEnum::Unknown3>(-100500);
     
     EXPECT_EQ(value1.forceAsCase<TestEnum::StringOpt1>(), "test");
-    EXPECT_THROW(value1.forceAsCase<TestEnum::Unknown3>(), std::invalid_argument);
+    EXPECT_ASENUM_ERROR(value1.forceAsCase<TestEnum::Unknown3>(), std::invalid_argument);
     
-    EXPECT_THROW(value3.forceAsCase<TestEnum::StringOpt1>(), std::invalid_argument);
+    EXPECT_ASENUM_ERROR(value3.forceAsCase<TestEnum::StringOpt1>(), std::invalid_argument);
     EXPECT_EQ(value3.forceAsCase<TestEnum::Unknown3>(), -100500);
 }
 
+TEST(AsEnum, GetUnchecked)
+{
+    const TestAsEnum value1 = TestAsEnum::create<TestEnum::StringOpt1>("test");
+    const TestAsEnum value3 = TestAsEnum::create<TestEnum::Unknown3>(-100500);
+    
+    static_assert(noexcept(value1.getUnchecked<TestEnum::StringOpt1>()), "Unchecked access should not throw");
+    EXPECT_EQ(value1.getUnchecked<TestEnum::StringOpt1>(), "test");
+    EXPECT_EQ(&value1.getUnchecked<TestEnum::StringOpt1>(), &value1.forceAsCase<TestEnum::StringOpt1>());
+    EXPECT_EQ(value3.getUnchecked<TestEnum::Unknown3>(), -100500);
+    
+#if !defined(NDEBUG)
+    EXPECT_DEATH(value1.getUnchecked<TestEnum::Unknown3>(), "");
+#endif
+}
+
 TEST(AsEnum, Equality)
 {
     const TestAsEnum value1 = TestAsEnum::create<TestEnum::StringOpt1>("test");
@@ -304,3 +392,958 @@ TEST(AsEnum, Compare_RandomCase)
     EXPECT_GE(value2, value1);
     EXPECT_GE(value1, value1);
 }
+
+namespace
+{
+    struct LifetimeCounter
+    {
+        static int s_alive;
+        
+        explicit LifetimeCounter(int v) : value(v) { s_alive++; }
+        LifetimeCounter(const LifetimeCounter& other) : value(other.value) { s_alive++; }
+        LifetimeCounter(LifetimeCounter&& other) noexcept : value(other.value) { s_alive++; }
+        ~LifetimeCounter() { s_alive--; }
+        
+        LifetimeCounter& operator=(const LifetimeCounter& other) = default;
+        
+        bool operator==(const LifetimeCounter& other) const { return value == other.value; }
+        bool operator<(const LifetimeCounter& other) const { return value < other.value; }
+        
+        int value;
+    };
+    
+    int LifetimeCounter::s_alive = 0;
+    
+    struct BigPayload
+    {
+        LifetimeCounter counter;
+        char padding[64];
+    };
+    
+    enum class StorageEnum
+    {
+        Small,
+        Big,
+        Empty
+    };
+    
+    using StorageAsEnum = asenum::AsEnum<
+    asenum::Case11<StorageEnum, StorageEnum::Small, LifetimeCounter>,
+    asenum::Case11<StorageEnum, StorageEnum::Big, BigPayload>,
+    asenum::Case11<StorageEnum, StorageEnum::Empty, void>
+    >;
+    
+    static_assert(StorageAsEnum::storesInline<StorageEnum::Small>(), "Small payload should be stored inline");
+    static_assert(!StorageAsEnum::storesInline<StorageEnum::Big>(), "Big payload should be stored on the heap");
+    static_assert(StorageAsEnum::storesInline<StorageEnum::Empty>(), "Void payload does not require storage");
+    
+    static_assert(TestAsEnum::storesInline<TestEnum::Unknown3>(), "'int' should be stored inline");
+    
+    using WideTestAsEnum = asenum::BasicAsEnum<
+    asenum::InlineStorage<sizeof(std::string), alignof(std::string)>,
+    asenum::Case11<TestEnum, TestEnum::Unknown3, int>,
+    asenum::Case11<TestEnum, TestEnum::StringOpt1, std::string>,
+    asenum::Case11<TestEnum, TestEnum::VoidOpt2, void>
+    >;
+    
+    static_assert(WideTestAsEnum::storesInline<TestEnum::StringOpt1>(), "Custom storage should fit 'std::string'");
+}
+
+TEST(AsEnum, Storage_CopyMove)
+{
+    {
+        const StorageAsEnum small = StorageAsEnum::create<StorageEnum::Small>(LifetimeCounter(1));
+        const StorageAsEnum big = StorageAsEnum::create<StorageEnum::Big>(BigPayload { LifetimeCounter(2), {} });
+        const StorageAsEnum empty = StorageAsEnum::create<StorageEnum::Empty>();
+        EXPECT_EQ(LifetimeCounter::s_alive, 2);
+        
+        StorageAsEnum smallCopy = small;
+        StorageAsEnum bigCopy = big;
+        EXPECT_EQ(LifetimeCounter::s_alive, 3); // inline payload is copied, heap payload is shared
+        EXPECT_EQ(smallCopy.forceAsCase<StorageEnum::Small>().value, 1);
+        EXPECT_EQ(&bigCopy.forceAsCase<StorageEnum::Big>(), &big.forceAsCase<StorageEnum::Big>());
+        
+        StorageAsEnum moved = std::move(smallCopy);
+        EXPECT_EQ(moved.forceAsCase<StorageEnum::Small>().value, 1);
+        
+        moved = big;
+        EXPECT_TRUE(moved.isCase<StorageEnum::Big>());
+        EXPECT_EQ(moved.forceAsCase<StorageEnum::Big>().counter.value, 2);
+        
+        bigCopy = small;
+        EXPECT_EQ(bigCopy.forceAsCase<StorageEnum::Small>().value, 1);
+        
+        bigCopy = empty;
+        EXPECT_TRUE(bigCopy.isCase<StorageEnum::Empty>());
+        
+        bigCopy = std::move(moved);
+        EXPECT_EQ(bigCopy.forceAsCase<StorageEnum::Big>().counter.value, 2);
+    }
+    
+    EXPECT_EQ(LifetimeCounter::s_alive, 0);
+}
+
+TEST(AsEnum, Storage_Custom)
+{
+    const WideTestAsEnum value1 = WideTestAsEnum::create<TestEnum::StringOpt1>("test");
+    const WideTestAsEnum value2 = value1;
+    
+    EXPECT_NE(&value1.forceAsCase<TestEnum::StringOpt1>(), &value2.forceAsCase<TestEnum::StringOpt1>());
+    EXPECT_EQ(value1, value2);
+    EXPECT_LT(value1, WideTestAsEnum::create<TestEnum::StringOpt1>("test2"));
+}
+
+TEST(AsEnum, Match_All_Cases)
+{
+    const TestAsEnum value = TestAsEnum::create<TestEnum::StringOpt1>("test");
+    
+    MockFunction<void(std::string)> handler;
+    
+    EXPECT_CALL(handler, Call("test"))
+    .WillOnce(Return());
+    
+    value.match()
+    .ifCase<TestEnum::Unknown3>([] (const int&) {
+        EXPECT_TRUE(false);
+    })
+    .ifCase<TestEnum::StringOpt1>(handler.AsStdFunction())
+    .ifCase<TestEnum::VoidOpt2>([] {
+        EXPECT_TRUE(false);
+    });
+}
+
+TEST(AsEnum, Match_Default)
+{
+    const TestAsEnum value = TestAsEnum::create<TestEnum::VoidOpt2>();
+    
+    MockFunction<void(void)> handler;
+    
+    EXPECT_CALL(handler, Call())
+    .WillOnce(Return());
+    
+    value.match()
+    .ifCase<TestEnum::StringOpt1>([] (const std::string&) {
+        EXPECT_TRUE(false);
+    })
+    .ifDefault(handler.AsStdFunction());
+    
+    value.match()
+    .ifCase<TestEnum::VoidOpt2>([] {})
+    .ifDefault([] {
+        EXPECT_TRUE(false);
+    });
+}
+
+TEST(AsEnum, Match_Result)
+{
+    const auto toInt = [] (const TestAsEnum& value) {
+        return value.match<int>()
+        .ifCase<TestEnum::VoidOpt2>([] {
+            return 0;
+        })
+        .ifCase<TestEnum::StringOpt1>([] (const std::string& value) {
+            return static_cast<int>(value.size());
+        })
+        .ifCase<TestEnum::Unknown3>([] (const int value) {
+            return value;
+        });
+    };
+    
+    EXPECT_EQ(toInt(TestAsEnum::create<TestEnum::VoidOpt2>()), 0);
+    EXPECT_EQ(toInt(TestAsEnum::create<TestEnum::StringOpt1>("test")), 4);
+    EXPECT_EQ(toInt(TestAsEnum::create<TestEnum::Unknown3>(-100500)), -100500);
+    
+    const std::string partial = TestAsEnum::create<TestEnum::Unknown3>(1).match<std::string>()
+    .ifCase<TestEnum::StringOpt1>([] (const std::string& value) {
+        return value;
+    })
+    .ifDefault([] {
+        return "default";
+    });
+    
+    EXPECT_EQ(partial, "default");
+}
+
+namespace
+{
+    template <typename Step, typename = void>
+    struct CanFinishLvalue : std::false_type {};
+    
+    template <typename Step>
+    struct CanFinishLvalue<Step, decltype(void(std::declval<Step&>().ifDefault(std::function<void()>())))> : std::true_type {};
+    
+    template <typename Step, typename = void>
+    struct CanFinishRvalue : std::false_type {};
+    
+    template <typename Step>
+    struct CanFinishRvalue<Step, decltype(void(std::declval<Step>().ifDefault(std::function<void()>())))> : std::true_type {};
+}
+
+TEST(AsEnum, Match_Steps_Not_Storable)
+{
+    using Root = decltype(std::declval<const TestAsEnum&>().match());
+    using Step = decltype(std::declval<Root>().ifCase<TestEnum::VoidOpt2>(std::function<void()>()));
+    
+    // Steps are returned by rvalue reference to temporaries of the full-expression: 'auto step = ...' doesn't compile,
+    // with or without C++17 copy elision.
+    static_assert(std::is_rvalue_reference<Root>::value, "");
+    static_assert(std::is_rvalue_reference<Step>::value, "");
+    static_assert(!std::is_constructible<typename std::decay<Root>::type, Root>::value, "");
+    static_assert(!std::is_constructible<typename std::decay<Step>::type, Step>::value, "");
+    static_assert(!std::is_default_constructible<typename std::decay<Root>::type>::value, "");
+    
+    static_assert(CanFinishRvalue<Root>::value, "");
+    static_assert(CanFinishRvalue<Step>::value, "");
+    static_assert(!CanFinishLvalue<Root>::value, "");
+    static_assert(!CanFinishLvalue<Step>::value, "");
+}
+
+namespace
+{
+    int StringLength(const std::string& value)
+    {
+        return static_cast<int>(value.size());
+    }
+}
+
+TEST(AsEnum, Matcher_All_Cases)
+{
+    const auto toInt = TestAsEnum::matcher<int>()
+    .ifCase<TestEnum::VoidOpt2>([] {
+        return 0;
+    })
+    .ifCase<TestEnum::StringOpt1>(&StringLength)
+    .ifCase<TestEnum::Unknown3>([] (const int value) {
+        return value;
+    });
+    
+    EXPECT_EQ(toInt(TestAsEnum::create<TestEnum::VoidOpt2>()), 0);
+    EXPECT_EQ(toInt(TestAsEnum::create<TestEnum::StringOpt1>("test")), 4);
+    EXPECT_EQ(toInt(TestAsEnum::create<TestEnum::Unknown3>(-100500)), -100500);
+    
+    // Matcher is reusable and copyable.
+    const auto copy = toInt;
+    EXPECT_EQ(copy(TestAsEnum::create<TestEnum::StringOpt1>("qwerty")), 6);
+}
+
+TEST(AsEnum, Matcher_Default)
+{
+    MockFunction<void(void)> handler;
+    
+    EXPECT_CALL(handler, Call())
+    .Times(2)
+    .WillRepeatedly(Return());
+    
+    const auto matcher = TestAsEnum::matcher()
+    .ifCase<TestEnum::StringOpt1>([] (const std::string&) {
+        EXPECT_TRUE(false);
+    })
+    .ifDefault(handler.AsStdFunction());
+    
+    matcher(TestAsEnum::create<TestEnum::VoidOpt2>());
+    matcher(TestAsEnum::create<TestEnum::Unknown3>(1));
+}
+
+TEST(AsEnum, Compare_ThreeWay)
+{
+    const TestAsEnum string1 = TestAsEnum::create<TestEnum::StringOpt1>("test");
+    const TestAsEnum string2 = TestAsEnum::create<TestEnum::StringOpt1>("test2");
+    const TestAsEnum empty = TestAsEnum::create<TestEnum::VoidOpt2>();
+    const TestAsEnum number = TestAsEnum::create<TestEnum::Unknown3>(-100500);
+    
+    EXPECT_EQ(string1.compare(string1), 0);
+    EXPECT_EQ(string1.compare(TestAsEnum::create<TestEnum::StringOpt1>("test")), 0);
+    EXPECT_EQ(empty.compare(TestAsEnum::create<TestEnum::VoidOpt2>()), 0);
+    
+    EXPECT_LT(string1.compare(string2), 0);
+    EXPECT_GT(string2.compare(string1), 0);
+    
+    EXPECT_LT(string2.compare(empty), 0);
+    EXPECT_LT(empty.compare(number), 0);
+    EXPECT_GT(number.compare(string1), 0);
+}
+
+namespace
+{
+    struct ComparedPayload
+    {
+        static int s_comparisons;
+        
+        bool operator==(const ComparedPayload& other) const { s_comparisons++; return value == other.value; }
+        bool operator<(const ComparedPayload& other) const { s_comparisons++; return value < other.value; }
+        bool operator<=(const ComparedPayload& other) const { s_comparisons++; return value <= other.value; }
+        bool operator>(const ComparedPayload& other) const { s_comparisons++; return value > other.value; }
+        bool operator>=(const ComparedPayload& other) const { s_comparisons++; return value >= other.value; }
+        
+        double value;
+        char padding[64];
+    };
+    
+    int ComparedPayload::s_comparisons = 0;
+    
+    using ComparedAsEnum = asenum::AsEnum<
+    asenum::Case11<StorageEnum, StorageEnum::Small, double>,
+    asenum::Case11<StorageEnum, StorageEnum::Big, ComparedPayload>,
+    asenum::Case11<StorageEnum, StorageEnum::Empty, void>
+    >;
+    
+    static_assert(ComparedAsEnum::storesInline<StorageEnum::Small>(), "Payload should be stored inline");
+    static_assert(!ComparedAsEnum::storesInline<StorageEnum::Big>(), "Payload should be shared between copies");
+}
+
+TEST(AsEnum, Compare_SharedPayload)
+{
+    // Result doesn't depend on whether copies share payload: values are always compared.
+    const ComparedAsEnum value1 = ComparedAsEnum::create<StorageEnum::Big>(ComparedPayload { 1, {} });
+    const ComparedAsEnum value2 = value1;
+    
+    ComparedPayload::s_comparisons = 0;
+    EXPECT_EQ(value1, value2);
+    EXPECT_EQ(value1.compare(value2), 0);
+    EXPECT_LE(value1, value2);
+    EXPECT_NE(ComparedPayload::s_comparisons, 0);
+    
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    const ComparedAsEnum sharedNan = ComparedAsEnum::create<StorageEnum::Big>(ComparedPayload { nan, {} });
+    const ComparedAsEnum sharedNanCopy = sharedNan;
+    EXPECT_FALSE(sharedNan == sharedNan);
+    EXPECT_FALSE(sharedNan == sharedNanCopy);
+    EXPECT_FALSE(sharedNan <= sharedNanCopy);
+    
+    const ComparedAsEnum inlineNan = ComparedAsEnum::create<StorageEnum::Small>(nan);
+    const ComparedAsEnum inlineNanCopy = inlineNan;
+    EXPECT_FALSE(inlineNan == inlineNan);
+    EXPECT_FALSE(inlineNan == inlineNanCopy);
+}
+
+TEST(AsEnum, Compare_PayloadOperators)
+{
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    const ComparedAsEnum nanValue = ComparedAsEnum::create<StorageEnum::Small>(nan);
+    const ComparedAsEnum one = ComparedAsEnum::create<StorageEnum::Small>(1.0);
+    
+    // Relational operators use the same operators of payload.
+    EXPECT_FALSE(nanValue < one);
+    EXPECT_FALSE(nanValue <= one);
+    EXPECT_FALSE(nanValue > one);
+    EXPECT_FALSE(nanValue >= one);
+    EXPECT_FALSE(nanValue == one);
+    EXPECT_TRUE(nanValue != one);
+    
+    // Three-way comparison uses only 'operator<', so unordered values are equivalent.
+    EXPECT_EQ(nanValue.compare(one), 0);
+    
+    // Different cases are ordered by case.
+    const ComparedAsEnum empty = ComparedAsEnum::create<StorageEnum::Empty>();
+    EXPECT_TRUE(nanValue < empty);
+    EXPECT_TRUE(nanValue <= empty);
+    EXPECT_TRUE(empty >= nanValue);
+    EXPECT_TRUE(empty <= ComparedAsEnum::create<StorageEnum::Empty>());
+    EXPECT_FALSE(empty < ComparedAsEnum::create<StorageEnum::Empty>());
+}
+
+TEST(AsEnum, Hash)
+{
+    const std::hash<TestAsEnum> hasher;
+    
+    EXPECT_EQ(hasher(TestAsEnum::create<TestEnum::StringOpt1>("test")), hasher(TestAsEnum::create<TestEnum::StringOpt1>("test")));
+    EXPECT_EQ(hasher(TestAsEnum::create<TestEnum::VoidOpt2>()), hasher(TestAsEnum::create<TestEnum::VoidOpt2>()));
+    
+    EXPECT_NE(hasher(TestAsEnum::create<TestEnum::StringOpt1>("test")), hasher(TestAsEnum::create<TestEnum::StringOpt1>("test2")));
+    EXPECT_NE(hasher(TestAsEnum::create<TestEnum::Unknown3>(0)), hasher(TestAsEnum::create<TestEnum::VoidOpt2>()));
+    
+    const SomeVoidAsEnum void1 = SomeVoidAsEnum::create<SomeVoidEnum::Opt1>();
+    const SomeVoidAsEnum void2 = SomeVoidAsEnum::create<SomeVoidEnum::Opt2>();
+    EXPECT_NE(std::hash<SomeVoidAsEnum>()(void1), std::hash<SomeVoidAsEnum>()(void2));
+}
+
+namespace
+{
+    struct CopyCounter
+    {
+        static int s_copies;
+        
+        CopyCounter(std::vector<uint8_t> d) : data(std::move(d)) {}
+        CopyCounter(const CopyCounter& other) : data(other.data) { s_copies++; }
+        CopyCounter(CopyCounter&& other) noexcept = default;
+        
+        std::vector<uint8_t> data;
+    };
+    
+    int CopyCounter::s_copies = 0;
+    
+    using BufferAsEnum = asenum::AsEnum<
+    asenum::Case11<StorageEnum, StorageEnum::Big, CopyCounter>,
+    asenum::Case11<StorageEnum, StorageEnum::Small, int>,
+    asenum::Case11<StorageEnum, StorageEnum::Empty, void>
+    >;
+    
+    static_assert(!BufferAsEnum::storesInline<StorageEnum::Big>(), "Buffer should be stored on the heap");
+}
+
+TEST(AsEnum, Take)
+{
+    CopyCounter::s_copies = 0;
+    
+    // Exclusively owned heap value is moved out.
+    BufferAsEnum exclusive = BufferAsEnum::create<StorageEnum::Big>(CopyCounter({ 1, 2, 3 }));
+    const CopyCounter taken = std::move(exclusive).take<StorageEnum::Big>();
+    EXPECT_EQ(taken.data, std::vector<uint8_t>({ 1, 2, 3 }));
+    EXPECT_EQ(CopyCounter::s_copies, 0);
+    
+    // Shared heap value is copied: other instance must stay untouched.
+    BufferAsEnum shared = BufferAsEnum::create<StorageEnum::Big>(CopyCounter({ 4, 5 }));
+    const BufferAsEnum other = shared;
+    const CopyCounter copied = std::move(shared).take<StorageEnum::Big>();
+    EXPECT_EQ(copied.data, std::vector<uint8_t>({ 4, 5 }));
+    EXPECT_EQ(other.forceAsCase<StorageEnum::Big>().data, std::vector<uint8_t>({ 4, 5 }));
+    EXPECT_EQ(CopyCounter::s_copies, 1);
+    
+    // Inline value is always moved.
+    const std::string string = WideTestAsEnum::create<TestEnum::StringOpt1>("test").take<TestEnum::StringOpt1>();
+    EXPECT_EQ(string, "test");
+    
+    EXPECT_ASENUM_ERROR(BufferAsEnum::create<StorageEnum::Small>(1).take<StorageEnum::Big>(), std::invalid_argument);
+}
+
+TEST(AsEnum, Switch_Map_Rvalue)
+{
+    CopyCounter::s_copies = 0;
+    
+    std::vector<uint8_t> received;
+    BufferAsEnum::create<StorageEnum::Big>(CopyCounter({ 1, 2, 3 })).doSwitch()
+    .ifCase<StorageEnum::Small>([] (const int&) {
+        EXPECT_TRUE(false);
+    })
+    .ifCase<StorageEnum::Big>([&received] (CopyCounter&& value) {
+        received = std::move(value.data);
+    })
+    .ifDefault([] {
+        EXPECT_TRUE(false);
+    });
+    EXPECT_EQ(received, std::vector<uint8_t>({ 1, 2, 3 }));
+    
+    const std::vector<uint8_t> mapped = BufferAsEnum::create<StorageEnum::Big>(CopyCounter({ 4, 5 })).doMap<std::vector<uint8_t>>()
+    .ifCase<StorageEnum::Big>([] (CopyCounter&& value) {
+        return std::move(value.data);
+    })
+    .ifCase<StorageEnum::Small>([] (const int value) {
+        return std::vector<uint8_t>(1, static_cast<uint8_t>(value));
+    })
+    .ifCase<StorageEnum::Empty>([] {
+        return std::vector<uint8_t>();
+    });
+    EXPECT_EQ(mapped, std::vector<uint8_t>({ 4, 5 }));
+    EXPECT_EQ(CopyCounter::s_copies, 0);
+    
+    // Value shared with other instance is passed as a copy.
+    BufferAsEnum shared = BufferAsEnum::create<StorageEnum::Big>(CopyCounter({ 6 }));
+    const BufferAsEnum other = shared;
+    std::move(shared).doSwitch()
+    .ifCase<StorageEnum::Big>([] (CopyCounter&& value) {
+        value.data.clear();
+    });
+    EXPECT_EQ(other.forceAsCase<StorageEnum::Big>().data, std::vector<uint8_t>({ 6 }));
+    EXPECT_EQ(CopyCounter::s_copies, 1);
+}
+
+namespace
+{
+    template <typename T>
+    struct CountingAllocator
+    {
+        using value_type = T;
+        
+        explicit CountingAllocator(int* alive) : alive(alive) {}
+        
+        template <typename U>
+        CountingAllocator(const CountingAllocator<U>& other) : alive(other.alive) {}
+        
+        T* allocate(const size_t count) { (*alive)++; return static_cast<T*>(::operator new(count * sizeof(T))); }
+        void deallocate(T* ptr, size_t) { (*alive)--; ::operator delete(ptr); }
+        
+        template <typename U>
+        bool operator==(const CountingAllocator<U>& other) const { return alive == other.alive; }
+        
+        template <typename U>
+        bool operator!=(const CountingAllocator<U>& other) const { return alive != other.alive; }
+        
+        int* alive;
+    };
+}
+
+TEST(AsEnum, Create_Allocator)
+{
+    int alive = 0;
+    const CountingAllocator<char> allocator(&alive);
+    
+    {
+        const BufferAsEnum big = BufferAsEnum::create<StorageEnum::Big>(std::allocator_arg, allocator, CopyCounter({ 1, 2, 3 }));
+        EXPECT_EQ(big.forceAsCase<StorageEnum::Big>().data, std::vector<uint8_t>({ 1, 2, 3 }));
+        
+        // Value and its reference counter are allocated in single block.
+        EXPECT_EQ(alive, 1);
+        
+        const BufferAsEnum copy = big;
+        EXPECT_EQ(alive, 1);
+        
+        // Inline values don't allocate.
+        const BufferAsEnum small = BufferAsEnum::create<StorageEnum::Small>(std::allocator_arg, allocator, 10);
+        EXPECT_EQ(small.forceAsCase<StorageEnum::Small>(), 10);
+        EXPECT_EQ(alive, 1);
+    }
+    
+    EXPECT_EQ(alive, 0);
+}
+
+#if __cplusplus > 201402L
+TEST(AsEnum, Create_MemoryResource)
+{
+    std::pmr::monotonic_buffer_resource arena;
+    
+    const BufferAsEnum value = BufferAsEnum::create<StorageEnum::Big>(&arena, CopyCounter({ 4, 5 }));
+    EXPECT_EQ(value.forceAsCase<StorageEnum::Big>().data, std::vector<uint8_t>({ 4, 5 }));
+}
+#endif
+
+namespace
+{
+    using LocalStorageAsEnum = asenum::LocalAsEnum<
+    asenum::Case11<StorageEnum, StorageEnum::Small, LifetimeCounter>,
+    asenum::Case11<StorageEnum, StorageEnum::Big, BigPayload>,
+    asenum::Case11<StorageEnum, StorageEnum::Empty, void>
+    >;
+    
+    using DeepCopyStorageAsEnum = asenum::DeepCopyAsEnum<
+    asenum::Case11<StorageEnum, StorageEnum::Small, LifetimeCounter>,
+    asenum::Case11<StorageEnum, StorageEnum::Big, BigPayload>,
+    asenum::Case11<StorageEnum, StorageEnum::Empty, void>
+    >;
+    
+    using DeepCopyBufferAsEnum = asenum::DeepCopyAsEnum<
+    asenum::Case11<StorageEnum, StorageEnum::Big, CopyCounter>,
+    asenum::Case11<StorageEnum, StorageEnum::Small, int>,
+    asenum::Case11<StorageEnum, StorageEnum::Empty, void>
+    >;
+    
+    static_assert(sizeof(LocalStorageAsEnum) <= sizeof(StorageAsEnum), "Ownership policy should not grow AsEnum");
+    static_assert(sizeof(DeepCopyStorageAsEnum) <= sizeof(StorageAsEnum), "Ownership policy should not grow AsEnum");
+}
+
+TEST(AsEnum, Ownership_LocalShared)
+{
+    {
+        const LocalStorageAsEnum big = LocalStorageAsEnum::create<StorageEnum::Big>(BigPayload { LifetimeCounter(2), {} });
+        EXPECT_EQ(LifetimeCounter::s_alive, 1);
+        
+        LocalStorageAsEnum copy = big;
+        EXPECT_EQ(LifetimeCounter::s_alive, 1); // heap payload is shared
+        EXPECT_EQ(&copy.forceAsCase<StorageEnum::Big>(), &big.forceAsCase<StorageEnum::Big>());
+        
+        LocalStorageAsEnum moved = std::move(copy);
+        EXPECT_EQ(moved.forceAsCase<StorageEnum::Big>().counter.value, 2);
+        
+        moved = LocalStorageAsEnum::create<StorageEnum::Small>(LifetimeCounter(1));
+        EXPECT_EQ(LifetimeCounter::s_alive, 2);
+        
+        copy = big;
+        copy = moved;
+        EXPECT_EQ(copy.forceAsCase<StorageEnum::Small>().value, 1);
+        EXPECT_EQ(LifetimeCounter::s_alive, 3);
+        
+        const int value = big.doMap<int>()
+        .ifCase<StorageEnum::Big>([] (const BigPayload& payload) {
+            return payload.counter.value;
+        })
+        .ifDefault([] {
+            return 0;
+        });
+        EXPECT_EQ(value, 2);
+    }
+    
+    EXPECT_EQ(LifetimeCounter::s_alive, 0);
+}
+
+TEST(AsEnum, Ownership_DeepCopy)
+{
+    {
+        const DeepCopyStorageAsEnum big = DeepCopyStorageAsEnum::create<StorageEnum::Big>(BigPayload { LifetimeCounter(2), {} });
+        EXPECT_EQ(LifetimeCounter::s_alive, 1);
+        
+        DeepCopyStorageAsEnum copy = big;
+        EXPECT_EQ(LifetimeCounter::s_alive, 2); // heap payload is copied
+        EXPECT_NE(&copy.forceAsCase<StorageEnum::Big>(), &big.forceAsCase<StorageEnum::Big>());
+        EXPECT_EQ(copy.forceAsCase<StorageEnum::Big>().counter.value, 2);
+        
+        DeepCopyStorageAsEnum moved = std::move(copy);
+        EXPECT_EQ(LifetimeCounter::s_alive, 2);
+        
+        moved = big;
+        EXPECT_EQ(LifetimeCounter::s_alive, 2);
+        
+        moved = DeepCopyStorageAsEnum::create<StorageEnum::Empty>();
+        EXPECT_EQ(LifetimeCounter::s_alive, 1);
+    }
+    
+    EXPECT_EQ(LifetimeCounter::s_alive, 0);
+    
+    // Each copy owns its value, so 'take' always moves it out.
+    CopyCounter::s_copies = 0;
+    
+    const DeepCopyBufferAsEnum original = DeepCopyBufferAsEnum::create<StorageEnum::Big>(CopyCounter({ 1, 2 }));
+    DeepCopyBufferAsEnum copy = original;
+    EXPECT_EQ(CopyCounter::s_copies, 1);
+    
+    const CopyCounter taken = std::move(copy).take<StorageEnum::Big>();
+    EXPECT_EQ(taken.data, std::vector<uint8_t>({ 1, 2 }));
+    EXPECT_EQ(original.forceAsCase<StorageEnum::Big>().data, std::vector<uint8_t>({ 1, 2 }));
+    EXPECT_EQ(CopyCounter::s_copies, 1);
+}
+
+namespace
+{
+    template <typename Value>
+    void CheckMovedFromCopy()
+    {
+        {
+            Value original = Value::template create<StorageEnum::Big>(BigPayload { LifetimeCounter(2), {} });
+            const Value moved = std::move(original);
+            EXPECT_EQ(LifetimeCounter::s_alive, 1);
+            
+            // Moved-from value may be copied, assigned to and destroyed.
+            Value copy = original;
+            copy = original;
+            EXPECT_EQ(LifetimeCounter::s_alive, 1);
+            
+            copy.template replace<StorageEnum::Big>(BigPayload { LifetimeCounter(3), {} });
+            EXPECT_EQ(copy.template forceAsCase<StorageEnum::Big>().counter.value, 3);
+            
+            original = moved;
+            EXPECT_EQ(original.template forceAsCase<StorageEnum::Big>().counter.value, 2);
+        }
+        
+        EXPECT_EQ(LifetimeCounter::s_alive, 0);
+    }
+}
+
+TEST(AsEnum, Ownership_MovedFrom_Copy)
+{
+    CheckMovedFromCopy<StorageAsEnum>();
+    CheckMovedFromCopy<LocalStorageAsEnum>();
+    CheckMovedFromCopy<DeepCopyStorageAsEnum>();
+}
+
+TEST(AsEnum, Ownership_Allocator)
+{
+    int alive = 0;
+    const CountingAllocator<char> allocator(&alive);
+    
+    {
+        const DeepCopyBufferAsEnum big = DeepCopyBufferAsEnum::create<StorageEnum::Big>(std::allocator_arg, allocator, CopyCounter({ 1, 2, 3 }));
+        EXPECT_EQ(alive, 1);
+        
+        // Copy is allocated with the allocator of original value.
+        const DeepCopyBufferAsEnum copy = big;
+        EXPECT_EQ(alive, 2);
+        EXPECT_EQ(copy.forceAsCase<StorageEnum::Big>().data, std::vector<uint8_t>({ 1, 2, 3 }));
+    }
+    EXPECT_EQ(alive, 0);
+    
+    using LocalBufferAsEnum = asenum::LocalAsEnum<
+    asenum::Case11<StorageEnum, StorageEnum::Big, CopyCounter>,
+    asenum::Case11<StorageEnum, StorageEnum::Small, int>
+    >;
+    
+    {
+        const LocalBufferAsEnum big = LocalBufferAsEnum::create<StorageEnum::Big>(std::allocator_arg, allocator, CopyCounter({ 4 }));
+        const LocalBufferAsEnum copy = big;
+        EXPECT_EQ(alive, 1);
+    }
+    EXPECT_EQ(alive, 0);
+}
+
+namespace
+{
+    enum class SparseEnum : int32_t
+    {
+        Negative = -1000,
+        Zero = 0,
+        Byte = 0x100,
+        Big = 0x7fff0001,
+    };
+    
+    using SparseAsEnum = asenum::AsEnum<
+    asenum::Case11<SparseEnum, SparseEnum::Byte, int>,
+    asenum::Case11<SparseEnum, SparseEnum::Negative, std::string>,
+    asenum::Case11<SparseEnum, SparseEnum::Big, void>,
+    asenum::Case11<SparseEnum, SparseEnum::Zero, void>
+    >;
+    
+    static_assert(SparseAsEnum::indexOf(SparseEnum::Byte) == 0, "Invalid case index");
+    static_assert(SparseAsEnum::indexOf(SparseEnum::Negative) == 1, "Invalid case index");
+    static_assert(SparseAsEnum::indexOf(SparseEnum::Big) == 2, "Invalid case index");
+    static_assert(SparseAsEnum::indexOf(SparseEnum::Zero) == 3, "Invalid case index");
+    static_assert(SparseAsEnum::indexOf(static_cast<SparseEnum>(1)) == 4, "Unknown value should not be found");
+    static_assert(SparseAsEnum::fromIndex(2) == SparseEnum::Big, "Invalid enum case");
+    
+    static_assert(TestAsEnum::indexOf(TestEnum::StringOpt1) == 1, "Invalid case index");
+    static_assert(TestAsEnum::indexOf(TestEnum::Unknown3) == 0, "Invalid case index");
+}
+
+TEST(AsEnum, IndexOf_Sequential)
+{
+    for (size_t i = 0; i < 3; i++)
+    {
+        EXPECT_EQ(TestAsEnum::indexOf(TestAsEnum::AllCases[i]), i);
+        EXPECT_EQ(TestAsEnum::fromIndex(i), TestAsEnum::AllCases[i]);
+    }
+    
+    EXPECT_EQ(TestAsEnum::indexOf(static_cast<TestEnum>(3)), 3);
+    EXPECT_EQ(TestAsEnum::indexOf(static_cast<TestEnum>(-1)), 3);
+}
+
+TEST(AsEnum, IndexOf_Sparse)
+{
+    for (size_t i = 0; i < 4; i++)
+    {
+        EXPECT_EQ(SparseAsEnum::indexOf(SparseAsEnum::AllCases[i]), i);
+        EXPECT_EQ(SparseAsEnum::checkedIndexOf(SparseAsEnum::AllCases[i]), i);
+    }
+    
+    for (int32_t value = -2000; value < 2000; value++)
+    {
+        const size_t index = SparseAsEnum::indexOf(static_cast<SparseEnum>(value));
+        EXPECT_TRUE(index == 4 || SparseAsEnum::AllCases[index] == static_cast<SparseEnum>(value));
+    }
+    
+    EXPECT_ASENUM_ERROR(SparseAsEnum::checkedIndexOf(static_cast<SparseEnum>(0x200)), std::invalid_argument);
+    EXPECT_ASENUM_ERROR(SparseAsEnum::fromIndex(4), std::out_of_range);
+}
+
+TEST(AsEnum, CaseIndex)
+{
+    EXPECT_EQ(SparseAsEnum::create<SparseEnum::Byte>(1).caseIndex(), 0);
+    EXPECT_EQ(SparseAsEnum::create<SparseEnum::Negative>("test").caseIndex(), 1);
+    EXPECT_EQ(SparseAsEnum::create<SparseEnum::Zero>().caseIndex(), 3);
+}
+
+namespace
+{
+    enum class Code
+    {
+        Ok,
+        Timeout,
+        Retry,
+        Closed
+    };
+    
+    struct RetryPolicy
+    {
+        int attempts;
+        int delayMs;
+        
+        constexpr bool operator==(const RetryPolicy& other) const { return attempts == other.attempts && delayMs == other.delayMs; }
+        constexpr bool operator<(const RetryPolicy& other) const { return attempts < other.attempts || (attempts == other.attempts && delayMs < other.delayMs); }
+    };
+    
+    using Response = asenum::AsEnum<
+    asenum::Case11<Code, Code::Ok, void>,
+    asenum::Case11<Code, Code::Timeout, std::chrono::seconds>,
+    asenum::Case11<Code, Code::Retry, RetryPolicy>,
+    asenum::Case11<Code, Code::Closed, int>
+    >;
+    
+    /// Literal payloads: table is initialized at compile time and placed into read-only data.
+    constexpr Response DefaultResponses[] = {
+        Response::create<Code::Ok>(),
+        Response::create<Code::Timeout>(std::chrono::seconds(5)),
+        Response::create<Code::Retry>(RetryPolicy { 3, 100 }),
+        Response::create<Code::Closed>(-1),
+    };
+    
+    static_assert(DefaultResponses[0].enumCase() == Code::Ok, "Invalid enum case");
+    static_assert(DefaultResponses[1].isCase<Code::Timeout>(), "Invalid enum case");
+    static_assert(!DefaultResponses[1].isCase<Code::Ok>(), "Invalid enum case");
+    static_assert(DefaultResponses[1].forceAsCase<Code::Timeout>() == std::chrono::seconds(5), "Invalid value");
+    static_assert(DefaultResponses[2].forceAsCase<Code::Retry>().attempts == 3, "Invalid value");
+    static_assert(DefaultResponses[2].getUnchecked<Code::Retry>().attempts == 3, "Invalid value");
+    static_assert(DefaultResponses[3].caseIndex() == 3, "Invalid case index");
+    
+    static_assert(DefaultResponses[1] == Response::create<Code::Timeout>(std::chrono::seconds(5)), "Invalid equality");
+    static_assert(DefaultResponses[1] != Response::create<Code::Timeout>(std::chrono::seconds(6)), "Invalid equality");
+    static_assert(DefaultResponses[0] != DefaultResponses[1], "Invalid equality");
+    static_assert(DefaultResponses[0] < DefaultResponses[1], "Invalid comparison");
+    static_assert(DefaultResponses[3] < Response::create<Code::Closed>(0), "Invalid comparison");
+    static_assert(DefaultResponses[1].compare(DefaultResponses[1]) == 0, "Invalid comparison");
+    
+    /// Handler usable in constant expressions (lambdas are not constexpr in C++11).
+    struct NoopHandler
+    {
+        constexpr bool operator()() const { return true; }
+        constexpr bool operator()(const int) const { return true; }
+    };
+    
+    static_assert(DefaultResponses[3].ifCase<Code::Closed>(NoopHandler()), "Handler should be called");
+    static_assert(!DefaultResponses[3].ifCase<Code::Ok>(NoopHandler()), "Handler should not be called");
+    
+    static_assert(std::is_literal_type<Response>::value, "AsEnum with literal payloads should be literal type");
+    static_assert(!std::is_literal_type<TestAsEnum>::value, "AsEnum with std::string payload is not literal type");
+}
+
+TEST(AsEnum, Constexpr_Table)
+{
+    EXPECT_EQ(DefaultResponses[2].forceAsCase<Code::Retry>().delayMs, 100);
+    EXPECT_ASENUM_ERROR(DefaultResponses[2].forceAsCase<Code::Closed>(), std::invalid_argument);
+    
+    // Literal AsEnum behaves as usual at runtime.
+    Response response = DefaultResponses[1];
+    EXPECT_EQ(response, DefaultResponses[1]);
+    response = Response::create<Code::Closed>(10);
+    EXPECT_EQ(std::move(response).take<Code::Closed>(), 10);
+    
+    std::chrono::seconds timeout;
+    Response(DefaultResponses[1]).doSwitch()
+    .ifCase<Code::Timeout>([&timeout] (std::chrono::seconds&& value) {
+        timeout = value;
+    });
+    EXPECT_EQ(timeout, std::chrono::seconds(5));
+}
+
+namespace
+{
+    static_assert(std::is_trivially_copyable<Response>::value, "AsEnum with trivially copyable payloads should be trivially copyable");
+    static_assert(std::is_trivially_destructible<Response>::value, "AsEnum with trivially copyable payloads should be trivially destructible");
+    static_assert(sizeof(Response) == sizeof(std::chrono::seconds) + alignof(std::chrono::seconds), "Layout should be tag plus union of payloads");
+    
+    static_assert(!std::is_trivially_copyable<TestAsEnum>::value, "AsEnum with std::string payload is not trivially copyable");
+    static_assert(!std::is_trivially_copyable<BufferAsEnum>::value, "AsEnum with heap payload is not trivially copyable");
+}
+
+TEST(AsEnum, TriviallyCopyable)
+{
+    const Response original = Response::create<Code::Retry>(RetryPolicy { 5, 250 });
+    
+    unsigned char bytes[sizeof(Response)];
+    std::memcpy(bytes, &original, sizeof(original));
+    
+    Response copy = Response::create<Code::Ok>();
+    std::memcpy(&copy, bytes, sizeof(copy));
+    
+    EXPECT_EQ(copy, original);
+    EXPECT_EQ(copy.forceAsCase<Code::Retry>().delayMs, 250);
+}
+
+TEST(AsEnum, Modify)
+{
+    CopyCounter::s_copies = 0;
+    
+    // Exclusively owned heap value is changed in place.
+    BufferAsEnum buffer = BufferAsEnum::create<StorageEnum::Big>(CopyCounter({ 1 }));
+    const CopyCounter* const address = &buffer.forceAsCase<StorageEnum::Big>();
+    for (uint8_t i = 2; i <= 4; i++)
+    {
+        EXPECT_TRUE(buffer.modify<StorageEnum::Big>([i] (CopyCounter& value) {
+            value.data.push_back(i);
+        }));
+    }
+    EXPECT_EQ(buffer.forceAsCase<StorageEnum::Big>().data, std::vector<uint8_t>({ 1, 2, 3, 4 }));
+    EXPECT_EQ(&buffer.forceAsCase<StorageEnum::Big>(), address);
+    EXPECT_EQ(CopyCounter::s_copies, 0);
+    
+    // Shared heap value is copied first: other instance must stay untouched.
+    const BufferAsEnum other = buffer;
+    EXPECT_TRUE(buffer.modify<StorageEnum::Big>([] (CopyCounter& value) {
+        value.data.clear();
+    }));
+    EXPECT_TRUE(buffer.forceAsCase<StorageEnum::Big>().data.empty());
+    EXPECT_EQ(other.forceAsCase<StorageEnum::Big>().data, std::vector<uint8_t>({ 1, 2, 3, 4 }));
+    EXPECT_EQ(CopyCounter::s_copies, 1);
+    
+    // Unshared copy is modified in place afterwards.
+    EXPECT_TRUE(buffer.modify<StorageEnum::Big>([] (CopyCounter& value) {
+        value.data.push_back(5);
+    }));
+    EXPECT_EQ(CopyCounter::s_copies, 1);
+    
+    EXPECT_FALSE(buffer.modify<StorageEnum::Small>([] (int&) {
+        EXPECT_TRUE(false);
+    }));
+    
+    // Inline and literal values.
+    TestAsEnum number = TestAsEnum::create<TestEnum::Unknown3>(1);
+    EXPECT_TRUE(number.modify<TestEnum::Unknown3>([] (int& value) {
+        value += 10;
+    }));
+    EXPECT_EQ(number.forceAsCase<TestEnum::Unknown3>(), 11);
+    
+    Response response = Response::create<Code::Timeout>(std::chrono::seconds(1));
+    EXPECT_TRUE(response.modify<Code::Timeout>([] (std::chrono::seconds& value) {
+        value *= 2;
+    }));
+    EXPECT_EQ(response.forceAsCase<Code::Timeout>(), std::chrono::seconds(2));
+}
+
+TEST(AsEnum, Modify_While_Other_Thread_Releases_Copy)
+{
+    for (uint8_t i = 0; i < 200; i++)
+    {
+        BufferAsEnum value = BufferAsEnum::create<StorageEnum::Big>(CopyCounter({ i }));
+        std::atomic<size_t> observed(0);
+        
+        std::thread reader([&observed] (BufferAsEnum copy) {
+            observed = copy.forceAsCase<StorageEnum::Big>().data.size();
+        }, value);
+        
+        EXPECT_TRUE(value.modify<StorageEnum::Big>([] (CopyCounter& payload) {
+            payload.data.push_back(0xFF);
+        }));
+        reader.join();
+        
+        EXPECT_EQ(observed, 1);
+        EXPECT_EQ(value.forceAsCase<StorageEnum::Big>().data, std::vector<uint8_t>({ i, 0xFF }));
+    }
+}
+
+TEST(AsEnum, Replace)
+{
+    {
+        // Same case and exclusively owned value: assigned in place, heap block is reused.
+        StorageAsEnum big = StorageAsEnum::create<StorageEnum::Big>(BigPayload { LifetimeCounter(1), {} });
+        const BigPayload* const address = &big.forceAsCase<StorageEnum::Big>();
+        big.replace<StorageEnum::Big>(BigPayload { LifetimeCounter(2), {} });
+        EXPECT_EQ(big.forceAsCase<StorageEnum::Big>().counter.value, 2);
+        EXPECT_EQ(&big.forceAsCase<StorageEnum::Big>(), address);
+        
+        // Shared value is left to other instance.
+        const StorageAsEnum other = big;
+        big.replace<StorageEnum::Big>(BigPayload { LifetimeCounter(3), {} });
+        EXPECT_EQ(big.forceAsCase<StorageEnum::Big>().counter.value, 3);
+        EXPECT_EQ(other.forceAsCase<StorageEnum::Big>().counter.value, 2);
+        
+        // Other cases.
+        big.replace<StorageEnum::Small>(LifetimeCounter(4));
+        EXPECT_EQ(big.forceAsCase<StorageEnum::Small>().value, 4);
+        big.replace<StorageEnum::Empty>();
+        EXPECT_TRUE(big.isCase<StorageEnum::Empty>());
+        EXPECT_EQ(LifetimeCounter::s_alive, 1);
+    }
+    EXPECT_EQ(LifetimeCounter::s_alive, 0);
+    
+    // Value that can't be assigned is created again.
+    CopyCounter::s_copies = 0;
+    BufferAsEnum buffer = BufferAsEnum::create<StorageEnum::Big>(CopyCounter({ 1 }));
+    buffer.replace<StorageEnum::Big>(std::vector<uint8_t>({ 2, 3 }));
+    EXPECT_EQ(buffer.forceAsCase<StorageEnum::Big>().data, std::vector<uint8_t>({ 2, 3 }));
+    EXPECT_EQ(CopyCounter::s_copies, 0);
+    
+    // Inline string keeps its capacity.
+    WideTestAsEnum text = WideTestAsEnum::create<TestEnum::StringOpt1>(std::string(100, 'x'));
+    const char* const data = text.forceAsCase<TestEnum::StringOpt1>().data();
+    text.replace<TestEnum::StringOpt1>("short");
+    EXPECT_EQ(text.forceAsCase<TestEnum::StringOpt1>(), "short");
+    EXPECT_EQ(text.forceAsCase<TestEnum::StringOpt1>().data(), data);
+    
+    // Value constructed from several arguments.
+    text.replace<TestEnum::StringOpt1>(3, 'y');
+    EXPECT_EQ(text.forceAsCase<TestEnum::StringOpt1>(), "yyy");
+}
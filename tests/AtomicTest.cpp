@@ -0,0 +1,244 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Alkenso (Vladimir Vashurkin)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <asenum/atomic.h>
+
+#include <gmock/gmock.h>
+
+#include "TestUtils.h"
+
+#include <atomic>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    enum class Health
+    {
+        Ok,
+        Degraded,
+        Down
+    };
+    
+    using SmallState = asenum::AsEnum<
+    asenum::Case11<Health, Health::Ok, void>,
+    asenum::Case11<Health, Health::Degraded, int>,
+    asenum::Case11<Health, Health::Down, void>
+    >;
+    
+    using State = asenum::AsEnum<
+    asenum::Case11<Health, Health::Ok, void>,
+    asenum::Case11<Health, Health::Degraded, int>,
+    asenum::Case11<Health, Health::Down, std::string>
+    >;
+    
+#ifndef ASENUM_INSTRUMENTATION
+    static_assert(asenum::AtomicAsEnum<SmallState>::IsSingleWord, "Small trivially copyable AsEnum should fit single word");
+#endif
+    static_assert(!asenum::AtomicAsEnum<State>::IsSingleWord, "AsEnum with string should use heap snapshots");
+    
+    int DegradedLevel(const SmallState& state)
+    {
+        return state.ifCase<Health::Degraded>([] (const int) {}) ? state.forceAsCase<Health::Degraded>() : -1;
+    }
+    
+    /// Every character of the message encodes its length: torn or freed snapshots are detected by readers.
+    std::string MakeMessage(const size_t length)
+    {
+        return std::string(length, static_cast<char>('a' + length % 26));
+    }
+    
+    bool IsValidMessage(const std::string& message)
+    {
+        return message.find_first_not_of(static_cast<char>('a' + message.size() % 26)) == std::string::npos;
+    }
+}
+
+TEST(AtomicAsEnum, SingleWord)
+{
+    asenum::AtomicAsEnum<SmallState> state(SmallState::create<Health::Ok>());
+    EXPECT_TRUE(state.load().isCase<Health::Ok>());
+    
+    state.store(SmallState::create<Health::Degraded>(3));
+    EXPECT_EQ(DegradedLevel(state.load()), 3);
+    
+    const SmallState previous = state.exchange(SmallState::create<Health::Down>());
+    EXPECT_EQ(DegradedLevel(previous), 3);
+    EXPECT_TRUE(state.read([] (const SmallState& value) { return value.isCase<Health::Down>(); }));
+    
+    SmallState expected = SmallState::create<Health::Ok>();
+    EXPECT_FALSE(state.compareExchange(expected, SmallState::create<Health::Degraded>(5)));
+    EXPECT_TRUE(expected.isCase<Health::Down>());
+    
+    EXPECT_TRUE(state.compareExchange(expected, SmallState::create<Health::Degraded>(5)));
+    EXPECT_EQ(DegradedLevel(state.load()), 5);
+}
+
+TEST(AtomicAsEnum, SingleWord_CompareIgnoresPadding)
+{
+    // Cases without payload differ only in index bytes: all other bytes are padding and may hold garbage.
+    const SmallState down = SmallState::create<Health::Down>();
+    const SmallState ok = SmallState::create<Health::Ok>();
+    
+    alignas(SmallState) unsigned char dirty[sizeof(SmallState)];
+    unsigned char okBytes[sizeof(SmallState)];
+    std::memcpy(dirty, &down, sizeof(SmallState));
+    std::memcpy(okBytes, &ok, sizeof(SmallState));
+    for (size_t i = 0; i < sizeof(SmallState); i++)
+    {
+        if (dirty[i] == okBytes[i])
+        {
+            dirty[i] = 0xAB;
+        }
+    }
+    
+    const SmallState& dirtyDown = *reinterpret_cast<const SmallState*>(dirty);
+    ASSERT_TRUE(dirtyDown.isCase<Health::Down>());
+    ASSERT_NE(std::memcmp(&dirtyDown, &down, sizeof(SmallState)), 0);
+    
+    asenum::AtomicAsEnum<SmallState> state(dirtyDown);
+    
+    SmallState expected = down;
+    EXPECT_TRUE(state.compareExchange(expected, SmallState::create<Health::Ok>()));
+    EXPECT_TRUE(state.load().isCase<Health::Ok>());
+}
+
+TEST(AtomicAsEnum, Snapshots)
+{
+    asenum::AtomicAsEnum<State> state(State::create<Health::Down>("initial"));
+    EXPECT_EQ(state.load().forceAsCase<Health::Down>(), "initial");
+    
+    state.store(State::create<Health::Degraded>(1));
+    EXPECT_EQ(state.load().forceAsCase<Health::Degraded>(), 1);
+    
+    const State previous = state.exchange(State::create<Health::Down>("overloaded"));
+    EXPECT_EQ(previous.forceAsCase<Health::Degraded>(), 1);
+    
+    const size_t size = state.read([] (const State& value) {
+        return value.forceAsCase<Health::Down>().size();
+    });
+    EXPECT_EQ(size, 10);
+    
+    State expected = State::create<Health::Down>("timeout");
+    EXPECT_FALSE(state.compareExchange(expected, State::create<Health::Ok>()));
+    EXPECT_EQ(expected.forceAsCase<Health::Down>(), "overloaded");
+    
+    EXPECT_TRUE(state.compareExchange(expected, State::create<Health::Ok>()));
+    EXPECT_TRUE(state.load().isCase<Health::Ok>());
+    
+    // Many writes trigger reclamation of retired snapshots.
+    for (int i = 0; i < 1000; i++)
+    {
+        state.store(State::create<Health::Down>(MakeMessage(i)));
+    }
+    EXPECT_EQ(state.load().forceAsCase<Health::Down>(), MakeMessage(999));
+}
+
+TEST(AtomicAsEnum, NestedReads)
+{
+    asenum::AtomicAsEnum<State> first(State::create<Health::Down>("first"));
+    asenum::AtomicAsEnum<State> second(State::create<Health::Down>("second"));
+    
+    const std::string joined = first.read([&second] (const State& outer) {
+        return second.read([&outer] (const State& inner) {
+            return outer.forceAsCase<Health::Down>() + inner.forceAsCase<Health::Down>();
+        });
+    });
+    EXPECT_EQ(joined, "firstsecond");
+    
+    const auto nest = [&first] (const State&) {
+        return first.read([&first] (const State&) {
+            return first.read([&first] (const State&) {
+                return first.read([] (const State&) { return 0; });
+            });
+        });
+    };
+    EXPECT_EQ(first.read(nest), 0);
+    EXPECT_ASENUM_ERROR(first.read([&first, &nest] (const State&) { return first.read(nest); }), std::logic_error);
+    
+    // Slots are released after failure.
+    EXPECT_EQ(first.read(nest), 0);
+}
+
+TEST(AtomicAsEnum, ConcurrentReadersAndWriters)
+{
+    asenum::AtomicAsEnum<State> state(State::create<Health::Down>(MakeMessage(0)));
+    std::atomic<bool> stop(false);
+    std::atomic<size_t> invalid(0);
+    
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 4; i++)
+    {
+        readers.emplace_back([&state, &stop, &invalid] {
+            while (!stop.load())
+            {
+                const bool valid = state.read([] (const State& value) {
+                    return !value.isCase<Health::Down>() || IsValidMessage(value.forceAsCase<Health::Down>());
+                });
+                const State copy = state.load();
+                if (!valid || (copy.isCase<Health::Down>() && !IsValidMessage(copy.forceAsCase<Health::Down>())))
+                {
+                    invalid++;
+                }
+            }
+        });
+    }
+    
+    std::atomic<size_t> swaps(0);
+    std::vector<std::thread> writers;
+    for (int i = 0; i < 2; i++)
+    {
+        writers.emplace_back([&state, &swaps, i] {
+            for (size_t n = 0; n < 20000; n++)
+            {
+                if (n % 2)
+                {
+                    state.store(State::create<Health::Down>(MakeMessage(n % 100 + i)));
+                    continue;
+                }
+                
+                State expected = state.load();
+                if (state.compareExchange(expected, State::create<Health::Degraded>(static_cast<int>(n))))
+                {
+                    swaps++;
+                }
+            }
+        });
+    }
+    
+    for (std::thread& writer : writers)
+    {
+        writer.join();
+    }
+    stop = true;
+    for (std::thread& reader : readers)
+    {
+        reader.join();
+    }
+    
+    EXPECT_EQ(invalid.load(), 0);
+    EXPECT_GT(swaps.load(), 0);
+}
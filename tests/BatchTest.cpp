@@ -0,0 +1,215 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Alkenso (Vladimir Vashurkin)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <asenum/asenum.h>
+#include <asenum/batch.h>
+
+#include <gmock/gmock.h>
+
+#include "TestUtils.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+    using testutils::Record;
+    using testutils::RecordType;
+    
+    /// Cases are shuffled and unevenly sized, so groups differ from original order.
+    std::vector<Record> MakeRecords(const size_t count)
+    {
+        return testutils::MakeRecords(count, [] (const size_t i) {
+            switch (i * 7 % 5)
+            {
+                case 0:
+                case 1: return RecordType::Number;
+                case 2: return RecordType::Text;
+                default: return RecordType::Empty;
+            }
+        });
+    }
+    
+    enum class Wide
+    {
+        A, B, C, D, E, F
+    };
+    
+    /// Has more cases than Record.
+    using WideEnum = asenum::AsEnum<
+    asenum::Case11<Wide, Wide::A, int>,
+    asenum::Case11<Wide, Wide::B, int>,
+    asenum::Case11<Wide, Wide::C, int>,
+    asenum::Case11<Wide, Wide::D, int>,
+    asenum::Case11<Wide, Wide::E, int>,
+    asenum::Case11<Wide, Wide::F, int>
+    >;
+    
+    const auto g_measure = Record::matcher<long long>()
+    .ifCase<RecordType::Number>([] (const int value) {
+        return value;
+    })
+    .ifCase<RecordType::Text>([] (const std::string& value) {
+        return -static_cast<long long>(value.size());
+    })
+    .ifDefault([] {
+        return 0;
+    });
+}
+
+TEST(Batch, CaseGroups)
+{
+    const auto records = MakeRecords(1000);
+    
+    asenum::CaseGroups groups;
+    groups.assign(records.data(), records.size());
+    
+    EXPECT_EQ(groups.size(), records.size());
+    EXPECT_EQ(groups.groupCount(), 3);
+    EXPECT_EQ(groups.groupBegin(0), groups.indices());
+    EXPECT_EQ(groups.groupEnd(2), groups.indices() + groups.size());
+    
+    size_t total = 0;
+    for (size_t c = 0; c < groups.groupCount(); c++)
+    {
+        EXPECT_EQ(groups.groupEnd(c) - groups.groupBegin(c), groups.groupSize(c));
+        total += groups.groupSize(c);
+        
+        size_t previous = 0;
+        for (const size_t* index = groups.groupBegin(c); index != groups.groupEnd(c); index++)
+        {
+            EXPECT_EQ(records[*index].caseIndex(), c);
+            if (index != groups.groupBegin(c))
+            {
+                EXPECT_LT(previous, *index);
+            }
+            previous = *index;
+        }
+    }
+    EXPECT_EQ(total, records.size());
+    
+    // reuse with smaller batch
+    groups.assign(records.data(), 3);
+    EXPECT_EQ(groups.size(), 3);
+    EXPECT_EQ(groups.groupSize(0), 1);
+    EXPECT_EQ(groups.groupSize(1), 1);
+    EXPECT_EQ(groups.groupSize(2), 1);
+    
+    groups.assign(records.data(), 0);
+    EXPECT_EQ(groups.size(), 0);
+    EXPECT_EQ(groups.groupSize(1), 0);
+}
+
+TEST(Batch, ForEachCase)
+{
+    const auto records = MakeRecords(1000);
+    
+    std::vector<RecordType> visited;
+    std::vector<int> numbers;
+    const auto matcher = Record::matcher<void>()
+    .ifCase<RecordType::Number>([&] (const int value) {
+        visited.push_back(RecordType::Number);
+        numbers.push_back(value);
+    })
+    .ifCase<RecordType::Text>([&] (const std::string&) {
+        visited.push_back(RecordType::Text);
+    })
+    .ifCase<RecordType::Empty>([&] {
+        visited.push_back(RecordType::Empty);
+    });
+    
+    asenum::groupedForEachCase(records.data(), records.size(), matcher);
+    
+    ASSERT_EQ(visited.size(), records.size());
+    EXPECT_TRUE(std::is_sorted(visited.begin(), visited.end()));
+    EXPECT_TRUE(std::is_sorted(numbers.begin(), numbers.end()));
+}
+
+TEST(Batch, Map)
+{
+    const auto records = MakeRecords(1000);
+    
+    std::vector<long long> grouped(records.size());
+    asenum::groupedMap(records.data(), records.size(), g_measure, grouped.data());
+    
+    for (size_t i = 0; i < records.size(); i++)
+    {
+        EXPECT_EQ(grouped[i], g_measure(records[i]));
+    }
+}
+
+TEST(Batch, Map_GroupedOrder)
+{
+    const auto records = MakeRecords(1000);
+    
+    asenum::CaseGroups groups;
+    groups.assign(records.data(), records.size());
+    
+    std::vector<long long> grouped(records.size());
+    asenum::groupedMap(groups, records.data(), g_measure, grouped.data(), asenum::BatchOrder::Grouped);
+    
+    for (size_t k = 0; k < groups.size(); k++)
+    {
+        EXPECT_EQ(grouped[k], g_measure(records[groups.indices()[k]]));
+    }
+}
+
+TEST(Batch, Map_Empty)
+{
+    std::vector<long long> output;
+    asenum::groupedMap(static_cast<const Record*>(nullptr), 0, g_measure, output.data());
+    
+    asenum::CaseGroups groups;
+    asenum::groupedMap(groups, static_cast<const Record*>(nullptr), g_measure, output.data());
+}
+
+TEST(Batch, MismatchedGroups)
+{
+    using Other = asenum::AsEnum<
+    asenum::Case11<RecordType, RecordType::Number, int>,
+    asenum::Case11<RecordType, RecordType::Text, std::string>
+    >;
+    
+    const std::vector<Other> others = { Other::create<RecordType::Number>(1) };
+    asenum::CaseGroups groups;
+    groups.assign(others.data(), others.size());
+    
+    const auto records = MakeRecords(1);
+    long long output = 0;
+    EXPECT_ASENUM_ERROR(asenum::groupedMap(groups, records.data(), g_measure, &output), std::invalid_argument);
+}
+
+TEST(Batch, MismatchedGroups_Empty)
+{
+    asenum::CaseGroups groups;
+    groups.assign(static_cast<const WideEnum*>(nullptr), 0);
+    EXPECT_EQ(groups.size(), 0);
+    EXPECT_EQ(groups.groupCount(), 6);
+    
+    long long output = 0;
+    EXPECT_ASENUM_ERROR(asenum::groupedMap(groups, static_cast<const Record*>(nullptr), g_measure, &output), std::invalid_argument);
+    EXPECT_ASENUM_ERROR(asenum::groupedForEachCase(groups, static_cast<const Record*>(nullptr), g_measure), std::invalid_argument);
+}
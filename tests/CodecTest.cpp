@@ -0,0 +1,183 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Alkenso (Vladimir Vashurkin)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <asenum/flat_hash.h>
+#include <asenum/codec.h>
+
+#include <gmock/gmock.h>
+
+#include "TestUtils.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace
+{
+    enum class EventType : int16_t
+    {
+        Position = -2,
+        Name = 1,
+        Samples = 300,
+        Label = 7,
+        Stop = 5
+    };
+    
+    struct Point
+    {
+        double x;
+        double y;
+        
+        bool operator==(const Point& other) const { return x == other.x && y == other.y; }
+    };
+    
+    /// Not trivially copyable: serialized with user-provided serializer.
+    struct Label
+    {
+        std::string text;
+        
+        bool operator==(const Label& other) const { return text == other.text; }
+    };
+    
+    using Event = asenum::AsEnum<
+    asenum::Case11<EventType, EventType::Position, Point>,
+    asenum::Case11<EventType, EventType::Name, std::string>,
+    asenum::Case11<EventType, EventType::Samples, std::vector<float>>,
+    asenum::Case11<EventType, EventType::Label, Label>,
+    asenum::Case11<EventType, EventType::Stop, void>
+    >;
+    
+    /// The same enum with fewer cases: decoder of older version.
+    using OldEvent = asenum::AsEnum<
+    asenum::Case11<EventType, EventType::Position, Point>,
+    asenum::Case11<EventType, EventType::Stop, void>
+    >;
+}
+
+namespace asenum
+{
+    template <>
+    struct Serializer<Label>
+    {
+        static void write(BinaryWriter& writer, const Label& value) { writer.writeValue(value.text); }
+        static Label read(BinaryReader& reader) { return Label { reader.readValue<std::string>() }; }
+    };
+}
+
+TEST(Codec, RoundTrip)
+{
+    const std::vector<Event> events = {
+        Event::create<EventType::Position>(Point { 1.5, -2 }),
+        Event::create<EventType::Name>("name"),
+        Event::create<EventType::Samples>(std::vector<float>({ 1, 2, 3 })),
+        Event::create<EventType::Label>(Label { "label" }),
+        Event::create<EventType::Stop>(),
+        Event::create<EventType::Name>(""),
+    };
+    
+    std::vector<uint8_t> buffer;
+    asenum::BinaryWriter writer(buffer);
+    for (const Event& event : events)
+    {
+        writer.write(event);
+    }
+    
+    // Zigzag tag of -2 (1 byte) + 16 bytes of Point.
+    EXPECT_EQ(buffer[0], 3);
+    // 'void' case is encoded as tag only: Stop (10) is followed by Name (2).
+    const size_t stopOffset = 17 + (1 + 1 + 4) + (2 + 1 + 12) + (1 + 1 + 5);
+    EXPECT_EQ(buffer[stopOffset], 10);
+    EXPECT_EQ(buffer[stopOffset + 1], 2);
+    
+    asenum::BinaryReader reader(buffer.data(), buffer.size());
+    for (const Event& event : events)
+    {
+        ASSERT_FALSE(reader.atEnd());
+        EXPECT_EQ(reader.read<Event>(), event);
+    }
+    EXPECT_TRUE(reader.atEnd());
+}
+
+TEST(Codec, Malformed)
+{
+    std::vector<uint8_t> buffer;
+    asenum::BinaryWriter writer(buffer);
+    writer.write(Event::create<EventType::Name>("name"));
+    
+    // Truncated payload.
+    asenum::BinaryReader truncated(buffer.data(), buffer.size() - 1);
+    EXPECT_ASENUM_ERROR(truncated.read<Event>(), std::out_of_range);
+    
+    // Case is unknown to decoder.
+    asenum::BinaryReader unknown(buffer.data(), buffer.size());
+    EXPECT_ASENUM_ERROR(unknown.read<OldEvent>(), std::invalid_argument);
+    
+    const std::vector<uint8_t> longVarint(11, 0xFF);
+    asenum::BinaryReader overflow(longVarint.data(), longVarint.size());
+    EXPECT_ASENUM_ERROR(overflow.readVarint(), std::invalid_argument);
+    
+    // 10th byte of varint may hold only the highest bit of uint64_t.
+    std::vector<uint8_t> wideVarint(9, 0xFF);
+    wideVarint.push_back(0x01);
+    asenum::BinaryReader maxVarint(wideVarint.data(), wideVarint.size());
+    EXPECT_EQ(maxVarint.readVarint(), UINT64_MAX);
+    wideVarint.back() = 0x02;
+    asenum::BinaryReader wideOverflow(wideVarint.data(), wideVarint.size());
+    EXPECT_ASENUM_ERROR(wideOverflow.readVarint(), std::invalid_argument);
+    
+    // Tag is out of range of enum, but its truncated value is a known case.
+    std::vector<uint8_t> wideTag;
+    asenum::BinaryWriter wideWriter(wideTag);
+    wideWriter.writeVarint(asenum::details::EncodeCaseTag(EventType::Name) + (0x10000 << 1));
+    asenum::BinaryReader wide(wideTag.data(), wideTag.size());
+    EXPECT_ASENUM_ERROR(wide.read<Event>(), std::invalid_argument);
+    
+    // Vector length exceeds buffer.
+    std::vector<uint8_t> hugeVector;
+    asenum::BinaryWriter hugeWriter(hugeVector);
+    hugeWriter.writeVarint(asenum::details::EncodeCaseTag(EventType::Samples));
+    hugeWriter.writeVarint(1ULL << 60);
+    asenum::BinaryReader huge(hugeVector.data(), hugeVector.size());
+    EXPECT_ASENUM_ERROR(huge.read<Event>(), std::out_of_range);
+}
+
+TEST(Codec, BoolAndEnum)
+{
+    std::vector<uint8_t> buffer;
+    asenum::BinaryWriter writer(buffer);
+    writer.writeValue(true);
+    writer.writeValue(false);
+    writer.writeValue(EventType::Samples);
+    ASSERT_EQ(buffer.size(), 1 + 1 + sizeof(int16_t));
+    
+    asenum::BinaryReader reader(buffer.data(), buffer.size());
+    EXPECT_TRUE(reader.readValue<bool>());
+    EXPECT_FALSE(reader.readValue<bool>());
+    EXPECT_EQ(reader.readValue<EventType>(), EventType::Samples);
+    EXPECT_TRUE(reader.atEnd());
+    
+    // Bytes other than 0 and 1 are not valid bool.
+    const uint8_t invalid = 2;
+    asenum::BinaryReader invalidReader(&invalid, sizeof(invalid));
+    EXPECT_ASENUM_ERROR(invalidReader.readValue<bool>(), std::invalid_argument);
+}
@@ -0,0 +1,211 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Alkenso (Vladimir Vashurkin)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <asenum/flat_hash.h>
+
+#include <gmock/gmock.h>
+
+#include <stdexcept>
+#include <string>
+
+namespace
+{
+    enum class HashEnum
+    {
+        Number,
+        Text,
+        Empty
+    };
+    
+    using HashAsEnum = asenum::AsEnum<
+    asenum::Case11<HashEnum, HashEnum::Number, int>,
+    asenum::Case11<HashEnum, HashEnum::Text, std::string>,
+    asenum::Case11<HashEnum, HashEnum::Empty, void>
+    >;
+    
+    /// Forces all values into single probe sequence.
+    struct CollidingHash
+    {
+        size_t operator()(const HashAsEnum&) const { return 0; }
+    };
+}
+
+TEST(FlatHashSet, InsertFindErase)
+{
+    asenum::FlatHashSet<HashAsEnum> set;
+    EXPECT_TRUE(set.empty());
+    
+    EXPECT_TRUE(set.insert(HashAsEnum::create<HashEnum::Number>(1)));
+    EXPECT_TRUE(set.insert(HashAsEnum::create<HashEnum::Text>("1")));
+    EXPECT_TRUE(set.insert(HashAsEnum::create<HashEnum::Empty>()));
+    EXPECT_FALSE(set.insert(HashAsEnum::create<HashEnum::Number>(1)));
+    EXPECT_FALSE(set.insert(HashAsEnum::create<HashEnum::Empty>()));
+    EXPECT_EQ(set.size(), 3);
+    
+    EXPECT_TRUE(set.contains(HashAsEnum::create<HashEnum::Text>("1")));
+    EXPECT_FALSE(set.contains(HashAsEnum::create<HashEnum::Text>("2")));
+    EXPECT_FALSE(set.contains(HashAsEnum::create<HashEnum::Number>(2)));
+    
+    EXPECT_TRUE(set.erase(HashAsEnum::create<HashEnum::Number>(1)));
+    EXPECT_FALSE(set.erase(HashAsEnum::create<HashEnum::Number>(1)));
+    EXPECT_FALSE(set.contains(HashAsEnum::create<HashEnum::Number>(1)));
+    EXPECT_EQ(set.size(), 2);
+    
+    size_t visited = 0;
+    set.forEach([&visited] (const HashAsEnum&) {
+        visited++;
+    });
+    EXPECT_EQ(visited, 2);
+    
+    set.clear();
+    EXPECT_TRUE(set.empty());
+    EXPECT_FALSE(set.contains(HashAsEnum::create<HashEnum::Empty>()));
+}
+
+TEST(FlatHashSet, Collisions)
+{
+    asenum::FlatHashSet<HashAsEnum, CollidingHash> set;
+    
+    for (int i = 0; i < 100; i++)
+    {
+        EXPECT_TRUE(set.insert(HashAsEnum::create<HashEnum::Number>(i)));
+    }
+    
+    // Deleted slots must not break probe sequence of the rest values.
+    for (int i = 0; i < 100; i += 2)
+    {
+        EXPECT_TRUE(set.erase(HashAsEnum::create<HashEnum::Number>(i)));
+    }
+    
+    for (int i = 0; i < 100; i++)
+    {
+        EXPECT_EQ(set.contains(HashAsEnum::create<HashEnum::Number>(i)), i % 2 == 1);
+    }
+    EXPECT_EQ(set.size(), 50);
+}
+
+TEST(FlatHashMap, Aggregate)
+{
+    asenum::FlatHashMap<HashAsEnum, int> counters;
+    
+    for (int i = 0; i < 1000; i++)
+    {
+        counters[HashAsEnum::create<HashEnum::Number>(i % 10)]++;
+        counters[HashAsEnum::create<HashEnum::Empty>()]++;
+    }
+    
+    EXPECT_EQ(counters.size(), 11);
+    ASSERT_NE(counters.find(HashAsEnum::create<HashEnum::Number>(3)), nullptr);
+    EXPECT_EQ(*counters.find(HashAsEnum::create<HashEnum::Number>(3)), 100);
+    EXPECT_EQ(*counters.find(HashAsEnum::create<HashEnum::Empty>()), 1000);
+    EXPECT_EQ(counters.find(HashAsEnum::create<HashEnum::Text>("3")), nullptr);
+    
+    EXPECT_TRUE(counters.emplace(HashAsEnum::create<HashEnum::Text>("text"), 5));
+    EXPECT_FALSE(counters.emplace(HashAsEnum::create<HashEnum::Text>("text"), 6));
+    EXPECT_EQ(*counters.find(HashAsEnum::create<HashEnum::Text>("text")), 5);
+    
+    const asenum::FlatHashMap<HashAsEnum, int> copy = counters;
+    EXPECT_EQ(copy.size(), counters.size());
+    
+    int total = 0;
+    copy.forEach([&total] (const HashAsEnum&, const int value) {
+        total += value;
+    });
+    EXPECT_EQ(total, 2005);
+    
+    asenum::FlatHashMap<HashAsEnum, int> moved = std::move(counters);
+    EXPECT_EQ(moved.size(), 12);
+    EXPECT_TRUE(moved.erase(HashAsEnum::create<HashEnum::Empty>()));
+    EXPECT_EQ(moved.size(), 11);
+}
+
+#if defined(ASENUM_HAS_EXCEPTIONS)
+namespace
+{
+    /// Counts live instances; copy throws once 'copiesLeft' is exhausted. Has no move, so slots are always copied.
+    struct ThrowingValue
+    {
+        explicit ThrowingValue(int v) : value(v) { alive++; }
+        ThrowingValue(const ThrowingValue& other) : value(other.value)
+        {
+            if (copiesLeft-- == 0)
+            {
+                throw std::runtime_error("copy failed");
+            }
+            alive++;
+        }
+        ~ThrowingValue() { alive--; }
+        
+        int value;
+        
+        static int alive;
+        static int copiesLeft;
+    };
+    
+    int ThrowingValue::alive = 0;
+    int ThrowingValue::copiesLeft = 0;
+    
+    using ThrowingMap = asenum::FlatHashMap<HashAsEnum, ThrowingValue>;
+    
+    void ExpectIntact(const ThrowingMap& map, const int count)
+    {
+        EXPECT_EQ(map.size(), count);
+        EXPECT_EQ(ThrowingValue::alive, count);
+        for (int i = 0; i < count; i++)
+        {
+            const ThrowingValue* const value = map.find(HashAsEnum::create<HashEnum::Number>(i));
+            ASSERT_NE(value, nullptr);
+            EXPECT_EQ(value->value, i);
+        }
+    }
+}
+
+TEST(FlatHashMap, ThrowingCopy)
+{
+    {
+        ThrowingValue::copiesLeft = 100;
+        ThrowingMap map;
+        for (int i = 0; i < 5; i++)
+        {
+            EXPECT_TRUE(map.emplace(HashAsEnum::create<HashEnum::Number>(i), i));
+        }
+        ExpectIntact(map, 5);
+        
+        // Copy constructor destroys slots copied before the failure.
+        ThrowingValue::copiesLeft = 2;
+        EXPECT_THROW(ThrowingMap copy = map, std::runtime_error);
+        ExpectIntact(map, 5);
+        
+        // Failed rehash leaves the table untouched.
+        ThrowingValue::copiesLeft = 2;
+        EXPECT_THROW(map.reserve(100), std::runtime_error);
+        ExpectIntact(map, 5);
+        
+        ThrowingValue::copiesLeft = 100;
+        map.reserve(100);
+        ExpectIntact(map, 5);
+    }
+    
+    EXPECT_EQ(ThrowingValue::alive, 0);
+}
+#endif
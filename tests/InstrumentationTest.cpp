@@ -0,0 +1,221 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Alkenso (Vladimir Vashurkin)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+// Built as separate 'asenum_instrumentation_tests' target with 'ASENUM_INSTRUMENTATION' defined.
+#include <asenum/asenum.h>
+#include <asenum/instrumentation.h>
+
+#include <gmock/gmock.h>
+
+#include <string>
+#include <thread>
+#include <typeinfo>
+#include <vector>
+
+namespace
+{
+    enum class Metric
+    {
+        Count,
+        Label,
+        Unknown
+    };
+    
+    using MetricAsEnum = asenum::AsEnum<
+    asenum::Case11<Metric, Metric::Count, int>,
+    asenum::Case11<Metric, Metric::Label, std::string>,
+    asenum::Case11<Metric, Metric::Unknown, void>
+    >;
+    
+    static_assert(MetricAsEnum::storesInline<Metric::Count>(), "Int should be stored inline");
+    static_assert(!MetricAsEnum::storesInline<Metric::Label>(), "String should be allocated on the heap");
+    
+    constexpr size_t CountIndex = 0;
+    constexpr size_t LabelIndex = 1;
+    constexpr size_t UnknownIndex = 2;
+    
+    uint64_t Counter(const asenum::AsEnumCounters& counters, const size_t index, const asenum::InstrumentationCounter counter)
+    {
+        return counters.cases.at(index)[counter];
+    }
+}
+
+TEST(Instrumentation, Create)
+{
+    asenum::ResetInstrumentation();
+    
+    const auto count1 = MetricAsEnum::create<Metric::Count>(1);
+    const auto count2 = MetricAsEnum::create<Metric::Count>(2);
+    const auto label = MetricAsEnum::create<Metric::Label>("label");
+    const auto unknown = MetricAsEnum::create<Metric::Unknown>();
+    
+    const asenum::AsEnumCounters counters = asenum::InstrumentationSnapshot<MetricAsEnum>();
+    EXPECT_STREQ(counters.typeName, typeid(MetricAsEnum).name());
+    ASSERT_EQ(counters.cases.size(), 3);
+    EXPECT_EQ(counters.cases[CountIndex].code, static_cast<int64_t>(Metric::Count));
+    EXPECT_EQ(counters.cases[UnknownIndex].code, static_cast<int64_t>(Metric::Unknown));
+    
+    EXPECT_EQ(Counter(counters, CountIndex, asenum::InstrumentationCounter::Created), 2);
+    EXPECT_EQ(Counter(counters, LabelIndex, asenum::InstrumentationCounter::Created), 1);
+    EXPECT_EQ(Counter(counters, UnknownIndex, asenum::InstrumentationCounter::Created), 1);
+    
+    EXPECT_EQ(Counter(counters, CountIndex, asenum::InstrumentationCounter::AllocatedBytes), 0);
+    EXPECT_EQ(Counter(counters, LabelIndex, asenum::InstrumentationCounter::AllocatedBytes), sizeof(std::string));
+    EXPECT_EQ(Counter(counters, UnknownIndex, asenum::InstrumentationCounter::AllocatedBytes), 0);
+}
+
+TEST(Instrumentation, Copy)
+{
+    const auto count = MetricAsEnum::create<Metric::Count>(1);
+    const auto label = MetricAsEnum::create<Metric::Label>("label");
+    
+    asenum::ResetInstrumentation();
+    
+    const MetricAsEnum countCopy = count;
+    const MetricAsEnum labelCopy = label;
+    MetricAsEnum assigned = count;
+    assigned = label;
+    
+    // Moves are not counted.
+    MetricAsEnum moved = std::move(assigned);
+    
+    const asenum::AsEnumCounters counters = asenum::InstrumentationSnapshot<MetricAsEnum>();
+    EXPECT_EQ(Counter(counters, CountIndex, asenum::InstrumentationCounter::Copied), 2);
+    EXPECT_EQ(Counter(counters, CountIndex, asenum::InstrumentationCounter::SharedCopies), 0);
+    EXPECT_EQ(Counter(counters, LabelIndex, asenum::InstrumentationCounter::Copied), 2);
+    EXPECT_EQ(Counter(counters, LabelIndex, asenum::InstrumentationCounter::SharedCopies), 2);
+    
+    EXPECT_EQ(Counter(counters, CountIndex, asenum::InstrumentationCounter::Created), 0);
+    EXPECT_EQ(Counter(counters, LabelIndex, asenum::InstrumentationCounter::Created), 0);
+}
+
+TEST(Instrumentation, Dispatch)
+{
+    const auto count = MetricAsEnum::create<Metric::Count>(1);
+    const auto label = MetricAsEnum::create<Metric::Label>("label");
+    
+    asenum::ResetInstrumentation();
+    
+    EXPECT_TRUE(count.ifCase<Metric::Count>([] (int) {}));
+    EXPECT_FALSE(count.ifCase<Metric::Label>([] (const std::string&) {}));
+    
+    label.doSwitch()
+    .ifCase<Metric::Count>([] (int) {})
+    .ifCase<Metric::Label>([] (const std::string&) {})
+    .ifDefault([] {});
+    
+    const int mapped = count.doMap<int>()
+    .ifCase<Metric::Count>([] (int value) { return value; })
+    .ifDefault([] { return 0; });
+    EXPECT_EQ(mapped, 1);
+    
+    // Default handlers are not counted as case hits.
+    MetricAsEnum::create<Metric::Unknown>().doSwitch()
+    .ifCase<Metric::Count>([] (int) {})
+    .ifDefault([] {});
+    
+    MetricAsEnum consumed = label;
+    std::move(consumed).doSwitch()
+    .ifCase<Metric::Label>([] (std::string&&) {})
+    .ifDefault([] {});
+    
+    const asenum::AsEnumCounters counters = asenum::InstrumentationSnapshot<MetricAsEnum>();
+    
+    // 'ifCase' hits include ones made by 'doSwitch' and 'doMap'.
+    EXPECT_EQ(Counter(counters, CountIndex, asenum::InstrumentationCounter::IfCaseHits), 2);
+    EXPECT_EQ(Counter(counters, LabelIndex, asenum::InstrumentationCounter::IfCaseHits), 2);
+    EXPECT_EQ(Counter(counters, UnknownIndex, asenum::InstrumentationCounter::IfCaseHits), 0);
+    
+    EXPECT_EQ(Counter(counters, CountIndex, asenum::InstrumentationCounter::SwitchHits), 0);
+    EXPECT_EQ(Counter(counters, LabelIndex, asenum::InstrumentationCounter::SwitchHits), 2);
+    EXPECT_EQ(Counter(counters, UnknownIndex, asenum::InstrumentationCounter::SwitchHits), 0);
+    
+    EXPECT_EQ(Counter(counters, CountIndex, asenum::InstrumentationCounter::MapHits), 1);
+    EXPECT_EQ(Counter(counters, LabelIndex, asenum::InstrumentationCounter::MapHits), 0);
+}
+
+TEST(Instrumentation, Threads)
+{
+    asenum::ResetInstrumentation();
+    
+    constexpr size_t ThreadCount = 4;
+    constexpr size_t Iterations = 1000;
+    
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < ThreadCount; i++)
+    {
+        threads.emplace_back([] {
+            for (size_t j = 0; j < Iterations; j++)
+            {
+                const auto value = MetricAsEnum::create<Metric::Count>(static_cast<int>(j));
+                value.ifCase<Metric::Count>([] (int) {});
+            }
+        });
+    }
+    
+    // Reading while threads are running is allowed.
+    const asenum::AsEnumCounters running = asenum::InstrumentationSnapshot<MetricAsEnum>();
+    EXPECT_LE(Counter(running, CountIndex, asenum::InstrumentationCounter::Created), ThreadCount * Iterations);
+    
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    
+    // Counters of exited threads are kept.
+    const asenum::AsEnumCounters counters = asenum::InstrumentationSnapshot<MetricAsEnum>();
+    EXPECT_EQ(Counter(counters, CountIndex, asenum::InstrumentationCounter::Created), ThreadCount * Iterations);
+    EXPECT_EQ(Counter(counters, CountIndex, asenum::InstrumentationCounter::IfCaseHits), ThreadCount * Iterations);
+}
+
+TEST(Instrumentation, SnapshotAll)
+{
+    MetricAsEnum::create<Metric::Label>("label");
+    
+    bool found = false;
+    for (const asenum::AsEnumCounters& counters : asenum::InstrumentationSnapshot())
+    {
+        if (std::string(counters.typeName) == typeid(MetricAsEnum).name())
+        {
+            found = true;
+            EXPECT_GT(Counter(counters, LabelIndex, asenum::InstrumentationCounter::Created), 0);
+        }
+    }
+    EXPECT_TRUE(found);
+    
+    asenum::ResetInstrumentation();
+    
+    const asenum::AsEnumCounters counters = asenum::InstrumentationSnapshot<MetricAsEnum>();
+    for (const asenum::CaseCounters& caseCounters : counters.cases)
+    {
+        for (const uint64_t value : caseCounters.values)
+        {
+            EXPECT_EQ(value, 0);
+        }
+    }
+    
+    EXPECT_STREQ(asenum::InstrumentationCounterName(asenum::InstrumentationCounter::Created), "created");
+    EXPECT_STREQ(asenum::InstrumentationCounterName(asenum::InstrumentationCounter::MapHits), "map_hits");
+}
@@ -0,0 +1,122 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Alkenso (Vladimir Vashurkin)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <asenum/flat_hash.h>
+#include <asenum/asenum.h>
+#include <asenum/parallel.h>
+
+#include <gmock/gmock.h>
+
+#include "TestUtils.h"
+
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+    using testutils::Record;
+    using testutils::RecordType;
+    
+    /// Cases are interleaved evenly.
+    std::vector<Record> MakeRecords(const size_t count)
+    {
+        return testutils::MakeRecords(count, [] (const size_t i) {
+            return static_cast<RecordType>(i % 3);
+        });
+    }
+}
+
+TEST(Parallel, Map)
+{
+    const auto records = MakeRecords(100000);
+    const auto matcher = Record::matcher<long long>()
+    .ifCase<RecordType::Number>([] (const int value) {
+        return value;
+    })
+    .ifCase<RecordType::Text>([] (const std::string& value) {
+        return -static_cast<long long>(value.size());
+    })
+    .ifCase<RecordType::Empty>([] {
+        return 0;
+    });
+    
+    for (const size_t threads : { 1, 4 })
+    {
+        asenum::ThreadPool pool(threads);
+        EXPECT_EQ(pool.threadCount(), threads);
+        
+        // Pool is reused for several batches.
+        const std::vector<size_t> counts = { 0, 10, records.size() };
+        for (const size_t count : counts)
+        {
+            std::vector<long long> output(count, 42);
+            asenum::parallelMap(pool, records.data(), count, matcher, output.data());
+            for (size_t i = 0; i < count; i++)
+            {
+                ASSERT_EQ(output[i], matcher(records[i])) << "index " << i;
+            }
+        }
+    }
+}
+
+TEST(Parallel, ForEachCase)
+{
+    const auto records = MakeRecords(100000);
+    
+    std::atomic<size_t> numbers(0);
+    std::atomic<size_t> others(0);
+    const auto matcher = Record::matcher<void>()
+    .ifCase<RecordType::Number>([&numbers] (const int) {
+        numbers++;
+    })
+    .ifDefault([&others] {
+        others++;
+    });
+    
+    asenum::ThreadPool pool(4);
+    asenum::parallelForEachCase(pool, records.data(), records.size(), matcher);
+    EXPECT_EQ(numbers.load(), (records.size() + 2) / 3);
+    EXPECT_EQ(numbers.load() + others.load(), records.size());
+}
+
+#if defined(ASENUM_HAS_EXCEPTIONS)
+TEST(Parallel, Exception)
+{
+    asenum::ThreadPool pool(4);
+    EXPECT_THROW(pool.parallelFor(100000, 100, [] (const size_t begin, size_t) {
+        if (begin == 5000)
+        {
+            throw std::runtime_error("failure");
+        }
+    }), std::runtime_error);
+    
+    // Pool is usable after failed batch.
+    std::atomic<size_t> processed(0);
+    pool.parallelFor(100000, 100, [&processed] (const size_t begin, const size_t end) {
+        processed += end - begin;
+    });
+    EXPECT_EQ(processed.load(), 100000);
+}
+#endif
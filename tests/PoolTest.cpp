@@ -0,0 +1,204 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Alkenso (Vladimir Vashurkin)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <asenum/pool.h>
+
+#include <gmock/gmock.h>
+
+#include <array>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    enum class PoolEnum
+    {
+        Text,
+        Numbers,
+        Empty
+    };
+    
+    using PoolAsEnum = asenum::PooledAsEnum<
+    asenum::Case11<PoolEnum, PoolEnum::Text, std::string>,
+    asenum::Case11<PoolEnum, PoolEnum::Numbers, std::array<int, 16>>,
+    asenum::Case11<PoolEnum, PoolEnum::Empty, void>
+    >;
+    
+    static_assert(!PoolAsEnum::storesInline<PoolEnum::Text>(), "String should be allocated from the pool");
+    static_assert(!PoolAsEnum::storesInline<PoolEnum::Numbers>(), "Array should be allocated from the pool");
+    
+    struct Block
+    {
+        char data[40];
+    };
+    
+    /// Byte-aligned type whose size is not multiple of free list link alignment.
+    struct OddBlock
+    {
+        char data[25];
+    };
+    
+    struct LateBlock
+    {
+        char data[40];
+    };
+    
+    /// Thread-local holder that outlives thread-local pool cache: it is constructed first, so destroyed last.
+    struct LateHolder
+    {
+        ~LateHolder()
+        {
+            for (LateBlock* block : blocks)
+            {
+                asenum::PoolAllocator<LateBlock>().deallocate(block, 1);
+            }
+        }
+        
+        std::vector<LateBlock*> blocks;
+    };
+}
+
+TEST(PoolAllocator, ReusesBlocks)
+{
+    asenum::PoolAllocator<Block> allocator;
+    
+    Block* const first = allocator.allocate(1);
+    allocator.deallocate(first, 1);
+    
+    // Freed block is on top of thread's free list.
+    Block* const second = allocator.allocate(1);
+    EXPECT_EQ(first, second);
+    
+    std::set<Block*> blocks;
+    for (int i = 0; i < 1000; i++)
+    {
+        Block* const block = allocator.allocate(1);
+        EXPECT_TRUE(blocks.insert(block).second);
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(block) % alignof(Block), 0);
+    }
+    
+    for (Block* block : blocks)
+    {
+        allocator.deallocate(block, 1);
+    }
+    allocator.deallocate(second, 1);
+    
+    // Arrays are not pooled.
+    Block* const array = allocator.allocate(3);
+    allocator.deallocate(array, 3);
+}
+
+TEST(PoolAllocator, OddSizedBlocksKeepLinkAlignment)
+{
+    asenum::PoolAllocator<OddBlock> allocator;
+    
+    std::vector<OddBlock*> blocks;
+    for (int i = 0; i < 200; i++)
+    {
+        blocks.push_back(allocator.allocate(1));
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(blocks.back()) % alignof(void*), 0);
+    }
+    
+    for (OddBlock* block : blocks)
+    {
+        allocator.deallocate(block, 1);
+    }
+}
+
+TEST(PoolAllocator, ReleaseAfterThreadExit)
+{
+    LateBlock* released = nullptr;
+    std::thread([&released] {
+        static thread_local LateHolder s_holder;
+        s_holder.blocks.push_back(asenum::PoolAllocator<LateBlock>().allocate(1));
+        released = s_holder.blocks.back();
+    }).join();
+    
+    // Block released after its thread's cache was destroyed goes to shared list, and new thread takes it first.
+    LateBlock* reused = nullptr;
+    std::thread([&reused] {
+        asenum::PoolAllocator<LateBlock> allocator;
+        reused = allocator.allocate(1);
+        allocator.deallocate(reused, 1);
+    }).join();
+    EXPECT_EQ(reused, released);
+}
+
+TEST(PooledAsEnum, CreateCopyDestroy)
+{
+    const PoolAsEnum text = PoolAsEnum::create<PoolEnum::Text>("some long string that is stored on the heap");
+    const PoolAsEnum copy = text;
+    EXPECT_EQ(copy, text);
+    EXPECT_EQ(copy.forceAsCase<PoolEnum::Text>(), "some long string that is stored on the heap");
+    
+    std::array<int, 16> numbers {};
+    numbers[5] = 5;
+    const PoolAsEnum array = PoolAsEnum::create<PoolEnum::Numbers>(numbers);
+    EXPECT_EQ(array.forceAsCase<PoolEnum::Numbers>()[5], 5);
+    
+    EXPECT_TRUE(PoolAsEnum::create<PoolEnum::Empty>().isCase<PoolEnum::Empty>());
+}
+
+TEST(PooledAsEnum, CrossThreadRelease)
+{
+    constexpr int Count = 10000;
+    
+    // Values created by one thread and released by another: released blocks must migrate back through shared list.
+    std::vector<PoolAsEnum> values;
+    values.reserve(Count);
+    std::thread producer([&values] {
+        for (int i = 0; i < Count; i++)
+        {
+            values.push_back(PoolAsEnum::create<PoolEnum::Text>(std::to_string(i)));
+        }
+    });
+    producer.join();
+    
+    std::thread consumer([&values] {
+        for (int i = 0; i < Count; i++)
+        {
+            EXPECT_EQ(values[i].forceAsCase<PoolEnum::Text>(), std::to_string(i));
+        }
+        values.clear();
+    });
+    consumer.join();
+    
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++)
+    {
+        threads.emplace_back([] {
+            for (int i = 0; i < Count; i++)
+            {
+                const PoolAsEnum value = PoolAsEnum::create<PoolEnum::Text>(std::to_string(i));
+                EXPECT_EQ(value.forceAsCase<PoolEnum::Text>(), std::to_string(i));
+            }
+        });
+    }
+    
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+}
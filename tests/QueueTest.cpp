@@ -0,0 +1,241 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Alkenso (Vladimir Vashurkin)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <asenum/queue.h>
+
+#include <gmock/gmock.h>
+
+#include "TestUtils.h"
+
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    enum class Event
+    {
+        Tick,
+        Text,
+        Stop
+    };
+    
+    using EventAsEnum = asenum::AsEnum<
+    asenum::Case11<Event, Event::Tick, uint64_t>,
+    asenum::Case11<Event, Event::Text, std::string>,
+    asenum::Case11<Event, Event::Stop, void>
+    >;
+    
+    using SharedEventAsEnum = asenum::AsEnum<
+    asenum::Case11<Event, Event::Tick, uint64_t>,
+    asenum::Case11<Event, Event::Text, std::shared_ptr<int>>,
+    asenum::Case11<Event, Event::Stop, void>
+    >;
+}
+
+TEST(AsEnumQueue, PushPop)
+{
+    asenum::AsEnumQueue<EventAsEnum> queue(3);
+    EXPECT_EQ(queue.capacity(), 4);
+    
+    EXPECT_TRUE(queue.tryPush(EventAsEnum::create<Event::Tick>(1)));
+    EXPECT_TRUE(queue.tryPush(EventAsEnum::create<Event::Text>(std::string(100, 'x'))));
+    
+    const EventAsEnum stop = EventAsEnum::create<Event::Stop>();
+    EXPECT_TRUE(queue.tryPush(stop));
+    EXPECT_TRUE(queue.tryPush(EventAsEnum::create<Event::Tick>(2)));
+    
+    // Rejected message is left untouched.
+    EventAsEnum rejected = EventAsEnum::create<Event::Text>(std::string(100, 'y'));
+    EXPECT_FALSE(queue.tryPush(std::move(rejected)));
+    EXPECT_EQ(rejected.forceAsCase<Event::Text>(), std::string(100, 'y'));
+    
+    EventAsEnum message = EventAsEnum::create<Event::Stop>();
+    EXPECT_TRUE(queue.tryPop(message));
+    EXPECT_EQ(message.forceAsCase<Event::Tick>(), 1);
+    EXPECT_TRUE(queue.tryPop(message));
+    EXPECT_EQ(message.forceAsCase<Event::Text>(), std::string(100, 'x'));
+    EXPECT_TRUE(queue.tryPop(message));
+    EXPECT_TRUE(message.isCase<Event::Stop>());
+    
+    // Slots are reused on the next lap.
+    EXPECT_TRUE(queue.tryPush(std::move(rejected)));
+    EXPECT_TRUE(queue.tryPop(message));
+    EXPECT_EQ(message.forceAsCase<Event::Tick>(), 2);
+    EXPECT_TRUE(queue.tryPop(message));
+    EXPECT_EQ(message.forceAsCase<Event::Text>(), std::string(100, 'y'));
+    EXPECT_FALSE(queue.tryPop(message));
+    
+    EXPECT_ASENUM_ERROR(asenum::AsEnumQueue<EventAsEnum>(0), std::invalid_argument);
+}
+
+TEST(AsEnumQueue, Drain)
+{
+    asenum::AsEnumQueue<EventAsEnum> queue(256);
+    for (uint64_t i = 0; i < 200; i++)
+    {
+        ASSERT_TRUE(queue.tryPush(i % 2 ? EventAsEnum::create<Event::Tick>(i) : EventAsEnum::create<Event::Text>(std::to_string(i))));
+    }
+    
+    uint64_t ticks = 0;
+    std::vector<std::string> texts;
+    const auto matcher = EventAsEnum::matcher<void>()
+    .ifCase<Event::Tick>([&ticks] (const uint64_t value) {
+        ticks += value;
+    })
+    .ifCase<Event::Text>([&texts] (const std::string& value) {
+        texts.push_back(value);
+    })
+    .ifCase<Event::Stop>([] {});
+    
+    EXPECT_EQ(queue.drain(matcher, 10), 10);
+    EXPECT_EQ(texts.size(), 5);
+    EXPECT_EQ(texts.front(), "0");
+    
+    EXPECT_EQ(queue.drain(matcher), 190);
+    EXPECT_EQ(queue.drain(matcher), 0);
+    EXPECT_EQ(ticks, 100 * 100);
+    EXPECT_EQ(texts.size(), 100);
+    EXPECT_EQ(texts.back(), "198");
+}
+
+#if defined(ASENUM_HAS_EXCEPTIONS)
+TEST(AsEnumQueue, Drain_Exception)
+{
+    asenum::AsEnumQueue<EventAsEnum> queue(16);
+    for (uint64_t i = 0; i < 10; i++)
+    {
+        ASSERT_TRUE(queue.tryPush(EventAsEnum::create<Event::Tick>(i)));
+    }
+    
+    EXPECT_THROW(queue.drain([] (const EventAsEnum& event) {
+        if (event.forceAsCase<Event::Tick>() == 3)
+        {
+            throw std::runtime_error("failure");
+        }
+    }), std::runtime_error);
+    
+    // Rest of claimed batch is discarded, queue stays usable.
+    EXPECT_EQ(queue.drain([] (const EventAsEnum&) {}), 0);
+    for (uint64_t i = 0; i < 16; i++)
+    {
+        ASSERT_TRUE(queue.tryPush(EventAsEnum::create<Event::Tick>(i)));
+    }
+    EXPECT_EQ(queue.drain([] (const EventAsEnum&) {}), 16);
+}
+#endif
+
+TEST(AsEnumQueue, DestroysMessages)
+{
+    const auto payload = std::make_shared<int>(42);
+    {
+        asenum::AsEnumQueue<SharedEventAsEnum> queue(8);
+        for (int i = 0; i < 5; i++)
+        {
+            ASSERT_TRUE(queue.tryPush(SharedEventAsEnum::create<Event::Text>(payload)));
+        }
+        
+        SharedEventAsEnum message = SharedEventAsEnum::create<Event::Stop>();
+        ASSERT_TRUE(queue.tryPop(message));
+        EXPECT_EQ(payload.use_count(), 6);
+    }
+    EXPECT_EQ(payload.use_count(), 1);
+}
+
+TEST(AsEnumQueue, ConcurrentProducersAndConsumers)
+{
+    constexpr uint64_t Producers = 4;
+    constexpr uint64_t Consumers = 4;
+    constexpr uint64_t PerProducer = 50000;
+    
+    asenum::AsEnumQueue<EventAsEnum> queue(64);
+    
+    std::vector<std::thread> producers;
+    for (uint64_t producer = 0; producer < Producers; producer++)
+    {
+        producers.emplace_back([&queue, producer] {
+            for (uint64_t i = 0; i < PerProducer; i++)
+            {
+                // Tick value encodes producer and sequence number.
+                EventAsEnum event = EventAsEnum::create<Event::Tick>(producer * PerProducer + i);
+                while (!queue.tryPush(std::move(event)))
+                {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    
+    std::atomic<uint64_t> received(0);
+    std::atomic<uint64_t> sum(0);
+    std::atomic<uint64_t> reordered(0);
+    std::vector<std::thread> consumers;
+    for (uint64_t consumer = 0; consumer < Consumers; consumer++)
+    {
+        consumers.emplace_back([&] {
+            std::vector<uint64_t> last(Producers, 0);
+            std::vector<bool> seen(Producers, false);
+            const auto matcher = EventAsEnum::matcher<void>()
+            .ifCase<Event::Tick>([&] (const uint64_t value) {
+                // Messages of each producer are taken in push order.
+                const uint64_t producer = value / PerProducer;
+                if (seen[producer] && value <= last[producer])
+                {
+                    reordered++;
+                }
+                seen[producer] = true;
+                last[producer] = value;
+                sum += value;
+            })
+            .ifDefault([] {});
+            
+            while (received.load() < Producers * PerProducer)
+            {
+                const size_t count = queue.drain(matcher);
+                received += count;
+                if (!count)
+                {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    
+    for (std::thread& producer : producers)
+    {
+        producer.join();
+    }
+    for (std::thread& consumer : consumers)
+    {
+        consumer.join();
+    }
+    
+    const uint64_t total = Producers * PerProducer;
+    EXPECT_EQ(received.load(), total);
+    EXPECT_EQ(sum.load(), total * (total - 1) / 2);
+    EXPECT_EQ(reordered.load(), 0);
+}
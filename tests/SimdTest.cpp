@@ -0,0 +1,229 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Alkenso (Vladimir Vashurkin)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <asenum/flat_hash.h>
+#include <asenum/simd.h>
+
+#include <gmock/gmock.h>
+
+#include <random>
+#include <vector>
+
+namespace
+{
+    enum class TagEnum8 : uint8_t {};
+    enum class TagEnum16 : uint16_t {};
+    enum class TagEnum32 : uint32_t {};
+    enum class TagEnum64 : uint64_t {};
+    
+    enum class Dense : uint8_t
+    {
+        Success,
+        Timeout,
+        Error
+    };
+    
+    using DenseAsEnum = asenum::AsEnum<
+    asenum::Case11<Dense, Dense::Success, void>,
+    asenum::Case11<Dense, Dense::Timeout, void>,
+    asenum::Case11<Dense, Dense::Error, void>
+    >;
+    
+    enum class Sparse : int16_t
+    {
+        Negative = -2,
+        Hundred = 100,
+        TwoHundred = 200
+    };
+    
+    using SparseAsEnum = asenum::AsEnum<
+    asenum::Case11<Sparse, Sparse::Negative, void>,
+    asenum::Case11<Sparse, Sparse::Hundred, int>,
+    asenum::Case11<Sparse, Sparse::TwoHundred, void>
+    >;
+    
+    /// More cases than vector histogram handles.
+    enum class Wide : int32_t
+    {
+        A = -50, B = -10, C = 0, D = 3, E = 40, F = 41, G = 700, H = 1000, I = 123456
+    };
+    
+    using WideAsEnum = asenum::AsEnum<
+    asenum::Case11<Wide, Wide::A, void>,
+    asenum::Case11<Wide, Wide::B, void>,
+    asenum::Case11<Wide, Wide::C, void>,
+    asenum::Case11<Wide, Wide::D, void>,
+    asenum::Case11<Wide, Wide::E, void>,
+    asenum::Case11<Wide, Wide::F, void>,
+    asenum::Case11<Wide, Wide::G, void>,
+    asenum::Case11<Wide, Wide::H, void>,
+    asenum::Case11<Wide, Wide::I, void>
+    >;
+    
+    std::vector<asenum::SimdLevel> SupportedLevels()
+    {
+        std::vector<asenum::SimdLevel> levels = { asenum::SimdLevel::Scalar };
+        switch (asenum::ActiveSimdLevel())
+        {
+            case asenum::SimdLevel::AVX2:
+                levels.push_back(asenum::SimdLevel::AVX2);
+                levels.push_back(asenum::SimdLevel::SSE2);
+                break;
+            case asenum::SimdLevel::Scalar:
+                break;
+            default:
+                levels.push_back(asenum::ActiveSimdLevel());
+                break;
+        }
+        
+        return levels;
+    }
+    
+    /// Checks kernels of every supported instruction set against plain loops. Sizes cover vector tails.
+    template <typename Enum>
+    void CheckKernels()
+    {
+        using Word = typename asenum::details::TagWord<sizeof(Enum)>::type;
+        using Kernels = asenum::details::TagKernels<Word>;
+        
+        std::mt19937 generator(42);
+        std::uniform_int_distribution<int> distribution(0, 9);
+        
+        for (const size_t count : { 0, 1, 15, 31, 33, 100, 8200 })
+        {
+            std::vector<Enum> tags(count);
+            for (Enum& tag : tags)
+            {
+                tag = static_cast<Enum>(distribution(generator));
+            }
+            const Word* words = reinterpret_cast<const Word*>(tags.data());
+            
+            for (const size_t bins : { 3, 8, 12 })
+            {
+                std::vector<size_t> expectedHistogram(bins);
+                for (const Enum tag : tags)
+                {
+                    if (static_cast<size_t>(tag) < bins)
+                    {
+                        expectedHistogram[static_cast<size_t>(tag)]++;
+                    }
+                }
+                
+                for (const asenum::SimdLevel level : SupportedLevels())
+                {
+                    std::vector<size_t> histogram(bins, 100);
+                    Kernels::histogram(level, words, count, histogram.data(), bins);
+                    EXPECT_EQ(histogram, expectedHistogram) << "level " << static_cast<int>(level) << ", count " << count << ", bins " << bins;
+                }
+            }
+            
+            for (const Enum value : { static_cast<Enum>(0), static_cast<Enum>(7), static_cast<Enum>(200) })
+            {
+                std::vector<size_t> expectedIndices;
+                for (size_t i = 0; i < count; i++)
+                {
+                    if (tags[i] == value)
+                    {
+                        expectedIndices.push_back(i);
+                    }
+                }
+                
+                for (const asenum::SimdLevel level : SupportedLevels())
+                {
+                    EXPECT_EQ(Kernels::count(level, words, count, static_cast<Word>(value)), expectedIndices.size());
+                    
+                    std::vector<size_t> indices(count);
+                    indices.resize(Kernels::select(level, words, count, static_cast<Word>(value), indices.data()));
+                    EXPECT_EQ(indices, expectedIndices) << "level " << static_cast<int>(level) << ", count " << count;
+                }
+            }
+        }
+    }
+}
+
+TEST(Simd, Kernels)
+{
+    CheckKernels<TagEnum8>();
+    CheckKernels<TagEnum16>();
+    CheckKernels<TagEnum32>();
+    CheckKernels<TagEnum64>();
+}
+
+TEST(Simd, PublicInterface)
+{
+    enum class Code : uint8_t
+    {
+        Success,
+        Timeout,
+        Error
+    };
+    
+    const std::vector<Code> tags = { Code::Error, Code::Success, Code::Error, Code::Timeout, Code::Error };
+    EXPECT_EQ(asenum::countCase(tags.data(), tags.size(), Code::Error), 3);
+    EXPECT_EQ(asenum::countCase(tags.data(), tags.size(), Code::Success), 1);
+    
+    std::vector<size_t> indices(tags.size());
+    indices.resize(asenum::selectCase(tags.data(), tags.size(), Code::Error, indices.data()));
+    EXPECT_EQ(indices, std::vector<size_t>({ 0, 2, 4 }));
+    
+    size_t histogram[3] = {};
+    asenum::caseHistogram(tags.data(), tags.size(), histogram, 3);
+    EXPECT_EQ(histogram[0], 1);
+    EXPECT_EQ(histogram[1], 1);
+    EXPECT_EQ(histogram[2], 3);
+}
+
+TEST(Simd, CaseHistogram_ByCase)
+{
+    const std::vector<Dense> codes = { Dense::Error, Dense::Success, Dense::Error, Dense::Timeout, static_cast<Dense>(3) };
+    size_t codeHistogram[3] = {};
+    asenum::caseHistogram<DenseAsEnum>(codes.data(), codes.size(), codeHistogram);
+    EXPECT_EQ(codeHistogram[0], 1);
+    EXPECT_EQ(codeHistogram[1], 1);
+    EXPECT_EQ(codeHistogram[2], 2);
+    
+    // Sparse and negative values are counted in bins of their cases, unknown values are skipped.
+    std::vector<Sparse> sparse(100, Sparse::Hundred);
+    sparse[3] = Sparse::Negative;
+    sparse[50] = Sparse::TwoHundred;
+    sparse[51] = Sparse::TwoHundred;
+    sparse[99] = static_cast<Sparse>(1);
+    size_t sparseHistogram[3] = {};
+    asenum::caseHistogram<SparseAsEnum>(sparse.data(), sparse.size(), sparseHistogram);
+    EXPECT_EQ(sparseHistogram[0], 1);
+    EXPECT_EQ(sparseHistogram[1], 96);
+    EXPECT_EQ(sparseHistogram[2], 2);
+    
+    std::vector<Wide> wide;
+    for (size_t i = 0; i < 9 * 10; i++)
+    {
+        wide.push_back(WideAsEnum::AllCases[i % 9]);
+    }
+    wide.push_back(static_cast<Wide>(5));
+    size_t wideHistogram[9] = {};
+    asenum::caseHistogram<WideAsEnum>(wide.data(), wide.size(), wideHistogram);
+    for (const size_t bin : wideHistogram)
+    {
+        EXPECT_EQ(bin, 10);
+    }
+}
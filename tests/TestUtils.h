@@ -0,0 +1,77 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Alkenso (Vladimir Vashurkin)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <asenum/asenum.h>
+
+#include <gmock/gmock.h>
+
+#include <string>
+#include <vector>
+
+/// Expects 'statement' to fail: throw 'exception' or, if library is built without exceptions, terminate with error message.
+#if defined(ASENUM_NO_EXCEPTIONS)
+#define EXPECT_ASENUM_ERROR(statement, exception) EXPECT_DEATH(statement, "asenum: ")
+#else
+#define EXPECT_ASENUM_ERROR(statement, exception) EXPECT_THROW(statement, exception)
+#endif
+
+
+namespace testutils
+{
+    enum class RecordType
+    {
+        Number,
+        Text,
+        Empty
+    };
+    
+    /// Record of batch algorithms tests: trivial, heap-allocated and empty payloads.
+    using Record = asenum::AsEnum<
+    asenum::Case11<RecordType, RecordType::Number, int>,
+    asenum::Case11<RecordType, RecordType::Text, std::string>,
+    asenum::Case11<RecordType, RecordType::Empty, void>
+    >;
+    
+    /// Makes 'count' records. Case of i-th record is 'caseOf(i)', payload depends on 'i'.
+    template <typename CaseOf>
+    std::vector<Record> MakeRecords(const size_t count, const CaseOf& caseOf)
+    {
+        std::vector<Record> records;
+        records.reserve(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            switch (caseOf(i))
+            {
+                case RecordType::Number: records.push_back(Record::create<RecordType::Number>(static_cast<int>(i))); break;
+                case RecordType::Text: records.push_back(Record::create<RecordType::Text>(std::string(i % 7, 'x'))); break;
+                case RecordType::Empty: records.push_back(Record::create<RecordType::Empty>()); break;
+            }
+        }
+        
+        return records;
+    }
+}
@@ -0,0 +1,192 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Alkenso (Vladimir Vashurkin)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <asenum/flat_hash.h>
+#include <asenum/vector.h>
+
+#include <gmock/gmock.h>
+
+#include "TestUtils.h"
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+    enum class ColumnEnum
+    {
+        Number,
+        Text,
+        Empty
+    };
+    
+    using ColumnVector = asenum::AsEnumVector<
+    asenum::Case11<ColumnEnum, ColumnEnum::Number, int>,
+    asenum::Case11<ColumnEnum, ColumnEnum::Text, std::string>,
+    asenum::Case11<ColumnEnum, ColumnEnum::Empty, void>
+    >;
+    
+    using ColumnAsEnum = ColumnVector::value_type;
+}
+
+TEST(AsEnumVector, PushAndAccess)
+{
+    ColumnVector vector;
+    EXPECT_TRUE(vector.empty());
+    
+    vector.push_back<ColumnEnum::Number>(1);
+    vector.push_back<ColumnEnum::Text>("a");
+    vector.push_back<ColumnEnum::Empty>();
+    vector.push_back(ColumnAsEnum::create<ColumnEnum::Number>(2));
+    vector.push_back(ColumnAsEnum::create<ColumnEnum::Text>("b"));
+    vector.push_back(ColumnAsEnum::create<ColumnEnum::Empty>());
+    
+    ASSERT_EQ(vector.size(), 6);
+    EXPECT_EQ(vector.count<ColumnEnum::Number>(), 2);
+    EXPECT_EQ(vector.count<ColumnEnum::Text>(), 2);
+    EXPECT_EQ(vector.count<ColumnEnum::Empty>(), 2);
+    
+    EXPECT_EQ(vector.enumCase(0), ColumnEnum::Number);
+    EXPECT_EQ(vector[1].enumCase(), ColumnEnum::Text);
+    EXPECT_TRUE(vector[2].isCase<ColumnEnum::Empty>());
+    EXPECT_FALSE(vector[2].isCase<ColumnEnum::Number>());
+    
+    EXPECT_EQ(vector[3].forceAsCase<ColumnEnum::Number>(), 2);
+    EXPECT_EQ(vector[4].forceAsCase<ColumnEnum::Text>(), "b");
+    EXPECT_ASENUM_ERROR(vector[4].forceAsCase<ColumnEnum::Number>(), std::invalid_argument);
+    EXPECT_EQ(vector[3].getUnchecked<ColumnEnum::Number>(), 2);
+    EXPECT_EQ(vector[4].getUnchecked<ColumnEnum::Text>(), "b");
+    
+    bool called = false;
+    EXPECT_TRUE(vector[5].ifCase<ColumnEnum::Empty>([&called] {
+        called = true;
+    }));
+    EXPECT_TRUE(called);
+    EXPECT_FALSE(vector[5].ifCase<ColumnEnum::Text>([] (const std::string&) {}));
+    
+    const std::vector<ColumnAsEnum> expected = {
+        ColumnAsEnum::create<ColumnEnum::Number>(1),
+        ColumnAsEnum::create<ColumnEnum::Text>("a"),
+        ColumnAsEnum::create<ColumnEnum::Empty>(),
+        ColumnAsEnum::create<ColumnEnum::Number>(2),
+        ColumnAsEnum::create<ColumnEnum::Text>("b"),
+        ColumnAsEnum::create<ColumnEnum::Empty>(),
+    };
+    for (size_t i = 0; i < expected.size(); i++)
+    {
+        EXPECT_EQ(vector.toAsEnum(i), expected[i]);
+    }
+    
+    vector.clear();
+    EXPECT_TRUE(vector.empty());
+    EXPECT_EQ(vector.count<ColumnEnum::Text>(), 0);
+    EXPECT_EQ(vector.count<ColumnEnum::Empty>(), 0);
+}
+
+#if defined(ASENUM_HAS_EXCEPTIONS)
+namespace
+{
+    struct ThrowingMove
+    {
+        explicit ThrowingMove(bool fail) : fail(fail) {}
+        ThrowingMove(const ThrowingMove&) = default;
+        ThrowingMove(ThrowingMove&& other) : fail(other.fail)
+        {
+            if (fail)
+            {
+                throw std::runtime_error("move failed");
+            }
+        }
+        
+        bool fail;
+    };
+    
+    enum class ThrowingEnum
+    {
+        Value,
+        Empty
+    };
+    
+    using ThrowingVector = asenum::AsEnumVector<
+    asenum::Case11<ThrowingEnum, ThrowingEnum::Value, ThrowingMove>,
+    asenum::Case11<ThrowingEnum, ThrowingEnum::Empty, void>
+    >;
+}
+
+TEST(AsEnumVector, PushThrowingValue)
+{
+    ThrowingVector vector;
+    vector.push_back<ThrowingEnum::Value>(ThrowingMove(false));
+    
+    const ThrowingMove failing(true);
+    EXPECT_THROW(vector.push_back<ThrowingEnum::Value>(failing), std::runtime_error);
+    
+    ASSERT_EQ(vector.size(), 1);
+    EXPECT_EQ(vector.count<ThrowingEnum::Value>(), 1);
+    
+    vector.push_back<ThrowingEnum::Empty>();
+    ASSERT_EQ(vector.size(), 2);
+    EXPECT_EQ(vector.enumCase(1), ThrowingEnum::Empty);
+    EXPECT_FALSE(vector[0].getUnchecked<ThrowingEnum::Value>().fail);
+}
+#endif
+
+TEST(AsEnumVector, ForEachCase)
+{
+    ColumnVector vector;
+    for (int i = 0; i < 10; i++)
+    {
+        if (i % 3 == 0)
+        {
+            vector.push_back<ColumnEnum::Number>(i);
+        }
+        else if (i % 3 == 1)
+        {
+            vector.push_back<ColumnEnum::Text>(std::to_string(i));
+        }
+        else
+        {
+            vector.push_back<ColumnEnum::Empty>();
+        }
+    }
+    
+    std::vector<int> numbers;
+    vector.forEach<ColumnEnum::Number>([&numbers] (const int value) {
+        numbers.push_back(value);
+    });
+    EXPECT_EQ(numbers, std::vector<int>({ 0, 3, 6, 9 }));
+    EXPECT_EQ(vector.column<ColumnEnum::Number>(), numbers);
+    
+    std::string texts;
+    vector.forEach<ColumnEnum::Text>([&texts] (const std::string& value) {
+        texts += value;
+    });
+    EXPECT_EQ(texts, "147");
+    
+    size_t empties = 0;
+    vector.forEach<ColumnEnum::Empty>([&empties] {
+        empties++;
+    });
+    EXPECT_EQ(empties, 3);
+}